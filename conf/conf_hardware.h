@@ -12,6 +12,8 @@
 #ifndef CONF_HARDWARE_H
 #define CONF_HARDWARE_H
 
+#include <roboost/motor_control/robot_description.hpp>
+#include <stddef.h>
 #include <stdint.h>
 
 /**
@@ -43,62 +45,149 @@ const float WHEEL_RADIUS = 0.06; // 0.0835; // radius of wheels
 const float WHEEL_BASE = 0.3185; // distance between wheel contact point in x direction
 const float TRACK_WIDTH = 0.38;  // distance between wheel contact point in y direction
 
-//--------------------------pinout
-// definitions------------------------------------
+const float MAX_WHEEL_VELOCITY = 20.0; // maximum wheel velocity in rad/s, commands are scaled to stay below
 
-// motor front left
-const uint8_t M0_IN1 = 23;
-const uint8_t M0_IN2 = 22;
-const uint8_t M0_ENA = 21;
+/**
+ * @brief Description of the motors, one line per wheel in the order of the
+ * kinematics. The firmware builds drivers, encoders and controllers from it.
+ * in1, in2, enable: L298N pins, pwm_channel: LEDC channel of the enable pin,
+ * encoder_a, encoder_b, encoder_resolution: encoder pins and pulses per
+ * revolution, inverted: motor mounted mirrored, gains: velocity PID gains.
+ *
+ */
+constexpr roboost::motor_control::MotorGains MOTOR_GAINS = {0.105, 0.125, 0.005};
 
-// motor front right
-const uint8_t M1_IN1 = 14;
-const uint8_t M1_IN2 = 18;
-const uint8_t M1_ENA = 19;
+constexpr roboost::motor_control::MotorDescription ROBOT_MOTORS[] = {
+    {23, 22, 21, 0, 17, 16, 360, false, MOTOR_GAINS}, // front left
+    {14, 18, 19, 1, 5, 15, 600, false, MOTOR_GAINS},  // front right
+    {26, 27, 13, 2, 39, 36, 360, false, MOTOR_GAINS}, // back left
+    {32, 33, 25, 3, 35, 34, 360, false, MOTOR_GAINS}, // back right
+};
 
-// motor back left
-const uint8_t M2_IN1 = 26;
-const uint8_t M2_IN2 = 27;
-const uint8_t M2_ENA = 13;
+constexpr size_t MOTOR_COUNT = roboost::motor_control::motor_count(ROBOT_MOTORS);
 
-// motor back right
-const uint8_t M3_IN1 = 32;
-const uint8_t M3_IN2 = 33;
-const uint8_t M3_ENA = 25;
+static_assert(roboost::motor_control::has_unique_pins(ROBOT_MOTORS), "A pin is used twice in ROBOT_MOTORS");
+static_assert(roboost::motor_control::has_valid_pwm_channels(ROBOT_MOTORS, 16), "PWM channels must be unique and below 16");
+static_assert(roboost::motor_control::has_output_capable_driver_pins(ROBOT_MOTORS, 34, 39), "GPIO 34 to 39 are input only");
+static_assert(roboost::motor_control::avoids_pin_range(ROBOT_MOTORS, 6, 11), "GPIO 6 to 11 connect the SPI flash");
+static_assert(roboost::motor_control::has_valid_encoder_resolutions(ROBOT_MOTORS), "Encoder resolution must not be zero");
 
 // PWM config
-const uint8_t M0_PWM_CNL = 0;
-const uint8_t M1_PWM_CNL = 1;
-const uint8_t M2_PWM_CNL = 2;
-const uint8_t M3_PWM_CNL = 3;
-
 const uint16_t M_PWM_FRQ = 15000; // Hz
 const uint8_t M_PWM_RES = 8;      // 2^n Bits
 #endif
 
+#ifdef SWERVE_3WHEEL
+/**
+ * @brief Definitions of the swerve modules. Positions in meters relative to
+ * the robot center, module 0 points forward.
+ *
+ */
+
+const float WHEEL_RADIUS = 0.05; // radius of the drive wheels
+
+const float SWERVE_MODULE_X[3] = {0.2, -0.1, -0.1};
+const float SWERVE_MODULE_Y[3] = {0.0, 0.1732, -0.1732};
+
+const float MAX_STEERING_RATE = 6.0;   // maximum steering rate in rad/s
+const float MAX_WHEEL_VELOCITY = 20.0; // maximum wheel velocity in rad/s
+#endif
+
+// Uncomment to load the geometry and motor description from NVS at boot, the
+// values above are the fallback. New configurations are received on the
+// robot_config topic, see src/native/robot_config_tool.cpp
+// #define RUNTIME_CONFIG
+
 // Uncomment if encoders should be used in the system
 #define ENCODERS
-#ifdef ENCODERS
-
-// encoder front left
-const uint8_t M0_ENC_A = 17;
-const uint8_t M0_ENC_B = 16;
-const uint16_t M0_ENC_RESOLUTION = 360;
-
-// encoder front right
-const uint8_t M1_ENC_A = 5;
-const uint8_t M1_ENC_B = 15;
-const uint16_t M1_ENC_RESOLUTION = 600;
-
-// encoder back left
-const uint8_t M2_ENC_A = 39;
-const uint8_t M2_ENC_B = 36;
-const uint16_t M2_ENC_RESOLUTION = 360;
-
-// encoder back right
-const uint8_t M3_ENC_A = 35;
-const uint8_t M3_ENC_B = 34;
-const uint16_t M3_ENC_RESOLUTION = 360;
+
+// Period of the control loop in ms
+const uint32_t CONTROL_PERIOD_MS = 20;
+
+// Nominal model of the motors with their wheels: gain in rad/s at full duty,
+// time constant in s and inertia at the wheel in kg m^2, e.g. from
+// src/native/system_analyzer.cpp. Used by the disturbance observer and by
+// src/native/lqr_design.cpp and src/native/mpc_design.cpp
+const float MOTOR_MODEL_GAIN = 25.0;          // rad/s at full duty
+const float MOTOR_MODEL_TIME_CONSTANT = 0.08; // s
+const float MOTOR_MODEL_INERTIA = 2e-4;       // kg m^2
+
+// Uncomment to cancel load changes (carpet, rollers hitting edges, payload) with
+// a disturbance observer per wheel, built on the MOTOR_MODEL constants
+// #define DISTURBANCE_OBSERVER
+#ifdef DISTURBANCE_OBSERVER
+const float DOB_CUTOFF_FREQUENCY = 5.0; // Hz, per section of the Q-filter, below a quarter of the control rate
+const float DOB_MAX_COMPENSATION = 0.5; // duty
+#endif
+
+// Uncomment to couple the wheel velocity loops through the kinematics, so that
+// a lagging wheel does not turn the chassis. A PI law on the robot-frame
+// tracking error corrects the command, see src/native/wheel_sync_simulator.cpp
+// Higher integral gains remove the drift faster but make the chassis wobble on
+// the quantized encoder speeds, these keep the RMS yaw rate below the one of the
+// independent loops.
+// #define WHEEL_SYNCHRONIZATION
+#ifdef WHEEL_SYNCHRONIZATION
+const float SYNC_KP_LINEAR = 0.2;    // on the vx and vy error
+const float SYNC_KI_LINEAR = 1.0;    // 1/s
+const float SYNC_KP_ANGULAR = 1.5;   // on the omega error
+const float SYNC_KI_ANGULAR = 2.0;   // 1/s
+const float SYNC_MAX_INTEGRAL = 0.5; // m, rad
+#endif
+
+// Uncomment to run the wheel velocity loops with the LQR gains of conf_lqr.h
+// instead of the PID gains of the robot config. Regenerate conf_lqr.h with
+// src/native/lqr_design.cpp whenever the MOTOR_MODEL constants or CONTROL_PERIOD_MS change
+// #define LQR_CONTROL
+
+// Uncomment to run the wheel velocity loops with the explicit MPC of conf_mpc.h,
+// which keeps the duty and MAX_WHEEL_VELOCITY within limits by construction.
+// It has no integral, enable DISTURBANCE_OBSERVER to remove offsets. Regenerate
+// conf_mpc.h with src/native/mpc_design.cpp like conf_lqr.h
+// #define MPC_CONTROL
+
+// Uncomment to compute the odometry with the float polynomial sin and cos of
+// roboost/utils/fast_math.hpp (error 3e-7) instead of double precision libm,
+// see src/native/fast_math_benchmark.cpp for the speed
+// #define FAST_MATH
+
+// Commands older than the timeout are expired, the control loop then stops the
+// robot along a jerk-limited ramp within the limits below (vx, vy, omega)
+const uint32_t CMD_VEL_TIMEOUT_MS = 500;
+const float STOP_MAX_DECELERATION[3] = {1.5, 1.5, 4.0}; // m/s^2, m/s^2, rad/s^2
+const float STOP_MAX_JERK[3] = {6.0, 6.0, 16.0};        // m/s^3, m/s^3, rad/s^3
+
+// Uncomment to learn a feedforward for motions that are repeated many times,
+// e.g. docking or shuttle runs. Publish the id of the trajectory (1 to 255) on
+// ilc_run when it starts and 0 when it ends, every completed run corrects the
+// command of the next one
+// #define ILC
+#ifdef ILC
+const size_t ILC_TRAJECTORIES = 4;
+const uint32_t ILC_MAX_DURATION_MS = 10000;            // later parts of a run are not learned
+const float ILC_LEARNING_GAIN = 0.5;                   // fraction of the error learned per run
+const size_t ILC_LEAD = 1;                             // control periods from command to measured velocity
+const float ILC_CUTOFF_FREQUENCY = 2.0;                // Hz, of the Q-filter
+const float ILC_MAX_FEEDFORWARD[3] = {0.2, 0.2, 0.5};  // m/s, m/s, rad/s
+#endif
+
+// Uncomment to supervise the critical tasks with the software watchdog, which
+// also feeds the hardware task watchdog. Comment out when debugging with
+// breakpoints
+#define WATCHDOG
+
+// Uncomment if an MPU6050 is connected for the heading estimation
+// #define IMU
+#ifdef IMU
+
+// The default I2C pins 21/22 are used by M0, GPIO 0 is a strapping pin but
+// stays high during boot because of the I2C pull-ups
+const uint8_t IMU_SDA = 4;
+const uint8_t IMU_SCL = 0;
+
+#ifdef MECANUM_4WHEEL
+static_assert(roboost::motor_control::is_pin_unused(ROBOT_MOTORS, IMU_SDA) && roboost::motor_control::is_pin_unused(ROBOT_MOTORS, IMU_SCL), "IMU pins are used by a motor");
+#endif
 
 #endif
 
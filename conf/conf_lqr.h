@@ -0,0 +1,47 @@
+/**
+ * @file conf_lqr.h
+ * @author Friedl Jakob (friedl.jak@gmail.com)
+ * @brief Gains of the LQR velocity controllers.
+ * @version 0.1
+ * @date 2024-06-26
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * Regenerate both blocks with src/native/lqr_design.cpp whenever the
+ * MOTOR_MODEL constants or CONTROL_PERIOD_MS change:
+ *   lqr_design > wheel.h
+ *   lqr_design --chassis > chassis.h
+ */
+
+#ifndef CONF_LQR_H
+#define CONF_LQR_H
+
+#include <stddef.h>
+
+// Generated by src/native/lqr_design.cpp, wheel model
+// Model: gain 25.000 rad/s, time constant 0.0800 s, period 0.0200 s
+// Weights: velocity 1, integral 20, duty 40
+// Step: rise time 0.040 s, overshoot 9.1 %, peak duty 0.128
+constexpr size_t LQR_WHEEL_STATES = 1;
+constexpr size_t LQR_WHEEL_INPUTS = 1;
+constexpr size_t LQR_WHEEL_REFERENCES = 1;
+constexpr float LQR_WHEEL_SAMPLE_TIME = 0.02; // s
+constexpr float LQR_WHEEL_KX[1][1] = {{0.08794668}};
+constexpr float LQR_WHEEL_KI[1][1] = {{-0.4702696}};
+constexpr float LQR_WHEEL_KR[1][1] = {{0.1279467}};
+constexpr float LQR_WHEEL_C[1][1] = {{1}};
+
+// Generated by src/native/lqr_design.cpp, chassis model
+// Model: gain 25.000 rad/s, time constant 0.0800 s, period 0.0200 s
+// Weights: velocity 1, integral 20, duty 40
+// Step: rise time 0.040 s, overshoot 9.1 %, peak duty 0.426
+constexpr size_t LQR_CHASSIS_STATES = 4;
+constexpr size_t LQR_CHASSIS_INPUTS = 4;
+constexpr size_t LQR_CHASSIS_REFERENCES = 3;
+constexpr float LQR_CHASSIS_SAMPLE_TIME = 0.02; // s
+constexpr float LQR_CHASSIS_KX[4][4] = {{0.08423591, 0.003710774, 0.003710774, -0.003710774}, {0.003710774, 0.08423591, -0.003710774, 0.003710774}, {0.003710774, -0.003710774, 0.08423591, 0.003710774}, {-0.003710774, 0.003710774, 0.003710774, 0.08423591}};
+constexpr float LQR_CHASSIS_KI[4][3] = {{-7.837826, 7.837826, 2.737361}, {7.837826, 7.837826, 2.737361}, {-7.837826, -7.837826, 2.737361}, {7.837826, -7.837826, 2.737361}};
+constexpr float LQR_CHASSIS_KR[4][3] = {{2.132445, -2.132445, -0.7447564}, {-2.132445, -2.132445, -0.7447564}, {2.132445, 2.132445, -0.7447564}, {-2.132445, 2.132445, -0.7447564}};
+constexpr float LQR_CHASSIS_C[3][4] = {{0.015, -0.015, 0.015, -0.015}, {-0.015, -0.015, 0.015, 0.015}, {-0.04294917, -0.04294917, -0.04294917, -0.04294917}};
+
+#endif // CONF_LQR_H
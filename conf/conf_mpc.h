@@ -0,0 +1,35 @@
+/**
+ * @file conf_mpc.h
+ * @author Friedl Jakob (friedl.jak@gmail.com)
+ * @brief Region table of the explicit MPC velocity controller.
+ * @version 0.1
+ * @date 2024-06-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * Regenerate with src/native/mpc_design.cpp whenever the MOTOR_MODEL
+ * constants, CONTROL_PERIOD_MS or MAX_WHEEL_VELOCITY change:
+ *   mpc_design > wheel.h
+ * and replace the block below with it.
+ */
+
+#ifndef CONF_MPC_H
+#define CONF_MPC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Generated by src/native/mpc_design.cpp
+// Model: gain 25.000 rad/s, time constant 0.0800 s, period 0.0200 s
+// Horizon 5, weights: velocity 1, duty 40, velocity limit 20 rad/s
+// 13 regions, 5 laws, tree depth 5; step to the limit: rise time 0.120 s, peak 20.000 rad/s
+constexpr size_t MPC_WHEEL_NODES = 5;
+constexpr size_t MPC_WHEEL_LAWS = 5;
+constexpr float MPC_WHEEL_SAMPLE_TIME = 0.02; // s
+constexpr float MPC_WHEEL_VELOCITY_RANGE = 30; // rad/s, measured velocities are clamped to it
+constexpr float MPC_WHEEL_MAX_VELOCITY = 20; // rad/s, references are clamped to it
+constexpr float MPC_WHEEL_PLANES[5][3] = {{0.5428268, -0.8398447, 7.425447}, {0.4496212, -0.8932193, -11.08995}, {0.5137522, 0.8579386, 27.43382}, {0.5428268, -0.8398447, -7.425447}, {0.5137522, 0.8579386, -27.43382}};
+constexpr int16_t MPC_WHEEL_CHILDREN[5][2] = {{1, -3}, {-2, 2}, {3, -4}, {-2, 4}, {-5, -1}};
+constexpr float MPC_WHEEL_LAW_TABLE[5][3] = {{-0.07310359, 0.1131036, 0}, {0, 0, 1}, {0, 0, -1}, {-0.1408325, 0, 3.616649}, {-0.1408325, 0, -3.616649}};
+
+#endif // CONF_MPC_H
@@ -0,0 +1,171 @@
+/**
+ * @file desaturation.hpp
+ * @author Friedl Jakob (friedl.jak@gmail.com)
+ * @brief Scales robot velocity commands so that no wheel exceeds its velocity
+ * limit while the direction of travel is preserved.
+ * @version 0.1
+ * @date 2024-06-08
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DESATURATION_HPP
+#define DESATURATION_HPP
+
+#include <math.h>
+#include <stddef.h>
+
+namespace roboost
+{
+    namespace kinematics
+    {
+        /**
+         * @brief Strategy used to bring a saturated command back into the limits.
+         * UNIFORM: Scale the whole twist by the same factor.
+         * ROTATION_PRIORITY: Keep as much of the rotation as possible, scale the
+         * translation into the remaining headroom.
+         * TRANSLATION_PRIORITY: Keep as much of the translation as possible, scale
+         * the rotation into the remaining headroom.
+         */
+        enum class DesaturationMode
+        {
+            UNIFORM,
+            ROTATION_PRIORITY,
+            TRANSLATION_PRIORITY
+        };
+
+        /**
+         * @brief Desaturates robot twists (vx, vy, omega) against a wheel velocity
+         * limit.
+         *
+         * The kinematics are linear, so the wheel velocities split into a
+         * translational and a rotational part. The rotational part per unit of
+         * omega is computed once at construction, every call then costs a single
+         * inverse kinematics evaluation plus a closed form min/max over the
+         * wheels.
+         *
+         * @tparam Kinematics Kinematics providing calculate_wheel_velocity.
+         * @tparam Twist Robot velocity vector accepted by the kinematics, indexed
+         * with [] and constructible from three components.
+         * @tparam WheelCount Number of wheels.
+         */
+        template <typename Kinematics, typename Twist, size_t WheelCount = 4>
+        class TwistDesaturator
+        {
+        public:
+            /**
+             * @brief Construct a new Twist Desaturator object
+             *
+             * @param kinematics Kinematics of the robot.
+             * @param max_wheel_velocity Velocity limit of every wheel in rad/s.
+             * @param mode Desaturation strategy.
+             */
+            TwistDesaturator(Kinematics& kinematics, float max_wheel_velocity, DesaturationMode mode = DesaturationMode::UNIFORM)
+                : kinematics_(kinematics), max_wheel_velocity_(max_wheel_velocity), mode_(mode)
+            {
+                const auto wheel_rotation = kinematics_.calculate_wheel_velocity(Twist{0.0f, 0.0f, 1.0f});
+                for (size_t i = 0; i < WheelCount; i++)
+                {
+                    rotation_per_omega_[i] = static_cast<float>(wheel_rotation[i]);
+                }
+            }
+
+            /**
+             * @brief Scale a twist so that all wheel velocities stay within the limit.
+             *
+             * @param twist Commanded robot velocity (vx, vy, omega).
+             * @return Twist Desaturated robot velocity.
+             */
+            Twist desaturate(const Twist& twist)
+            {
+                const auto wheel_velocity = kinematics_.calculate_wheel_velocity(twist);
+                const float omega = static_cast<float>(twist[2]);
+
+                float rotation[WheelCount];
+                float translation[WheelCount];
+                for (size_t i = 0; i < WheelCount; i++)
+                {
+                    rotation[i] = rotation_per_omega_[i] * omega;
+                    translation[i] = static_cast<float>(wheel_velocity[i]) - rotation[i];
+                }
+
+                switch (mode_)
+                {
+                    case DesaturationMode::ROTATION_PRIORITY:
+                        rotation_scale_ = primary_scale(rotation);
+                        translation_scale_ = secondary_scale(rotation, rotation_scale_, translation);
+                        break;
+                    case DesaturationMode::TRANSLATION_PRIORITY:
+                        translation_scale_ = primary_scale(translation);
+                        rotation_scale_ = secondary_scale(translation, translation_scale_, rotation);
+                        break;
+                    default:
+                        for (size_t i = 0; i < WheelCount; i++)
+                        {
+                            translation[i] += rotation[i];
+                        }
+                        translation_scale_ = primary_scale(translation);
+                        rotation_scale_ = translation_scale_;
+                        break;
+                }
+
+                return Twist{twist[0] * translation_scale_, twist[1] * translation_scale_, twist[2] * rotation_scale_};
+            }
+
+            /**
+             * @brief Check whether the last command had to be scaled down.
+             *
+             * @return true if any wheel would have exceeded the limit.
+             */
+            bool is_saturated() const { return translation_scale_ < 1.0f || rotation_scale_ < 1.0f; }
+
+            float get_translation_scale() const { return translation_scale_; }
+
+            float get_rotation_scale() const { return rotation_scale_; }
+
+            void set_max_wheel_velocity(float max_wheel_velocity) { max_wheel_velocity_ = max_wheel_velocity; }
+
+            float get_max_wheel_velocity() const { return max_wheel_velocity_; }
+
+            void set_mode(DesaturationMode mode) { mode_ = mode; }
+
+        private:
+            // Largest factor in [0, 1] that keeps |s * w_i| <= limit for all wheels
+            float primary_scale(const float (&wheels)[WheelCount]) const
+            {
+                float max_abs = 0.0f;
+                for (size_t i = 0; i < WheelCount; i++)
+                {
+                    max_abs = fmaxf(max_abs, fabsf(wheels[i]));
+                }
+                // Division by zero yields +inf, which fminf maps to 1
+                return fminf(1.0f, max_wheel_velocity_ / max_abs);
+            }
+
+            // Largest factor in [0, 1] that keeps |s_p * p_i + s * q_i| <= limit
+            float secondary_scale(const float (&primary)[WheelCount], float primary_scale, const float (&secondary)[WheelCount]) const
+            {
+                float scale = 1.0f;
+                for (size_t i = 0; i < WheelCount; i++)
+                {
+                    // Headroom in the direction the secondary part pushes the wheel,
+                    // 0/0 yields NaN, which fminf ignores
+                    const float headroom = max_wheel_velocity_ - copysignf(1.0f, secondary[i]) * primary_scale * primary[i];
+                    scale = fminf(scale, headroom / fabsf(secondary[i]));
+                }
+                return fmaxf(0.0f, scale);
+            }
+
+            Kinematics& kinematics_;
+            float max_wheel_velocity_;
+            DesaturationMode mode_;
+            float rotation_per_omega_[WheelCount];
+            float translation_scale_ = 1.0f;
+            float rotation_scale_ = 1.0f;
+        };
+
+    } // namespace kinematics
+} // namespace roboost
+
+#endif // DESATURATION_HPP
@@ -0,0 +1,214 @@
+/**
+ * @file drive_kinematics.hpp
+ * @author Friedl Jakob (friedl.jak@gmail.com)
+ * @brief Differential, three wheel omni and mecanum kinematics with fixed size
+ * matrices and a common compile time interface.
+ * @version 0.1
+ * @date 2024-06-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * All models have constexpr constructors, so a kinematics object declared
+ * constexpr has its matrices computed by the compiler. Code that is generic
+ * over the drive type takes the kinematics as template parameter and checks it
+ * with is_drive_kinematics, there are no virtual calls.
+ */
+
+#ifndef DRIVE_KINEMATICS_HPP
+#define DRIVE_KINEMATICS_HPP
+
+#include <array>
+#include <stddef.h>
+#include <type_traits>
+#include <utility>
+
+namespace roboost
+{
+    namespace kinematics
+    {
+        /**
+         * @brief Robot velocity (vx, vy, omega) in m/s and rad/s.
+         */
+        using RobotVelocity = std::array<float, 3>;
+
+        /**
+         * @brief Kinematics given by a wheel Jacobian and its pseudo inverse.
+         *
+         * @tparam WheelCount Number of driven wheels.
+         */
+        template <size_t WheelCount>
+        class LinearDriveKinematics
+        {
+        public:
+            static constexpr size_t WHEEL_COUNT = WheelCount;
+
+            using WheelVelocity = std::array<float, WheelCount>;
+
+            /**
+             * @brief Inverse kinematics.
+             *
+             * @param robot_velocity Robot velocity (vx, vy, omega).
+             * @return WheelVelocity Wheel velocities in rad/s.
+             */
+            constexpr WheelVelocity calculate_wheel_velocity(const RobotVelocity& robot_velocity) const
+            {
+                WheelVelocity wheel_velocity = {};
+                for (size_t i = 0; i < WheelCount; i++)
+                {
+                    wheel_velocity[i] = inverse_[i][0] * robot_velocity[0] + inverse_[i][1] * robot_velocity[1] + inverse_[i][2] * robot_velocity[2];
+                }
+                return wheel_velocity;
+            }
+
+            /**
+             * @brief Forward kinematics, least squares for redundant wheels.
+             *
+             * @param wheel_velocity Wheel velocities in rad/s.
+             * @return RobotVelocity Robot velocity (vx, vy, omega).
+             */
+            constexpr RobotVelocity calculate_robot_velocity(const WheelVelocity& wheel_velocity) const
+            {
+                RobotVelocity robot_velocity = {};
+                for (size_t axis = 0; axis < 3; axis++)
+                {
+                    for (size_t i = 0; i < WheelCount; i++)
+                    {
+                        robot_velocity[axis] += forward_[axis][i] * wheel_velocity[i];
+                    }
+                }
+                return robot_velocity;
+            }
+
+        protected:
+            constexpr LinearDriveKinematics() = default;
+
+            // wheel = inverse_ * robot, robot = forward_ * wheel
+            float inverse_[WheelCount][3] = {};
+            float forward_[3][WheelCount] = {};
+        };
+
+        /**
+         * @brief Differential drive with the left wheel first. The robot cannot
+         * move sideways, vy is ignored by the inverse kinematics and zero in the
+         * forward kinematics.
+         */
+        class DifferentialDriveKinematics : public LinearDriveKinematics<2>
+        {
+        public:
+            /**
+             * @brief Construct a new Differential Drive Kinematics object
+             *
+             * @param wheel_radius Wheel radius in m.
+             * @param track_width Distance between the wheel contact points in m.
+             */
+            constexpr DifferentialDriveKinematics(float wheel_radius, float track_width)
+            {
+                inverse_[0][0] = 1.0f / wheel_radius;
+                inverse_[0][2] = -0.5f * track_width / wheel_radius;
+                inverse_[1][0] = 1.0f / wheel_radius;
+                inverse_[1][2] = 0.5f * track_width / wheel_radius;
+
+                forward_[0][0] = 0.5f * wheel_radius;
+                forward_[0][1] = 0.5f * wheel_radius;
+                forward_[2][0] = -wheel_radius / track_width;
+                forward_[2][1] = wheel_radius / track_width;
+            }
+        };
+
+        /**
+         * @brief Three omni wheels at 0, 120 and 240 deg around the robot center,
+         * each driving tangentially (counterclockwise positive).
+         */
+        class OmniKinematics3W : public LinearDriveKinematics<3>
+        {
+        public:
+            /**
+             * @brief Construct a new Omni Kinematics 3W object
+             *
+             * @param wheel_radius Wheel radius in m.
+             * @param robot_radius Distance of the wheel contact points from the robot center in m.
+             */
+            constexpr OmniKinematics3W(float wheel_radius, float robot_radius)
+            {
+                // sin and cos of the wheel positions 0, 120 and 240 deg
+                constexpr float sin_theta[3] = {0.0f, 0.866025404f, -0.866025404f};
+                constexpr float cos_theta[3] = {1.0f, -0.5f, -0.5f};
+
+                for (size_t i = 0; i < 3; i++)
+                {
+                    inverse_[i][0] = -sin_theta[i] / wheel_radius;
+                    inverse_[i][1] = cos_theta[i] / wheel_radius;
+                    inverse_[i][2] = robot_radius / wheel_radius;
+
+                    // The columns of the Jacobian are orthogonal for the symmetric layout
+                    forward_[0][i] = -2.0f / 3.0f * sin_theta[i] * wheel_radius;
+                    forward_[1][i] = 2.0f / 3.0f * cos_theta[i] * wheel_radius;
+                    forward_[2][i] = wheel_radius / (3.0f * robot_radius);
+                }
+            }
+        };
+
+        /**
+         * @brief Four wheel mecanum drive, wheel order front left, front right,
+         * back left, back right, with the same sign convention as
+         * MecanumKinematics4W.
+         */
+        class MecanumDriveKinematics : public LinearDriveKinematics<4>
+        {
+        public:
+            /**
+             * @brief Construct a new Mecanum Drive Kinematics object
+             *
+             * @param wheel_radius Wheel radius in m.
+             * @param wheel_base Distance between the wheel contact points in x direction in m.
+             * @param track_width Distance between the wheel contact points in y direction in m.
+             */
+            constexpr MecanumDriveKinematics(float wheel_radius, float wheel_base, float track_width)
+            {
+                const float k = 0.5f * (wheel_base + track_width);
+                const float signs[4][2] = {{1.0f, -1.0f}, {-1.0f, -1.0f}, {1.0f, 1.0f}, {-1.0f, 1.0f}};
+
+                for (size_t i = 0; i < 4; i++)
+                {
+                    inverse_[i][0] = signs[i][0] / wheel_radius;
+                    inverse_[i][1] = signs[i][1] / wheel_radius;
+                    inverse_[i][2] = -k / wheel_radius;
+
+                    // The columns of the Jacobian are orthogonal, each has squared norm 4 / r^2 (4 k^2 / r^2 for omega)
+                    forward_[0][i] = 0.25f * wheel_radius * signs[i][0];
+                    forward_[1][i] = 0.25f * wheel_radius * signs[i][1];
+                    forward_[2][i] = -0.25f * wheel_radius / k;
+                }
+            }
+        };
+
+        /**
+         * @brief Compile time check of the kinematics interface: WHEEL_COUNT, a
+         * WheelVelocity type, calculate_wheel_velocity(RobotVelocity) and
+         * calculate_robot_velocity(WheelVelocity).
+         */
+        template <typename Kinematics, typename = void>
+        struct is_drive_kinematics : std::false_type
+        {
+        };
+
+        template <typename Kinematics>
+        struct is_drive_kinematics<Kinematics, std::void_t<decltype(Kinematics::WHEEL_COUNT), typename Kinematics::WheelVelocity>>
+        {
+        private:
+            using WheelVelocity = typename Kinematics::WheelVelocity;
+
+            template <typename K>
+            static auto check(const K& kinematics) -> std::integral_constant<bool, std::is_same<decltype(kinematics.calculate_wheel_velocity(RobotVelocity{})), WheelVelocity>::value &&
+                                                                                          std::is_same<decltype(kinematics.calculate_robot_velocity(WheelVelocity{})), RobotVelocity>::value &&
+                                                                                          std::tuple_size<WheelVelocity>::value == Kinematics::WHEEL_COUNT>;
+            static std::false_type check(...);
+
+        public:
+            static constexpr bool value = decltype(check(std::declval<const Kinematics&>()))::value;
+        };
+
+    } // namespace kinematics
+} // namespace roboost
+
+#endif // DRIVE_KINEMATICS_HPP
@@ -0,0 +1,258 @@
+/**
+ * @file swerve_kinematics.hpp
+ * @author Friedl Jakob (friedl.jak@gmail.com)
+ * @brief Kinematics of swerve drives with independently steered and driven
+ * modules.
+ * @version 0.1
+ * @date 2024-06-15
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef SWERVE_KINEMATICS_HPP
+#define SWERVE_KINEMATICS_HPP
+
+#include <array>
+#include <math.h>
+#include <roboost/utils/fast_math.hpp>
+#include <stddef.h>
+
+namespace roboost
+{
+    namespace kinematics
+    {
+        /**
+         * @brief State of a swerve module.
+         * speed: Wheel velocity in rad/s, negative if the wheel drives backwards.
+         * angle: Steering angle in rad, 0 points along the robot x axis.
+         */
+        struct SwerveModuleState
+        {
+            float speed;
+            float angle;
+        };
+
+        /**
+         * @brief Robot velocity, vx and vy in m/s, omega in rad/s.
+         */
+        struct SwerveTwist
+        {
+            float vx;
+            float vy;
+            float omega;
+        };
+
+        /**
+         * @brief Kinematics of a swerve drive with ModuleCount modules at arbitrary
+         * positions.
+         *
+         * The inverse kinematics steer every module along the shorter way: if the
+         * target is more than 90 deg away, the module turns to the opposite angle
+         * and drives backwards. The steering rate is limited, and the wheel speed
+         * is scaled with the cosine of the remaining steering error so that a
+         * module does not push sideways while it is still turning. Only one
+         * atan2 per module is evaluated per tick.
+         *
+         * @tparam ModuleCount Number of modules, at least 2.
+         * @tparam Math sin, cos, atan2 and sqrt, double precision libm by
+         * default. PolynomialMath of fast_math.hpp avoids the emulated double
+         * arithmetic of a single precision FPU.
+         */
+        template <size_t ModuleCount, typename Math = math::LibmMath>
+        class SwerveKinematics
+        {
+        public:
+            static_assert(ModuleCount >= 2, "A swerve drive needs at least two modules");
+
+            using ModuleStates = std::array<SwerveModuleState, ModuleCount>;
+
+            /**
+             * @brief Construct a new Swerve Kinematics object
+             *
+             * @param module_x X positions of the modules relative to the robot center in m.
+             * @param module_y Y positions of the modules relative to the robot center in m.
+             * @param wheel_radius Wheel radius in m.
+             * @param max_steering_rate Maximum steering rate in rad/s.
+             */
+            SwerveKinematics(const float (&module_x)[ModuleCount], const float (&module_y)[ModuleCount], float wheel_radius, float max_steering_rate)
+                : wheel_radius_(wheel_radius), max_steering_rate_(max_steering_rate)
+            {
+                // Normal equations of the forward kinematics, A^T A with rows [1 0 -y] and [0 1 x]
+                float sum_x = 0.0f, sum_y = 0.0f, sum_r2 = 0.0f;
+                for (size_t i = 0; i < ModuleCount; i++)
+                {
+                    module_x_[i] = module_x[i];
+                    module_y_[i] = module_y[i];
+                    sum_x += module_x[i];
+                    sum_y += module_y[i];
+                    sum_r2 += module_x[i] * module_x[i] + module_y[i] * module_y[i];
+                }
+                const float n = static_cast<float>(ModuleCount);
+                const float normal[3][3] = {{n, 0.0f, -sum_y}, {0.0f, n, sum_x}, {-sum_y, sum_x, sum_r2}};
+                invert(normal, normal_inverse_);
+
+                for (size_t i = 0; i < ModuleCount; i++)
+                {
+                    states_[i] = {0.0f, 0.0f};
+                }
+            }
+
+            /**
+             * @brief Inverse kinematics with minimal rotation and steering rate limit.
+             *
+             * @param twist Commanded robot velocity.
+             * @param current_angles Measured steering angles in rad, may be unwrapped.
+             * @param dt Time since the last call in s, limits the steering change.
+             * @return const ModuleStates& Module setpoints. The angles stay continuous
+             * with current_angles, i.e. they are not wrapped.
+             */
+            const ModuleStates& calculate_module_states(const SwerveTwist& twist, const std::array<float, ModuleCount>& current_angles, float dt)
+            {
+                solve(twist, current_angles, max_steering_rate_ * dt);
+                return states_;
+            }
+
+            /**
+             * @brief Inverse kinematics without steering rate limit, e.g. for
+             * planning. Returns the minimal rotation states relative to the angles of
+             * the last call.
+             *
+             * @param twist Robot velocity.
+             * @return const ModuleStates& Module states.
+             */
+            const ModuleStates& calculate_module_states(const SwerveTwist& twist)
+            {
+                std::array<float, ModuleCount> angles;
+                for (size_t i = 0; i < ModuleCount; i++)
+                {
+                    angles[i] = states_[i].angle;
+                }
+                solve(twist, angles, INFINITY);
+                return states_;
+            }
+
+            /**
+             * @brief Forward kinematics, the least squares robot velocity for the
+             * measured module states. With more than two modules the residual
+             * absorbs the disagreement of slipping wheels.
+             *
+             * @param states Measured module states.
+             * @return SwerveTwist Robot velocity.
+             */
+            SwerveTwist calculate_robot_velocity(const ModuleStates& states) const
+            {
+                float b[3] = {0.0f, 0.0f, 0.0f};
+                for (size_t i = 0; i < ModuleCount; i++)
+                {
+                    const float v = states[i].speed * wheel_radius_;
+                    const float vx = v * Math::cos(states[i].angle);
+                    const float vy = v * Math::sin(states[i].angle);
+                    b[0] += vx;
+                    b[1] += vy;
+                    b[2] += module_x_[i] * vy - module_y_[i] * vx;
+                }
+
+                float twist[3];
+                for (size_t r = 0; r < 3; r++)
+                {
+                    twist[r] = normal_inverse_[r][0] * b[0] + normal_inverse_[r][1] * b[1] + normal_inverse_[r][2] * b[2];
+                }
+                return {twist[0], twist[1], twist[2]};
+            }
+
+            void set_max_steering_rate(float max_steering_rate) { max_steering_rate_ = max_steering_rate; }
+
+            float get_max_steering_rate() const { return max_steering_rate_; }
+
+            const ModuleStates& get_module_states() const { return states_; }
+
+        private:
+            static constexpr float PI = 3.14159265f;
+            static constexpr float HALF_PI = 0.5f * PI;
+            static constexpr float MIN_SPEED = 1e-3f; // rad/s
+
+            static float wrap(float angle)
+            {
+                while (angle > PI)
+                {
+                    angle -= 2.0f * PI;
+                }
+                while (angle < -PI)
+                {
+                    angle += 2.0f * PI;
+                }
+                return angle;
+            }
+
+            void solve(const SwerveTwist& twist, const std::array<float, ModuleCount>& current_angles, float max_step)
+            {
+                for (size_t i = 0; i < ModuleCount; i++)
+                {
+                    const float vx = twist.vx - twist.omega * module_y_[i];
+                    const float vy = twist.vy + twist.omega * module_x_[i];
+                    float speed = Math::sqrt(vx * vx + vy * vy) / wheel_radius_;
+
+                    // Standing still: keep the steering where it is
+                    if (speed < MIN_SPEED)
+                    {
+                        states_[i] = {0.0f, current_angles[i]};
+                        continue;
+                    }
+
+                    // Turn the shorter way, driving backwards if that is closer
+                    float delta = wrap(Math::atan2(vy, vx) - current_angles[i]);
+                    if (delta > HALF_PI)
+                    {
+                        delta -= PI;
+                        speed = -speed;
+                    }
+                    else if (delta < -HALF_PI)
+                    {
+                        delta += PI;
+                        speed = -speed;
+                    }
+
+                    const float step = delta > max_step ? max_step : (delta < -max_step ? -max_step : delta);
+                    states_[i] = {speed * cosine(delta - step), current_angles[i] + step};
+                }
+            }
+
+            // Cosine for |angle| <= pi / 2 from its Taylor series, clamped at zero
+            static float cosine(float angle)
+            {
+                const float a2 = angle * angle;
+                const float value = 1.0f - a2 * (0.5f - a2 * (1.0f / 24.0f));
+                return value > 0.0f ? value : 0.0f;
+            }
+
+            static void invert(const float (&m)[3][3], float (&inverse)[3][3])
+            {
+                const float det = m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+                const float inv_det = 1.0f / det;
+                inverse[0][0] = (m[1][1] * m[2][2] - m[1][2] * m[2][1]) * inv_det;
+                inverse[0][1] = (m[0][2] * m[2][1] - m[0][1] * m[2][2]) * inv_det;
+                inverse[0][2] = (m[0][1] * m[1][2] - m[0][2] * m[1][1]) * inv_det;
+                inverse[1][0] = (m[1][2] * m[2][0] - m[1][0] * m[2][2]) * inv_det;
+                inverse[1][1] = (m[0][0] * m[2][2] - m[0][2] * m[2][0]) * inv_det;
+                inverse[1][2] = (m[0][2] * m[1][0] - m[0][0] * m[1][2]) * inv_det;
+                inverse[2][0] = (m[1][0] * m[2][1] - m[1][1] * m[2][0]) * inv_det;
+                inverse[2][1] = (m[0][1] * m[2][0] - m[0][0] * m[2][1]) * inv_det;
+                inverse[2][2] = (m[0][0] * m[1][1] - m[0][1] * m[1][0]) * inv_det;
+            }
+
+            float module_x_[ModuleCount];
+            float module_y_[ModuleCount];
+            float wheel_radius_;
+            float max_steering_rate_;
+            float normal_inverse_[3][3];
+            ModuleStates states_;
+        };
+
+        using SwerveKinematics3W = SwerveKinematics<3>;
+        using SwerveKinematics4W = SwerveKinematics<4>;
+
+    } // namespace kinematics
+} // namespace roboost
+
+#endif // SWERVE_KINEMATICS_HPP
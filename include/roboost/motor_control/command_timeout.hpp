@@ -0,0 +1,277 @@
+/**
+ * @file command_timeout.hpp
+ * @author Friedl Jakob (friedl.jak@gmail.com)
+ * @brief Expiry of velocity commands with a jerk-limited stop.
+ * @version 0.1
+ * @date 2024-06-20
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * The communication side only stores commands with their arrival time. The
+ * control loop asks for the command to apply every tick. Once the newest
+ * command is older than the timeout, the last applied command is scaled down
+ * to zero along an S-curve, so all axes stop at the same time and the robot
+ * keeps its direction of travel while slowing down. The scale s goes from 1 to
+ * 0 with zero deceleration at both ends. Its rate is bounded so that no axis
+ * exceeds its maximum deceleration, and its second derivative so that no axis
+ * exceeds its maximum jerk. The deceleration ramps up linearly, is held and
+ * ramps down again. The profile is a function of the time since the
+ * expiry only, so the same command always stops the same way and the stop
+ * time is known as soon as the command expires.
+ */
+
+#ifndef COMMAND_TIMEOUT_HPP
+#define COMMAND_TIMEOUT_HPP
+
+#include <array>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace roboost
+{
+    namespace motor_control
+    {
+        /**
+         * @brief Command freshness tracking and deterministic safe deceleration.
+         *
+         * Not thread safe, set_command and update are meant to be called from
+         * the same cooperative loop.
+         *
+         * @tparam Axes Number of command axes, 3 for (vx, vy, omega).
+         */
+        template <size_t Axes = 3>
+        class CommandTimeout
+        {
+        public:
+            using Command = std::array<float, Axes>;
+
+            /**
+             * @brief Construct a new Command Timeout object
+             *
+             * @param timeout_us Maximum age of a command in microseconds.
+             * @param max_deceleration Deceleration limit per axis while stopping.
+             * @param max_jerk Jerk limit per axis while stopping.
+             */
+            CommandTimeout(uint32_t timeout_us, const float (&max_deceleration)[Axes], const float (&max_jerk)[Axes]) : timeout_us_(timeout_us)
+            {
+                for (size_t i = 0; i < Axes; i++)
+                {
+                    max_deceleration_[i] = max_deceleration[i];
+                    max_jerk_[i] = max_jerk[i];
+                }
+                output_.fill(0.0f);
+                command_.fill(0.0f);
+                stop_from_.fill(0.0f);
+            }
+
+            /**
+             * @brief Store a new command, ends a running stop.
+             *
+             * @param command Commanded velocity.
+             * @param now_us Arrival time in microseconds.
+             */
+            void set_command(const Command& command, uint64_t now_us)
+            {
+                command_ = command;
+                last_command_us_ = now_us;
+                has_command_ = true;
+                expired_ = false;
+                stopping_ = false;
+            }
+
+            /**
+             * @brief Command to apply in this control tick.
+             *
+             * @param now_us Current time from now_us64().
+             * @return const Command& The latest command while it is fresh, the
+             * stop profile after it expired and zero once stopped.
+             */
+            const Command& update(uint64_t now_us)
+            {
+                if (!has_command_)
+                {
+                    return output_;
+                }
+
+                if (!expired_)
+                {
+                    if (now_us - last_command_us_ <= timeout_us_)
+                    {
+                        output_ = command_;
+                        return output_;
+                    }
+                    begin_stop(now_us);
+                }
+
+                if (stopping_)
+                {
+                    const float t = (now_us - stop_start_us_) * 1e-6f;
+                    const float scale = t < stop_duration_ ? scale_at(t) : 0.0f;
+                    for (size_t i = 0; i < Axes; i++)
+                    {
+                        output_[i] = stop_from_[i] * scale;
+                    }
+                    stop_ticks_++;
+                    if (scale == 0.0f)
+                    {
+                        stopping_ = false;
+                        last_stop_latency_us_ = static_cast<uint32_t>(now_us - stop_start_us_);
+                        if (last_stop_latency_us_ > max_stop_latency_us_)
+                        {
+                            max_stop_latency_us_ = last_stop_latency_us_;
+                        }
+                    }
+                }
+                return output_;
+            }
+
+            /**
+             * @brief Duration of the stop from a command in seconds.
+             *
+             * With the largest command the robot can be given this bounds the
+             * stop of every timeout, ceil(stop_time / control period) + 1 ticks.
+             */
+            float stop_time(const Command& from) const
+            {
+                float rate_limit, curvature_limit;
+                if (!scale_limits(from, rate_limit, curvature_limit))
+                {
+                    return 0.0f;
+                }
+                float ramp, hold;
+                phase_durations(rate_limit, curvature_limit, ramp, hold);
+                return 2.0f * ramp + hold;
+            }
+
+            bool is_expired() const { return expired_; }
+
+            bool is_stopping() const { return stopping_; }
+
+            const Command& get_output() const { return output_; }
+
+            uint32_t get_timeout_count() const { return timeout_count_; }
+
+            /**
+             * @brief Time from the expiry until the output reached zero in the
+             * last completed stop, in microseconds.
+             */
+            uint32_t get_last_stop_latency_us() const { return last_stop_latency_us_; }
+
+            uint32_t get_max_stop_latency_us() const { return max_stop_latency_us_; }
+
+            /**
+             * @brief Control ticks of the current or last stop.
+             */
+            uint32_t get_stop_ticks() const { return stop_ticks_; }
+
+            void set_timeout(uint32_t timeout_us) { timeout_us_ = timeout_us; }
+
+            uint32_t get_timeout() const { return timeout_us_; }
+
+        private:
+            void begin_stop(uint64_t now_us)
+            {
+                expired_ = true;
+                timeout_count_++;
+                stop_from_ = output_;
+                stop_start_us_ = now_us;
+                stop_ticks_ = 0;
+
+                float rate_limit, curvature_limit;
+                stopping_ = scale_limits(stop_from_, rate_limit, curvature_limit);
+                if (stopping_)
+                {
+                    jerk_ = curvature_limit;
+                    phase_durations(rate_limit, curvature_limit, ramp_, hold_);
+                    stop_duration_ = 2.0f * ramp_ + hold_;
+                }
+                else
+                {
+                    output_.fill(0.0f);
+                    last_stop_latency_us_ = 0;
+                }
+            }
+
+            /**
+             * @brief Limits of the scale derived from the axis limits, false if
+             * the command is already zero.
+             */
+            bool scale_limits(const Command& from, float& rate_limit, float& curvature_limit) const
+            {
+                rate_limit = INFINITY;
+                curvature_limit = INFINITY;
+                for (size_t i = 0; i < Axes; i++)
+                {
+                    const float magnitude = fabsf(from[i]);
+                    if (magnitude > 0.0f)
+                    {
+                        rate_limit = fminf(rate_limit, max_deceleration_[i] / magnitude);
+                        curvature_limit = fminf(curvature_limit, max_jerk_[i] / magnitude);
+                    }
+                }
+                return isfinite(rate_limit);
+            }
+
+            /**
+             * @brief Durations of the jerk ramps and the constant deceleration in
+             * between, the scale drops by 1 in total.
+             */
+            static void phase_durations(float rate_limit, float curvature_limit, float& ramp, float& hold)
+            {
+                ramp = rate_limit / curvature_limit;
+                if (rate_limit * ramp >= 1.0f)
+                {
+                    // The deceleration limit is never reached
+                    ramp = sqrtf(1.0f / curvature_limit);
+                    hold = 0.0f;
+                }
+                else
+                {
+                    hold = 1.0f / rate_limit - ramp;
+                }
+            }
+
+            float scale_at(float t) const
+            {
+                if (t < ramp_)
+                {
+                    return 1.0f - 0.5f * jerk_ * t * t;
+                }
+                if (t < ramp_ + hold_)
+                {
+                    return 1.0f - 0.5f * jerk_ * ramp_ * ramp_ - jerk_ * ramp_ * (t - ramp_);
+                }
+                // Mirror image of the first ramp
+                const float remaining = stop_duration_ - t;
+                return 0.5f * jerk_ * remaining * remaining;
+            }
+
+            uint32_t timeout_us_;
+            float max_deceleration_[Axes];
+            float max_jerk_[Axes];
+
+            Command command_;
+            Command output_;
+            Command stop_from_;
+            uint64_t last_command_us_ = 0;
+            bool has_command_ = false;
+            bool expired_ = false;
+            bool stopping_ = false;
+
+            uint64_t stop_start_us_ = 0;
+            float jerk_ = 0.0f;
+            float ramp_ = 0.0f;
+            float hold_ = 0.0f;
+            float stop_duration_ = 0.0f;
+
+            uint32_t timeout_count_ = 0;
+            uint32_t last_stop_latency_us_ = 0;
+            uint32_t max_stop_latency_us_ = 0;
+            uint32_t stop_ticks_ = 0;
+        };
+
+    } // namespace motor_control
+} // namespace roboost
+
+#endif // COMMAND_TIMEOUT_HPP
@@ -0,0 +1,238 @@
+/**
+ * @file disturbance_observer.hpp
+ * @author Friedl Jakob (friedl.jak@gmail.com)
+ * @brief Disturbance observer that estimates the load torque of a wheel from
+ * the nominal motor model and cancels it through feedforward.
+ * @version 0.1
+ * @date 2024-06-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * The nominal motor is first order from duty to velocity, with the load acting
+ * on the input:
+ *
+ *   tau * dw/dt + w = K * (u - d)
+ *
+ * Sampled with a zero-order hold, w[k+1] = a * w[k] + b * (u[k] - d[k]) with
+ * a = exp(-T / tau) and b = K * (1 - a). Every tick the observer inverts the
+ * model with the duty applied during the last period and the velocity measured
+ * now, which leaves the disturbance in duty units. The inversion amplifies
+ * measurement noise, so it is passed through the Q-filter, FilterOrder first
+ * order lowpasses in series. The estimate is added to the next duty, the
+ * controller then sees the nominal motor no matter the load, while its integral
+ * only has to remove what the observer cannot follow. A tick is about ten
+ * multiply-adds.
+ *
+ * The load torque at the wheel is d * K * J / tau for the inertia J, since a
+ * load of d stops the motor with the same acceleration as a duty of -d.
+ */
+
+#ifndef DISTURBANCE_OBSERVER_HPP
+#define DISTURBANCE_OBSERVER_HPP
+
+#include <math.h>
+#include <roboost/motor_control/motor_drivers/motor_driver.hpp>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace roboost
+{
+    namespace motor_control
+    {
+        /**
+         * @brief Nominal first order model of a motor with its wheel.
+         * gain: Steady state velocity at full duty in rad/s.
+         * time_constant: Mechanical time constant in s.
+         * inertia: Inertia at the wheel in kg m^2, only scales the torque estimate.
+         */
+        struct MotorModel
+        {
+            float gain;
+            float time_constant;
+            float inertia;
+        };
+
+        /**
+         * @brief Load disturbance observer of one motor, duty in [-1, 1].
+         *
+         * @tparam FilterOrder Number of first order sections of the Q-filter, at
+         * least 1. Higher orders suppress more noise at the cost of lag.
+         */
+        template <size_t FilterOrder = 2>
+        class DisturbanceObserver
+        {
+        public:
+            static_assert(FilterOrder >= 1, "The Q-filter needs at least one section");
+
+            /**
+             * @brief Construct a new Disturbance Observer object
+             *
+             * @param model Nominal motor model.
+             * @param sample_time Time between two updates in s.
+             * @param cutoff_frequency Cutoff of each Q-filter section in Hz.
+             * @param max_compensation Limit of the feedforward in duty.
+             */
+            DisturbanceObserver(const MotorModel& model, float sample_time, float cutoff_frequency, float max_compensation = 1.0f)
+                : model_(model), cutoff_frequency_(cutoff_frequency), max_compensation_(max_compensation)
+            {
+                set_sample_time(sample_time);
+                reset();
+            }
+
+            /**
+             * @brief Estimate the disturbance from the velocity measured at the end
+             * of the period in which the last applied duty was active.
+             *
+             * @param velocity Measured velocity in rad/s.
+             * @return float Estimated disturbance in duty.
+             */
+            float update(float velocity)
+            {
+                if (!initialized_)
+                {
+                    previous_velocity_ = velocity;
+                    initialized_ = true;
+                    return estimate_;
+                }
+                const float raw = applied_duty_ - (velocity - a_ * previous_velocity_) * inverse_b_;
+                previous_velocity_ = velocity;
+
+                float value = raw;
+                for (size_t i = 0; i < FilterOrder; i++)
+                {
+                    state_[i] += alpha_ * (value - state_[i]);
+                    value = state_[i];
+                }
+                estimate_ = clamp(value, max_compensation_);
+                return estimate_;
+            }
+
+            /**
+             * @brief Add the estimate to the duty of the controller and remember the
+             * result as the duty of the coming period.
+             *
+             * @param duty Duty requested by the controller.
+             * @return float Duty to apply, limited to [-1, 1].
+             */
+            float compensate(float duty)
+            {
+                applied_duty_ = clamp(duty + estimate_, 1.0f);
+                return applied_duty_;
+            }
+
+            /**
+             * @brief Reset the estimate, e.g. after the motor was disabled. The next
+             * update only takes the velocity.
+             */
+            void reset()
+            {
+                for (size_t i = 0; i < FilterOrder; i++)
+                {
+                    state_[i] = 0.0f;
+                }
+                estimate_ = 0.0f;
+                applied_duty_ = 0.0f;
+                previous_velocity_ = 0.0f;
+                initialized_ = false;
+            }
+
+            void set_sample_time(float sample_time)
+            {
+                sample_time_ = sample_time;
+                a_ = expf(-sample_time / model_.time_constant);
+                inverse_b_ = 1.0f / (model_.gain * (1.0f - a_));
+                alpha_ = 1.0f - expf(-2.0f * static_cast<float>(M_PI) * cutoff_frequency_ * sample_time);
+            }
+
+            /**
+             * @brief Estimated disturbance in duty, positive for a braking load when
+             * driving forward.
+             */
+            float get_disturbance() const { return estimate_; }
+
+            /**
+             * @brief Estimated load torque at the wheel in Nm.
+             */
+            float get_load_torque() const { return estimate_ * model_.gain * model_.inertia / model_.time_constant; }
+
+            float get_applied_duty() const { return applied_duty_; }
+
+            float get_sample_time() const { return sample_time_; }
+
+            const MotorModel& get_model() const { return model_; }
+
+        private:
+            static float clamp(float value, float limit) { return value > limit ? limit : (value < -limit ? -limit : value); }
+
+            MotorModel model_;
+            float cutoff_frequency_;
+            float max_compensation_;
+            float sample_time_;
+            float a_;
+            float inverse_b_;
+            float alpha_;
+            float state_[FilterOrder];
+            float estimate_;
+            float applied_duty_;
+            float previous_velocity_;
+            bool initialized_;
+        };
+
+        /**
+         * @brief Motor driver that adds the feedforward of a disturbance observer
+         * to every command, so a velocity controller gets the observer by being
+         * handed this driver instead of the plain one.
+         *
+         * The observer is updated with the encoder velocity whenever the
+         * controller sets a new command, which it does once per control period
+         * after reading the encoder.
+         *
+         * @tparam Encoder Encoder with get_velocity() in rad/s.
+         * @tparam FilterOrder Order of the Q-filter.
+         */
+        template <typename Encoder, size_t FilterOrder = 2>
+        class DisturbanceCompensatedDriver : public MotorDriver
+        {
+        public:
+            /**
+             * @brief Construct a new Disturbance Compensated Driver object
+             *
+             * @param driver Driver of the motor.
+             * @param encoder Encoder of the motor.
+             * @param observer Observer with the model of the motor.
+             * @param full_scale Command of the driver at full duty.
+             */
+            DisturbanceCompensatedDriver(MotorDriver& driver, const Encoder& encoder, const DisturbanceObserver<FilterOrder>& observer, int32_t full_scale)
+                : driver_(driver), encoder_(encoder), observer_(observer), full_scale_(full_scale)
+            {
+            }
+
+            void set_motor_control(int32_t value) override
+            {
+                observer_.update(static_cast<float>(encoder_.get_velocity()));
+                const float duty = observer_.compensate(static_cast<float>(value) / full_scale_);
+                command_ = static_cast<int32_t>(lroundf(duty * full_scale_));
+                driver_.set_motor_control(command_);
+            }
+
+            /**
+             * @brief Command that reached the driver, including the feedforward.
+             */
+            int32_t get_motor_control() const override { return command_; }
+
+            DisturbanceObserver<FilterOrder>& get_observer() { return observer_; }
+
+            const DisturbanceObserver<FilterOrder>& get_observer() const { return observer_; }
+
+        private:
+            MotorDriver& driver_;
+            const Encoder& encoder_;
+            DisturbanceObserver<FilterOrder> observer_;
+            int32_t full_scale_;
+            int32_t command_ = 0;
+        };
+
+    } // namespace motor_control
+} // namespace roboost
+
+#endif // DISTURBANCE_OBSERVER_HPP
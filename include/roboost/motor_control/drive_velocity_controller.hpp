@@ -0,0 +1,98 @@
+/**
+ * @file drive_velocity_controller.hpp
+ * @author Friedl Jakob (friedl.jak@gmail.com)
+ * @brief Robot velocity controller instantiated per drive type.
+ * @version 0.1
+ * @date 2024-06-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DRIVE_VELOCITY_CONTROLLER_HPP
+#define DRIVE_VELOCITY_CONTROLLER_HPP
+
+#include <roboost/kinematics/drive_kinematics.hpp>
+#include <stddef.h>
+
+namespace roboost
+{
+    namespace robot_controller
+    {
+        /**
+         * @brief Same job as RobotVelocityController, but the kinematics is a
+         * template parameter instead of a Kinematics pointer. The wheel count and
+         * all matrices are known at compile time and every call is resolved
+         * statically.
+         *
+         * @tparam Kinematics Kinematics satisfying kinematics::is_drive_kinematics.
+         * @tparam MotorManager Motor controller manager with set_motor_speed(index,
+         * speed), get_motor_speed(index) and update().
+         */
+        template <typename Kinematics, typename MotorManager>
+        class DriveVelocityController
+        {
+        public:
+            static_assert(kinematics::is_drive_kinematics<Kinematics>::value, "Kinematics does not provide the drive kinematics interface");
+
+            static constexpr size_t WHEEL_COUNT = Kinematics::WHEEL_COUNT;
+
+            using RobotVelocity = kinematics::RobotVelocity;
+            using WheelVelocity = typename Kinematics::WheelVelocity;
+
+            DriveVelocityController(MotorManager& motor_manager, const Kinematics& kinematics) : motor_manager_(motor_manager), kinematics_(kinematics) {}
+
+            /**
+             * @brief Set the commanded robot velocity and compute the wheel setpoints.
+             *
+             * @param robot_velocity Robot velocity (vx, vy, omega).
+             */
+            void set_latest_command(const RobotVelocity& robot_velocity)
+            {
+                latest_command_ = robot_velocity;
+                wheel_velocity_setpoints_ = kinematics_.calculate_wheel_velocity(robot_velocity);
+            }
+
+            /**
+             * @brief Pass the setpoints to the motors, run their controllers and
+             * estimate the robot velocity from the measured wheel velocities.
+             */
+            void update()
+            {
+                for (size_t i = 0; i < WHEEL_COUNT; i++)
+                {
+                    motor_manager_.set_motor_speed(i, wheel_velocity_setpoints_[i]);
+                }
+                motor_manager_.update();
+
+                for (size_t i = 0; i < WHEEL_COUNT; i++)
+                {
+                    wheel_velocities_[i] = motor_manager_.get_motor_speed(i);
+                }
+                robot_velocity_ = kinematics_.calculate_robot_velocity(wheel_velocities_);
+            }
+
+            const RobotVelocity& get_latest_command() const { return latest_command_; }
+
+            const RobotVelocity& get_robot_vel() const { return robot_velocity_; }
+
+            const WheelVelocity& get_wheel_vel() const { return wheel_velocities_; }
+
+            const WheelVelocity& get_wheel_vel_setpoints() const { return wheel_velocity_setpoints_; }
+
+            const Kinematics& get_kinematics() const { return kinematics_; }
+
+        private:
+            MotorManager& motor_manager_;
+            const Kinematics kinematics_;
+
+            RobotVelocity latest_command_ = {};
+            RobotVelocity robot_velocity_ = {};
+            WheelVelocity wheel_velocities_ = {};
+            WheelVelocity wheel_velocity_setpoints_ = {};
+        };
+
+    } // namespace robot_controller
+} // namespace roboost
+
+#endif // DRIVE_VELOCITY_CONTROLLER_HPP
@@ -0,0 +1,307 @@
+/**
+ * @file iterative_learning.hpp
+ * @author Friedl Jakob (friedl.jak@gmail.com)
+ * @brief Iterative learning control of repeated trajectories.
+ * @version 0.1
+ * @date 2024-06-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * Docking or shuttle runs repeat the same command sequence, and the tracking
+ * error of the velocity loops repeats with it. For every trajectory, known by
+ * an id, the controller keeps a feedforward sequence with one sample per
+ * control period. During a run the feedforward of the current sample is added
+ * to the command and the tracking error is recorded. After the run the
+ * sequence is updated with the learning law
+ *
+ *   f[k] <- Q(f[k] + L * e[k + lead])
+ *
+ * The lead shifts the error by the delay from the command to the measured
+ * velocity. Q is a first order lowpass run forward and backward over the whole
+ * run, so it has no phase lag. It keeps the learning to the frequencies the
+ * loop can follow, otherwise noise and unmodelled dynamics build up over the
+ * iterations. A tick costs a buffer read and write, the learning law runs once
+ * per run.
+ */
+
+#ifndef ITERATIVE_LEARNING_HPP
+#define ITERATIVE_LEARNING_HPP
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace roboost
+{
+    namespace motor_control
+    {
+        /**
+         * @brief Learned feedforward of up to Trajectories repeated trajectories,
+         * all buffers are allocated with the object.
+         *
+         * @tparam Channels Number of command channels, e.g. 3 for (vx, vy, omega).
+         * @tparam Samples Longest run in control periods, later samples get no
+         * feedforward and are not learned.
+         * @tparam Trajectories Number of trajectories that can be learned.
+         */
+        template <size_t Channels, size_t Samples, size_t Trajectories>
+        class IterativeLearningController
+        {
+        public:
+            static_assert(Channels > 0 && Samples > 0 && Trajectories > 0, "The buffers need at least one entry");
+
+            /**
+             * @brief Construct a new Iterative Learning Controller object
+             *
+             * @param learning_gain Fraction of the error learned per run, in (0, 1].
+             * @param lead Delay from the command to the measurement in periods.
+             * @param sample_time Control period in s.
+             * @param cutoff_frequency Cutoff of the Q-filter in Hz.
+             * @param max_feedforward Limit of the feedforward of each channel.
+             */
+            IterativeLearningController(float learning_gain, size_t lead, float sample_time, float cutoff_frequency, const float (&max_feedforward)[Channels])
+                : learning_gain_(learning_gain), lead_(lead), alpha_(1.0f - expf(-2.0f * static_cast<float>(M_PI) * cutoff_frequency * sample_time))
+            {
+                for (size_t c = 0; c < Channels; c++)
+                {
+                    max_feedforward_[c] = max_feedforward[c];
+                    zero_[c] = 0.0f;
+                }
+                reset();
+            }
+
+            /**
+             * @brief Start a run of a trajectory. An unknown id takes a free slot.
+             *
+             * @param id Id of the trajectory, any value but 0.
+             * @return true The run is recorded.
+             * @return false All slots are taken by other trajectories or the id is
+             * 0. The run then gets no feedforward.
+             */
+            bool start(uint8_t id)
+            {
+                running_ = false;
+                int free = -1;
+                for (size_t t = 0; t < Trajectories; t++)
+                {
+                    if (ids_[t] == id && id != 0)
+                    {
+                        return begin(t);
+                    }
+                    if (ids_[t] == 0 && free < 0)
+                    {
+                        free = static_cast<int>(t);
+                    }
+                }
+                if (id == 0 || free < 0)
+                {
+                    return false;
+                }
+                ids_[free] = id;
+                lengths_[free] = 0;
+                iterations_[free] = 0;
+                rms_error_[free] = 0.0f;
+                for (size_t k = 0; k < Samples; k++)
+                {
+                    for (size_t c = 0; c < Channels; c++)
+                    {
+                        feedforward_[free][k][c] = 0.0f;
+                    }
+                }
+                return begin(static_cast<size_t>(free));
+            }
+
+            /**
+             * @brief Feedforward of the current sample, zero outside of a run.
+             *
+             * @return const float* Channels values to add to the command.
+             */
+            const float* get_feedforward() const { return running_ && sample_ < Samples ? feedforward_[active_][sample_] : zero_; }
+
+            /**
+             * @brief Record the tracking error of the current sample and advance to
+             * the next one.
+             *
+             * @param error Command minus measurement of each channel.
+             */
+            void record(const float (&error)[Channels])
+            {
+                if (!running_)
+                {
+                    return;
+                }
+                if (sample_ < Samples)
+                {
+                    for (size_t c = 0; c < Channels; c++)
+                    {
+                        error_[sample_][c] = error[c];
+                    }
+                }
+                sample_++;
+            }
+
+            /**
+             * @brief End the run and learn from it.
+             *
+             * @return true The feedforward was updated.
+             * @return false There was no run or it was too short to learn from.
+             */
+            bool finish()
+            {
+                if (!running_)
+                {
+                    return false;
+                }
+                running_ = false;
+                const size_t length = sample_ < Samples ? sample_ : Samples;
+                if (length <= lead_)
+                {
+                    return false;
+                }
+
+                float (*feedforward)[Channels] = feedforward_[active_];
+                float squared_error = 0.0f;
+                for (size_t c = 0; c < Channels; c++)
+                {
+                    // The error k + lead is the response to the command k, the last samples have none
+                    for (size_t k = 0; k < length; k++)
+                    {
+                        const float error = k + lead_ < length ? error_[k + lead_][c] : 0.0f;
+                        feedforward[k][c] += learning_gain_ * error;
+                        squared_error += error_[k][c] * error_[k][c];
+                    }
+                    // Beyond a shorter run nothing is known anymore
+                    for (size_t k = length; k < lengths_[active_]; k++)
+                    {
+                        feedforward[k][c] = 0.0f;
+                    }
+                    filter(feedforward, length, c);
+                }
+                lengths_[active_] = length;
+                iterations_[active_]++;
+                rms_error_[active_] = sqrtf(squared_error / (length * Channels));
+                return true;
+            }
+
+            /**
+             * @brief End the run without learning, e.g. when it was interrupted.
+             */
+            void abort() { running_ = false; }
+
+            /**
+             * @brief Drop the feedforward of a trajectory and free its slot.
+             */
+            void forget(uint8_t id)
+            {
+                for (size_t t = 0; t < Trajectories; t++)
+                {
+                    if (ids_[t] == id && id != 0)
+                    {
+                        running_ = running_ && active_ != t;
+                        ids_[t] = 0;
+                    }
+                }
+            }
+
+            /**
+             * @brief Forget all trajectories.
+             */
+            void reset()
+            {
+                running_ = false;
+                active_ = 0;
+                sample_ = 0;
+                for (size_t t = 0; t < Trajectories; t++)
+                {
+                    ids_[t] = 0;
+                    lengths_[t] = 0;
+                    iterations_[t] = 0;
+                    rms_error_[t] = 0.0f;
+                }
+            }
+
+            bool is_running() const { return running_; }
+
+            uint8_t get_active_id() const { return running_ ? ids_[active_] : 0; }
+
+            size_t get_sample() const { return sample_; }
+
+            /**
+             * @brief Number of runs learned from, 0 for an unknown trajectory.
+             */
+            uint32_t get_iterations(uint8_t id) const
+            {
+                const int t = find(id);
+                return t < 0 ? 0 : iterations_[t];
+            }
+
+            /**
+             * @brief RMS tracking error of the last learned run of a trajectory,
+             * over all channels. It should fall from run to run.
+             */
+            float get_rms_error(uint8_t id) const
+            {
+                const int t = find(id);
+                return t < 0 ? 0.0f : rms_error_[t];
+            }
+
+        private:
+            bool begin(size_t slot)
+            {
+                active_ = slot;
+                sample_ = 0;
+                running_ = true;
+                return true;
+            }
+
+            int find(uint8_t id) const
+            {
+                for (size_t t = 0; t < Trajectories; t++)
+                {
+                    if (ids_[t] == id && id != 0)
+                    {
+                        return static_cast<int>(t);
+                    }
+                }
+                return -1;
+            }
+
+            // Zero phase Q-filter, forward and backward in place, then the limit
+            void filter(float (*feedforward)[Channels], size_t length, size_t c) const
+            {
+                float state = feedforward[0][c];
+                for (size_t k = 0; k < length; k++)
+                {
+                    state += alpha_ * (feedforward[k][c] - state);
+                    feedforward[k][c] = state;
+                }
+                for (size_t k = length; k-- > 0;)
+                {
+                    state += alpha_ * (feedforward[k][c] - state);
+                    const float limit = max_feedforward_[c];
+                    feedforward[k][c] = state > limit ? limit : (state < -limit ? -limit : state);
+                }
+            }
+
+            float learning_gain_;
+            size_t lead_;
+            float alpha_;
+            float max_feedforward_[Channels];
+            float zero_[Channels];
+
+            float feedforward_[Trajectories][Samples][Channels];
+            float error_[Samples][Channels];
+            uint8_t ids_[Trajectories];
+            size_t lengths_[Trajectories];
+            uint32_t iterations_[Trajectories];
+            float rms_error_[Trajectories];
+
+            bool running_;
+            size_t active_;
+            size_t sample_;
+        };
+
+    } // namespace motor_control
+} // namespace roboost
+
+#endif // ITERATIVE_LEARNING_HPP
@@ -0,0 +1,288 @@
+/**
+ * @file robot_description.hpp
+ * @author Friedl Jakob (friedl.jak@gmail.com)
+ * @brief Constexpr description of the motors of a robot and factories that
+ * build the motor control stack from it.
+ * @version 0.1
+ * @date 2024-06-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * The description is a constexpr array of MotorDescription in conf_hardware.h.
+ * The validation functions are constexpr and meant for static_assert, so pin
+ * conflicts and invalid channels fail the build. The factories expand the
+ * description with an index sequence into the same aggregate initialization
+ * that was written by hand before, the objects are constructed in place and
+ * nothing of the description remains at runtime.
+ */
+
+#ifndef ROBOT_DESCRIPTION_HPP
+#define ROBOT_DESCRIPTION_HPP
+
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+
+namespace roboost
+{
+    namespace motor_control
+    {
+        /**
+         * @brief PID gains of a motor velocity controller.
+         */
+        struct MotorGains
+        {
+            float kp;
+            float ki;
+            float kd;
+        };
+
+        /**
+         * @brief Hardware of one motor: L298N driver pins and PWM channel,
+         * encoder pins and resolution, direction and controller gains.
+         * inverted: The motor is mounted mirrored, the factories swap the driver
+         * inputs and the encoder channels so positive speeds drive forward.
+         */
+        struct MotorDescription
+        {
+            uint8_t in1;
+            uint8_t in2;
+            uint8_t enable;
+            uint8_t pwm_channel;
+            uint8_t encoder_a;
+            uint8_t encoder_b;
+            uint16_t encoder_resolution;
+            bool inverted;
+            MotorGains gains;
+        };
+
+        /**
+         * @brief Number of motors of a description.
+         */
+        template <size_t MotorCount>
+        constexpr size_t motor_count(const MotorDescription (&)[MotorCount])
+        {
+            return MotorCount;
+        }
+
+        namespace detail
+        {
+            constexpr size_t PINS_PER_MOTOR = 5;
+
+            constexpr uint8_t pin(const MotorDescription& motor, size_t index)
+            {
+                const uint8_t pins[PINS_PER_MOTOR] = {motor.in1, motor.in2, motor.enable, motor.encoder_a, motor.encoder_b};
+                return pins[index];
+            }
+
+            template <typename T, size_t N, typename Factory, size_t... I>
+            constexpr std::array<T, N> make_array(Factory&& factory, std::index_sequence<I...>)
+            {
+                return {{factory(I)...}};
+            }
+
+            template <typename Manager, typename T, size_t N, size_t... I>
+            Manager make_manager(std::array<T, N>& controllers, std::index_sequence<I...>)
+            {
+                return Manager{&controllers[I]...};
+            }
+        } // namespace detail
+
+        /**
+         * @brief Check that no pin is used twice, neither within a motor nor
+         * across motors.
+         */
+        template <size_t MotorCount>
+        constexpr bool has_unique_pins(const MotorDescription (&motors)[MotorCount])
+        {
+            for (size_t a = 0; a < MotorCount * detail::PINS_PER_MOTOR; a++)
+            {
+                for (size_t b = a + 1; b < MotorCount * detail::PINS_PER_MOTOR; b++)
+                {
+                    if (detail::pin(motors[a / detail::PINS_PER_MOTOR], a % detail::PINS_PER_MOTOR) == detail::pin(motors[b / detail::PINS_PER_MOTOR], b % detail::PINS_PER_MOTOR))
+                    {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        /**
+         * @brief Check that a pin is not used by any motor, e.g. for the pins of
+         * other peripherals.
+         */
+        template <size_t MotorCount>
+        constexpr bool is_pin_unused(const MotorDescription (&motors)[MotorCount], uint8_t pin)
+        {
+            for (size_t a = 0; a < MotorCount * detail::PINS_PER_MOTOR; a++)
+            {
+                if (detail::pin(motors[a / detail::PINS_PER_MOTOR], a % detail::PINS_PER_MOTOR) == pin)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * @brief Check that every motor has its own PWM channel below
+         * channel_count.
+         */
+        template <size_t MotorCount>
+        constexpr bool has_valid_pwm_channels(const MotorDescription (&motors)[MotorCount], uint8_t channel_count)
+        {
+            for (size_t a = 0; a < MotorCount; a++)
+            {
+                if (motors[a].pwm_channel >= channel_count)
+                {
+                    return false;
+                }
+                for (size_t b = a + 1; b < MotorCount; b++)
+                {
+                    if (motors[a].pwm_channel == motors[b].pwm_channel)
+                    {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        /**
+         * @brief Check that the driver pins are outputs, i.e. not in the input
+         * only range [first_input_only, last_input_only] (GPIO 34 to 39 on the
+         * ESP32).
+         */
+        template <size_t MotorCount>
+        constexpr bool has_output_capable_driver_pins(const MotorDescription (&motors)[MotorCount], uint8_t first_input_only, uint8_t last_input_only)
+        {
+            for (const MotorDescription& motor : motors)
+            {
+                const uint8_t outputs[3] = {motor.in1, motor.in2, motor.enable};
+                for (uint8_t pin : outputs)
+                {
+                    if (pin >= first_input_only && pin <= last_input_only)
+                    {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        /**
+         * @brief Check that no pin of any motor is in [first, last], e.g. GPIO 6
+         * to 11, which connect the SPI flash on the ESP32.
+         */
+        template <size_t MotorCount>
+        constexpr bool avoids_pin_range(const MotorDescription (&motors)[MotorCount], uint8_t first, uint8_t last)
+        {
+            for (size_t a = 0; a < MotorCount * detail::PINS_PER_MOTOR; a++)
+            {
+                const uint8_t pin = detail::pin(motors[a / detail::PINS_PER_MOTOR], a % detail::PINS_PER_MOTOR);
+                if (pin >= first && pin <= last)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * @brief Check that every encoder has a resolution.
+         */
+        template <size_t MotorCount>
+        constexpr bool has_valid_encoder_resolutions(const MotorDescription (&motors)[MotorCount])
+        {
+            for (const MotorDescription& motor : motors)
+            {
+                if (motor.encoder_resolution == 0)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * @brief Construct one object per motor with factory(index).
+         */
+        template <typename T, size_t MotorCount, typename Factory>
+        constexpr std::array<T, MotorCount> make_per_motor(const MotorDescription (&)[MotorCount], Factory&& factory)
+        {
+            return detail::make_array<T, MotorCount>(factory, std::make_index_sequence<MotorCount>());
+        }
+
+        /**
+         * @brief Motor drivers constructed from (in1, in2, enable, pwm_channel),
+         * with swapped inputs for inverted motors.
+         */
+        template <typename Driver, size_t MotorCount>
+        std::array<Driver, MotorCount> make_motor_drivers(const MotorDescription (&motors)[MotorCount])
+        {
+            return make_per_motor<Driver>(motors,
+                                          [&motors](size_t i)
+                                          {
+                                              const MotorDescription& m = motors[i];
+                                              return Driver(m.inverted ? m.in2 : m.in1, m.inverted ? m.in1 : m.in2, m.enable, m.pwm_channel);
+                                          });
+        }
+
+        /**
+         * @brief Encoders constructed from (pin_a, pin_b, resolution), with
+         * swapped channels for inverted motors.
+         */
+        template <typename Encoder, size_t MotorCount>
+        std::array<Encoder, MotorCount> make_encoders(const MotorDescription (&motors)[MotorCount])
+        {
+            return make_per_motor<Encoder>(motors,
+                                           [&motors](size_t i)
+                                           {
+                                               const MotorDescription& m = motors[i];
+                                               return Encoder(m.inverted ? m.encoder_b : m.encoder_a, m.inverted ? m.encoder_a : m.encoder_b, m.encoder_resolution);
+                                           });
+        }
+
+        /**
+         * @brief PID controllers constructed from (kp, ki, kd,
+         * max_expected_sampling_time, max_integral).
+         */
+        template <typename Controller, size_t MotorCount>
+        std::array<Controller, MotorCount> make_pid_controllers(const MotorDescription (&motors)[MotorCount], double max_expected_sampling_time, double max_integral)
+        {
+            return make_per_motor<Controller>(motors,
+                                              [&](size_t i)
+                                              {
+                                                  const MotorGains& g = motors[i].gains;
+                                                  return Controller(g.kp, g.ki, g.kd, max_expected_sampling_time, max_integral);
+                                              });
+        }
+
+        /**
+         * @brief Motor controllers wiring up the driver, encoder, controller and
+         * filters of each motor.
+         */
+        template <typename MotorController, typename Driver, typename Encoder, typename Controller, typename InputFilter, typename OutputFilter, size_t MotorCount, typename... Args>
+        std::array<MotorController, MotorCount> make_motor_controllers(std::array<Driver, MotorCount>& drivers, std::array<Encoder, MotorCount>& encoders,
+                                                                       std::array<Controller, MotorCount>& controllers, std::array<InputFilter, MotorCount>& input_filters,
+                                                                       std::array<OutputFilter, MotorCount>& output_filters, Args&&... args)
+        {
+            return detail::make_array<MotorController, MotorCount>([&](size_t i) { return MotorController(drivers[i], encoders[i], controllers[i], input_filters[i], output_filters[i], args...); },
+                                                                   std::make_index_sequence<MotorCount>());
+        }
+
+        /**
+         * @brief Manager constructed from pointers to all motor controllers.
+         */
+        template <typename Manager, typename MotorController, size_t MotorCount>
+        Manager make_motor_controller_manager(std::array<MotorController, MotorCount>& motor_controllers)
+        {
+            return detail::make_manager<Manager>(motor_controllers, std::make_index_sequence<MotorCount>());
+        }
+
+    } // namespace motor_control
+} // namespace roboost
+
+#endif // ROBOT_DESCRIPTION_HPP
@@ -0,0 +1,144 @@
+/**
+ * @file wheel_synchronization.hpp
+ * @author Friedl Jakob (friedl.jak@gmail.com)
+ * @brief Cross-coupled synchronization of the wheel velocity loops in the robot
+ * frame.
+ * @version 0.1
+ * @date 2024-06-06
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef WHEEL_SYNCHRONIZATION_HPP
+#define WHEEL_SYNCHRONIZATION_HPP
+
+#include <array>
+#include <roboost/kinematics/kinematics.hpp>
+#include <stddef.h>
+#include <utility>
+
+namespace roboost
+{
+    namespace motor_control
+    {
+        /**
+         * @brief Couples independent wheel velocity controllers through the robot
+         * kinematics.
+         *
+         * The wheel tracking errors are mapped to a robot-frame error (vx, vy,
+         * omega) with the forward kinematics. A PI law on that error yields a
+         * robot-frame correction, which the inverse kinematics distributes back to
+         * all wheels. A wheel that lags therefore does not only get corrected by
+         * its own loop, the whole group reacts so that the chassis keeps its
+         * heading and direction of travel.
+         *
+         * The wheel correction is the inverse kinematics of the robot-frame
+         * correction, so adding get_correction() to the robot command has the
+         * same effect as adding it to the wheel setpoints.
+         *
+         * @tparam Kinematics Kinematics providing calculate_robot_velocity and
+         * calculate_wheel_velocity.
+         * @tparam WheelCount Number of wheels.
+         * @tparam Twist Robot velocity vector accepted by the kinematics, indexed
+         * with [] and constructible from three components.
+         * @tparam WheelVector Wheel velocity vector accepted by the kinematics,
+         * constructible from WheelCount components.
+         */
+        template <typename Kinematics, size_t WheelCount = 4, typename Twist = roboost::math::Vector<float>, typename WheelVector = Twist>
+        class WheelSynchronizationController
+        {
+        public:
+            using WheelArray = std::array<float, WheelCount>;
+            using RobotArray = std::array<float, 3>;
+
+            /**
+             * @brief Construct a new Wheel Synchronization Controller object
+             *
+             * @param kinematics Kinematics of the robot.
+             * @param kp_linear Proportional gain for the vx and vy error.
+             * @param ki_linear Integral gain for the vx and vy error.
+             * @param kp_angular Proportional gain for the omega error.
+             * @param ki_angular Integral gain for the omega error.
+             * @param max_integral Limit of the integrated robot-frame error.
+             */
+            WheelSynchronizationController(Kinematics& kinematics, float kp_linear, float ki_linear, float kp_angular, float ki_angular, float max_integral)
+                : kinematics_(kinematics), kp_{kp_linear, kp_linear, kp_angular}, ki_{ki_linear, ki_linear, ki_angular}, max_integral_(max_integral)
+            {
+                reset();
+            }
+
+            /**
+             * @brief Calculate synchronized wheel setpoints.
+             *
+             * @param setpoints Wheel velocity setpoints from the inverse kinematics.
+             * @param measured Measured wheel velocities.
+             * @param dt Time since the last update in seconds.
+             * @return const WheelArray& Adjusted wheel velocity setpoints.
+             */
+            const WheelArray& update(const WheelArray& setpoints, const WheelArray& measured, float dt)
+            {
+                WheelArray wheel_error;
+                for (size_t i = 0; i < WheelCount; i++)
+                {
+                    wheel_error[i] = setpoints[i] - measured[i];
+                }
+
+                const auto robot_error = kinematics_.calculate_robot_velocity(to_vector<WheelVector>(wheel_error, std::make_index_sequence<WheelCount>()));
+
+                for (size_t i = 0; i < 3; i++)
+                {
+                    robot_error_[i] = static_cast<float>(robot_error[i]);
+                    integral_[i] += robot_error_[i] * dt;
+                    integral_[i] = integral_[i] > max_integral_ ? max_integral_ : (integral_[i] < -max_integral_ ? -max_integral_ : integral_[i]);
+                    correction_[i] = kp_[i] * robot_error_[i] + ki_[i] * integral_[i];
+                }
+
+                const auto wheel_correction = kinematics_.calculate_wheel_velocity(to_vector<Twist>(correction_, std::make_index_sequence<3>()));
+                for (size_t i = 0; i < WheelCount; i++)
+                {
+                    adjusted_setpoints_[i] = setpoints[i] + static_cast<float>(wheel_correction[i]);
+                }
+                return adjusted_setpoints_;
+            }
+
+            void reset()
+            {
+                robot_error_.fill(0.0f);
+                integral_.fill(0.0f);
+                correction_.fill(0.0f);
+                adjusted_setpoints_.fill(0.0f);
+            }
+
+            const RobotArray& get_robot_error() const { return robot_error_; }
+
+            const RobotArray& get_integral() const { return integral_; }
+
+            /**
+             * @brief Robot-frame correction (vx, vy, omega) of the last update.
+             */
+            const RobotArray& get_correction() const { return correction_; }
+
+            const WheelArray& get_adjusted_setpoints() const { return adjusted_setpoints_; }
+
+        private:
+            template <typename Vector, size_t N, size_t... I>
+            static Vector to_vector(const std::array<float, N>& values, std::index_sequence<I...>)
+            {
+                return Vector{values[I]...};
+            }
+
+            Kinematics& kinematics_;
+            RobotArray kp_;
+            RobotArray ki_;
+            float max_integral_;
+            RobotArray robot_error_;
+            RobotArray integral_;
+            RobotArray correction_;
+            WheelArray adjusted_setpoints_;
+        };
+
+    } // namespace motor_control
+} // namespace roboost
+
+#endif // WHEEL_SYNCHRONIZATION_HPP
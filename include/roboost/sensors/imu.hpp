@@ -0,0 +1,107 @@
+/**
+ * @file imu.hpp
+ * @author Friedl Jakob (friedl.jak@gmail.com)
+ * @brief Common IMU sample type and a simulated IMU for native builds.
+ * @version 0.1
+ * @date 2024-06-10
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * Every IMU driver provides the same duck-typed interface:
+ *  - bool begin(): configure the sensor, returns false if it does not respond
+ *  - bool update(): read all samples that accumulated since the last call
+ *  - const ImuSample& get_sample(): averaged sample of the last update
+ */
+
+#ifndef IMU_HPP
+#define IMU_HPP
+
+#include <math.h>
+#include <stdint.h>
+
+namespace roboost
+{
+    namespace sensors
+    {
+        /**
+         * @brief IMU measurement in SI units: angular velocity in rad/s, linear
+         * acceleration in m/s^2, both in the sensor frame.
+         */
+        struct ImuSample
+        {
+            float angular_velocity[3] = {0.0f, 0.0f, 0.0f};
+            float linear_acceleration[3] = {0.0f, 0.0f, 0.0f};
+            uint16_t sample_count = 0; // Number of raw samples averaged into this one
+        };
+
+        /**
+         * @brief Stand-in for a real IMU on native builds. The true motion is set
+         * by the simulation, the readings contain a constant gyro bias and white
+         * noise from a deterministic generator.
+         */
+        class SimulatedImu
+        {
+        public:
+            /**
+             * @brief Construct a new Simulated Imu object
+             *
+             * @param gyro_bias Constant bias of the z gyro in rad/s.
+             * @param gyro_noise Standard deviation of the gyro noise in rad/s.
+             * @param seed Seed of the noise generator.
+             */
+            SimulatedImu(float gyro_bias = 0.0f, float gyro_noise = 0.0f, uint32_t seed = 1) : gyro_bias_(gyro_bias), gyro_noise_(gyro_noise), state_(seed == 0 ? 1 : seed) {}
+
+            bool begin() { return true; }
+
+            /**
+             * @brief Set the true motion of the robot.
+             *
+             * @param yaw_rate True yaw rate in rad/s.
+             * @param ax True acceleration in x in m/s^2.
+             * @param ay True acceleration in y in m/s^2.
+             */
+            void set_motion(float yaw_rate, float ax = 0.0f, float ay = 0.0f)
+            {
+                yaw_rate_ = yaw_rate;
+                ax_ = ax;
+                ay_ = ay;
+            }
+
+            bool update()
+            {
+                sample_.angular_velocity[2] = yaw_rate_ + gyro_bias_ + gyro_noise_ * gaussian();
+                sample_.linear_acceleration[0] = ax_;
+                sample_.linear_acceleration[1] = ay_;
+                sample_.linear_acceleration[2] = 9.80665f;
+                sample_.sample_count = 1;
+                return true;
+            }
+
+            const ImuSample& get_sample() const { return sample_; }
+
+        private:
+            // xorshift32, uniform in (0, 1]
+            float uniform()
+            {
+                state_ ^= state_ << 13;
+                state_ ^= state_ >> 17;
+                state_ ^= state_ << 5;
+                return (state_ >> 8) * (1.0f / 16777216.0f) + (1.0f / 33554432.0f);
+            }
+
+            // Box-Muller
+            float gaussian() { return sqrtf(-2.0f * logf(uniform())) * cosf(6.2831853f * uniform()); }
+
+            float gyro_bias_;
+            float gyro_noise_;
+            uint32_t state_;
+            float yaw_rate_ = 0.0f;
+            float ax_ = 0.0f;
+            float ay_ = 0.0f;
+            ImuSample sample_;
+        };
+
+    } // namespace sensors
+} // namespace roboost
+
+#endif // IMU_HPP
@@ -0,0 +1,203 @@
+/**
+ * @file mpu6050.hpp
+ * @author Friedl Jakob (friedl.jak@gmail.com)
+ * @brief I2C driver (ESP32 Wire) for the MPU6050 reading gyro and accelerometer
+ * data in bursts from the sensor FIFO.
+ * @version 0.1
+ * @date 2024-06-10
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * The sensor samples at a fixed rate into its FIFO, update() drains all samples
+ * that accumulated since the last call with a few burst reads and averages them.
+ * That keeps the bus traffic per control tick bounded and independent of the
+ * tick jitter.
+ */
+
+#ifndef MPU6050_HPP
+#define MPU6050_HPP
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <roboost/sensors/imu.hpp>
+
+namespace roboost
+{
+    namespace sensors
+    {
+        class MPU6050
+        {
+        public:
+            /**
+             * @brief Construct a new MPU6050 object
+             *
+             * @param wire I2C bus the sensor is connected to.
+             * @param sda SDA pin.
+             * @param scl SCL pin.
+             * @param address I2C address, 0x68 or 0x69 depending on AD0.
+             */
+            MPU6050(TwoWire& wire, uint8_t sda, uint8_t scl, uint8_t address = 0x68) : wire_(wire), sda_(sda), scl_(scl), address_(address) {}
+
+            /**
+             * @brief Configure the sensor: 200 Hz sample rate, 44 Hz DLPF, +-500 deg/s,
+             * +-4 g, gyro and accelerometer into the FIFO.
+             *
+             * @return true if the sensor responded.
+             */
+            bool begin()
+            {
+                wire_.begin(sda_, scl_, 400000);
+
+                if (read_register(REG_WHO_AM_I) != 0x68)
+                {
+                    return false;
+                }
+
+                write_register(REG_PWR_MGMT_1, 0x80); // Device reset
+                delay(100);
+                write_register(REG_PWR_MGMT_1, 0x01);   // Wake up, PLL with X gyro reference
+                write_register(REG_CONFIG, 0x03);       // DLPF 44 Hz, gyro output rate 1 kHz
+                write_register(REG_SMPLRT_DIV, 4);      // 1 kHz / (1 + 4) = 200 Hz
+                write_register(REG_GYRO_CONFIG, 0x08);  // +-500 deg/s
+                write_register(REG_ACCEL_CONFIG, 0x08); // +-4 g
+                reset_fifo();
+                return true;
+            }
+
+            /**
+             * @brief Drain the FIFO and average all samples in it.
+             *
+             * @return true if at least one new sample was read.
+             */
+            bool update()
+            {
+                uint8_t count_buffer[2];
+                if (!read_registers(REG_FIFO_COUNT_H, count_buffer, 2))
+                {
+                    return false;
+                }
+                uint16_t bytes = (static_cast<uint16_t>(count_buffer[0]) << 8) | count_buffer[1];
+
+                // An overflowed FIFO is misaligned, start over
+                if (bytes >= FIFO_SIZE)
+                {
+                    overflow_count_++;
+                    reset_fifo();
+                    return false;
+                }
+
+                uint16_t samples = bytes / SAMPLE_SIZE;
+                if (samples == 0)
+                {
+                    return false;
+                }
+
+                int32_t sum[6] = {0, 0, 0, 0, 0, 0};
+                uint16_t remaining = samples;
+                uint8_t buffer[SAMPLES_PER_BURST * SAMPLE_SIZE];
+                while (remaining > 0)
+                {
+                    uint16_t burst = remaining < SAMPLES_PER_BURST ? remaining : SAMPLES_PER_BURST;
+                    if (!read_registers(REG_FIFO_R_W, buffer, burst * SAMPLE_SIZE))
+                    {
+                        reset_fifo();
+                        return false;
+                    }
+                    for (uint16_t s = 0; s < burst; s++)
+                    {
+                        const uint8_t* raw = &buffer[s * SAMPLE_SIZE];
+                        for (uint8_t axis = 0; axis < 6; axis++)
+                        {
+                            sum[axis] += static_cast<int16_t>((raw[2 * axis] << 8) | raw[2 * axis + 1]);
+                        }
+                    }
+                    remaining -= burst;
+                }
+
+                const float scale = 1.0f / samples;
+                for (uint8_t axis = 0; axis < 3; axis++)
+                {
+                    sample_.linear_acceleration[axis] = sum[axis] * scale * ACCEL_SCALE;
+                    sample_.angular_velocity[axis] = sum[axis + 3] * scale * GYRO_SCALE;
+                }
+                sample_.sample_count = samples;
+                return true;
+            }
+
+            const ImuSample& get_sample() const { return sample_; }
+
+            uint32_t get_overflow_count() const { return overflow_count_; }
+
+        private:
+            static constexpr uint8_t REG_SMPLRT_DIV = 0x19;
+            static constexpr uint8_t REG_CONFIG = 0x1A;
+            static constexpr uint8_t REG_GYRO_CONFIG = 0x1B;
+            static constexpr uint8_t REG_ACCEL_CONFIG = 0x1C;
+            static constexpr uint8_t REG_FIFO_EN = 0x23;
+            static constexpr uint8_t REG_USER_CTRL = 0x6A;
+            static constexpr uint8_t REG_PWR_MGMT_1 = 0x6B;
+            static constexpr uint8_t REG_FIFO_COUNT_H = 0x72;
+            static constexpr uint8_t REG_FIFO_R_W = 0x74;
+            static constexpr uint8_t REG_WHO_AM_I = 0x75;
+
+            static constexpr uint16_t FIFO_SIZE = 1024;
+            static constexpr uint8_t SAMPLE_SIZE = 12;       // accel xyz + gyro xyz, 16 bit each
+            static constexpr uint8_t SAMPLES_PER_BURST = 10; // fits into the 128 byte Wire buffer
+
+            static constexpr float ACCEL_SCALE = 9.80665f / 8192.0f;            // +-4 g
+            static constexpr float GYRO_SCALE = (3.14159265f / 180.0f) / 65.5f; // +-500 deg/s
+
+            void reset_fifo()
+            {
+                write_register(REG_FIFO_EN, 0x00);
+                write_register(REG_USER_CTRL, 0x04); // FIFO reset
+                write_register(REG_USER_CTRL, 0x40); // FIFO enable
+                write_register(REG_FIFO_EN, 0x78);   // gyro xyz + accel
+            }
+
+            void write_register(uint8_t reg, uint8_t value)
+            {
+                wire_.beginTransmission(address_);
+                wire_.write(reg);
+                wire_.write(value);
+                wire_.endTransmission();
+            }
+
+            uint8_t read_register(uint8_t reg)
+            {
+                uint8_t value = 0;
+                read_registers(reg, &value, 1);
+                return value;
+            }
+
+            bool read_registers(uint8_t reg, uint8_t* buffer, uint8_t length)
+            {
+                wire_.beginTransmission(address_);
+                wire_.write(reg);
+                if (wire_.endTransmission(false) != 0)
+                {
+                    return false;
+                }
+                if (wire_.requestFrom(address_, length) != length)
+                {
+                    return false;
+                }
+                for (uint8_t i = 0; i < length; i++)
+                {
+                    buffer[i] = wire_.read();
+                }
+                return true;
+            }
+
+            TwoWire& wire_;
+            uint8_t sda_;
+            uint8_t scl_;
+            uint8_t address_;
+            ImuSample sample_;
+            uint32_t overflow_count_ = 0;
+        };
+
+    } // namespace sensors
+} // namespace roboost
+
+#endif // MPU6050_HPP
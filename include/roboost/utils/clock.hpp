@@ -0,0 +1,68 @@
+/**
+ * @file clock.hpp
+ * @author Friedl Jakob (friedl.jak@gmail.com)
+ * @brief Clock instances that are injected into components instead of reading
+ * the time from a process-wide scheduler.
+ * @version 0.1
+ * @date 2024-06-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * A clock is any type with uint64_t now_us() const. Components take the clock,
+ * or the time read from it, from their owner, so several simulated robots can
+ * run side by side in one process, each on its own time. SystemClock is the
+ * default for the firmware, ManualClock is stepped by a simulation or a test.
+ */
+
+#ifndef CLOCK_HPP
+#define CLOCK_HPP
+
+#include <atomic>
+#include <roboost/utils/timebase.hpp>
+#include <stdint.h>
+
+namespace roboost
+{
+    namespace timing
+    {
+        /**
+         * @brief Monotonic time of the system in microseconds, see now_us64().
+         */
+        class SystemClock
+        {
+        public:
+            uint64_t now_us() const { return now_us64(); }
+        };
+
+        /**
+         * @brief Simulated time, only advanced explicitly. The time may be read
+         * from other threads, e.g. a monitor, while the owner advances it.
+         */
+        class ManualClock
+        {
+        public:
+            explicit ManualClock(uint64_t start_us = 0) : now_us_(start_us) {}
+
+            uint64_t now_us() const { return now_us_.load(std::memory_order_acquire); }
+
+            void advance(uint64_t delta_us) { now_us_.store(now_us_.load(std::memory_order_relaxed) + delta_us, std::memory_order_release); }
+
+            void set(uint64_t now_us) { now_us_.store(now_us, std::memory_order_release); }
+
+        private:
+            std::atomic<uint64_t> now_us_;
+        };
+
+        /**
+         * @brief Clock for code that is not handed one, the firmware default.
+         */
+        inline SystemClock& default_clock()
+        {
+            static SystemClock clock;
+            return clock;
+        }
+
+    } // namespace timing
+} // namespace roboost
+
+#endif // CLOCK_HPP
@@ -0,0 +1,210 @@
+/**
+ * @file coroutine.hpp
+ * @author Friedl Jakob (friedl.jak@gmail.com)
+ * @brief Stackless coroutines (protothreads) for long running procedures that
+ * have to share the CPU with the control loop.
+ * @version 0.1
+ * @date 2024-06-04
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * A coroutine is a class deriving from Coroutine that implements run() between
+ * CO_BEGIN() and CO_END(). Every CO_YIELD(), CO_AWAIT() or CO_DELAY_US() returns
+ * to the caller and continues at the same point on the next resume(). Since
+ * there is no separate stack, local variables do not survive a wait point and
+ * have to be stored as members. switch statements cannot be used inside run()
+ * and there can only be one wait point per source line.
+ *
+ * @code
+ * class Blink : public Coroutine
+ * {
+ *     CoroutineStatus run() override
+ *     {
+ *         CO_BEGIN();
+ *         while (true)
+ *         {
+ *             digitalWrite(LED_BUILTIN, HIGH);
+ *             CO_DELAY_MS(500);
+ *             digitalWrite(LED_BUILTIN, LOW);
+ *             CO_DELAY_MS(500);
+ *         }
+ *         CO_END();
+ *     }
+ * };
+ * @endcode
+ */
+
+#ifndef COROUTINE_HPP
+#define COROUTINE_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace roboost
+{
+    namespace timing
+    {
+        enum class CoroutineStatus
+        {
+            RUNNING,
+            DONE
+        };
+
+        /**
+         * @brief Base class of a stackless coroutine. The state of a coroutine is
+         * the line of its last wait point plus the members of the derived class.
+         */
+        class Coroutine
+        {
+        public:
+            virtual ~Coroutine() = default;
+
+            /**
+             * @brief Continue the coroutine until its next wait point.
+             *
+             * @param now_us Current time in microseconds, used for CO_DELAY_US.
+             * @return CoroutineStatus DONE once the coroutine has finished.
+             */
+            CoroutineStatus resume(uint32_t now_us)
+            {
+                if (co_done_)
+                {
+                    return CoroutineStatus::DONE;
+                }
+                co_now_ = now_us;
+                co_done_ = run() == CoroutineStatus::DONE;
+                return co_done_ ? CoroutineStatus::DONE : CoroutineStatus::RUNNING;
+            }
+
+            /**
+             * @brief Start the coroutine from the beginning on the next resume().
+             *
+             */
+            void restart()
+            {
+                co_line_ = 0;
+                co_done_ = false;
+            }
+
+            bool is_done() const { return co_done_; }
+
+        protected:
+            /**
+             * @brief Body of the coroutine, enclosed by CO_BEGIN() and CO_END().
+             *
+             * @return CoroutineStatus RUNNING at every wait point, DONE at the end.
+             */
+            virtual CoroutineStatus run() = 0;
+
+            uint32_t co_line_ = 0;
+            uint32_t co_now_ = 0;
+            uint32_t co_wait_start_ = 0;
+            bool co_done_ = false;
+        };
+
+        /**
+         * @brief Runs a fixed number of coroutines round robin. Meant to be called
+         * from a Scheduler task or loop() so that each coroutine advances by one
+         * step per tick.
+         *
+         * @tparam MaxCoroutines Maximum number of concurrently running coroutines.
+         */
+        template <size_t MaxCoroutines>
+        class CoroutineRunner
+        {
+        public:
+            /**
+             * @brief Add a coroutine. It is removed once it is done.
+             *
+             * @param coroutine Coroutine to run, must outlive its execution.
+             * @return true if there was a free slot.
+             */
+            bool add(Coroutine& coroutine)
+            {
+                for (size_t i = 0; i < MaxCoroutines; i++)
+                {
+                    if (coroutines_[i] == nullptr)
+                    {
+                        coroutine.restart();
+                        coroutines_[i] = &coroutine;
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            /**
+             * @brief Resume every active coroutine once.
+             *
+             * @param now_us Current time in microseconds.
+             */
+            void update(uint32_t now_us)
+            {
+                for (size_t i = 0; i < MaxCoroutines; i++)
+                {
+                    if (coroutines_[i] != nullptr && coroutines_[i]->resume(now_us) == CoroutineStatus::DONE)
+                    {
+                        coroutines_[i] = nullptr;
+                    }
+                }
+            }
+
+            bool is_idle() const
+            {
+                for (size_t i = 0; i < MaxCoroutines; i++)
+                {
+                    if (coroutines_[i] != nullptr)
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+        private:
+            Coroutine* coroutines_[MaxCoroutines] = {};
+        };
+
+    } // namespace timing
+} // namespace roboost
+
+#define CO_BEGIN()                                                                                                                                                                                     \
+    switch (co_line_)                                                                                                                                                                                  \
+    {                                                                                                                                                                                                  \
+        case 0:
+
+#define CO_END()                                                                                                                                                                                       \
+    }                                                                                                                                                                                                  \
+    co_line_ = 0;                                                                                                                                                                                      \
+    return roboost::timing::CoroutineStatus::DONE
+
+#define CO_YIELD()                                                                                                                                                                                     \
+    do                                                                                                                                                                                                 \
+    {                                                                                                                                                                                                  \
+        co_line_ = __LINE__;                                                                                                                                                                           \
+        return roboost::timing::CoroutineStatus::RUNNING;                                                                                                                                              \
+        case __LINE__:;                                                                                                                                                                                \
+    } while (0)
+
+#define CO_AWAIT(condition)                                                                                                                                                                            \
+    do                                                                                                                                                                                                 \
+    {                                                                                                                                                                                                  \
+        co_line_ = __LINE__;                                                                                                                                                                           \
+        [[fallthrough]];                                                                                                                                                                               \
+        case __LINE__:                                                                                                                                                                                 \
+            if (!(condition))                                                                                                                                                                          \
+            {                                                                                                                                                                                          \
+                return roboost::timing::CoroutineStatus::RUNNING;                                                                                                                                      \
+            }                                                                                                                                                                                          \
+    } while (0)
+
+#define CO_DELAY_US(us)                                                                                                                                                                                \
+    do                                                                                                                                                                                                 \
+    {                                                                                                                                                                                                  \
+        co_wait_start_ = co_now_;                                                                                                                                                                      \
+        CO_AWAIT(static_cast<uint32_t>(co_now_ - co_wait_start_) >= static_cast<uint32_t>(us));                                                                                                        \
+    } while (0)
+
+#define CO_DELAY_MS(ms) CO_DELAY_US(static_cast<uint32_t>(ms) * 1000UL)
+
+#endif // COROUTINE_HPP
@@ -0,0 +1,291 @@
+/**
+ * @file differentiators.hpp
+ * @author Friedl Jakob (friedl.jak@gmail.com)
+ * @brief FIR differentiators from least squares polynomial fits (Savitzky-Golay,
+ * end point polynomial fit, Lanczos) with kernels computed at compile time.
+ * @version 0.1
+ * @date 2024-06-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * A polynomial of the given order is fitted to the last WindowSize samples and
+ * its slope is evaluated either at the window center or at the newest sample:
+ *
+ * - Savitzky-Golay: slope at the center. Lowest noise, (WindowSize - 1) / 2
+ *   samples delay.
+ * - Polynomial fit: slope at the newest sample. No delay for signals that are
+ *   polynomials up to the fit order, but several times the noise of the
+ *   centered fit.
+ * - Lanczos: the closed form of the centered first order fit (identical to
+ *   Savitzky-Golay of order 1 and 2).
+ *
+ * A raw finite difference over a 360 count encoder jumps by a full count per
+ * sample, all of these average the quantization noise over the window instead.
+ */
+
+#ifndef DIFFERENTIATORS_HPP
+#define DIFFERENTIATORS_HPP
+
+#include <array>
+#include <stddef.h>
+
+namespace roboost
+{
+    namespace filters
+    {
+        /**
+         * @brief Kernel that computes the slope of the least squares polynomial
+         * through WindowSize equally spaced samples, in units per sample. Element 0
+         * weights the newest sample.
+         *
+         * @tparam WindowSize Number of samples in the window.
+         * @tparam Order Order of the fitted polynomial.
+         * @param evaluation_point Position of the slope relative to the window
+         * center in samples, (WindowSize - 1) / 2 is the newest sample.
+         */
+        template <size_t WindowSize, size_t Order>
+        constexpr std::array<double, WindowSize> polynomial_derivative_kernel(double evaluation_point)
+        {
+            static_assert(Order >= 1 && Order < WindowSize, "The window has to contain more samples than the polynomial has coefficients");
+            constexpr size_t M = Order + 1;
+
+            // Normal equations (A^T A) v = g with the slope g_k = k * x_e^(k-1) of the basis,
+            // positions are centered for a well conditioned Gram matrix
+            double gram[M][M + 1] = {};
+            const double center = 0.5 * (WindowSize - 1);
+            for (size_t j = 0; j < WindowSize; j++)
+            {
+                const double x = center - j;
+                double power[2 * M] = {};
+                power[0] = 1.0;
+                for (size_t k = 1; k < 2 * M; k++)
+                {
+                    power[k] = power[k - 1] * x;
+                }
+                for (size_t r = 0; r < M; r++)
+                {
+                    for (size_t c = 0; c < M; c++)
+                    {
+                        gram[r][c] += power[r + c];
+                    }
+                }
+            }
+            double evaluation_power = 1.0;
+            for (size_t k = 1; k < M; k++)
+            {
+                gram[k][M] = k * evaluation_power;
+                evaluation_power *= evaluation_point;
+            }
+
+            // Gauss-Jordan elimination, the Gram matrix is positive definite
+            for (size_t pivot = 0; pivot < M; pivot++)
+            {
+                for (size_t r = 0; r < M; r++)
+                {
+                    if (r != pivot)
+                    {
+                        const double factor = gram[r][pivot] / gram[pivot][pivot];
+                        for (size_t c = pivot; c <= M; c++)
+                        {
+                            gram[r][c] -= factor * gram[pivot][c];
+                        }
+                    }
+                }
+            }
+
+            std::array<double, WindowSize> kernel = {};
+            for (size_t j = 0; j < WindowSize; j++)
+            {
+                const double x = center - j;
+                double power = 1.0;
+                for (size_t k = 0; k < M; k++)
+                {
+                    kernel[j] += gram[k][M] / gram[k][k] * power;
+                    power *= x;
+                }
+            }
+            return kernel;
+        }
+
+        /**
+         * @brief Savitzky-Golay differentiator kernel, slope at the window center.
+         * Delay of (WindowSize - 1) / 2 samples.
+         */
+        template <size_t WindowSize, size_t Order = 2>
+        constexpr std::array<double, WindowSize> savitzky_golay_kernel()
+        {
+            static_assert(WindowSize % 2 == 1, "Savitzky-Golay windows have an odd number of samples");
+            return polynomial_derivative_kernel<WindowSize, Order>(0.0);
+        }
+
+        /**
+         * @brief Polynomial fit differentiator kernel, slope at the newest sample.
+         * No delay, but more noise than the centered kernels.
+         */
+        template <size_t WindowSize, size_t Order = 2>
+        constexpr std::array<double, WindowSize> polynomial_fit_kernel()
+        {
+            return polynomial_derivative_kernel<WindowSize, Order>(0.5 * (WindowSize - 1));
+        }
+
+        /**
+         * @brief Lanczos (low noise) differentiator kernel,
+         * f' = 3 / (m (m + 1) (2m + 1)) * sum k (f_k - f_-k) with m = (WindowSize - 1) / 2.
+         * Delay of m samples.
+         */
+        template <size_t WindowSize>
+        constexpr std::array<double, WindowSize> lanczos_kernel()
+        {
+            static_assert(WindowSize % 2 == 1 && WindowSize >= 3, "Lanczos windows have an odd number of samples");
+            constexpr double m = (WindowSize - 1) / 2;
+            std::array<double, WindowSize> kernel = {};
+            for (size_t j = 0; j < WindowSize; j++)
+            {
+                kernel[j] = 3.0 * (m - j) / (m * (m + 1.0) * (2.0 * m + 1.0));
+            }
+            return kernel;
+        }
+
+        /**
+         * @brief Differentiates a signal, e.g. the encoder position, with a
+         * precomputed kernel.
+         *
+         * @tparam T float or double.
+         * @tparam WindowSize Kernel length.
+         */
+        template <typename T, size_t WindowSize>
+        class KernelDifferentiator
+        {
+        public:
+            /**
+             * @brief Construct a new Kernel Differentiator object
+             *
+             * @param kernel Differentiator kernel in units per sample.
+             * @param sample_time Time between two samples in seconds.
+             */
+            KernelDifferentiator(const std::array<double, WindowSize>& kernel, T sample_time)
+            {
+                for (size_t j = 0; j < WindowSize; j++)
+                {
+                    kernel_[j] = static_cast<T>(kernel[j] / sample_time);
+                }
+            }
+
+            /**
+             * @brief Add a sample and compute the derivative.
+             *
+             * @param sample New sample.
+             * @return T Derivative in units per second.
+             */
+            T update(T sample)
+            {
+                // Start from a constant signal instead of a jump from zero
+                if (!initialized_)
+                {
+                    for (size_t j = 0; j < WindowSize; j++)
+                    {
+                        history_[j] = sample;
+                    }
+                    initialized_ = true;
+                }
+
+                newest_ = newest_ + 1 < WindowSize ? newest_ + 1 : 0;
+                history_[newest_] = sample;
+
+                T derivative = 0;
+                size_t index = newest_;
+                for (size_t j = 0; j < WindowSize; j++)
+                {
+                    derivative += kernel_[j] * history_[index];
+                    index = index > 0 ? index - 1 : WindowSize - 1;
+                }
+                output_ = derivative;
+                return derivative;
+            }
+
+            void reset()
+            {
+                initialized_ = false;
+                output_ = 0;
+            }
+
+            T get_output() const { return output_; }
+
+        private:
+            T kernel_[WindowSize];
+            T history_[WindowSize] = {};
+            size_t newest_ = 0;
+            bool initialized_ = false;
+            T output_ = 0;
+        };
+
+        /**
+         * @brief Smoothing filter for finite differences, e.g. the derivative
+         * filter of a PID controller. The kernel weights sum to zero, so the
+         * kernel applied to a signal equals its cumulative sum applied to the
+         * differences of the signal. Feeding (e_k - e_k-1) / dt therefore yields
+         * exactly the derivative the kernel computes from e.
+         *
+         * @tparam T float or double.
+         * @tparam WindowSize Length of the differentiator kernel.
+         */
+        template <typename T, size_t WindowSize>
+        class DerivativeKernelFilter
+        {
+        public:
+            DerivativeKernelFilter(const std::array<double, WindowSize>& kernel)
+            {
+                double sum = 0.0;
+                for (size_t j = 0; j < TAPS; j++)
+                {
+                    sum += kernel[j];
+                    weights_[j] = static_cast<T>(sum);
+                }
+            }
+
+            /**
+             * @brief Filter the next finite difference.
+             *
+             * @param difference_quotient (e_k - e_k-1) / dt
+             * @return T Smoothed derivative.
+             */
+            T update(T difference_quotient)
+            {
+                newest_ = newest_ + 1 < TAPS ? newest_ + 1 : 0;
+                history_[newest_] = difference_quotient;
+
+                T output = 0;
+                size_t index = newest_;
+                for (size_t j = 0; j < TAPS; j++)
+                {
+                    output += weights_[j] * history_[index];
+                    index = index > 0 ? index - 1 : TAPS - 1;
+                }
+                output_ = output;
+                return output;
+            }
+
+            void reset()
+            {
+                for (size_t j = 0; j < TAPS; j++)
+                {
+                    history_[j] = 0;
+                }
+                output_ = 0;
+            }
+
+            T get_output() const { return output_; }
+
+        private:
+            static constexpr size_t TAPS = WindowSize - 1;
+
+            T weights_[TAPS];
+            T history_[TAPS] = {};
+            size_t newest_ = 0;
+            T output_ = 0;
+        };
+
+    } // namespace filters
+} // namespace roboost
+
+#endif // DIFFERENTIATORS_HPP
@@ -0,0 +1,120 @@
+/**
+ * @file explicit_mpc_controller.hpp
+ * @author Friedl Jakob (friedl.jak@gmail.com)
+ * @brief Wheel velocity MPC evaluated from a precomputed region table.
+ * @version 0.1
+ * @date 2024-06-27
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * Solving the MPC problem online does not fit into a control tick, but for a
+ * wheel its solution only depends on the measured velocity and the reference.
+ * src/native/mpc_design.cpp solves it offline for all of them: the first duty
+ * is affine within each of a few polygonal regions of that plane, with the
+ * duty limits and the velocity limit respected. It writes the affine laws and
+ * a binary search tree over the region edges into conf/conf_mpc.h. Per tick the
+ * controller descends the tree with one comparison of a line per level and
+ * evaluates the law of the leaf, a few dozen multiply-adds with the default
+ * table. The tables are read in place, so they stay in flash.
+ *
+ * The controller has no integral, the nominal model fixes the steady state
+ * duty. Model error and load therefore leave an offset, which the disturbance
+ * observer (DISTURBANCE_OBSERVER) removes.
+ */
+
+#ifndef EXPLICIT_MPC_CONTROLLER_HPP
+#define EXPLICIT_MPC_CONTROLLER_HPP
+
+#include <roboost/utils/controllers.hpp>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace roboost
+{
+    namespace controllers
+    {
+        /**
+         * @brief Explicit MPC for one wheel velocity.
+         *
+         * Node i of the tree sends (velocity, reference) to children[i][0] if
+         * planes[i][0] * velocity + planes[i][1] * reference <= planes[i][2],
+         * otherwise to children[i][1]. A child c >= 0 is the next node, c < 0
+         * selects law -c - 1, duty = laws[l][0] * velocity + laws[l][1] * reference +
+         * laws[l][2]. Node 0 is the root. It has the Controller interface, so
+         * it replaces the PIDController of a VelocityController.
+         *
+         * @tparam Nodes Number of tree nodes.
+         * @tparam Laws Number of affine laws.
+         */
+        template <size_t Nodes, size_t Laws>
+        class ExplicitMPCController : public Controller
+        {
+        public:
+            /**
+             * @brief Construct a new Explicit MPC Controller object
+             *
+             * @param planes Line of each node.
+             * @param children Children of each node.
+             * @param laws Affine law of each leaf.
+             * @param velocity_range Measured velocities covered by the table in rad/s.
+             * @param max_velocity References covered by the table in rad/s.
+             * @param output_limit Output is limited to +-output_limit.
+             */
+            ExplicitMPCController(const float (&planes)[Nodes][3], const int16_t (&children)[Nodes][2], const float (&laws)[Laws][3], float velocity_range, float max_velocity,
+                                  float output_limit = 1.0f)
+                : planes_(planes), children_(children), laws_(laws), velocity_range_(velocity_range), max_velocity_(max_velocity), output_limit_(output_limit)
+            {
+            }
+
+            /**
+             * @brief Compute the duty for the next period. Inputs outside the table
+             * are clamped to it, for the reference this is the velocity limit.
+             *
+             * @param setpoint Reference velocity.
+             * @param input Measured velocity.
+             * @return double Control output.
+             */
+            double update(double setpoint, double input) override
+            {
+                const float reference = clamp(static_cast<float>(setpoint), max_velocity_);
+                const float velocity = clamp(static_cast<float>(input), velocity_range_);
+
+                // Every level leaves the node for a child, a well formed tree reaches a leaf within Nodes steps
+                int child = 0;
+                for (size_t depth = 0; depth < Nodes && child >= 0; depth++)
+                {
+                    const float* plane = planes_[child];
+                    child = children_[child][plane[0] * velocity + plane[1] * reference <= plane[2] ? 0 : 1];
+                }
+                law_ = child < 0 ? static_cast<size_t>(-child - 1) : 0;
+
+                const float* law = laws_[law_];
+                return clamp(law[0] * velocity + law[1] * reference + law[2], output_limit_);
+            }
+
+            /**
+             * @brief Index of the law used by the last update, e.g. to see whether
+             * the duty or the velocity limit was active.
+             */
+            size_t get_law() const { return law_; }
+
+            float get_output_limit() const { return output_limit_; }
+
+            float get_max_velocity() const { return max_velocity_; }
+
+        private:
+            static float clamp(float value, float limit) { return value > limit ? limit : (value < -limit ? -limit : value); }
+
+            const float (*planes_)[3];
+            const int16_t (*children_)[2];
+            const float (*laws_)[3];
+            float velocity_range_;
+            float max_velocity_;
+            float output_limit_;
+            size_t law_ = 0;
+        };
+
+    } // namespace controllers
+} // namespace roboost
+
+#endif // EXPLICIT_MPC_CONTROLLER_HPP
@@ -0,0 +1,464 @@
+/**
+ * @file fast_math.hpp
+ * @author Friedl Jakob (friedl.jak@gmail.com)
+ * @brief Table-interpolated and polynomial sin, cos, atan2 and sqrt in float
+ * and fixed point.
+ * @version 0.1
+ * @date 2024-06-24
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * The ESP32 has a single precision FPU without trigonometric functions, and
+ * double precision is emulated in software. The functions here need a few
+ * multiply-adds instead, at known worst case errors over the whole input range
+ * (checked in test/test_fast_math.hpp):
+ *
+ *   poly_sin, poly_cos     3e-7        minimax degree 9 on [-pi/2, pi/2]
+ *   poly_atan2             2e-6 rad    minimax degree 11 on [0, 1]
+ *   poly_sqrt              3e-7 rel.   cubic seed and two Newton steps
+ *   table_sin, table_cos   8e-5        256 intervals per turn, linear
+ *   table_atan2            2e-6 rad    256 intervals on [0, 1], linear
+ *   table_sqrt             5e-6 rel.   256 intervals on [0.25, 1), linear
+ *   sin_q15, cos_q15       4 LSB       binary angle, 256 intervals per turn
+ *   atan2_bam              4 bam       minimax degree 7 in Q15 arithmetic
+ *   isqrt, sqrt_q16        exact floor digit by digit
+ *
+ * Float angles are accurate for |x| < 1000 rad, beyond that the error of the
+ * range reduction grows with |x|. The tables are computed at compile time and
+ * live in flash. LibmMath, PolynomialMath and TableMath bundle the functions
+ * for code that takes the math as a template parameter. LibmMath is double
+ * precision libm and the default, the float approximations are opt-in, see
+ * src/native/fast_math_benchmark.cpp for the speed on native and
+ * src/testing/fast_math_benchmark.cpp on the target.
+ */
+
+#ifndef FAST_MATH_HPP
+#define FAST_MATH_HPP
+
+#include <array>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace roboost
+{
+    namespace math
+    {
+        constexpr float PI_F = 3.14159265358979f;
+        constexpr float HALF_PI_F = 1.57079632679490f;
+        constexpr float TWO_PI_F = 6.28318530717959f;
+
+        // Intervals of the float tables and the Q15 sine table
+        constexpr size_t SIN_TABLE_SIZE = 256;
+        constexpr size_t ATAN_TABLE_SIZE = 256;
+        constexpr size_t SQRT_TABLE_SIZE = 256;
+
+        namespace detail
+        {
+            // Double precision series to fill the tables at compile time
+            constexpr double PI_D = 3.14159265358979323846;
+
+            constexpr double series_sin(double x)
+            {
+                while (x > PI_D)
+                {
+                    x -= 2.0 * PI_D;
+                }
+                double term = x;
+                double sum = x;
+                for (int n = 1; n < 30; n++)
+                {
+                    term *= -x * x / ((2 * n) * (2 * n + 1));
+                    sum += term;
+                }
+                return sum;
+            }
+
+            constexpr double series_sqrt(double x)
+            {
+                double y = x > 1.0 ? x : 1.0;
+                for (int i = 0; i < 64; i++)
+                {
+                    y = 0.5 * (y + x / y);
+                }
+                return y;
+            }
+
+            // atan(z) = 2 atan(z / (1 + sqrt(1 + z^2))) brings z below 0.42 for a fast series
+            constexpr double series_atan(double z)
+            {
+                const double half = z / (1.0 + series_sqrt(1.0 + z * z));
+                double term = half;
+                double sum = half;
+                for (int n = 1; n < 40; n++)
+                {
+                    term *= -half * half;
+                    sum += term / (2 * n + 1);
+                }
+                return 2.0 * sum;
+            }
+
+            template <typename T, size_t N, typename Function>
+            constexpr std::array<T, N + 1> make_table(Function function)
+            {
+                std::array<T, N + 1> table{};
+                for (size_t i = 0; i <= N; i++)
+                {
+                    table[i] = function(i);
+                }
+                return table;
+            }
+
+            inline float from_bits(uint32_t bits)
+            {
+                float value;
+                memcpy(&value, &bits, sizeof(value));
+                return value;
+            }
+
+            inline uint32_t to_bits(float value)
+            {
+                uint32_t bits;
+                memcpy(&bits, &value, sizeof(bits));
+                return bits;
+            }
+
+            // Split x > 0 into m * 4^exponent with m in [0.25, 1), so that sqrt(x) = sqrt(m) * 2^exponent
+            inline float split_sqrt_argument(float x, int32_t& exponent)
+            {
+                const uint32_t bits = to_bits(x);
+                const int32_t binary_exponent = static_cast<int32_t>((bits >> 23) & 0xFF) - 126;
+                float m = from_bits((bits & 0x007FFFFF) | (126u << 23));
+                if (binary_exponent & 1)
+                {
+                    m *= 0.5f;
+                    exponent = (binary_exponent + 1) / 2;
+                }
+                else
+                {
+                    exponent = binary_exponent / 2;
+                }
+                return m;
+            }
+
+            inline float scale_by_power_of_two(float x, int32_t exponent) { return x * from_bits(static_cast<uint32_t>(127 + exponent) << 23); }
+
+            // Reduce x to [-pi, pi], the constant 2 pi is split in two parts to keep the reduction exact
+            inline float reduce_angle(float x)
+            {
+                const float turns = nearbyintf(x * (1.0f / TWO_PI_F));
+                return (x - turns * 6.28125f) - turns * 1.93530717959e-3f;
+            }
+
+            // atan2 from atan on [0, 1], the octant is restored from the signs and the swap
+            template <typename Atan>
+            inline float atan2_octant(float y, float x, Atan atan01)
+            {
+                const float abs_x = fabsf(x);
+                const float abs_y = fabsf(y);
+                if (abs_x == 0.0f && abs_y == 0.0f)
+                {
+                    return 0.0f;
+                }
+                const bool swap = abs_y > abs_x;
+                float angle = atan01(swap ? abs_x / abs_y : abs_y / abs_x);
+                if (swap)
+                {
+                    angle = HALF_PI_F - angle;
+                }
+                if (x < 0.0f)
+                {
+                    angle = PI_F - angle;
+                }
+                return y < 0.0f ? -angle : angle;
+            }
+
+            inline float interpolate(const float* table, float position)
+            {
+                const int32_t index = static_cast<int32_t>(position);
+                const float fraction = position - static_cast<float>(index);
+                return table[index] + fraction * (table[index + 1] - table[index]);
+            }
+
+        } // namespace detail
+
+        // sin(2 pi i / N) for i = 0..N
+        constexpr std::array<float, SIN_TABLE_SIZE + 1> SIN_TABLE =
+            detail::make_table<float, SIN_TABLE_SIZE>([](size_t i) { return static_cast<float>(detail::series_sin(2.0 * detail::PI_D * i / SIN_TABLE_SIZE)); });
+
+        // atan(i / N) for i = 0..N
+        constexpr std::array<float, ATAN_TABLE_SIZE + 1> ATAN_TABLE =
+            detail::make_table<float, ATAN_TABLE_SIZE>([](size_t i) { return static_cast<float>(detail::series_atan(static_cast<double>(i) / ATAN_TABLE_SIZE)); });
+
+        // sqrt(0.25 + 0.75 i / N) for i = 0..N
+        constexpr std::array<float, SQRT_TABLE_SIZE + 1> SQRT_TABLE =
+            detail::make_table<float, SQRT_TABLE_SIZE>([](size_t i) { return static_cast<float>(detail::series_sqrt(0.25 + 0.75 * i / SQRT_TABLE_SIZE)); });
+
+        // Q15 sine, sin(2 pi i / N) * 32768 saturated at 32767
+        constexpr std::array<int16_t, SIN_TABLE_SIZE + 1> SIN_TABLE_Q15 = detail::make_table<int16_t, SIN_TABLE_SIZE>(
+            [](size_t i)
+            {
+                const double value = detail::series_sin(2.0 * detail::PI_D * i / SIN_TABLE_SIZE) * 32768.0;
+                const double rounded = value < 0.0 ? value - 0.5 : value + 0.5;
+                return static_cast<int16_t>(rounded > 32767.0 ? 32767 : static_cast<int32_t>(rounded));
+            });
+
+        // ---------------------------------------------------------------------
+        // Float, polynomial
+
+        /**
+         * @brief Sine from a minimax polynomial of degree 9, error below 3e-7.
+         */
+        inline float poly_sin(float x)
+        {
+            float r = detail::reduce_angle(x);
+            // sin(r) = sin(pi - r), folds r into [-pi/2, pi/2]
+            if (r > HALF_PI_F)
+            {
+                r = PI_F - r;
+            }
+            else if (r < -HALF_PI_F)
+            {
+                r = -PI_F - r;
+            }
+            const float r2 = r * r;
+            return r * (9.9999999916e-01f + r2 * (-1.6666662484e-01f + r2 * (8.3331307782e-03f + r2 * (-1.9813423871e-04f + r2 * 2.6125380358e-06f))));
+        }
+
+        /**
+         * @brief Cosine from a minimax polynomial of degree 9, error below 3e-7.
+         */
+        inline float poly_cos(float x)
+        {
+            // cos(r) = sin(pi/2 - |r|), which is in [-pi/2, pi/2] for r in [-pi, pi]
+            const float r = HALF_PI_F - fabsf(detail::reduce_angle(x));
+            const float r2 = r * r;
+            return r * (9.9999999916e-01f + r2 * (-1.6666662484e-01f + r2 * (8.3331307782e-03f + r2 * (-1.9813423871e-04f + r2 * 2.6125380358e-06f))));
+        }
+
+        /**
+         * @brief atan2 from a minimax polynomial of degree 11, error below 2e-6
+         * rad. Returns 0 for (0, 0).
+         */
+        inline float poly_atan2(float y, float x)
+        {
+            return detail::atan2_octant(y, x,
+                                        [](float z)
+                                        {
+                                            const float z2 = z * z;
+                                            return z * (9.9997721908e-01f +
+                                                        z2 * (-3.3262282789e-01f + z2 * (1.9354037608e-01f + z2 * (-1.1642648197e-01f + z2 * (5.2647351466e-02f + z2 * -1.1719135734e-02f)))));
+                                        });
+        }
+
+        /**
+         * @brief Square root from a cubic seed of 1 / sqrt and two Newton
+         * steps, relative error below 3e-7. Returns 0 for x <= 0 and for
+         * subnormal x.
+         */
+        inline float poly_sqrt(float x)
+        {
+            if (!(x >= 1.17549435e-38f))
+            {
+                return 0.0f;
+            }
+            int32_t exponent;
+            const float m = detail::split_sqrt_argument(x, exponent);
+            // Minimax of 1 / sqrt(m) on [0.25, 1), relative error 7e-3
+            float y = 3.112374f + m * (-5.910904f + m * (6.229943f + m * -2.438453f));
+            y = y * (1.5f - 0.5f * m * y * y);
+            y = y * (1.5f - 0.5f * m * y * y);
+            return detail::scale_by_power_of_two(m * y, exponent);
+        }
+
+        // ---------------------------------------------------------------------
+        // Float, table
+
+        /**
+         * @brief Sine interpolated from SIN_TABLE, error below 8e-5.
+         */
+        inline float table_sin(float x)
+        {
+            float position = detail::reduce_angle(x) * (SIN_TABLE_SIZE / TWO_PI_F);
+            if (position < 0.0f)
+            {
+                position += SIN_TABLE_SIZE;
+            }
+            // Rounding can land exactly on the end of the turn
+            if (position >= SIN_TABLE_SIZE)
+            {
+                position -= SIN_TABLE_SIZE;
+            }
+            return detail::interpolate(SIN_TABLE.data(), position);
+        }
+
+        /**
+         * @brief Cosine interpolated from SIN_TABLE, error below 8e-5.
+         */
+        inline float table_cos(float x) { return table_sin(detail::reduce_angle(x) + HALF_PI_F); }
+
+        /**
+         * @brief atan2 interpolated from ATAN_TABLE, error below 2e-6 rad.
+         * Returns 0 for (0, 0).
+         */
+        inline float table_atan2(float y, float x)
+        {
+            return detail::atan2_octant(y, x,
+                                        [](float z)
+                                        {
+                                            // z is at most 1, the last interval is interpolated up to its end
+                                            const float position = z * ATAN_TABLE_SIZE;
+                                            return detail::interpolate(ATAN_TABLE.data(), position < ATAN_TABLE_SIZE ? position : ATAN_TABLE_SIZE - 1e-3f);
+                                        });
+        }
+
+        /**
+         * @brief Square root interpolated from SQRT_TABLE, relative error below
+         * 5e-6. Returns 0 for x <= 0 and for subnormal x.
+         */
+        inline float table_sqrt(float x)
+        {
+            if (!(x >= 1.17549435e-38f))
+            {
+                return 0.0f;
+            }
+            int32_t exponent;
+            const float m = detail::split_sqrt_argument(x, exponent);
+            const float root = detail::interpolate(SQRT_TABLE.data(), (m - 0.25f) * (SQRT_TABLE_SIZE / 0.75f));
+            return detail::scale_by_power_of_two(root, exponent);
+        }
+
+        // ---------------------------------------------------------------------
+        // Fixed point. Angles are binary angles (bam), 65536 per turn, so that
+        // wrapping is the overflow of a uint16_t. Values are Q15.
+
+        constexpr float BAM_PER_RAD = 65536.0f / TWO_PI_F;
+
+        inline uint16_t rad_to_bam(float angle) { return static_cast<uint16_t>(static_cast<int32_t>(nearbyintf(detail::reduce_angle(angle) * BAM_PER_RAD))); }
+
+        inline float bam_to_rad(int16_t angle) { return angle * (1.0f / BAM_PER_RAD); }
+
+        /**
+         * @brief Sine in Q15 of a binary angle, interpolated from SIN_TABLE_Q15,
+         * error below 4 LSB.
+         */
+        inline int16_t sin_q15(uint16_t angle)
+        {
+            const uint32_t index = angle >> 8;
+            const int32_t fraction = angle & 0xFF;
+            const int32_t low = SIN_TABLE_Q15[index];
+            return static_cast<int16_t>(low + (((SIN_TABLE_Q15[index + 1] - low) * fraction + 128) >> 8));
+        }
+
+        /**
+         * @brief Cosine in Q15 of a binary angle, error below 4 LSB.
+         */
+        inline int16_t cos_q15(uint16_t angle) { return sin_q15(static_cast<uint16_t>(angle + 16384)); }
+
+        /**
+         * @brief atan2 as a binary angle, error below 4 bam (4e-4 rad). y and x
+         * can have any scale up to 2^30. Returns 0 for (0, 0).
+         */
+        inline uint16_t atan2_bam(int32_t y, int32_t x)
+        {
+            const uint32_t abs_x = x < 0 ? static_cast<uint32_t>(-static_cast<int64_t>(x)) : static_cast<uint32_t>(x);
+            const uint32_t abs_y = y < 0 ? static_cast<uint32_t>(-static_cast<int64_t>(y)) : static_cast<uint32_t>(y);
+            if (abs_x == 0 && abs_y == 0)
+            {
+                return 0;
+            }
+            const bool swap = abs_y > abs_x;
+            // z = min / max in Q15
+            const int32_t z = static_cast<int32_t>((static_cast<uint64_t>(swap ? abs_x : abs_y) << 15) / (swap ? abs_y : abs_x));
+            const int32_t z2 = (z * z) >> 15;
+            // Minimax of atan(z) on [0, 1] in bam, error 0.85 bam before rounding
+            int32_t p = -407;
+            p = 1526 + ((p * z2) >> 15);
+            p = -3350 + ((p * z2) >> 15);
+            p = 10422 + ((p * z2) >> 15);
+            int32_t angle = (p * z + (1 << 14)) >> 15;
+            if (swap)
+            {
+                angle = 16384 - angle;
+            }
+            if (x < 0)
+            {
+                angle = 32768 - angle;
+            }
+            return static_cast<uint16_t>(y < 0 ? -angle : angle);
+        }
+
+        /**
+         * @brief floor(sqrt(x)), digit by digit with shifts and adds only.
+         */
+        inline uint32_t isqrt(uint64_t x)
+        {
+            if (x == 0)
+            {
+                return 0;
+            }
+            uint64_t root = 0;
+            // Highest power of four not above x
+            uint64_t bit = 1ull << ((63 - __builtin_clzll(x)) & ~1);
+            while (bit != 0)
+            {
+                if (x >= root + bit)
+                {
+                    x -= root + bit;
+                    root = (root >> 1) + bit;
+                }
+                else
+                {
+                    root >>= 1;
+                }
+                bit >>= 2;
+            }
+            return static_cast<uint32_t>(root);
+        }
+
+        /**
+         * @brief Square root of an unsigned Q16.16 value in Q16.16, exact floor.
+         */
+        inline uint32_t sqrt_q16(uint32_t x) { return isqrt(static_cast<uint64_t>(x) << 16); }
+
+        // ---------------------------------------------------------------------
+        // Math policies for templates, e.g. SwerveKinematics
+
+        // Double precision libm, wraps angles with atan2
+        struct LibmMath
+        {
+            static double sin(double x) { return ::sin(x); }
+            static double cos(double x) { return ::cos(x); }
+            static double atan2(double y, double x) { return ::atan2(y, x); }
+            static double sqrt(double x) { return ::sqrt(x); }
+            static double wrap_angle(double angle) { return ::atan2(::sin(angle), ::cos(angle)); }
+        };
+
+        struct PolynomialMath
+        {
+            static float sin(float x) { return poly_sin(x); }
+            static float cos(float x) { return poly_cos(x); }
+            static float atan2(float y, float x) { return poly_atan2(y, x); }
+            static float sqrt(float x) { return poly_sqrt(x); }
+            static float wrap_angle(float angle) { return detail::reduce_angle(angle); }
+        };
+
+        struct TableMath
+        {
+            static float sin(float x) { return table_sin(x); }
+            static float cos(float x) { return table_cos(x); }
+            static float atan2(float y, float x) { return table_atan2(y, x); }
+            static float sqrt(float x) { return table_sqrt(x); }
+            static float wrap_angle(float angle) { return detail::reduce_angle(angle); }
+        };
+
+        /**
+         * @brief Wrap an angle to [-pi, pi] without atan2.
+         */
+        inline float wrap_angle(float angle) { return detail::reduce_angle(angle); }
+
+    } // namespace math
+} // namespace roboost
+
+#endif // FAST_MATH_HPP
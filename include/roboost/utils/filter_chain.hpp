@@ -0,0 +1,186 @@
+/**
+ * @file filter_chain.hpp
+ * @author Friedl Jakob (friedl.jak@gmail.com)
+ * @brief Composition of any number of filters into a single filter.
+ * @version 0.1
+ * @date 2024-06-13
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef FILTER_CHAIN_HPP
+#define FILTER_CHAIN_HPP
+
+#include <stddef.h>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace roboost
+{
+    namespace filters
+    {
+        namespace detail
+        {
+            /**
+             * @brief Storage of one filter of a chain. Index makes every slot a
+             * distinct type, so that empty slots share their address.
+             */
+            template <size_t Index, typename Filter, bool Stateless = std::is_empty<Filter>::value && std::is_default_constructible<Filter>::value>
+            class FilterSlot
+            {
+            public:
+                FilterSlot(Filter filter) : filter_(std::forward<Filter>(filter)) {}
+
+                Filter& get() { return filter_; }
+
+            private:
+                Filter filter_;
+            };
+
+            // Filters without data members are created at the call site, even
+            // several of them in a chain take no space
+            template <size_t Index, typename Filter>
+            class FilterSlot<Index, Filter, true>
+            {
+            public:
+                FilterSlot(Filter) {}
+
+                Filter get() const { return Filter{}; }
+            };
+
+            template <typename Indices, typename... Filters>
+            class FilterChainStorage;
+
+            template <size_t... Index, typename... Filters>
+            class FilterChainStorage<std::index_sequence<Index...>, Filters...> : private FilterSlot<Index, Filters>...
+            {
+            public:
+                FilterChainStorage(Filters... filters) : FilterSlot<Index, Filters>(std::forward<Filters>(filters))... {}
+
+                template <size_t I>
+                decltype(auto) get()
+                {
+                    using Filter = std::tuple_element_t<I, std::tuple<Filters...>>;
+                    return static_cast<FilterSlot<I, Filter>&>(*this).get();
+                }
+            };
+        } // namespace detail
+
+        /**
+         * @brief Applies a sequence of filters in order. The chain itself has
+         * update() and reset(), so it can be passed wherever a single filter is
+         * expected, e.g. as input or output filter of a motor controller.
+         *
+         * All calls are resolved at compile time through fold expressions and
+         * inline completely. Filters without data members, e.g. a pass-through or
+         * a fixed gain, are not stored at all, so a chain of them is an empty
+         * object that compiles to nothing. The NoFilter of roboost/utils/filters.hpp
+         * keeps its last output and is stored like any other filter. Reference
+         * types can be used to chain filters that are owned elsewhere:
+         *
+         * @code
+         * FilterChain<MovingAverageFilter<float>, RateLimitingFilter<float>&> chain(MovingAverageFilter<float>(10), rate_limiter);
+         * float output = chain.update(input);
+         * @endcode
+         *
+         * @tparam Filters Filters in the order they are applied.
+         */
+        template <typename... Filters>
+        class FilterChain : private detail::FilterChainStorage<std::index_sequence_for<Filters...>, Filters...>
+        {
+            using Storage = detail::FilterChainStorage<std::index_sequence_for<Filters...>, Filters...>;
+
+        public:
+            FilterChain(Filters... filters) : Storage(std::forward<Filters>(filters)...) {}
+
+            /**
+             * @brief Pass a value through all filters.
+             *
+             * @param input Input of the first filter.
+             * @return T Output of the last filter.
+             */
+            template <typename T>
+            T update(T input)
+            {
+                return update(input, std::index_sequence_for<Filters...>{});
+            }
+
+            /**
+             * @brief Reset the state of every filter that has a reset() method.
+             *
+             */
+            void reset() { reset(std::index_sequence_for<Filters...>{}); }
+
+            /**
+             * @brief Access a filter of the chain, e.g. to retune it. Filters
+             * without data members are returned by value.
+             *
+             * @tparam Index Position of the filter in the chain.
+             */
+            template <size_t Index>
+            decltype(auto) get()
+            {
+                return Storage::template get<Index>();
+            }
+
+            static constexpr size_t size() { return sizeof...(Filters); }
+
+        private:
+            template <typename Filter, typename = void>
+            struct has_reset : std::false_type
+            {
+            };
+
+            template <typename Filter>
+            struct has_reset<Filter, decltype(std::declval<Filter&>().reset())> : std::true_type
+            {
+            };
+
+            template <typename T, size_t... Index>
+            T update(T value, std::index_sequence<Index...>)
+            {
+                ((value = static_cast<T>(get<Index>().update(value))), ...);
+                return value;
+            }
+
+            template <size_t... Index>
+            void reset(std::index_sequence<Index...>)
+            {
+                (reset_filter<std::remove_reference_t<std::tuple_element_t<Index, std::tuple<Filters...>>>>(get<Index>()), ...);
+            }
+
+            template <typename Filter, typename Slot>
+            static void reset_filter(Slot&& filter)
+            {
+                if constexpr (has_reset<Filter>::value)
+                {
+                    filter.reset();
+                }
+            }
+        };
+
+        /**
+         * @brief Chain without filters, passes the input through unchanged.
+         *
+         */
+        template <>
+        class FilterChain<>
+        {
+        public:
+            template <typename T>
+            T update(T input)
+            {
+                return input;
+            }
+
+            void reset() {}
+
+            static constexpr size_t size() { return 0; }
+        };
+
+    } // namespace filters
+} // namespace roboost
+
+#endif // FILTER_CHAIN_HPP
@@ -0,0 +1,407 @@
+/**
+ * @file filter_design.hpp
+ * @author Friedl Jakob (friedl.jak@gmail.com)
+ * @brief Compile time design of Butterworth, Bessel, notch and band-stop filters
+ * as cascaded biquad sections (second order sections, SOS).
+ * @version 0.1
+ * @date 2024-06-11
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * All design functions are constexpr, so the coefficients of a filter with fixed
+ * sample rate and cutoff are computed by the compiler:
+ *
+ * @code
+ * constexpr auto encoder_lowpass = design_butterworth_lowpass<2>(1000.0, 40.0);
+ * SOSFilter<float, 2> filter(encoder_lowpass);
+ * @endcode
+ *
+ * They can be called at runtime as well, e.g. to move a notch with the wheel
+ * speed. The analog prototypes are mapped with the bilinear transform and
+ * prewarped, so the cutoff frequencies are exact.
+ */
+
+#ifndef FILTER_DESIGN_HPP
+#define FILTER_DESIGN_HPP
+
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace roboost
+{
+    namespace filters
+    {
+        /**
+         * @brief Coefficients of one biquad section, normalized to a0 = 1.
+         *
+         * H(z) = (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2)
+         */
+        struct BiquadCoefficients
+        {
+            double b0, b1, b2;
+            double a1, a2;
+        };
+
+        template <size_t Sections>
+        using SOSCoefficients = std::array<BiquadCoefficients, Sections>;
+
+        namespace design
+        {
+            constexpr double PI = 3.14159265358979323846;
+
+            constexpr double sqrt(double x)
+            {
+                if (x <= 0.0)
+                {
+                    return 0.0;
+                }
+                double root = x > 1.0 ? x : 1.0;
+                for (int i = 0; i < 64; i++)
+                {
+                    const double next = 0.5 * (root + x / root);
+                    if (next == root)
+                    {
+                        break;
+                    }
+                    root = next;
+                }
+                return root;
+            }
+
+            constexpr double sin(double x)
+            {
+                // Reduce to [-pi, pi], the Taylor series converges quickly there
+                const double turns = x / (2.0 * PI);
+                const long whole = static_cast<long>(turns < 0.0 ? turns - 0.5 : turns + 0.5);
+                x -= whole * 2.0 * PI;
+
+                double term = x;
+                double sum = x;
+                for (int n = 1; n < 16; n++)
+                {
+                    term *= -x * x / ((2 * n) * (2 * n + 1));
+                    sum += term;
+                }
+                return sum;
+            }
+
+            constexpr double cos(double x) { return sin(x + 0.5 * PI); }
+
+            constexpr double tan(double x) { return sin(x) / cos(x); }
+
+            struct Complex
+            {
+                double re, im;
+            };
+
+            constexpr Complex operator+(Complex a, Complex b) { return {a.re + b.re, a.im + b.im}; }
+
+            constexpr Complex operator-(Complex a, Complex b) { return {a.re - b.re, a.im - b.im}; }
+
+            constexpr Complex operator*(Complex a, Complex b) { return {a.re * b.re - a.im * b.im, a.re * b.im + a.im * b.re}; }
+
+            constexpr Complex operator/(Complex a, Complex b)
+            {
+                const double norm = b.re * b.re + b.im * b.im;
+                return {(a.re * b.re + a.im * b.im) / norm, (a.im * b.re - a.re * b.im) / norm};
+            }
+
+            constexpr Complex sqrt(Complex z)
+            {
+                const double magnitude = sqrt(z.re * z.re + z.im * z.im);
+                const double re = sqrt(0.5 * (magnitude + z.re));
+                const double im = sqrt(0.5 * (magnitude - z.re));
+                return {re, z.im < 0.0 ? -im : im};
+            }
+
+            /**
+             * @brief Bilinear transform of the analog section
+             * (n2 s^2 + n1 s + n0) / (d2 s^2 + d1 s + d0).
+             */
+            constexpr BiquadCoefficients bilinear(double n2, double n1, double n0, double d2, double d1, double d0, double sample_rate)
+            {
+                const double c = 2.0 * sample_rate;
+                const double c2 = c * c;
+                const double a0 = d2 * c2 + d1 * c + d0;
+                return {(n2 * c2 + n1 * c + n0) / a0, 2.0 * (n0 - n2 * c2) / a0, (n2 * c2 - n1 * c + n0) / a0, 2.0 * (d0 - d2 * c2) / a0, (d2 * c2 - d1 * c + d0) / a0};
+            }
+
+            // Analog frequency in rad/s that the bilinear transform maps onto frequency
+            constexpr double prewarp(double frequency, double sample_rate) { return 2.0 * sample_rate * tan(PI * frequency / sample_rate); }
+
+            // Pole k of the analog Butterworth prototype of the given order, upper half plane for k < order / 2
+            constexpr Complex butterworth_pole(size_t k, size_t order)
+            {
+                const double theta = PI * (2.0 * k + 1.0) / (2.0 * order);
+                return {-sin(theta), cos(theta)};
+            }
+
+            // Upper half plane poles of the Bessel prototypes with -3 dB at 1 rad/s, orders 2, 4, 6 and 8
+            constexpr Complex BESSEL_POLES[4][4] = {
+                {{-1.1016013306, 0.6360098248}, {0.0, 0.0}, {0.0, 0.0}, {0.0, 0.0}},
+                {{-0.9952087644, 1.2571057395}, {-1.3700678306, 0.4102497175}, {0.0, 0.0}, {0.0, 0.0}},
+                {{-0.9306565229, 1.6618632689}, {-1.3818580976, 0.9714718907}, {-1.5714904036, 0.3208963742}, {0.0, 0.0}},
+                {{-0.8928697188, 1.9983258436}, {-1.3738412176, 1.3883565759}, {-1.6369394181, 0.8227956251}, {-1.7574084004, 0.2728675751}},
+            };
+
+            // Lowpass section with unity DC gain for the normalized pole pair, scaled to omega_c
+            constexpr BiquadCoefficients lowpass_section(Complex pole, double omega_c, double sample_rate)
+            {
+                const double d1 = -2.0 * pole.re * omega_c;
+                const double d0 = (pole.re * pole.re + pole.im * pole.im) * omega_c * omega_c;
+                return bilinear(0.0, 0.0, d0, 1.0, d1, d0, sample_rate);
+            }
+        } // namespace design
+
+        /**
+         * @brief Butterworth lowpass of order 2 * Sections.
+         *
+         * @param sample_rate Sample rate in Hz.
+         * @param cutoff -3 dB frequency in Hz, below sample_rate / 2.
+         */
+        template <size_t Sections>
+        constexpr SOSCoefficients<Sections> design_butterworth_lowpass(double sample_rate, double cutoff)
+        {
+            SOSCoefficients<Sections> sos = {};
+            const double omega_c = design::prewarp(cutoff, sample_rate);
+            for (size_t k = 0; k < Sections; k++)
+            {
+                sos[k] = design::lowpass_section(design::butterworth_pole(k, 2 * Sections), omega_c, sample_rate);
+            }
+            return sos;
+        }
+
+        /**
+         * @brief Butterworth highpass of order 2 * Sections.
+         *
+         * @param sample_rate Sample rate in Hz.
+         * @param cutoff -3 dB frequency in Hz, below sample_rate / 2.
+         */
+        template <size_t Sections>
+        constexpr SOSCoefficients<Sections> design_butterworth_highpass(double sample_rate, double cutoff)
+        {
+            SOSCoefficients<Sections> sos = {};
+            const double omega_c = design::prewarp(cutoff, sample_rate);
+            for (size_t k = 0; k < Sections; k++)
+            {
+                // s -> omega_c / s maps the unit circle poles onto themselves
+                const design::Complex pole = design::butterworth_pole(k, 2 * Sections);
+                sos[k] = design::bilinear(1.0, 0.0, 0.0, 1.0, -2.0 * pole.re * omega_c, omega_c * omega_c, sample_rate);
+            }
+            return sos;
+        }
+
+        /**
+         * @brief Bessel lowpass of order 2 * Sections with maximally flat group
+         * delay, i.e. no overshoot on steps. Supports 1 to 4 sections.
+         *
+         * @param sample_rate Sample rate in Hz.
+         * @param cutoff -3 dB frequency in Hz, below sample_rate / 2.
+         */
+        template <size_t Sections>
+        constexpr SOSCoefficients<Sections> design_bessel_lowpass(double sample_rate, double cutoff)
+        {
+            static_assert(Sections >= 1 && Sections <= 4, "Bessel filters are tabulated for 1 to 4 sections");
+
+            SOSCoefficients<Sections> sos = {};
+            const double omega_c = design::prewarp(cutoff, sample_rate);
+            for (size_t k = 0; k < Sections; k++)
+            {
+                sos[k] = design::lowpass_section(design::BESSEL_POLES[Sections - 1][k], omega_c, sample_rate);
+            }
+            return sos;
+        }
+
+        /**
+         * @brief Second order notch with unity gain away from the notch.
+         *
+         * @param sample_rate Sample rate in Hz.
+         * @param frequency Center frequency in Hz.
+         * @param quality Quality factor, center frequency over -3 dB bandwidth.
+         */
+        constexpr SOSCoefficients<1> design_notch(double sample_rate, double frequency, double quality)
+        {
+            const double omega_0 = design::prewarp(frequency, sample_rate);
+            return {design::bilinear(1.0, 0.0, omega_0 * omega_0, 1.0, omega_0 / quality, omega_0 * omega_0, sample_rate)};
+        }
+
+        /**
+         * @brief Butterworth band-stop of order 2 * Sections, obtained from the
+         * lowpass prototype of order Sections. For an odd number of sections the
+         * ratio high / low has to stay below 5.8, otherwise the real prototype
+         * pole splits into two real poles that do not form a section.
+         *
+         * @param sample_rate Sample rate in Hz.
+         * @param low Lower -3 dB frequency in Hz.
+         * @param high Upper -3 dB frequency in Hz.
+         */
+        template <size_t Sections>
+        constexpr SOSCoefficients<Sections> design_bandstop(double sample_rate, double low, double high)
+        {
+            SOSCoefficients<Sections> sos = {};
+            const double omega_low = design::prewarp(low, sample_rate);
+            const double omega_high = design::prewarp(high, sample_rate);
+            const double omega_0_squared = omega_low * omega_high;
+            const double bandwidth = omega_high - omega_low;
+
+            // s -> bandwidth * s / (s^2 + omega_0^2), every prototype pole p yields the
+            // roots of s^2 - (bandwidth / p) s + omega_0^2, one section per upper half plane root
+            size_t section = 0;
+            for (size_t k = 0; k < Sections; k++)
+            {
+                const design::Complex half = design::Complex{0.5 * bandwidth, 0.0} / design::butterworth_pole(k, Sections);
+                const design::Complex root = design::sqrt(half * half - design::Complex{omega_0_squared, 0.0});
+                const design::Complex candidates[2] = {half + root, half - root};
+                for (const design::Complex& pole : candidates)
+                {
+                    if (pole.im > 0.0 && section < Sections)
+                    {
+                        const double pole_squared = pole.re * pole.re + pole.im * pole.im;
+                        const double gain = pole_squared / omega_0_squared;
+                        sos[section++] = design::bilinear(gain, 0.0, gain * omega_0_squared, 1.0, -2.0 * pole.re, pole_squared, sample_rate);
+                    }
+                }
+            }
+            return sos;
+        }
+
+        /**
+         * @brief Cascade of biquad sections in transposed direct form II, which
+         * needs two state variables per section and behaves well in floating point.
+         *
+         * @tparam T float or double.
+         * @tparam Sections Number of biquad sections.
+         */
+        template <typename T, size_t Sections>
+        class SOSFilter
+        {
+        public:
+            SOSFilter(const SOSCoefficients<Sections>& coefficients) { set_coefficients(coefficients); }
+
+            T update(T input)
+            {
+                T value = input;
+                for (size_t i = 0; i < Sections; i++)
+                {
+                    const Section& c = sections_[i];
+                    const T output = c.b0 * value + state_[i][0];
+                    state_[i][0] = c.b1 * value - c.a1 * output + state_[i][1];
+                    state_[i][1] = c.b2 * value - c.a2 * output;
+                    value = output;
+                }
+                output_ = value;
+                return value;
+            }
+
+            /**
+             * @brief Replace the coefficients, e.g. to retune a notch. The state is
+             * kept so that the output does not jump.
+             *
+             * @param coefficients New coefficients.
+             */
+            void set_coefficients(const SOSCoefficients<Sections>& coefficients)
+            {
+                for (size_t i = 0; i < Sections; i++)
+                {
+                    sections_[i] = {static_cast<T>(coefficients[i].b0), static_cast<T>(coefficients[i].b1), static_cast<T>(coefficients[i].b2), static_cast<T>(coefficients[i].a1),
+                                    static_cast<T>(coefficients[i].a2)};
+                }
+            }
+
+            void reset()
+            {
+                for (size_t i = 0; i < Sections; i++)
+                {
+                    state_[i][0] = 0;
+                    state_[i][1] = 0;
+                }
+                output_ = 0;
+            }
+
+            T get_output() const { return output_; }
+
+        private:
+            struct Section
+            {
+                T b0, b1, b2, a1, a2;
+            };
+
+            Section sections_[Sections];
+            T state_[Sections][2] = {};
+            T output_ = 0;
+        };
+
+        /**
+         * @brief Fixed point variant of SOSFilter for integer signals such as
+         * encoder counts. Coefficients are stored with FractionalBits fractional
+         * bits, the state in 64 bit. The output of every section is rounded to an
+         * integer, so small signals should be scaled up before filtering.
+         *
+         * @tparam Sections Number of biquad sections.
+         * @tparam FractionalBits Fractional bits of the coefficients, 28 leaves
+         * room for coefficients up to +-8.
+         */
+        template <size_t Sections, uint8_t FractionalBits = 28>
+        class FixedPointSOSFilter
+        {
+        public:
+            static_assert(FractionalBits > 0 && FractionalBits < 31, "Coefficients have to fit into 32 bit");
+
+            FixedPointSOSFilter(const SOSCoefficients<Sections>& coefficients) { set_coefficients(coefficients); }
+
+            int32_t update(int32_t input)
+            {
+                int64_t value = input;
+                for (size_t i = 0; i < Sections; i++)
+                {
+                    const Section& c = sections_[i];
+                    const int64_t output = (c.b0 * value + state_[i][0] + ROUNDING) >> FractionalBits;
+                    state_[i][0] = c.b1 * value - c.a1 * output + state_[i][1];
+                    state_[i][1] = c.b2 * value - c.a2 * output;
+                    value = output;
+                }
+                output_ = static_cast<int32_t>(value);
+                return output_;
+            }
+
+            void set_coefficients(const SOSCoefficients<Sections>& coefficients)
+            {
+                for (size_t i = 0; i < Sections; i++)
+                {
+                    sections_[i] = {to_fixed(coefficients[i].b0), to_fixed(coefficients[i].b1), to_fixed(coefficients[i].b2), to_fixed(coefficients[i].a1), to_fixed(coefficients[i].a2)};
+                }
+            }
+
+            void reset()
+            {
+                for (size_t i = 0; i < Sections; i++)
+                {
+                    state_[i][0] = 0;
+                    state_[i][1] = 0;
+                }
+                output_ = 0;
+            }
+
+            int32_t get_output() const { return output_; }
+
+        private:
+            static constexpr int64_t ONE = int64_t(1) << FractionalBits;
+            static constexpr int64_t ROUNDING = ONE / 2;
+
+            static constexpr int64_t to_fixed(double coefficient) { return static_cast<int64_t>(coefficient * ONE + (coefficient < 0.0 ? -0.5 : 0.5)); }
+
+            struct Section
+            {
+                int64_t b0, b1, b2, a1, a2;
+            };
+
+            Section sections_[Sections];
+            int64_t state_[Sections][2] = {};
+            int32_t output_ = 0;
+        };
+
+    } // namespace filters
+} // namespace roboost
+
+#endif // FILTER_DESIGN_HPP
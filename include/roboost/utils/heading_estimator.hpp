@@ -0,0 +1,224 @@
+/**
+ * @file heading_estimator.hpp
+ * @author Friedl Jakob (friedl.jak@gmail.com)
+ * @brief Fusion of gyro yaw rate and wheel odometry for the robot heading.
+ * @version 0.1
+ * @date 2024-06-10
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef HEADING_ESTIMATOR_HPP
+#define HEADING_ESTIMATOR_HPP
+
+#include <math.h>
+
+namespace roboost
+{
+    namespace estimators
+    {
+        /**
+         * @brief Two state Kalman filter for heading and gyro bias.
+         *
+         * The heading is propagated with the bias corrected gyro rate. The yaw
+         * rate from the wheel odometry serves as measurement of the gyro rate,
+         * which makes the bias observable. Measurements that disagree with the
+         * gyro by more than the gate (rollers slipping) are rejected, so slip
+         * does not leak into the heading. The filter is linear, so the EKF
+         * reduces to a fixed 2x2 Kalman filter with constant per-tick cost.
+         */
+        class HeadingKalmanFilter
+        {
+        public:
+            /**
+             * @brief Construct a new Heading Kalman Filter object
+             *
+             * @param gyro_noise Gyro rate noise density in rad/s/sqrt(Hz).
+             * @param bias_noise Gyro bias random walk in rad/s^2/sqrt(Hz).
+             * @param wheel_rate_noise Standard deviation of the wheel odometry yaw rate in rad/s.
+             * @param slip_gate Innovation gate in standard deviations.
+             */
+            HeadingKalmanFilter(float gyro_noise = 0.01f, float bias_noise = 0.0005f, float wheel_rate_noise = 0.05f, float slip_gate = 3.0f)
+                : q_theta_(gyro_noise * gyro_noise), q_bias_(bias_noise * bias_noise), r_(wheel_rate_noise * wheel_rate_noise), gate_squared_(slip_gate * slip_gate)
+            {
+                reset();
+            }
+
+            /**
+             * @brief Advance the filter by one tick.
+             *
+             * @param gyro_rate Measured gyro yaw rate in rad/s.
+             * @param wheel_rate Yaw rate from the wheel odometry in rad/s.
+             * @param dt Time step in seconds.
+             * @return float Fused yaw rate in rad/s.
+             */
+            float update(float gyro_rate, float wheel_rate, float dt)
+            {
+                // Predict: theta += (gyro - bias) * dt, F = [1 -dt; 0 1]
+                rate_ = gyro_rate - bias_;
+                theta_ = wrap(theta_ + rate_ * dt);
+
+                const float p00 = p_[0][0] - dt * (p_[1][0] + p_[0][1]) + dt * dt * p_[1][1] + q_theta_ * dt;
+                const float p01 = p_[0][1] - dt * p_[1][1];
+                const float p11 = p_[1][1] + q_bias_ * dt;
+                p_[0][0] = p00;
+                p_[0][1] = p01;
+                p_[1][0] = p01;
+                p_[1][1] = p11;
+
+                // Update with the wheel yaw rate: z = gyro - bias, H = [0 -1]
+                const float innovation = wheel_rate - rate_;
+                const float s = p_[1][1] + r_ + q_theta_;
+                if (innovation * innovation > gate_squared_ * s)
+                {
+                    rejected_count_++;
+                    return rate_;
+                }
+
+                const float k0 = -p_[0][1] / s;
+                const float k1 = -p_[1][1] / s;
+                theta_ = wrap(theta_ + k0 * innovation);
+                bias_ += k1 * innovation;
+
+                // P = (I - K H) P
+                const float u00 = p_[0][0] + k0 * p_[1][0];
+                const float u01 = p_[0][1] + k0 * p_[1][1];
+                const float u11 = p_[1][1] + k1 * p_[1][1];
+                p_[0][0] = u00;
+                p_[0][1] = u01;
+                p_[1][0] = u01;
+                p_[1][1] = u11;
+
+                rate_ = gyro_rate - bias_;
+                return rate_;
+            }
+
+            void reset(float theta = 0.0f, float bias = 0.0f)
+            {
+                theta_ = theta;
+                bias_ = bias;
+                rate_ = 0.0f;
+                p_[0][0] = 0.0f;
+                p_[0][1] = 0.0f;
+                p_[1][0] = 0.0f;
+                p_[1][1] = 0.01f;
+                rejected_count_ = 0;
+            }
+
+            float get_heading() const { return theta_; }
+
+            float get_bias() const { return bias_; }
+
+            float get_yaw_rate() const { return rate_; }
+
+            float get_heading_variance() const { return p_[0][0]; }
+
+            unsigned long get_rejected_count() const { return rejected_count_; }
+
+        private:
+            static float wrap(float angle) { return atan2f(sinf(angle), cosf(angle)); }
+
+            float q_theta_;
+            float q_bias_;
+            float r_;
+            float gate_squared_;
+            float theta_;
+            float bias_;
+            float rate_;
+            float p_[2][2];
+            unsigned long rejected_count_;
+        };
+
+        /**
+         * @brief Complementary filter blending gyro and wheel yaw rate. Cheaper
+         * than the Kalman filter, but it cannot estimate the gyro bias.
+         */
+        class ComplementaryHeadingFilter
+        {
+        public:
+            /**
+             * @brief Construct a new Complementary Heading Filter object
+             *
+             * @param gyro_weight Weight of the gyro rate in [0, 1].
+             */
+            ComplementaryHeadingFilter(float gyro_weight = 0.98f) : gyro_weight_(gyro_weight) {}
+
+            float update(float gyro_rate, float wheel_rate, float dt)
+            {
+                rate_ = gyro_weight_ * gyro_rate + (1.0f - gyro_weight_) * wheel_rate;
+                theta_ = atan2f(sinf(theta_ + rate_ * dt), cosf(theta_ + rate_ * dt));
+                return rate_;
+            }
+
+            void reset(float theta = 0.0f) { theta_ = theta; }
+
+            float get_heading() const { return theta_; }
+
+            float get_yaw_rate() const { return rate_; }
+
+        private:
+            float gyro_weight_;
+            float theta_ = 0.0f;
+            float rate_ = 0.0f;
+        };
+
+        /**
+         * @brief Planar odometry with the heading taken from a heading filter
+         * instead of the integrated wheel yaw rate.
+         *
+         * @tparam HeadingFilter HeadingKalmanFilter or ComplementaryHeadingFilter.
+         */
+        template <typename HeadingFilter>
+        class FusedOdometry
+        {
+        public:
+            FusedOdometry(HeadingFilter& heading_filter) : heading_filter_(heading_filter) {}
+
+            /**
+             * @brief Integrate the pose by one tick.
+             *
+             * @param vx Body velocity in x from the wheel odometry in m/s.
+             * @param vy Body velocity in y from the wheel odometry in m/s.
+             * @param wheel_rate Yaw rate from the wheel odometry in rad/s.
+             * @param gyro_rate Measured gyro yaw rate in rad/s.
+             * @param dt Time step in seconds.
+             */
+            void update(float vx, float vy, float wheel_rate, float gyro_rate, float dt)
+            {
+                const float previous_heading = heading_filter_.get_heading();
+                heading_filter_.update(gyro_rate, wheel_rate, dt);
+
+                // Integrate with the heading at the middle of the step
+                const float heading = previous_heading + 0.5f * heading_filter_.get_yaw_rate() * dt;
+                const float c = cosf(heading);
+                const float s = sinf(heading);
+                x_ += (vx * c - vy * s) * dt;
+                y_ += (vx * s + vy * c) * dt;
+            }
+
+            void reset()
+            {
+                x_ = 0.0f;
+                y_ = 0.0f;
+                heading_filter_.reset();
+            }
+
+            float get_x() const { return x_; }
+
+            float get_y() const { return y_; }
+
+            float get_heading() const { return heading_filter_.get_heading(); }
+
+            float get_yaw_rate() const { return heading_filter_.get_yaw_rate(); }
+
+        private:
+            HeadingFilter& heading_filter_;
+            float x_ = 0.0f;
+            float y_ = 0.0f;
+        };
+
+    } // namespace estimators
+} // namespace roboost
+
+#endif // HEADING_ESTIMATOR_HPP
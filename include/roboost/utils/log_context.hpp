@@ -0,0 +1,147 @@
+/**
+ * @file log_context.hpp
+ * @author Friedl Jakob (friedl.jak@gmail.com)
+ * @brief Logger instances that are injected into components instead of the
+ * process-wide logger singleton.
+ * @version 0.1
+ * @date 2024-06-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * A LogContext has a name, a minimum level and a sink. Messages are formatted
+ * into a buffer on the stack of the caller and handed to the sink in one call,
+ * so a context keeps no shared state and several contexts, e.g. one per
+ * simulated robot, can log from different threads. A sink that is shared
+ * between threads has to be safe to call concurrently, the default sinks write
+ * each message with a single call.
+ */
+
+#ifndef LOG_CONTEXT_HPP
+#define LOG_CONTEXT_HPP
+
+#include <atomic>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+namespace roboost
+{
+    namespace logging
+    {
+        constexpr size_t LOG_MESSAGE_SIZE = 128;
+
+        enum class LogLevel : uint8_t
+        {
+            DEBUG = 0,
+            INFO,
+            WARNING,
+            ERROR
+        };
+
+        inline const char* to_string(LogLevel level)
+        {
+            switch (level)
+            {
+            case LogLevel::DEBUG:
+                return "DEBUG";
+            case LogLevel::INFO:
+                return "INFO";
+            case LogLevel::WARNING:
+                return "WARNING";
+            case LogLevel::ERROR:
+                return "ERROR";
+            }
+            return "UNKNOWN";
+        }
+
+        /**
+         * @brief Receives every message that passes the level of a context.
+         */
+        using LogSink = void (*)(void* user, LogLevel level, const char* name, const char* message);
+
+        /**
+         * @brief Default sink, Serial on the target and stdout on native.
+         */
+        inline void console_sink(void*, LogLevel level, const char* name, const char* message)
+        {
+            char line[LOG_MESSAGE_SIZE + 32];
+            snprintf(line, sizeof(line), "[%s] %s: %s\n", to_string(level), name, message);
+#ifdef ARDUINO
+            Serial.print(line);
+#else
+            fputs(line, stdout);
+#endif
+        }
+
+        class LogContext
+        {
+        public:
+            /**
+             * @brief Construct a new Log Context object
+             *
+             * @param name Prefix of all messages, must outlive the context.
+             * @param sink Receiver of the messages.
+             * @param user Passed to the sink, e.g. a buffer per robot.
+             * @param level Messages below this level are dropped.
+             */
+            explicit LogContext(const char* name, LogSink sink = console_sink, void* user = nullptr, LogLevel level = LogLevel::INFO)
+                : name_(name), sink_(sink), user_(user), level_(level)
+            {
+            }
+
+            void log(LogLevel level, const char* format, ...) __attribute__((format(printf, 3, 4)))
+            {
+                va_list args;
+                va_start(args, format);
+                vlog(level, format, args);
+                va_end(args);
+            }
+
+            void vlog(LogLevel level, const char* format, va_list args)
+            {
+                if (level < level_.load(std::memory_order_relaxed) || sink_ == nullptr)
+                {
+                    return;
+                }
+                char message[LOG_MESSAGE_SIZE];
+                vsnprintf(message, sizeof(message), format, args);
+                message_count_.fetch_add(1, std::memory_order_relaxed);
+                sink_(user_, level, name_, message);
+            }
+
+            void set_level(LogLevel level) { level_.store(level, std::memory_order_relaxed); }
+
+            LogLevel get_level() const { return level_.load(std::memory_order_relaxed); }
+
+            const char* get_name() const { return name_; }
+
+            /**
+             * @brief Number of messages handed to the sink.
+             */
+            uint32_t get_message_count() const { return message_count_.load(std::memory_order_relaxed); }
+
+        private:
+            const char* name_;
+            LogSink sink_;
+            void* user_;
+            std::atomic<LogLevel> level_;
+            std::atomic<uint32_t> message_count_{0};
+        };
+
+        /**
+         * @brief Context for code that is not handed one, the firmware default.
+         */
+        inline LogContext& default_log_context()
+        {
+            static LogContext context("roboost");
+            return context;
+        }
+
+    } // namespace logging
+} // namespace roboost
+
+#endif // LOG_CONTEXT_HPP
@@ -0,0 +1,223 @@
+/**
+ * @file lqr_controller.hpp
+ * @author Friedl Jakob (friedl.jak@gmail.com)
+ * @brief State feedback controller with integral action and gains solved
+ * offline.
+ * @version 0.1
+ * @date 2024-06-26
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * The gains come from src/native/lqr_design.cpp, which solves the discrete
+ * Riccati equation of the identified motor model augmented with the integral
+ * of the tracking error, and writes them as constexpr matrices into
+ * conf/conf_lqr.h. Per tick the controller evaluates
+ *
+ *   z += T * (r - C x)
+ *   u  = Kr r - Kx x - Ki z
+ *
+ * x is the measured state, r the reference and z the integrated error. Kr
+ * combines the steady state input and state for the reference, so the loop
+ * does not wait for the integral to track a step. With the chassis model this
+ * is four matrix-vector products of at most 4x4, with a wheel model it is a
+ * handful of multiplications. LQRVelocityController wraps the wheel model in
+ * the Controller interface of the velocity controllers.
+ */
+
+#ifndef LQR_CONTROLLER_HPP
+#define LQR_CONTROLLER_HPP
+
+#include <roboost/utils/controllers.hpp>
+#include <stddef.h>
+
+namespace roboost
+{
+    namespace controllers
+    {
+        /**
+         * @brief LQR servo controller.
+         *
+         * @tparam States Number of measured states.
+         * @tparam Inputs Number of control inputs.
+         * @tparam References Number of tracked outputs, each with an integrator.
+         */
+        template <size_t States, size_t Inputs, size_t References>
+        class LQRController
+        {
+        public:
+            /**
+             * @brief Construct a new LQR Controller object
+             *
+             * @param kx State feedback gain.
+             * @param ki Integral gain.
+             * @param kr Reference feedforward gain.
+             * @param c Map from the state to the tracked outputs.
+             * @param sample_time Period the gains were designed for in s.
+             * @param output_limit Inputs are limited to +-output_limit.
+             * @param max_integral Limit of each integrated error.
+             */
+            LQRController(const float (&kx)[Inputs][States], const float (&ki)[Inputs][References], const float (&kr)[Inputs][References], const float (&c)[References][States], float sample_time,
+                          float output_limit, float max_integral)
+                : sample_time_(sample_time), output_limit_(output_limit), max_integral_(max_integral)
+            {
+                for (size_t i = 0; i < Inputs; i++)
+                {
+                    for (size_t j = 0; j < States; j++)
+                    {
+                        kx_[i][j] = kx[i][j];
+                    }
+                    for (size_t j = 0; j < References; j++)
+                    {
+                        ki_[i][j] = ki[i][j];
+                        kr_[i][j] = kr[i][j];
+                    }
+                }
+                for (size_t i = 0; i < References; i++)
+                {
+                    for (size_t j = 0; j < States; j++)
+                    {
+                        c_[i][j] = c[i][j];
+                    }
+                }
+                reset();
+            }
+
+            /**
+             * @brief Compute the inputs for the next period.
+             *
+             * The integral is not advanced while an input is saturated in the
+             * direction the integral would push it, so it does not wind up when the
+             * motors are at their limit.
+             *
+             * @param reference Reference of the tracked outputs.
+             * @param state Measured state.
+             * @param output Inputs, limited to +-output_limit.
+             */
+            void update(const float (&reference)[References], const float (&state)[States], float (&output)[Inputs])
+            {
+                float error[References];
+                for (size_t i = 0; i < References; i++)
+                {
+                    float y = 0.0f;
+                    for (size_t j = 0; j < States; j++)
+                    {
+                        y += c_[i][j] * state[j];
+                    }
+                    error[i] = reference[i] - y;
+                }
+
+                // +1 or -1 for an input at its upper or lower limit
+                int saturation[Inputs];
+                for (size_t i = 0; i < Inputs; i++)
+                {
+                    float u = 0.0f;
+                    for (size_t j = 0; j < References; j++)
+                    {
+                        u += kr_[i][j] * reference[j] - ki_[i][j] * integral_[j];
+                    }
+                    for (size_t j = 0; j < States; j++)
+                    {
+                        u -= kx_[i][j] * state[j];
+                    }
+                    saturation[i] = u > output_limit_ ? 1 : (u < -output_limit_ ? -1 : 0);
+                    output[i] = u > output_limit_ ? output_limit_ : (u < -output_limit_ ? -output_limit_ : u);
+                }
+
+                for (size_t j = 0; j < References; j++)
+                {
+                    // The integral enters the inputs with -Ki, it is held if that drives a saturated input further
+                    bool winds_up = false;
+                    for (size_t i = 0; i < Inputs; i++)
+                    {
+                        const float change = -ki_[i][j] * error[j];
+                        winds_up = winds_up || (saturation[i] > 0 && change > 0.0f) || (saturation[i] < 0 && change < 0.0f);
+                    }
+                    if (!winds_up)
+                    {
+                        const float integral = integral_[j] + sample_time_ * error[j];
+                        integral_[j] = integral > max_integral_ ? max_integral_ : (integral < -max_integral_ ? -max_integral_ : integral);
+                    }
+                }
+            }
+
+            /**
+             * @brief Single input, single output form for a wheel velocity loop.
+             *
+             * @param setpoint Reference velocity.
+             * @param input Measured velocity.
+             * @return float Control output.
+             */
+            float update(float setpoint, float input)
+            {
+                static_assert(States == 1 && Inputs == 1 && References == 1, "The scalar update is only available for single input, single output controllers");
+                const float reference[1] = {setpoint};
+                const float state[1] = {input};
+                float output[1];
+                update(reference, state, output);
+                return output[0];
+            }
+
+            void reset()
+            {
+                for (size_t i = 0; i < References; i++)
+                {
+                    integral_[i] = 0.0f;
+                }
+            }
+
+            float get_integral(size_t index) const { return integral_[index]; }
+
+            float get_sample_time() const { return sample_time_; }
+
+            float get_output_limit() const { return output_limit_; }
+
+            float get_max_integral() const { return max_integral_; }
+
+        private:
+            float kx_[Inputs][States];
+            float ki_[Inputs][References];
+            float kr_[Inputs][References];
+            float c_[References][States];
+            float integral_[References];
+            float sample_time_;
+            float output_limit_;
+            float max_integral_;
+        };
+
+        /**
+         * @brief Wheel velocity LQR with the Controller interface, so it can
+         * replace the PIDController of a VelocityController.
+         */
+        class LQRVelocityController : public Controller
+        {
+        public:
+            /**
+             * @brief Construct a new LQR Velocity Controller object
+             *
+             * @param kx State feedback gain.
+             * @param ki Integral gain.
+             * @param kr Reference feedforward gain.
+             * @param c Map from the state to the tracked output.
+             * @param sample_time Period the gains were designed for in s.
+             * @param output_limit Output is limited to +-output_limit.
+             * @param max_integral Limit of the integrated error.
+             */
+            LQRVelocityController(const float (&kx)[1][1], const float (&ki)[1][1], const float (&kr)[1][1], const float (&c)[1][1], float sample_time, float output_limit, float max_integral)
+                : lqr_(kx, ki, kr, c, sample_time, output_limit, max_integral)
+            {
+            }
+
+            double update(double setpoint, double input) override { return lqr_.update(static_cast<float>(setpoint), static_cast<float>(input)); }
+
+            void reset() { lqr_.reset(); }
+
+            const LQRController<1, 1, 1>& get_lqr() const { return lqr_; }
+
+        private:
+            LQRController<1, 1, 1> lqr_;
+        };
+
+    } // namespace controllers
+} // namespace roboost
+
+#endif // LQR_CONTROLLER_HPP
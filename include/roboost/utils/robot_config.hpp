@@ -0,0 +1,388 @@
+/**
+ * @file robot_config.hpp
+ * @author Friedl Jakob (friedl.jak@gmail.com)
+ * @brief Robot configuration that can be stored as a compact binary blob,
+ * e.g. in NVS, and replaced without reflashing.
+ * @version 0.1
+ * @date 2024-06-18
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * Blob layout, all values little endian:
+ *   header  magic (u32), schema version (u16), payload size (u16), CRC-32 of the payload (u32)
+ *   payload wheel radius, wheel base, track width, max wheel velocity (f32),
+ *           motor count (u8), per motor: in1, in2, enable, pwm channel,
+ *           encoder a, encoder b (u8), encoder resolution (u16), flags (u8,
+ *           bit 0 inverted), kp, ki, kd (f32)
+ *
+ * The fields are encoded one by one instead of copying structs, so the blob
+ * does not depend on padding or endianness of the target. Decoding a four
+ * motor configuration is a few hundred byte operations plus a table CRC.
+ */
+
+#ifndef ROBOT_CONFIG_HPP
+#define ROBOT_CONFIG_HPP
+
+#include <math.h>
+#include <roboost/motor_control/robot_description.hpp>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace roboost
+{
+    namespace config
+    {
+        constexpr uint32_t ROBOT_CONFIG_MAGIC = 0x46434252; // "RBCF"
+        constexpr uint16_t ROBOT_CONFIG_VERSION = 1;
+        constexpr size_t ROBOT_CONFIG_HEADER_SIZE = 12;
+        constexpr size_t ROBOT_CONFIG_GEOMETRY_SIZE = 4 * sizeof(float) + 1;
+        constexpr size_t ROBOT_CONFIG_MOTOR_SIZE = 6 + 2 + 1 + 3 * sizeof(float);
+        constexpr uint8_t ROBOT_CONFIG_PWM_CHANNELS = 16;
+        // Pins of the ESP32 a configuration must not use, as in the static_asserts of conf_hardware.h
+        constexpr uint8_t ROBOT_CONFIG_FIRST_INPUT_ONLY_PIN = 34;
+        constexpr uint8_t ROBOT_CONFIG_LAST_INPUT_ONLY_PIN = 39;
+        constexpr uint8_t ROBOT_CONFIG_FIRST_FLASH_PIN = 6;
+        constexpr uint8_t ROBOT_CONFIG_LAST_FLASH_PIN = 11;
+
+        /**
+         * @brief Result of loading a configuration.
+         */
+        enum class ConfigStatus : uint8_t
+        {
+            OK = 0,
+            NOT_FOUND,           // No blob stored, the defaults are used
+            TOO_SHORT,           // Blob smaller than its header or payload size
+            BAD_MAGIC,           // Not a configuration blob
+            UNSUPPORTED_VERSION, // Written by an incompatible firmware
+            BAD_CRC,             // Corrupted payload
+            WRONG_MOTOR_COUNT,   // Configuration for a different robot variant
+            INVALID_VALUES       // Non-positive geometry, pin conflicts, invalid channels
+        };
+
+        inline const char* to_string(ConfigStatus status)
+        {
+            switch (status)
+            {
+            case ConfigStatus::OK:
+                return "OK";
+            case ConfigStatus::NOT_FOUND:
+                return "not found";
+            case ConfigStatus::TOO_SHORT:
+                return "too short";
+            case ConfigStatus::BAD_MAGIC:
+                return "bad magic";
+            case ConfigStatus::UNSUPPORTED_VERSION:
+                return "unsupported version";
+            case ConfigStatus::BAD_CRC:
+                return "bad CRC";
+            case ConfigStatus::WRONG_MOTOR_COUNT:
+                return "wrong motor count";
+            case ConfigStatus::INVALID_VALUES:
+                return "invalid values";
+            }
+            return "unknown";
+        }
+
+        /**
+         * @brief Parameters that are read from the configuration at boot.
+         *
+         * @tparam MotorCount Number of motors, fixed by the firmware.
+         */
+        template <size_t MotorCount>
+        struct RobotConfig
+        {
+            float wheel_radius;
+            float wheel_base;
+            float track_width;
+            float max_wheel_velocity;
+            motor_control::MotorDescription motors[MotorCount];
+        };
+
+        /**
+         * @brief Configuration from the compiled in values of conf_hardware.h.
+         */
+        template <size_t MotorCount>
+        constexpr RobotConfig<MotorCount> make_robot_config(float wheel_radius, float wheel_base, float track_width, float max_wheel_velocity,
+                                                            const motor_control::MotorDescription (&motors)[MotorCount])
+        {
+            RobotConfig<MotorCount> config = {wheel_radius, wheel_base, track_width, max_wheel_velocity, {}};
+            for (size_t i = 0; i < MotorCount; i++)
+            {
+                config.motors[i] = motors[i];
+            }
+            return config;
+        }
+
+        template <size_t MotorCount>
+        constexpr size_t serialized_size()
+        {
+            return ROBOT_CONFIG_HEADER_SIZE + ROBOT_CONFIG_GEOMETRY_SIZE + MotorCount * ROBOT_CONFIG_MOTOR_SIZE;
+        }
+
+        namespace detail
+        {
+            struct Crc32Table
+            {
+                uint32_t entries[256];
+
+                constexpr Crc32Table() : entries()
+                {
+                    for (uint32_t i = 0; i < 256; i++)
+                    {
+                        uint32_t crc = i;
+                        for (int bit = 0; bit < 8; bit++)
+                        {
+                            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+                        }
+                        entries[i] = crc;
+                    }
+                }
+            };
+
+            constexpr Crc32Table CRC32_TABLE;
+
+            class Writer
+            {
+            public:
+                explicit Writer(uint8_t* data) : data_(data) {}
+
+                void u8(uint8_t value) { data_[position_++] = value; }
+
+                void u16(uint16_t value)
+                {
+                    u8(value & 0xFF);
+                    u8(value >> 8);
+                }
+
+                void u32(uint32_t value)
+                {
+                    u16(value & 0xFFFF);
+                    u16(value >> 16);
+                }
+
+                void f32(float value)
+                {
+                    uint32_t bits;
+                    memcpy(&bits, &value, sizeof(bits));
+                    u32(bits);
+                }
+
+            private:
+                uint8_t* data_;
+                size_t position_ = 0;
+            };
+
+            class Reader
+            {
+            public:
+                explicit Reader(const uint8_t* data) : data_(data) {}
+
+                uint8_t u8() { return data_[position_++]; }
+
+                uint16_t u16()
+                {
+                    const uint16_t low = u8();
+                    return low | static_cast<uint16_t>(u8() << 8);
+                }
+
+                uint32_t u32()
+                {
+                    const uint32_t low = u16();
+                    return low | (static_cast<uint32_t>(u16()) << 16);
+                }
+
+                float f32()
+                {
+                    const uint32_t bits = u32();
+                    float value;
+                    memcpy(&value, &bits, sizeof(value));
+                    return value;
+                }
+
+            private:
+                const uint8_t* data_;
+                size_t position_ = 0;
+            };
+        } // namespace detail
+
+        /**
+         * @brief CRC-32 (IEEE 802.3) of a buffer.
+         */
+        inline uint32_t crc32(const uint8_t* data, size_t size)
+        {
+            uint32_t crc = 0xFFFFFFFFu;
+            for (size_t i = 0; i < size; i++)
+            {
+                crc = detail::CRC32_TABLE.entries[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+            }
+            return ~crc;
+        }
+
+        /**
+         * @brief Check the values of a configuration before it is used to build
+         * the motor stack, with the same pin checks the static_asserts of
+         * conf_hardware.h apply to the compiled in description.
+         *
+         * @param config Configuration.
+         * @param reserved_pins Pins of other peripherals, e.g. the IMU, no motor may use.
+         * @param reserved_count Number of reserved pins.
+         */
+        template <size_t MotorCount>
+        bool is_valid(const RobotConfig<MotorCount>& config, const uint8_t* reserved_pins = nullptr, size_t reserved_count = 0)
+        {
+            const float geometry[4] = {config.wheel_radius, config.wheel_base, config.track_width, config.max_wheel_velocity};
+            for (float value : geometry)
+            {
+                if (!(value > 0.0f) || !isfinite(value))
+                {
+                    return false;
+                }
+            }
+            for (const motor_control::MotorDescription& motor : config.motors)
+            {
+                const float gains[3] = {motor.gains.kp, motor.gains.ki, motor.gains.kd};
+                for (float gain : gains)
+                {
+                    if (!(gain >= 0.0f) || !isfinite(gain))
+                    {
+                        return false;
+                    }
+                }
+            }
+            for (size_t i = 0; i < reserved_count; i++)
+            {
+                if (!motor_control::is_pin_unused(config.motors, reserved_pins[i]))
+                {
+                    return false;
+                }
+            }
+            return motor_control::has_unique_pins(config.motors) && motor_control::has_valid_pwm_channels(config.motors, ROBOT_CONFIG_PWM_CHANNELS) &&
+                   motor_control::has_output_capable_driver_pins(config.motors, ROBOT_CONFIG_FIRST_INPUT_ONLY_PIN, ROBOT_CONFIG_LAST_INPUT_ONLY_PIN) &&
+                   motor_control::avoids_pin_range(config.motors, ROBOT_CONFIG_FIRST_FLASH_PIN, ROBOT_CONFIG_LAST_FLASH_PIN) && motor_control::has_valid_encoder_resolutions(config.motors);
+        }
+
+        /**
+         * @brief Encode a configuration.
+         *
+         * @param config Configuration.
+         * @param buffer Output buffer.
+         * @param capacity Size of the output buffer.
+         * @return size_t Size of the blob, 0 if the buffer is too small.
+         */
+        template <size_t MotorCount>
+        size_t serialize(const RobotConfig<MotorCount>& config, uint8_t* buffer, size_t capacity)
+        {
+            constexpr size_t size = serialized_size<MotorCount>();
+            constexpr size_t payload_size = size - ROBOT_CONFIG_HEADER_SIZE;
+            static_assert(payload_size <= UINT16_MAX && MotorCount <= UINT8_MAX, "Configuration too large");
+            if (capacity < size)
+            {
+                return 0;
+            }
+
+            detail::Writer payload(buffer + ROBOT_CONFIG_HEADER_SIZE);
+            payload.f32(config.wheel_radius);
+            payload.f32(config.wheel_base);
+            payload.f32(config.track_width);
+            payload.f32(config.max_wheel_velocity);
+            payload.u8(MotorCount);
+            for (const motor_control::MotorDescription& motor : config.motors)
+            {
+                payload.u8(motor.in1);
+                payload.u8(motor.in2);
+                payload.u8(motor.enable);
+                payload.u8(motor.pwm_channel);
+                payload.u8(motor.encoder_a);
+                payload.u8(motor.encoder_b);
+                payload.u16(motor.encoder_resolution);
+                payload.u8(motor.inverted ? 1 : 0);
+                payload.f32(motor.gains.kp);
+                payload.f32(motor.gains.ki);
+                payload.f32(motor.gains.kd);
+            }
+
+            detail::Writer header(buffer);
+            header.u32(ROBOT_CONFIG_MAGIC);
+            header.u16(ROBOT_CONFIG_VERSION);
+            header.u16(payload_size);
+            header.u32(crc32(buffer + ROBOT_CONFIG_HEADER_SIZE, payload_size));
+            return size;
+        }
+
+        /**
+         * @brief Decode and validate a configuration blob.
+         *
+         * @param data Blob.
+         * @param size Size of the blob.
+         * @param config Output, only written if the blob is valid so it can hold
+         * the defaults as fallback.
+         * @param reserved_pins Pins of other peripherals no motor may use.
+         * @param reserved_count Number of reserved pins.
+         * @return ConfigStatus OK or the first problem found.
+         */
+        template <size_t MotorCount>
+        ConfigStatus deserialize(const uint8_t* data, size_t size, RobotConfig<MotorCount>& config, const uint8_t* reserved_pins = nullptr, size_t reserved_count = 0)
+        {
+            if (size < ROBOT_CONFIG_HEADER_SIZE)
+            {
+                return ConfigStatus::TOO_SHORT;
+            }
+
+            detail::Reader header(data);
+            if (header.u32() != ROBOT_CONFIG_MAGIC)
+            {
+                return ConfigStatus::BAD_MAGIC;
+            }
+            if (header.u16() != ROBOT_CONFIG_VERSION)
+            {
+                return ConfigStatus::UNSUPPORTED_VERSION;
+            }
+            const uint16_t payload_size = header.u16();
+            const uint32_t crc = header.u32();
+            if (size < ROBOT_CONFIG_HEADER_SIZE + payload_size || payload_size < ROBOT_CONFIG_GEOMETRY_SIZE)
+            {
+                return ConfigStatus::TOO_SHORT;
+            }
+            if (crc32(data + ROBOT_CONFIG_HEADER_SIZE, payload_size) != crc)
+            {
+                return ConfigStatus::BAD_CRC;
+            }
+
+            detail::Reader payload(data + ROBOT_CONFIG_HEADER_SIZE);
+            RobotConfig<MotorCount> decoded;
+            decoded.wheel_radius = payload.f32();
+            decoded.wheel_base = payload.f32();
+            decoded.track_width = payload.f32();
+            decoded.max_wheel_velocity = payload.f32();
+            if (payload.u8() != MotorCount || payload_size != serialized_size<MotorCount>() - ROBOT_CONFIG_HEADER_SIZE)
+            {
+                return ConfigStatus::WRONG_MOTOR_COUNT;
+            }
+            for (motor_control::MotorDescription& motor : decoded.motors)
+            {
+                motor.in1 = payload.u8();
+                motor.in2 = payload.u8();
+                motor.enable = payload.u8();
+                motor.pwm_channel = payload.u8();
+                motor.encoder_a = payload.u8();
+                motor.encoder_b = payload.u8();
+                motor.encoder_resolution = payload.u16();
+                motor.inverted = (payload.u8() & 1) != 0;
+                motor.gains.kp = payload.f32();
+                motor.gains.ki = payload.f32();
+                motor.gains.kd = payload.f32();
+            }
+
+            if (!is_valid(decoded, reserved_pins, reserved_count))
+            {
+                return ConfigStatus::INVALID_VALUES;
+            }
+            config = decoded;
+            return ConfigStatus::OK;
+        }
+
+    } // namespace config
+} // namespace roboost
+
+#endif // ROBOT_CONFIG_HPP
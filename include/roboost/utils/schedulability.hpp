@@ -0,0 +1,340 @@
+/**
+ * @file schedulability.hpp
+ * @author Friedl Jakob (friedl.jak@gmail.com)
+ * @brief Admission control for periodic tasks based on response-time analysis
+ * (RM/DM) and EDF density tests over measured worst case execution times.
+ * @version 0.1
+ * @date 2024-06-02
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef SCHEDULABILITY_HPP
+#define SCHEDULABILITY_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace roboost
+{
+    namespace timing
+    {
+        /**
+         * @brief Priority assignment / scheduling policy used for the analysis.
+         * RATE_MONOTONIC: Shorter period -> higher priority.
+         * DEADLINE_MONOTONIC: Shorter relative deadline -> higher priority.
+         * EDF: Earliest deadline first, checked with the density test.
+         */
+        enum class SchedulingPolicy
+        {
+            RATE_MONOTONIC,
+            DEADLINE_MONOTONIC,
+            EDF
+        };
+
+        /**
+         * @brief Reaction of the analyzer when a task set becomes infeasible.
+         * WARN: Accept the change and report it through is_feasible().
+         * REJECT: Refuse to add or change the task.
+         */
+        enum class AdmissionMode
+        {
+            WARN,
+            REJECT
+        };
+
+        /**
+         * @brief Timing parameters and analysis results of a single task. All
+         * times are in microseconds.
+         */
+        struct TaskTimingInfo
+        {
+            const char* name = nullptr;
+            uint32_t period = 0;
+            uint32_t deadline = 0;
+            uint32_t wcet = 0;
+            uint32_t response_time = 0;
+            int32_t slack = 0;
+            bool feasible = false;
+        };
+
+        /**
+         * @brief Analyzes whether a set of periodic tasks can meet its deadlines.
+         *
+         * The analysis is re-run whenever a task is added, its period changes or a
+         * new worst case execution time is measured. The Scheduler executes tasks
+         * cooperatively, so by default the fixed priority analysis accounts for
+         * blocking by the longest lower priority task (non-preemptive RTA).
+         *
+         * @tparam MaxTasks Maximum number of tasks that can be registered.
+         */
+        template <size_t MaxTasks>
+        class SchedulabilityAnalyzer
+        {
+        public:
+            /**
+             * @brief Construct a new Schedulability Analyzer object
+             *
+             * @param policy Scheduling policy to analyze against.
+             * @param mode Reaction to infeasible task sets.
+             * @param preemptive Whether tasks can be preempted by higher priority ones.
+             */
+            SchedulabilityAnalyzer(SchedulingPolicy policy = SchedulingPolicy::DEADLINE_MONOTONIC, AdmissionMode mode = AdmissionMode::WARN, bool preemptive = false)
+                : policy_(policy), mode_(mode), preemptive_(preemptive)
+            {
+            }
+
+            /**
+             * @brief Register a new task.
+             *
+             * @param name Name of the task, used for reporting.
+             * @param period Activation period in microseconds.
+             * @param deadline Relative deadline in microseconds, 0 means equal to the period.
+             * @param wcet Initial estimate of the worst case execution time in microseconds.
+             * @return int Task id, or -1 if the task was rejected.
+             */
+            int add_task(const char* name, uint32_t period, uint32_t deadline = 0, uint32_t wcet = 0)
+            {
+                if (task_count_ >= MaxTasks || period == 0)
+                {
+                    return -1;
+                }
+
+                TaskTimingInfo& task = tasks_[task_count_];
+                task.name = name;
+                task.period = period;
+                task.deadline = deadline == 0 ? period : deadline;
+                task.wcet = wcet;
+                task_count_++;
+
+                if (!analyze() && mode_ == AdmissionMode::REJECT)
+                {
+                    task_count_--;
+                    analyze();
+                    return -1;
+                }
+                return static_cast<int>(task_count_ - 1);
+            }
+
+            /**
+             * @brief Change the period and deadline of a registered task.
+             *
+             * @param id Task id returned by add_task.
+             * @param period New period in microseconds.
+             * @param deadline New relative deadline in microseconds, 0 means equal to the period.
+             * @return true if the change was applied.
+             */
+            bool set_period(int id, uint32_t period, uint32_t deadline = 0)
+            {
+                if (!is_valid(id) || period == 0)
+                {
+                    return false;
+                }
+
+                TaskTimingInfo& task = tasks_[id];
+                const uint32_t old_period = task.period;
+                const uint32_t old_deadline = task.deadline;
+                task.period = period;
+                task.deadline = deadline == 0 ? period : deadline;
+
+                if (!analyze() && mode_ == AdmissionMode::REJECT)
+                {
+                    task.period = old_period;
+                    task.deadline = old_deadline;
+                    analyze();
+                    return false;
+                }
+                return true;
+            }
+
+            /**
+             * @brief Report a measured execution time. The analysis is only re-run
+             * if the measurement exceeds the known worst case execution time.
+             *
+             * @param id Task id returned by add_task.
+             * @param execution_time Measured execution time in microseconds.
+             * @return true if the task set is still feasible.
+             */
+            bool update_wcet(int id, uint32_t execution_time)
+            {
+                if (!is_valid(id))
+                {
+                    return false;
+                }
+                if (execution_time > tasks_[id].wcet)
+                {
+                    tasks_[id].wcet = execution_time;
+                    analyze();
+                }
+                return feasible_;
+            }
+
+            /**
+             * @brief Run the analysis for the current task set.
+             *
+             * @return true if all deadlines can be met.
+             */
+            bool analyze()
+            {
+                utilization_ = 0.0f;
+                for (size_t i = 0; i < task_count_; i++)
+                {
+                    utilization_ += static_cast<float>(tasks_[i].wcet) / tasks_[i].period;
+                }
+
+                feasible_ = policy_ == SchedulingPolicy::EDF ? analyze_edf() : analyze_fixed_priority();
+                return feasible_;
+            }
+
+            bool is_feasible() const { return feasible_; }
+
+            float get_utilization() const { return utilization_; }
+
+            size_t get_task_count() const { return task_count_; }
+
+            /**
+             * @brief Get the slack of a task, i.e. the time between its worst case
+             * response and its deadline. Negative values indicate a deadline miss.
+             *
+             * @param id Task id returned by add_task.
+             * @return int32_t Slack in microseconds.
+             */
+            int32_t get_slack(int id) const { return is_valid(id) ? tasks_[id].slack : 0; }
+
+            /**
+             * @brief Get the smallest slack over all tasks.
+             *
+             * @return int32_t Minimum slack in microseconds.
+             */
+            int32_t get_min_slack() const
+            {
+                int32_t min_slack = INT32_MAX;
+                for (size_t i = 0; i < task_count_; i++)
+                {
+                    if (tasks_[i].slack < min_slack)
+                    {
+                        min_slack = tasks_[i].slack;
+                    }
+                }
+                return task_count_ == 0 ? 0 : min_slack;
+            }
+
+            const TaskTimingInfo& get_task(int id) const { return tasks_[is_valid(id) ? id : 0]; }
+
+        private:
+            bool is_valid(int id) const { return id >= 0 && static_cast<size_t>(id) < task_count_; }
+
+            bool has_higher_priority(const TaskTimingInfo& a, const TaskTimingInfo& b) const
+            {
+                return policy_ == SchedulingPolicy::RATE_MONOTONIC ? a.period < b.period : a.deadline < b.deadline;
+            }
+
+            bool analyze_fixed_priority()
+            {
+                bool all_feasible = true;
+                for (size_t i = 0; i < task_count_; i++)
+                {
+                    TaskTimingInfo& task = tasks_[i];
+
+                    // Blocking by lower priority tasks that cannot be preempted
+                    uint32_t blocking = 0;
+                    if (!preemptive_)
+                    {
+                        for (size_t j = 0; j < task_count_; j++)
+                        {
+                            if (j != i && has_higher_priority(task, tasks_[j]) && tasks_[j].wcet > blocking)
+                            {
+                                blocking = tasks_[j].wcet;
+                            }
+                        }
+                    }
+
+                    // Fixed point iteration of the response time. In the non-preemptive
+                    // case the iteration covers the start time of the job, in the
+                    // preemptive case its completion time.
+                    uint64_t own = preemptive_ ? task.wcet : 0;
+                    uint64_t response = blocking + own;
+                    uint64_t previous = 0;
+                    bool converged = false;
+                    while (response <= task.deadline)
+                    {
+                        // Tasks of equal priority can run first, so they interfere like
+                        // higher priority ones
+                        uint64_t interference = 0;
+                        for (size_t j = 0; j < task_count_; j++)
+                        {
+                            if (j == i || has_higher_priority(task, tasks_[j]))
+                            {
+                                continue;
+                            }
+                            uint64_t activations = preemptive_ ? (response + tasks_[j].period - 1) / tasks_[j].period : response / tasks_[j].period + 1;
+                            interference += activations * tasks_[j].wcet;
+                        }
+                        previous = response;
+                        response = blocking + own + interference;
+                        if (response == previous)
+                        {
+                            converged = true;
+                            break;
+                        }
+                    }
+
+                    if (!preemptive_)
+                    {
+                        response += task.wcet;
+                    }
+
+                    task.response_time = response > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(response);
+                    task.feasible = converged && response <= task.deadline;
+                    task.slack = static_cast<int32_t>(static_cast<int64_t>(task.deadline) - static_cast<int64_t>(task.response_time));
+                    all_feasible = all_feasible && task.feasible;
+                }
+                return all_feasible;
+            }
+
+            bool analyze_edf()
+            {
+                // Density test, sufficient for constrained deadlines and exact for
+                // implicit deadlines in the preemptive case.
+                float density = 0.0f;
+                uint32_t blocking = 0;
+                uint32_t min_deadline = UINT32_MAX;
+                for (size_t i = 0; i < task_count_; i++)
+                {
+                    const uint32_t relative = tasks_[i].deadline < tasks_[i].period ? tasks_[i].deadline : tasks_[i].period;
+                    density += static_cast<float>(tasks_[i].wcet) / relative;
+                    blocking = tasks_[i].wcet > blocking ? tasks_[i].wcet : blocking;
+                    min_deadline = relative < min_deadline ? relative : min_deadline;
+                }
+                if (!preemptive_ && task_count_ > 0)
+                {
+                    density += static_cast<float>(blocking) / min_deadline;
+                }
+
+                // Report the slack as the part of the deadline left unused at the
+                // computed density.
+                const bool feasible = density <= 1.0f;
+                for (size_t i = 0; i < task_count_; i++)
+                {
+                    TaskTimingInfo& task = tasks_[i];
+                    task.response_time = static_cast<uint32_t>(density * task.deadline);
+                    task.slack = static_cast<int32_t>(static_cast<int64_t>(task.deadline) - task.response_time);
+                    task.feasible = feasible;
+                }
+                return feasible;
+            }
+
+            SchedulingPolicy policy_;
+            AdmissionMode mode_;
+            bool preemptive_;
+            TaskTimingInfo tasks_[MaxTasks];
+            size_t task_count_ = 0;
+            float utilization_ = 0.0f;
+            bool feasible_ = true;
+        };
+
+    } // namespace timing
+} // namespace roboost
+
+#endif // SCHEDULABILITY_HPP
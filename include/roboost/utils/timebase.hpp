@@ -0,0 +1,110 @@
+/**
+ * @file timebase.hpp
+ * @author Friedl Jakob (friedl.jak@gmail.com)
+ * @brief 64 bit monotonic time in microseconds for all targets.
+ * @version 0.1
+ * @date 2024-06-23
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * now_us64() is the single source of time. Timestamps are uint64_t and never
+ * wrap during the life of a robot, so differences of timestamps are always
+ * valid, unlike micros() in 32 bit which wraps after about 71 minutes.
+ *
+ * Backends:
+ *   ESP32   esp_timer_get_time(), already 64 bit.
+ *   Teensy  ARM DWT cycle counter, extended to 64 bit by WrapExtender.
+ *   Arduino micros(), extended to 64 bit by WrapExtender.
+ *   native  std::chrono::steady_clock.
+ *
+ * WrapExtender keeps the number of half periods of the 32 bit counter in one
+ * atomic word. The top bit of every reading tells whether the counter moved
+ * on to the next half since the last reading, which is then published with a
+ * compare and swap. Reads are lock-free and can be made from interrupts and
+ * tasks alike, as long as the counter is read at least once per half period
+ * (3.5 s for the cycle counter at 600 MHz, 35 min for micros()). The control
+ * loop does that many times over.
+ */
+
+#ifndef TIMEBASE_HPP
+#define TIMEBASE_HPP
+
+#include <atomic>
+#include <stdint.h>
+
+#if defined(ESP_PLATFORM)
+#include <esp_timer.h>
+#elif defined(ARDUINO)
+#include <Arduino.h>
+#else
+#include <chrono>
+#endif
+
+namespace roboost
+{
+    namespace timing
+    {
+        /**
+         * @brief Extends a free running 32 bit counter to 64 bit.
+         */
+        class WrapExtender
+        {
+        public:
+            /**
+             * @brief Read the counter and extend the reading.
+             *
+             * The state is loaded before the counter is read. A reading taken
+             * before a concurrent update would otherwise count a half period
+             * twice.
+             *
+             * @param counter Returns the current value of the 32 bit counter.
+             * @return uint64_t Value of the counter since it started.
+             */
+            template <typename Counter>
+            uint64_t read(Counter&& counter)
+            {
+                uint32_t half_periods = half_periods_.load(std::memory_order_acquire);
+                const uint32_t raw = counter();
+                while ((raw >> 31) != (half_periods & 1))
+                {
+                    // A failed exchange means that another context published the same step
+                    if (half_periods_.compare_exchange_weak(half_periods, half_periods + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+                    {
+                        half_periods++;
+                    }
+                }
+                return (static_cast<uint64_t>(half_periods) << 31) | (raw & 0x7FFFFFFFu);
+            }
+
+        private:
+            std::atomic<uint32_t> half_periods_{0};
+        };
+
+        /**
+         * @brief Microseconds since boot, monotonic and never wrapping.
+         */
+        inline uint64_t now_us64()
+        {
+#if defined(ESP_PLATFORM)
+            return static_cast<uint64_t>(esp_timer_get_time());
+#elif defined(ARDUINO) && defined(ARM_DWT_CYCCNT)
+            static WrapExtender cycles;
+            return cycles.read([]() { return static_cast<uint32_t>(ARM_DWT_CYCCNT); }) / (F_CPU / 1000000);
+#elif defined(ARDUINO)
+            static WrapExtender microseconds;
+            return microseconds.read([]() { return static_cast<uint32_t>(micros()); });
+#else
+            static const auto start = std::chrono::steady_clock::now();
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+#endif
+        }
+
+        /**
+         * @brief Difference of two timestamps in seconds.
+         */
+        inline float elapsed_s(uint64_t from_us, uint64_t to_us) { return static_cast<float>(to_us - from_us) * 1e-6f; }
+
+    } // namespace timing
+} // namespace roboost
+
+#endif // TIMEBASE_HPP
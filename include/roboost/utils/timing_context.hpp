@@ -0,0 +1,105 @@
+/**
+ * @file timing_context.hpp
+ * @author Friedl Jakob (friedl.jak@gmail.com)
+ * @brief Timing of a single periodic task or callback.
+ * @version 0.1
+ * @date 2024-06-21
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * Every periodic caller owns a TimingContext and ticks it once per run with the
+ * time of the sample. Components are handed the context, or its dt, of the
+ * task they run in, instead of reading the delta time of the shared scheduler,
+ * which belongs to whichever task ran last. A tick is a subtraction, a compare
+ * and a multiplication.
+ */
+
+#ifndef TIMING_CONTEXT_HPP
+#define TIMING_CONTEXT_HPP
+
+#include <stdint.h>
+
+namespace roboost
+{
+    namespace timing
+    {
+        class TimingContext
+        {
+        public:
+            /**
+             * @brief Construct a new Timing Context object
+             *
+             * @param nominal_period_us Period the task is scheduled with in microseconds.
+             * @param max_period_us Longest period that is not an overrun, 1.5 times
+             * the nominal period if 0.
+             */
+            explicit TimingContext(uint32_t nominal_period_us = 0, uint32_t max_period_us = 0)
+                : nominal_period_us_(nominal_period_us), max_period_us_(max_period_us != 0 ? max_period_us : nominal_period_us + nominal_period_us / 2), period_us_(nominal_period_us),
+                  dt_(nominal_period_us * 1e-6f)
+            {
+            }
+
+            /**
+             * @brief Start a new sample. The first sample reports the nominal
+             * period.
+             *
+             * @param now_us Time of the sample from now_us64().
+             */
+            void tick(uint64_t now_us)
+            {
+                if (tick_count_ != 0)
+                {
+                    const uint64_t period_us = now_us - sample_time_us_;
+                    period_us_ = period_us < UINT32_MAX ? static_cast<uint32_t>(period_us) : UINT32_MAX;
+                    dt_ = period_us * 1e-6f;
+                }
+                sample_time_us_ = now_us;
+                overrun_ = period_us_ > max_period_us_;
+                if (overrun_)
+                {
+                    overrun_count_++;
+                }
+                tick_count_++;
+            }
+
+            /**
+             * @brief Time of the current sample in microseconds.
+             */
+            uint64_t get_sample_time_us() const { return sample_time_us_; }
+
+            /**
+             * @brief Measured time since the previous sample in microseconds.
+             */
+            uint32_t get_period_us() const { return period_us_; }
+
+            /**
+             * @brief Measured time since the previous sample in seconds.
+             */
+            float get_dt() const { return dt_; }
+
+            /**
+             * @brief Whether the current sample came later than the maximum period.
+             */
+            bool is_overrun() const { return overrun_; }
+
+            uint32_t get_overrun_count() const { return overrun_count_; }
+
+            uint32_t get_tick_count() const { return tick_count_; }
+
+            uint32_t get_nominal_period_us() const { return nominal_period_us_; }
+
+        private:
+            uint32_t nominal_period_us_;
+            uint32_t max_period_us_;
+            uint32_t period_us_;
+            float dt_;
+            uint64_t sample_time_us_ = 0;
+            uint32_t tick_count_ = 0;
+            uint32_t overrun_count_ = 0;
+            bool overrun_ = false;
+        };
+
+    } // namespace timing
+} // namespace roboost
+
+#endif // TIMING_CONTEXT_HPP
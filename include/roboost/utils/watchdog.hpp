@@ -0,0 +1,207 @@
+/**
+ * @file watchdog.hpp
+ * @author Friedl Jakob (friedl.jak@gmail.com)
+ * @brief Software watchdog supervising task heartbeats with escalating
+ * actions.
+ * @version 0.1
+ * @date 2024-06-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * Every supervised task owns a Heartbeat and calls beat() once per successful
+ * run, which is a relaxed load and a release store of a 32 bit counter, no
+ * lock and no read-modify-write. A supervisor running in its own thread calls
+ * check() periodically. A task whose counter did not change for one deadline
+ * is overdue, and the action escalates with every further deadline:
+ * LOG, SAFE_STOP, RESTART_TASK and finally RESET, capped per task. check()
+ * returns true only while no task capped at RESET is overdue, which is the
+ * condition for feeding the hardware watchdog. Tasks with a lower cap handle
+ * their misses themselves and never reset the chip.
+ */
+
+#ifndef WATCHDOG_HPP
+#define WATCHDOG_HPP
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace roboost
+{
+    namespace timing
+    {
+        /**
+         * @brief Escalation levels of the watchdog, in increasing severity.
+         * NONE is reported when an overdue task recovers.
+         */
+        enum class WatchdogAction : uint8_t
+        {
+            NONE = 0,
+            LOG,
+            SAFE_STOP,
+            RESTART_TASK,
+            RESET
+        };
+
+        /**
+         * @brief Heartbeat counter of a single task. Only the owning task may
+         * call beat(), any thread may read the count.
+         */
+        class Heartbeat
+        {
+        public:
+            void beat() { count_.store(count_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+            uint32_t get_count() const { return count_.load(std::memory_order_acquire); }
+
+        private:
+            std::atomic<uint32_t> count_{0};
+        };
+
+        /**
+         * @brief Supervisor of up to MaxTasks heartbeats.
+         *
+         * Tasks are added before the supervisor thread starts, check() is then
+         * only called from that thread.
+         *
+         * @tparam MaxTasks Maximum number of supervised tasks.
+         */
+        template <size_t MaxTasks>
+        class SoftwareWatchdog
+        {
+        public:
+            /**
+             * @brief Called from check() for every escalation step of a task, in
+             * order, and with NONE once the task recovers.
+             */
+            using Handler = void (*)(size_t task_id, WatchdogAction action);
+
+            explicit SoftwareWatchdog(Handler handler = nullptr) : handler_(handler) {}
+
+            /**
+             * @brief Supervise a task.
+             *
+             * @param name Name of the task, must outlive the watchdog.
+             * @param deadline_us Maximum time between two heartbeats in microseconds.
+             * @param max_action Most severe action taken for this task.
+             * @param now_us Current time in microseconds, the first deadline starts here.
+             * @return int Id of the task, -1 if all slots are used.
+             */
+            int add_task(const char* name, uint32_t deadline_us, WatchdogAction max_action, uint64_t now_us)
+            {
+                if (task_count_ >= MaxTasks || deadline_us == 0)
+                {
+                    return -1;
+                }
+                Task& task = tasks_[task_count_];
+                task.name = name;
+                task.deadline_us = deadline_us;
+                task.max_action = max_action;
+                task.last_count = task.heartbeat.get_count();
+                task.last_seen_us = now_us;
+                task.action = WatchdogAction::NONE;
+                return static_cast<int>(task_count_++);
+            }
+
+            /**
+             * @brief Check all heartbeats and escalate overdue tasks.
+             *
+             * @param now_us Current time from now_us64().
+             * @return true if every task capped at RESET beat within its deadline.
+             */
+            bool check(uint64_t now_us)
+            {
+                bool healthy = true;
+                for (size_t id = 0; id < task_count_; id++)
+                {
+                    Task& task = tasks_[id];
+                    const uint32_t count = task.heartbeat.get_count();
+                    if (count != task.last_count)
+                    {
+                        task.last_count = count;
+                        task.last_seen_us = now_us;
+                        if (task.action != WatchdogAction::NONE)
+                        {
+                            task.action = WatchdogAction::NONE;
+                            notify(id, WatchdogAction::NONE);
+                        }
+                        continue;
+                    }
+
+                    // One escalation level per elapsed deadline
+                    const uint64_t overdue = (now_us - task.last_seen_us) / task.deadline_us;
+                    if (overdue == 0)
+                    {
+                        continue;
+                    }
+                    if (task.max_action == WatchdogAction::RESET)
+                    {
+                        healthy = false;
+                    }
+
+                    const uint8_t max_level = static_cast<uint8_t>(task.max_action);
+                    const uint8_t level = overdue < max_level ? static_cast<uint8_t>(overdue) : max_level;
+                    if (level == static_cast<uint8_t>(task.action))
+                    {
+                        continue;
+                    }
+                    if (static_cast<uint8_t>(task.action) == 0)
+                    {
+                        task.miss_count++;
+                    }
+
+                    // Report skipped levels too, a late check must not skip the safe stop
+                    while (static_cast<uint8_t>(task.action) < level)
+                    {
+                        task.action = static_cast<WatchdogAction>(static_cast<uint8_t>(task.action) + 1);
+                        notify(id, task.action);
+                    }
+                }
+                return healthy;
+            }
+
+            Heartbeat& get_heartbeat(size_t id) { return tasks_[id].heartbeat; }
+
+            const char* get_name(size_t id) const { return tasks_[id].name; }
+
+            WatchdogAction get_action(size_t id) const { return tasks_[id].action; }
+
+            /**
+             * @brief Number of times the task became overdue.
+             */
+            uint32_t get_miss_count(size_t id) const { return tasks_[id].miss_count; }
+
+            size_t size() const { return task_count_; }
+
+            void set_handler(Handler handler) { handler_ = handler; }
+
+        private:
+            struct Task
+            {
+                Heartbeat heartbeat;
+                const char* name = nullptr;
+                uint32_t deadline_us = 0;
+                uint32_t last_count = 0;
+                uint64_t last_seen_us = 0;
+                uint32_t miss_count = 0;
+                WatchdogAction max_action = WatchdogAction::LOG;
+                WatchdogAction action = WatchdogAction::NONE;
+            };
+
+            void notify(size_t id, WatchdogAction action)
+            {
+                if (handler_ != nullptr)
+                {
+                    handler_(id, action);
+                }
+            }
+
+            Task tasks_[MaxTasks];
+            size_t task_count_ = 0;
+            Handler handler_;
+        };
+
+    } // namespace timing
+} // namespace roboost
+
+#endif // WATCHDOG_HPP
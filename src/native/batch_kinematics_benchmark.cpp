@@ -0,0 +1,78 @@
+#include <chrono>
+#include <cmath>
+#include <conf_hardware.h>
+#include <iostream>
+#include <roboost/kinematics/batch_kinematics.hpp>
+#include <roboost/kinematics/kinematics.hpp>
+
+using namespace roboost::kinematics;
+
+using Twist = roboost::math::Vector<float>;
+
+// Candidate twists of a dynamic window planner: 8 x 8 x 8 velocity samples
+constexpr size_t CANDIDATES = 512;
+constexpr int repetitions = 2000;
+
+TwistBatch<CANDIDATES> twists;
+WheelVelocityBatch<CANDIDATES> wheels;
+
+// Keeps the optimizer from removing the benchmarked work
+volatile float sink = 0.0f;
+
+double seconds_since(std::chrono::high_resolution_clock::time_point start) { return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count(); }
+
+int main()
+{
+    MecanumKinematics4W kinematics(WHEEL_RADIUS, WHEEL_BASE, TRACK_WIDTH);
+    BatchKinematics<MecanumKinematics4W, Twist> batch_kinematics(kinematics);
+
+    for (int x = 0; x < 8; x++)
+    {
+        for (int y = 0; y < 8; y++)
+        {
+            for (int w = 0; w < 8; w++)
+            {
+                twists.add(-1.0f + x * 2.0f / 7.0f, -1.0f + y * 2.0f / 7.0f, -3.0f + w * 6.0f / 7.0f);
+            }
+        }
+    }
+
+    // One calculate_wheel_velocity call per twist
+    size_t single_feasible = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < repetitions; r++)
+    {
+        single_feasible = 0;
+        for (size_t n = 0; n < twists.size; n++)
+        {
+            Twist wheel_velocity = kinematics.calculate_wheel_velocity(Twist{twists.vx[n], twists.vy[n], twists.omega[n]});
+            float max_abs = 0.0f;
+            for (size_t i = 0; i < 4; i++)
+            {
+                max_abs = std::fmax(max_abs, std::fabs(wheel_velocity[i]));
+            }
+            single_feasible += max_abs <= MAX_WHEEL_VELOCITY;
+        }
+        sink = sink + single_feasible;
+    }
+    double single_time = seconds_since(start);
+
+    // Whole batch at once
+    size_t batch_feasible = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < repetitions; r++)
+    {
+        batch_feasible = batch_kinematics.calculate_wheel_velocities(twists, wheels, MAX_WHEEL_VELOCITY);
+        sink = sink + wheels.wheel[0][r % CANDIDATES];
+    }
+    double batch_time = seconds_since(start);
+
+    const double evaluations = static_cast<double>(repetitions) * CANDIDATES;
+    std::cout << CANDIDATES << " candidate twists, " << repetitions << " repetitions" << std::endl;
+    std::cout << "Feasible twists:   single " << single_feasible << ", batch " << batch_feasible << std::endl;
+    std::cout << "Single twist:      " << single_time / evaluations * 1e9 << " ns/twist, " << evaluations / single_time / 1e6 << " M twists/s" << std::endl;
+    std::cout << "Batch (SoA):       " << batch_time / evaluations * 1e9 << " ns/twist, " << evaluations / batch_time / 1e6 << " M twists/s" << std::endl;
+    std::cout << "Speedup:           " << single_time / batch_time << "x" << std::endl;
+
+    return 0;
+}
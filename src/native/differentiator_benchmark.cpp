@@ -0,0 +1,148 @@
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <roboost/utils/differentiators.hpp>
+#include <roboost/utils/filter_design.hpp>
+#include <string>
+#include <vector>
+
+using namespace roboost::filters;
+
+// Encoder and sampling like the motor controllers use them
+constexpr double sample_time = 0.001; // s
+constexpr int encoder_resolution = 360;
+constexpr int samples = 5000;
+constexpr int max_lag = 40; // samples
+
+constexpr size_t WINDOW = 21;
+
+struct BenchmarkResult
+{
+    double noise;       // rad/s RMS at constant velocity
+    int lag;            // samples, shift that best aligns the estimate with the true velocity
+    double error;       // rad/s RMS tracking error of a 2 Hz sine after removing the lag
+    double update_time; // ns per update
+};
+
+double quantize(double position) { return std::floor(position * encoder_resolution / (2.0 * M_PI)) * 2.0 * M_PI / encoder_resolution; }
+
+// Wheel accelerating and braking with 2 Hz around 8 rad/s
+double true_velocity(double time) { return 8.0 + 4.0 * std::sin(2.0 * M_PI * 2.0 * time); }
+
+double true_position(double time) { return 8.0 * time - 4.0 / (2.0 * M_PI * 2.0) * (std::cos(2.0 * M_PI * 2.0 * time) - 1.0); }
+
+BenchmarkResult benchmark(const std::function<double(double)>& estimator, const std::function<void()>& reset)
+{
+    BenchmarkResult result;
+
+    // Noise at a constant 8 rad/s
+    reset();
+    double squared_sum = 0.0;
+    for (int i = 0; i < samples; i++)
+    {
+        double error = estimator(quantize(8.0 * i * sample_time)) - 8.0;
+        if (i >= samples / 10)
+        {
+            squared_sum += error * error;
+        }
+    }
+    result.noise = std::sqrt(squared_sum / (samples - samples / 10));
+
+    // Sine response, the lag is the shift with the smallest error
+    reset();
+    std::vector<double> estimate(samples);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < samples; i++)
+    {
+        estimate[i] = estimator(quantize(true_position(i * sample_time)));
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    result.update_time = std::chrono::duration<double, std::nano>(end - start).count() / samples;
+
+    result.error = INFINITY;
+    for (int lag = 0; lag <= max_lag; lag++)
+    {
+        squared_sum = 0.0;
+        for (int i = samples / 10; i < samples; i++)
+        {
+            double error = estimate[i] - true_velocity((i - lag) * sample_time);
+            squared_sum += error * error;
+        }
+        double error = std::sqrt(squared_sum / (samples - samples / 10));
+        if (error < result.error)
+        {
+            result.error = error;
+            result.lag = lag;
+        }
+    }
+    return result;
+}
+
+void print_result(const std::string& name, const BenchmarkResult& result)
+{
+    std::cout << std::left << std::setw(32) << name << std::right << std::fixed << std::setprecision(3) << std::setw(10) << result.noise << std::setw(8) << result.lag << std::setw(10)
+              << result.error << std::setprecision(1) << std::setw(10) << result.update_time << std::endl;
+}
+
+template <size_t WindowSize>
+void benchmark_kernel(const std::string& name, const std::array<double, WindowSize>& kernel)
+{
+    KernelDifferentiator<double, WindowSize> differentiator(kernel, sample_time);
+    print_result(name, benchmark([&](double position) { return differentiator.update(position); }, [&]() { differentiator.reset(); }));
+}
+
+int main()
+{
+    std::cout << "Velocity from a " << encoder_resolution << " count encoder sampled at " << 1.0 / sample_time << " Hz" << std::endl;
+    std::cout << std::left << std::setw(32) << "Method" << std::right << std::setw(10) << "Noise" << std::setw(8) << "Lag" << std::setw(10) << "Error" << std::setw(10) << "ns" << std::endl;
+    std::cout << std::left << std::setw(32) << "" << std::right << std::setw(10) << "[rad/s]" << std::setw(8) << "[ms]" << std::setw(10) << "[rad/s]" << std::setw(10) << "" << std::endl;
+
+    // Finite difference, the previous D-term input
+    double previous = 0.0;
+    auto finite_difference = [&](double position)
+    {
+        double velocity = (position - previous) / sample_time;
+        previous = position;
+        return velocity;
+    };
+    print_result("Finite difference", benchmark(finite_difference, [&]() { previous = 0.0; }));
+
+    // Finite difference followed by a lowpass, the previous velocity estimate
+    SOSFilter<double, 1> lowpass(design_butterworth_lowpass<1>(1.0 / sample_time, 25.0));
+    bool first = true;
+    print_result("Finite difference + 25 Hz LP",
+                 benchmark(
+                     [&](double position)
+                     {
+                         // Skip the jump from zero to the first position
+                         double velocity = finite_difference(position);
+                         if (first)
+                         {
+                             first = false;
+                             return lowpass.update(0.0);
+                         }
+                         return lowpass.update(velocity);
+                     },
+                     [&]()
+                     {
+                         previous = 0.0;
+                         first = true;
+                         lowpass.reset();
+                     }));
+
+    benchmark_kernel("Savitzky-Golay 21, order 2", savitzky_golay_kernel<WINDOW, 2>());
+    benchmark_kernel("Savitzky-Golay 21, order 4", savitzky_golay_kernel<WINDOW, 4>());
+    benchmark_kernel("Savitzky-Golay 41, order 4", savitzky_golay_kernel<41, 4>());
+    benchmark_kernel("Lanczos 21", lanczos_kernel<WINDOW>());
+    benchmark_kernel("Polynomial fit 21, order 2", polynomial_fit_kernel<WINDOW, 2>());
+    benchmark_kernel("Polynomial fit 41, order 2", polynomial_fit_kernel<41, 2>());
+
+    std::cout << std::endl;
+    std::cout << "Centered kernels (Savitzky-Golay, Lanczos) have the lowest noise with (N - 1) / 2 samples lag," << std::endl;
+    std::cout << "a higher order keeps fast changes at the cost of noise. End point polynomial fits remove the" << std::endl;
+    std::cout << "lag completely and are the choice for the D-term, where lag costs phase margin." << std::endl;
+
+    return 0;
+}
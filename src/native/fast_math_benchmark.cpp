@@ -0,0 +1,110 @@
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <roboost/utils/fast_math.hpp>
+#include <string>
+#include <vector>
+
+using namespace roboost::math;
+
+// Inputs like the odometry sees them: headings within a few turns, velocity components and squared norms
+constexpr int samples = 1 << 16;
+constexpr int repetitions = 200;
+
+struct BenchmarkResult
+{
+    double error;       // worst case against double precision libm, relative for sqrt
+    double update_time; // ns per call
+};
+
+volatile float sink;
+
+BenchmarkResult benchmark(const std::function<float(int)>& function, const std::function<double(int)>& reference, bool relative)
+{
+    BenchmarkResult result{0.0, 0.0};
+    for (int i = 0; i < samples; i++)
+    {
+        const double expected = reference(i);
+        double error = std::fabs(function(i) - expected);
+        if (relative)
+        {
+            error /= std::fabs(expected);
+        }
+        result.error = std::max(result.error, error);
+    }
+
+    float sum = 0.0f;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < repetitions; r++)
+    {
+        for (int i = 0; i < samples; i++)
+        {
+            sum += function(i);
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    sink = sum;
+    result.update_time = std::chrono::duration<double, std::nano>(end - start).count() / (static_cast<double>(samples) * repetitions);
+    return result;
+}
+
+void print_result(const std::string& name, const BenchmarkResult& result)
+{
+    std::cout << std::left << std::setw(24) << name << std::right << std::scientific << std::setprecision(2) << std::setw(12) << result.error << std::fixed << std::setprecision(2)
+              << std::setw(10) << result.update_time << std::endl;
+}
+
+int main()
+{
+    std::vector<float> angles(samples), ys(samples), xs(samples), squares(samples);
+    for (int i = 0; i < samples; i++)
+    {
+        angles[i] = -4.0f * PI_F + 8.0f * PI_F * i / samples;
+        ys[i] = 2.0f * std::sin(angles[i] * 0.37f);
+        xs[i] = 2.0f * std::cos(angles[i] * 0.37f);
+        squares[i] = 1e-4f + 100.0f * i / samples;
+    }
+    auto sin_reference = [&](int i) { return std::sin(static_cast<double>(angles[i])); };
+    auto cos_reference = [&](int i) { return std::cos(static_cast<double>(angles[i])); };
+    auto atan2_reference = [&](int i) { return std::atan2(static_cast<double>(ys[i]), static_cast<double>(xs[i])); };
+    auto sqrt_reference = [&](int i) { return std::sqrt(static_cast<double>(squares[i])); };
+
+    std::cout << std::left << std::setw(24) << "Function" << std::right << std::setw(12) << "Error" << std::setw(10) << "ns" << std::endl;
+
+    print_result("sin (double)", benchmark([&](int i) { return static_cast<float>(std::sin(static_cast<double>(angles[i]))); }, sin_reference, false));
+    print_result("sinf", benchmark([&](int i) { return sinf(angles[i]); }, sin_reference, false));
+    print_result("poly_sin", benchmark([&](int i) { return poly_sin(angles[i]); }, sin_reference, false));
+    print_result("table_sin", benchmark([&](int i) { return table_sin(angles[i]); }, sin_reference, false));
+    print_result("sin_q15", benchmark([&](int i) { return sin_q15(rad_to_bam(angles[i])) * (1.0f / 32768.0f); }, sin_reference, false));
+    std::cout << std::endl;
+
+    print_result("cosf", benchmark([&](int i) { return cosf(angles[i]); }, cos_reference, false));
+    print_result("poly_cos", benchmark([&](int i) { return poly_cos(angles[i]); }, cos_reference, false));
+    print_result("table_cos", benchmark([&](int i) { return table_cos(angles[i]); }, cos_reference, false));
+    std::cout << std::endl;
+
+    print_result("atan2 (double)", benchmark([&](int i) { return static_cast<float>(std::atan2(static_cast<double>(ys[i]), static_cast<double>(xs[i]))); }, atan2_reference, false));
+    print_result("atan2f", benchmark([&](int i) { return atan2f(ys[i], xs[i]); }, atan2_reference, false));
+    print_result("poly_atan2", benchmark([&](int i) { return poly_atan2(ys[i], xs[i]); }, atan2_reference, false));
+    print_result("table_atan2", benchmark([&](int i) { return table_atan2(ys[i], xs[i]); }, atan2_reference, false));
+    // The binary angle is wrapped to [-pi, pi) for the comparison
+    print_result("atan2_bam", benchmark([&](int i) { return bam_to_rad(static_cast<int16_t>(atan2_bam(static_cast<int32_t>(ys[i] * 1e6f), static_cast<int32_t>(xs[i] * 1e6f)))); },
+                                        atan2_reference, false));
+    std::cout << std::endl;
+
+    print_result("sqrtf", benchmark([&](int i) { return sqrtf(squares[i]); }, sqrt_reference, true));
+    print_result("poly_sqrt", benchmark([&](int i) { return poly_sqrt(squares[i]); }, sqrt_reference, true));
+    print_result("table_sqrt", benchmark([&](int i) { return table_sqrt(squares[i]); }, sqrt_reference, true));
+    // Against the square root of the quantized input, the result is the exact floor in Q16.16
+    print_result("sqrt_q16", benchmark([&](int i) { return sqrt_q16(static_cast<uint32_t>(squares[i] * 65536.0f)) * (1.0f / 65536.0f); },
+                                       [&](int i) { return std::sqrt(std::floor(static_cast<double>(squares[i]) * 65536.0) / 65536.0); }, true));
+
+    std::cout << std::endl;
+    std::cout << "On native the FPU has sqrt and libm is fast, so the gains are small or negative here." << std::endl;
+    std::cout << "Run env:fast_math_benchmark_esp32 for the numbers that matter, there double precision" << std::endl;
+    std::cout << "is emulated in software and the single precision functions are library calls." << std::endl;
+
+    return 0;
+}
@@ -1,6 +1,9 @@
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <matplotlibcpp.h>
+#include <roboost/utils/filter_chain.hpp>
+#include <roboost/utils/filter_design.hpp>
 #include <roboost/utils/filters.hpp>
 #include <vector>
 
@@ -48,26 +51,68 @@ int main()
         iir_output[i] = iir.update(noisy_signal[i]);
     }
 
+    // Wheel velocity ramping up to 10 rad/s with the vibration of 12 rollers on top,
+    // the vibration frequency moves with the wheel speed
+    constexpr int rollers = 12;
+    constexpr double vibration_amplitude = 0.5;
+    std::vector<double> wheel_velocity(N);
+    std::vector<double> vibrating_velocity(N);
+    double roller_phase = 0.0;
+    for (int i = 0; i < N; ++i)
+    {
+        wheel_velocity[i] = 10.0 * std::min(1.0, 2.0 * t[i]);
+        roller_phase += wheel_velocity[i] * rollers / fs;
+        vibrating_velocity[i] = wheel_velocity[i] + vibration_amplitude * sin(roller_phase);
+    }
+
+    // Fixed lowpass designed at compile time against a notch retuned to the wheel speed
+    constexpr auto butterworth_coefficients = roboost::filters::design_butterworth_lowpass<2>(1000.0, 5.0);
+    roboost::filters::SOSFilter<float, 2> butterworth(butterworth_coefficients);
+    roboost::filters::SOSFilter<float, 1> notch(roboost::filters::design_notch(fs, 1.0, 2.0));
+
+    // Notch followed by a mild lowpass for the remaining encoder noise
+    roboost::filters::FilterChain<roboost::filters::SOSFilter<float, 1>, roboost::filters::SOSFilter<float, 1>> notch_lowpass(
+        roboost::filters::SOSFilter<float, 1>(roboost::filters::design_notch(fs, 1.0, 2.0)), roboost::filters::SOSFilter<float, 1>(roboost::filters::design_butterworth_lowpass<1>(1000.0, 50.0)));
+
+    std::vector<double> butterworth_output(N);
+    std::vector<double> notch_output(N);
+    std::vector<double> notch_lowpass_output(N);
+    for (int i = 0; i < N; ++i)
+    {
+        double vibration_frequency = std::max(1.0, wheel_velocity[i] * rollers / (2 * M_PI));
+        notch.set_coefficients(roboost::filters::design_notch(fs, vibration_frequency, 2.0));
+        notch_lowpass.get<0>().set_coefficients(roboost::filters::design_notch(fs, vibration_frequency, 2.0));
+        butterworth_output[i] = butterworth.update(vibrating_velocity[i]);
+        notch_output[i] = notch.update(vibrating_velocity[i]);
+        notch_lowpass_output[i] = notch_lowpass.update(static_cast<float>(vibrating_velocity[i]));
+    }
+
     // Plotting the results
-    plt::figure_size(1200, 900); // Set figure size
-    plt::subplot(3, 1, 1);
+    plt::figure_size(1200, 1200); // Set figure size
+    plt::subplot(4, 1, 1);
     plt::plot(t, noisy_signal, {{"label", "Noisy Signal"}});
     plt::title("Noisy Signal");
     plt::legend();
 
-    plt::subplot(3, 1, 2);
+    plt::subplot(4, 1, 2);
     plt::plot(t, lp_output, {{"label", "Low Pass Filter"}});
     plt::plot(t, ema_output, {{"label", "Exponential Moving Average"}});
     plt::plot(t, ma_output, {{"label", "Moving Average Filter"}});
     plt::title("Filtered Signals");
     plt::legend();
 
-    plt::subplot(3, 1, 3);
+    plt::subplot(4, 1, 3);
     plt::plot(t, iir_output, {{"label", "IIR Filter"}});
     plt::title("IIR Filter Output");
     plt::legend();
 
-    // TODO: add more
+    plt::subplot(4, 1, 4);
+    plt::plot(t, vibrating_velocity, {{"label", "Wheel Velocity with Roller Vibration"}});
+    plt::plot(t, butterworth_output, {{"label", "Butterworth Lowpass 5 Hz"}});
+    plt::plot(t, notch_output, {{"label", "Notch at Roller Frequency"}});
+    plt::plot(t, notch_lowpass_output, {{"label", "Notch + Butterworth Lowpass 50 Hz"}});
+    plt::title("Roller Vibration");
+    plt::legend();
 
     plt::show();
 
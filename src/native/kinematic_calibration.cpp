@@ -0,0 +1,540 @@
+// Calibration of the effective wheel radii and geometry of the mecanum drive
+// from logged wheel encoder data and ground truth poses.
+//
+// Usage:
+//   kinematic_calibration <log.csv> [fragment.h]   calibrate, print or write a conf_hardware.h fragment
+//   kinematic_calibration --generate <log.csv>      write a synthetic log with known parameters
+//
+// Log format, one header line followed by rows of
+//   time, wheel0, wheel1, wheel2, wheel3, x, y, theta
+// time in s, wheel positions as accumulated angles in rad (wheel order and
+// signs as in MecanumKinematics4W), ground truth pose in m and rad. Rows
+// without ground truth leave x, y and theta empty, e.g. when driving a known
+// square path and only the corners are known.
+//
+// The log is cut into segments between ground truth poses at least
+// SEGMENT_DURATION apart. For every segment the odometry is integrated from
+// the ground truth start pose and compared with the ground truth end pose. The
+// parameters (four wheel radii and k = (WHEEL_BASE + TRACK_WIDTH) / 2) are
+// fitted with Levenberg-Marquardt. Their derivatives are propagated along with
+// the odometry, so each iteration is a single pass over the data with one
+// sin/cos per sample, and hours of data at 100 Hz take well below a second.
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <conf_hardware.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+constexpr size_t WHEEL_COUNT = 4;
+constexpr size_t PARAMETER_COUNT = WHEEL_COUNT + 1; // radii and k
+
+constexpr double SEGMENT_DURATION = 1.0; // Minimum segment length in s
+constexpr int MAX_ITERATIONS = 50;
+
+// Signs of vx and vy in the wheel velocities, same convention as MecanumKinematics4W
+constexpr double SIGN_X[WHEEL_COUNT] = {1.0, -1.0, 1.0, -1.0};
+constexpr double SIGN_Y[WHEEL_COUNT] = {-1.0, -1.0, 1.0, 1.0};
+
+using Parameters = std::array<double, PARAMETER_COUNT>;
+
+// Structure of arrays, one entry per row
+struct Log
+{
+    std::vector<double> time;
+    std::vector<double> wheel[WHEEL_COUNT];
+    std::vector<double> x, y, theta;
+    std::vector<bool> has_pose;
+
+    size_t size() const { return time.size(); }
+};
+
+struct Segment
+{
+    size_t begin;
+    size_t end;
+};
+
+struct Normals
+{
+    double jtj[PARAMETER_COUNT][PARAMETER_COUNT];
+    double jtr[PARAMETER_COUNT];
+    double position_error_squared;
+    double heading_error_squared;
+    double cost;
+};
+
+double wrap(double angle) { return std::remainder(angle, 2.0 * M_PI); }
+
+// Parses one field and advances past the following comma, NAN if empty
+double parse_field(const char*& cursor)
+{
+    while (*cursor == ' ' || *cursor == '\t')
+    {
+        cursor++;
+    }
+    char* end;
+    double value = std::strtod(cursor, &end);
+    if (end == cursor)
+    {
+        value = NAN;
+    }
+    cursor = end;
+    while (*cursor != ',' && *cursor != '\n' && *cursor != '\0')
+    {
+        cursor++;
+    }
+    if (*cursor == ',')
+    {
+        cursor++;
+    }
+    return value;
+}
+
+bool read_log(const std::string& filename, Log& log)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cerr << "Error opening file: " << filename << std::endl;
+        return false;
+    }
+
+    // Read everything at once, line by line parsing with streams is the bottleneck for large logs
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    const char* cursor = std::strchr(content.c_str(), '\n'); // Skip the header line
+    if (cursor == nullptr)
+    {
+        std::cerr << "Empty log: " << filename << std::endl;
+        return false;
+    }
+
+    while (*cursor != '\0')
+    {
+        cursor++;
+        if (*cursor == '\0' || *cursor == '\n' || *cursor == '\r')
+        {
+            continue;
+        }
+
+        double fields[8];
+        for (double& field : fields)
+        {
+            field = parse_field(cursor);
+        }
+        while (*cursor != '\n' && *cursor != '\0')
+        {
+            cursor++;
+        }
+
+        if (std::isnan(fields[0]) || std::isnan(fields[1]) || std::isnan(fields[2]) || std::isnan(fields[3]) || std::isnan(fields[4]))
+        {
+            continue;
+        }
+        log.time.push_back(fields[0]);
+        for (size_t i = 0; i < WHEEL_COUNT; i++)
+        {
+            log.wheel[i].push_back(fields[1 + i]);
+        }
+        const bool has_pose = !std::isnan(fields[5]) && !std::isnan(fields[6]) && !std::isnan(fields[7]);
+        log.x.push_back(fields[5]);
+        log.y.push_back(fields[6]);
+        log.theta.push_back(fields[7]);
+        log.has_pose.push_back(has_pose);
+    }
+    return true;
+}
+
+std::vector<Segment> make_segments(const Log& log)
+{
+    std::vector<Segment> segments;
+    size_t begin = log.size();
+    for (size_t n = 0; n < log.size(); n++)
+    {
+        if (!log.has_pose[n])
+        {
+            continue;
+        }
+        if (begin == log.size())
+        {
+            begin = n;
+        }
+        else if (log.time[n] - log.time[begin] >= SEGMENT_DURATION)
+        {
+            segments.push_back({begin, n});
+            begin = n;
+        }
+    }
+    return segments;
+}
+
+// Integrates the odometry of every segment and accumulates the normal equations of the residuals
+void evaluate(const Log& log, const std::vector<Segment>& segments, const Parameters& p, double heading_weight, Normals& normals)
+{
+    std::memset(&normals, 0, sizeof(normals));
+    const double k = p[WHEEL_COUNT];
+
+    for (const Segment& segment : segments)
+    {
+        double x = log.x[segment.begin], y = log.y[segment.begin], theta = log.theta[segment.begin];
+        double dx_p[PARAMETER_COUNT] = {}, dy_p[PARAMETER_COUNT] = {}, dtheta_p[PARAMETER_COUNT] = {};
+
+        for (size_t n = segment.begin; n < segment.end; n++)
+        {
+            // Body frame displacement and its derivatives
+            double u[WHEEL_COUNT];
+            double forward = 0.0, lateral = 0.0, rolling = 0.0;
+            for (size_t i = 0; i < WHEEL_COUNT; i++)
+            {
+                u[i] = 0.25 * (log.wheel[i][n + 1] - log.wheel[i][n]);
+                forward += p[i] * SIGN_X[i] * u[i];
+                lateral += p[i] * SIGN_Y[i] * u[i];
+                rolling += p[i] * u[i];
+            }
+            const double rotation = -rolling / k;
+
+            double rotation_p[PARAMETER_COUNT];
+            for (size_t i = 0; i < WHEEL_COUNT; i++)
+            {
+                rotation_p[i] = -u[i] / k;
+            }
+            rotation_p[WHEEL_COUNT] = rolling / (k * k);
+
+            // Midpoint heading
+            const double phi = theta + 0.5 * rotation;
+            const double c = std::cos(phi);
+            const double s = std::sin(phi);
+            const double x_phi = -s * forward - c * lateral;
+            const double y_phi = c * forward - s * lateral;
+
+            for (size_t j = 0; j < PARAMETER_COUNT; j++)
+            {
+                const double forward_p = j < WHEEL_COUNT ? SIGN_X[j] * u[j] : 0.0;
+                const double lateral_p = j < WHEEL_COUNT ? SIGN_Y[j] * u[j] : 0.0;
+                const double phi_p = dtheta_p[j] + 0.5 * rotation_p[j];
+                dx_p[j] += c * forward_p - s * lateral_p + x_phi * phi_p;
+                dy_p[j] += s * forward_p + c * lateral_p + y_phi * phi_p;
+                dtheta_p[j] += rotation_p[j];
+            }
+
+            x += c * forward - s * lateral;
+            y += s * forward + c * lateral;
+            theta += rotation;
+        }
+
+        const double residual[3] = {x - log.x[segment.end], y - log.y[segment.end], heading_weight * wrap(theta - log.theta[segment.end])};
+        const double* jacobian[3] = {dx_p, dy_p, dtheta_p};
+        for (size_t r = 0; r < 3; r++)
+        {
+            const double weight = r == 2 ? heading_weight : 1.0;
+            for (size_t a = 0; a < PARAMETER_COUNT; a++)
+            {
+                normals.jtr[a] += weight * jacobian[r][a] * residual[r];
+                for (size_t b = 0; b < PARAMETER_COUNT; b++)
+                {
+                    normals.jtj[a][b] += weight * weight * jacobian[r][a] * jacobian[r][b];
+                }
+            }
+            normals.cost += residual[r] * residual[r];
+        }
+        normals.position_error_squared += residual[0] * residual[0] + residual[1] * residual[1];
+        normals.heading_error_squared += residual[2] * residual[2] / (heading_weight * heading_weight);
+    }
+}
+
+// Gauss-Jordan inversion with partial pivoting, returns false if singular
+bool invert(const double (&m)[PARAMETER_COUNT][PARAMETER_COUNT], double (&inverse)[PARAMETER_COUNT][PARAMETER_COUNT])
+{
+    double a[PARAMETER_COUNT][2 * PARAMETER_COUNT];
+    for (size_t r = 0; r < PARAMETER_COUNT; r++)
+    {
+        for (size_t c = 0; c < PARAMETER_COUNT; c++)
+        {
+            a[r][c] = m[r][c];
+            a[r][PARAMETER_COUNT + c] = r == c ? 1.0 : 0.0;
+        }
+    }
+
+    for (size_t col = 0; col < PARAMETER_COUNT; col++)
+    {
+        size_t pivot = col;
+        for (size_t r = col + 1; r < PARAMETER_COUNT; r++)
+        {
+            if (std::fabs(a[r][col]) > std::fabs(a[pivot][col]))
+            {
+                pivot = r;
+            }
+        }
+        if (std::fabs(a[pivot][col]) < 1e-300)
+        {
+            return false;
+        }
+        std::swap(a[pivot], a[col]);
+
+        const double scale = 1.0 / a[col][col];
+        for (double& value : a[col])
+        {
+            value *= scale;
+        }
+        for (size_t r = 0; r < PARAMETER_COUNT; r++)
+        {
+            if (r == col)
+            {
+                continue;
+            }
+            const double factor = a[r][col];
+            for (size_t c = 0; c < 2 * PARAMETER_COUNT; c++)
+            {
+                a[r][c] -= factor * a[col][c];
+            }
+        }
+    }
+
+    for (size_t r = 0; r < PARAMETER_COUNT; r++)
+    {
+        for (size_t c = 0; c < PARAMETER_COUNT; c++)
+        {
+            inverse[r][c] = a[r][PARAMETER_COUNT + c];
+        }
+    }
+    return true;
+}
+
+// Levenberg-Marquardt, returns the number of iterations
+int calibrate(const Log& log, const std::vector<Segment>& segments, double heading_weight, Parameters& p, Normals& normals)
+{
+    double lambda = 1e-3;
+    evaluate(log, segments, p, heading_weight, normals);
+
+    int iteration = 0;
+    for (; iteration < MAX_ITERATIONS; iteration++)
+    {
+        double damped[PARAMETER_COUNT][PARAMETER_COUNT];
+        double inverse[PARAMETER_COUNT][PARAMETER_COUNT];
+        for (size_t a = 0; a < PARAMETER_COUNT; a++)
+        {
+            for (size_t b = 0; b < PARAMETER_COUNT; b++)
+            {
+                damped[a][b] = normals.jtj[a][b];
+            }
+            damped[a][a] *= 1.0 + lambda;
+        }
+        if (!invert(damped, inverse))
+        {
+            std::cerr << "Normal equations are singular, the log does not excite all parameters" << std::endl;
+            break;
+        }
+
+        Parameters candidate = p;
+        double step_norm = 0.0;
+        for (size_t a = 0; a < PARAMETER_COUNT; a++)
+        {
+            double step = 0.0;
+            for (size_t b = 0; b < PARAMETER_COUNT; b++)
+            {
+                step -= inverse[a][b] * normals.jtr[b];
+            }
+            candidate[a] += step;
+            step_norm += (step / p[a]) * (step / p[a]);
+        }
+
+        Normals candidate_normals;
+        evaluate(log, segments, candidate, heading_weight, candidate_normals);
+        if (candidate_normals.cost < normals.cost)
+        {
+            p = candidate;
+            normals = candidate_normals;
+            lambda = std::fmax(lambda * 0.3, 1e-9);
+            if (std::sqrt(step_norm) < 1e-9)
+            {
+                break;
+            }
+        }
+        else
+        {
+            lambda *= 10.0;
+            if (lambda > 1e9)
+            {
+                break;
+            }
+        }
+    }
+    return iteration;
+}
+
+// Synthetic log of a robot driving smooth random twists, tracked by motion capture
+bool generate_log(const std::string& filename)
+{
+    const Parameters truth = {0.0605, 0.0598, 0.0611, 0.0594, 0.352};
+    constexpr double duration = 3600.0; // s
+    constexpr double dt = 0.01;         // s
+    constexpr double position_noise = 0.001;
+    constexpr double heading_noise = 0.003;
+
+    std::ofstream file(filename);
+    if (!file.is_open())
+    {
+        std::cerr << "Error opening file: " << filename << std::endl;
+        return false;
+    }
+
+    std::mt19937 rng(42);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    std::array<double, 3> twist = {0.0, 0.0, 0.0};
+    std::array<double, 3> target = {0.0, 0.0, 0.0};
+    std::array<double, WHEEL_COUNT> wheel = {};
+    double x = 0.0, y = 0.0, theta = 0.0;
+    char line[256];
+
+    file << "time,wheel0,wheel1,wheel2,wheel3,x,y,theta\n";
+    const long steps = static_cast<long>(duration / dt);
+    for (long n = 0; n <= steps; n++)
+    {
+        std::snprintf(line, sizeof(line), "%.3f,%.6f,%.6f,%.6f,%.6f,%.5f,%.5f,%.5f\n", n * dt, wheel[0], wheel[1], wheel[2], wheel[3], x + position_noise * normal(rng), y + position_noise * normal(rng),
+                      wrap(theta + heading_noise * normal(rng)));
+        file << line;
+
+        // New target twist every 2 s, approached with a first order lag
+        if (n % 200 == 0)
+        {
+            target = {0.4 * normal(rng), 0.3 * normal(rng), 1.0 * normal(rng)};
+        }
+        for (size_t a = 0; a < 3; a++)
+        {
+            twist[a] += (target[a] - twist[a]) * dt / 0.3;
+        }
+
+        // Exact integration over the step with constant body twist
+        const double k = truth[WHEEL_COUNT];
+        const double vx = twist[0], vy = twist[1], omega = twist[2];
+        const double wheel_velocity[WHEEL_COUNT] = {vx - vy - k * omega, -(vx + vy + k * omega), vx + vy - k * omega, -(vx - vy + k * omega)};
+        for (size_t i = 0; i < WHEEL_COUNT; i++)
+        {
+            wheel[i] += wheel_velocity[i] / truth[i] * dt;
+        }
+        const double phi = theta + 0.5 * omega * dt;
+        x += (std::cos(phi) * vx - std::sin(phi) * vy) * dt;
+        y += (std::sin(phi) * vx + std::cos(phi) * vy) * dt;
+        theta += omega * dt;
+    }
+
+    std::cout << "Wrote " << steps + 1 << " rows to " << filename << std::endl;
+    std::cout << "True radii " << truth[0] << ", " << truth[1] << ", " << truth[2] << ", " << truth[3] << " m, k " << truth[WHEEL_COUNT] << " m" << std::endl;
+    return true;
+}
+
+void write_fragment(std::ostream& out, const std::string& source, const Parameters& p, const Parameters& deviation, size_t segment_count, double rms_position, double rms_heading)
+{
+    double mean_radius = 0.0;
+    for (size_t i = 0; i < WHEEL_COUNT; i++)
+    {
+        mean_radius += p[i] / WHEEL_COUNT;
+    }
+
+    // Only the sum of wheel base and track width is observable, the measured ratio is kept
+    const double scale = 2.0 * p[WHEEL_COUNT] / (WHEEL_BASE + TRACK_WIDTH);
+
+    char buffer[512];
+    out << "// Generated by kinematic_calibration from " << source << "\n";
+    std::snprintf(buffer, sizeof(buffer), "// %zu segments, RMS position error %.4f m, RMS heading error %.4f rad\n", segment_count, rms_position, rms_heading);
+    out << buffer;
+    std::snprintf(buffer, sizeof(buffer), "const float WHEEL_RADIUS = %.5f; // mean effective radius of wheels\n", mean_radius);
+    out << buffer;
+    std::snprintf(buffer, sizeof(buffer), "const float WHEEL_BASE = %.5f;   // distance between wheel contact point in x direction\n", WHEEL_BASE * scale);
+    out << buffer;
+    std::snprintf(buffer, sizeof(buffer), "const float TRACK_WIDTH = %.5f;  // distance between wheel contact point in y direction\n", TRACK_WIDTH * scale);
+    out << buffer;
+    std::snprintf(buffer, sizeof(buffer), "const float WHEEL_RADII[4] = {%.5f, %.5f, %.5f, %.5f}; // effective radius of every wheel, +-%.5f\n", p[0], p[1], p[2], p[3],
+                  std::fmax(std::fmax(deviation[0], deviation[1]), std::fmax(deviation[2], deviation[3])));
+    out << buffer;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc >= 3 && std::string(argv[1]) == "--generate")
+    {
+        return generate_log(argv[2]) ? 0 : 1;
+    }
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <log.csv> [fragment.h]" << std::endl;
+        std::cerr << "       " << argv[0] << " --generate <log.csv>" << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    Log log;
+    if (!read_log(argv[1], log))
+    {
+        return 1;
+    }
+    const std::vector<Segment> segments = make_segments(log);
+    const double read_time = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    std::cout << "Read " << log.size() << " rows, " << segments.size() << " segments in " << read_time << " s" << std::endl;
+    if (segments.size() < PARAMETER_COUNT)
+    {
+        std::cerr << "Not enough segments with ground truth poses" << std::endl;
+        return 1;
+    }
+
+    // Initial guess from the hand measured values
+    Parameters p;
+    for (size_t i = 0; i < WHEEL_COUNT; i++)
+    {
+        p[i] = WHEEL_RADIUS;
+    }
+    p[WHEEL_COUNT] = 0.5 * (WHEEL_BASE + TRACK_WIDTH);
+    const double heading_weight = p[WHEEL_COUNT]; // Heading errors weighted like the displacement of a wheel
+
+    start = std::chrono::high_resolution_clock::now();
+    Normals normals;
+    const int iterations = calibrate(log, segments, heading_weight, p, normals);
+    const double solve_time = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    // Standard deviations from the residual variance and the inverse normal matrix
+    Parameters deviation = {};
+    double covariance[PARAMETER_COUNT][PARAMETER_COUNT];
+    const size_t residual_count = 3 * segments.size();
+    if (invert(normals.jtj, covariance))
+    {
+        const double variance = normals.cost / (residual_count - PARAMETER_COUNT);
+        for (size_t a = 0; a < PARAMETER_COUNT; a++)
+        {
+            deviation[a] = std::sqrt(variance * covariance[a][a]);
+        }
+    }
+    const double rms_position = std::sqrt(normals.position_error_squared / segments.size());
+    const double rms_heading = std::sqrt(normals.heading_error_squared / segments.size());
+
+    std::cout << "Solved in " << iterations << " iterations, " << solve_time << " s" << std::endl;
+    for (size_t i = 0; i < WHEEL_COUNT; i++)
+    {
+        std::cout << "Wheel " << i << " radius: " << p[i] << " m (+-" << deviation[i] << ")" << std::endl;
+    }
+    std::cout << "k = (WHEEL_BASE + TRACK_WIDTH) / 2: " << p[WHEEL_COUNT] << " m (+-" << deviation[WHEEL_COUNT] << ")" << std::endl;
+    std::cout << "RMS segment error: " << rms_position << " m, " << rms_heading << " rad" << std::endl << std::endl;
+
+    if (argc >= 3)
+    {
+        std::ofstream out(argv[2]);
+        if (!out.is_open())
+        {
+            std::cerr << "Error opening file: " << argv[2] << std::endl;
+            return 1;
+        }
+        write_fragment(out, argv[1], p, deviation, segments.size(), rms_position, rms_heading);
+        std::cout << "Wrote " << argv[2] << std::endl;
+    }
+    else
+    {
+        write_fragment(std::cout, argv[1], p, deviation, segments.size(), rms_position, rms_heading);
+    }
+    return 0;
+}
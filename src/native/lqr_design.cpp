@@ -0,0 +1,468 @@
+// Offline design of the LQR velocity controllers for the identified motor
+// model, see include/roboost/utils/lqr_controller.hpp.
+//
+// Usage:
+//   lqr_design [--chassis] [options] [fragment.h]   print or write a conf_lqr.h fragment
+//
+// Options:
+//   --gain K             motor gain in rad/s at full duty (MOTOR_MODEL_GAIN)
+//   --time-constant tau  motor time constant in s (MOTOR_MODEL_TIME_CONSTANT)
+//   --period T           control period in s (CONTROL_PERIOD_MS)
+//   --q-velocity q       weight of the wheel velocity
+//   --q-integral q       weight of the integrated tracking error
+//   --r r                weight of the duty
+//
+// The motor is the first order model from system_analyzer, sampled with a
+// zero-order hold: w[k+1] = a w[k] + b u[k] with a = exp(-T / tau) and
+// b = K (1 - a). The state is augmented with the integral of the tracking
+// error, z[k+1] = z[k] + T (r - C w[k]).
+//
+// Wheel: one wheel velocity, tracked by itself. The controller replaces the
+// PIDController of each VelocityController.
+// Chassis: the four wheel velocities, tracking the robot velocity (vx, vy,
+// omega) through the forward kinematics. The integrators act on the motion of
+// the chassis instead of on every wheel, so wheels that disagree are not
+// pushed against each other.
+//
+// The discrete algebraic Riccati equation is solved by iteration, the closed
+// loop is checked by simulating a step on the nominal model.
+
+#include <cmath>
+#include <conf_hardware.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+constexpr size_t WHEEL_COUNT = 4;
+constexpr int MAX_ITERATIONS = 100000;
+constexpr double TOLERANCE = 1e-12;
+
+// Signs of vx, vy and omega in the wheel velocities, same convention as MecanumKinematics4W
+constexpr double SIGN_X[WHEEL_COUNT] = {1.0, -1.0, 1.0, -1.0};
+constexpr double SIGN_Y[WHEEL_COUNT] = {-1.0, -1.0, 1.0, 1.0};
+constexpr double SIGN_OMEGA[WHEEL_COUNT] = {-1.0, -1.0, -1.0, -1.0};
+
+// Dense row-major matrix, the largest one is 7x7
+struct Matrix
+{
+    size_t rows;
+    size_t cols;
+    std::vector<double> data;
+
+    Matrix(size_t rows, size_t cols) : rows(rows), cols(cols), data(rows * cols, 0.0) {}
+
+    double& operator()(size_t r, size_t c) { return data[r * cols + c]; }
+    double operator()(size_t r, size_t c) const { return data[r * cols + c]; }
+};
+
+Matrix multiply(const Matrix& a, const Matrix& b)
+{
+    Matrix m(a.rows, b.cols);
+    for (size_t r = 0; r < a.rows; r++)
+    {
+        for (size_t k = 0; k < a.cols; k++)
+        {
+            for (size_t c = 0; c < b.cols; c++)
+            {
+                m(r, c) += a(r, k) * b(k, c);
+            }
+        }
+    }
+    return m;
+}
+
+Matrix transpose(const Matrix& a)
+{
+    Matrix m(a.cols, a.rows);
+    for (size_t r = 0; r < a.rows; r++)
+    {
+        for (size_t c = 0; c < a.cols; c++)
+        {
+            m(c, r) = a(r, c);
+        }
+    }
+    return m;
+}
+
+Matrix add(const Matrix& a, const Matrix& b, double scale = 1.0)
+{
+    Matrix m = a;
+    for (size_t i = 0; i < m.data.size(); i++)
+    {
+        m.data[i] += scale * b.data[i];
+    }
+    return m;
+}
+
+// Solves a x = b by Gauss-Jordan elimination with partial pivoting
+Matrix solve(Matrix a, Matrix b)
+{
+    const size_t n = a.rows;
+    for (size_t col = 0; col < n; col++)
+    {
+        size_t pivot = col;
+        for (size_t r = col + 1; r < n; r++)
+        {
+            if (std::fabs(a(r, col)) > std::fabs(a(pivot, col)))
+            {
+                pivot = r;
+            }
+        }
+        for (size_t c = 0; c < n; c++)
+        {
+            std::swap(a(col, c), a(pivot, c));
+        }
+        for (size_t c = 0; c < b.cols; c++)
+        {
+            std::swap(b(col, c), b(pivot, c));
+        }
+        for (size_t r = 0; r < n; r++)
+        {
+            if (r == col)
+            {
+                continue;
+            }
+            const double factor = a(r, col) / a(col, col);
+            for (size_t c = 0; c < n; c++)
+            {
+                a(r, c) -= factor * a(col, c);
+            }
+            for (size_t c = 0; c < b.cols; c++)
+            {
+                b(r, c) -= factor * b(col, c);
+            }
+        }
+    }
+    for (size_t r = 0; r < n; r++)
+    {
+        for (size_t c = 0; c < b.cols; c++)
+        {
+            b(r, c) /= a(r, r);
+        }
+    }
+    return b;
+}
+
+struct Design
+{
+    double gain;
+    double time_constant;
+    double period;
+    double q_velocity;
+    double q_integral;
+    double r;
+    bool chassis;
+};
+
+struct Gains
+{
+    Matrix kx; // Inputs x States
+    Matrix ki; // Inputs x References
+    Matrix kr; // Inputs x References
+    Matrix c;  // References x States
+    int iterations;
+};
+
+// Steady state K = (R + B^T P B)^-1 B^T P A of the Riccati iteration
+Gains design_lqr(const Design& design)
+{
+    const size_t states = design.chassis ? WHEEL_COUNT : 1;
+    const size_t inputs = states;
+    const size_t references = design.chassis ? 3 : 1;
+    const size_t n = states + references;
+
+    const double a = std::exp(-design.period / design.time_constant);
+    const double b = design.gain * (1.0 - a);
+
+    Matrix c(references, states);
+    if (design.chassis)
+    {
+        // Forward kinematics, the least squares robot velocity of the wheel velocities
+        const double k = 0.5 * (WHEEL_BASE + TRACK_WIDTH);
+        for (size_t i = 0; i < WHEEL_COUNT; i++)
+        {
+            c(0, i) = WHEEL_RADIUS * SIGN_X[i] / WHEEL_COUNT;
+            c(1, i) = WHEEL_RADIUS * SIGN_Y[i] / WHEEL_COUNT;
+            c(2, i) = WHEEL_RADIUS * SIGN_OMEGA[i] / (WHEEL_COUNT * k);
+        }
+    }
+    else
+    {
+        c(0, 0) = 1.0;
+    }
+
+    // Augmented system [w; z]
+    Matrix A(n, n), B(n, inputs), Q(n, n), R(inputs, inputs);
+    for (size_t i = 0; i < states; i++)
+    {
+        A(i, i) = a;
+        B(i, i) = b;
+        Q(i, i) = design.q_velocity;
+        R(i, i) = design.r;
+    }
+    for (size_t j = 0; j < references; j++)
+    {
+        A(states + j, states + j) = 1.0;
+        for (size_t i = 0; i < states; i++)
+        {
+            A(states + j, i) = -design.period * c(j, i);
+        }
+        Q(states + j, states + j) = design.q_integral;
+    }
+    if (design.chassis)
+    {
+        // Same weight for an integrated wheel angle as for the chassis motion that turns all wheels by it
+        for (size_t j = 0; j < references; j++)
+        {
+            double norm = 0.0;
+            for (size_t i = 0; i < states; i++)
+            {
+                norm += c(j, i) * c(j, i);
+            }
+            Q(states + j, states + j) = design.q_integral / norm;
+        }
+    }
+
+    const Matrix At = transpose(A);
+    const Matrix Bt = transpose(B);
+    Matrix P = Q;
+    Matrix K(inputs, n);
+    int iteration = 0;
+    for (; iteration < MAX_ITERATIONS; iteration++)
+    {
+        const Matrix PA = multiply(P, A);
+        const Matrix PB = multiply(P, B);
+        K = solve(add(R, multiply(Bt, PB)), multiply(Bt, PA));
+        const Matrix next = add(add(Q, multiply(At, PA)), multiply(multiply(At, PB), K), -1.0);
+
+        double change = 0.0, size = 0.0;
+        for (size_t i = 0; i < P.data.size(); i++)
+        {
+            change = std::fmax(change, std::fabs(next.data[i] - P.data[i]));
+            size = std::fmax(size, std::fabs(next.data[i]));
+        }
+        P = next;
+        if (change <= TOLERANCE * size)
+        {
+            break;
+        }
+    }
+
+    Gains gains{Matrix(inputs, states), Matrix(inputs, references), Matrix(inputs, references), c, iteration};
+    for (size_t i = 0; i < inputs; i++)
+    {
+        for (size_t j = 0; j < states; j++)
+        {
+            gains.kx(i, j) = K(i, j);
+        }
+        for (size_t j = 0; j < references; j++)
+        {
+            gains.ki(i, j) = K(i, states + j);
+        }
+    }
+
+    // Steady state for a reference: wheel velocities Nx = C^T (C C^T)^-1, duty Nu = Nx (1 - a) / b
+    const Matrix nx = transpose(solve(multiply(c, transpose(c)), c));
+    gains.kr = add(multiply(gains.kx, nx), nx, (1.0 - a) / b);
+    return gains;
+}
+
+struct StepResponse
+{
+    double rise_time;   // s to 90 %
+    double overshoot;   // fraction of the step
+    double peak_duty;   // largest duty
+    double final_error; // fraction of the step after 2 s
+};
+
+// Unit step of the first reference on the nominal model
+StepResponse simulate_step(const Design& design, const Gains& gains)
+{
+    const size_t states = gains.kx.cols;
+    const size_t inputs = gains.kx.rows;
+    const size_t references = gains.c.rows;
+    const double a = std::exp(-design.period / design.time_constant);
+    const double b = design.gain * (1.0 - a);
+    // 1 rad/s for a wheel, 0.2 m/s forward for the chassis
+    const double step = design.chassis ? 0.2 : 1.0;
+
+    std::vector<double> w(states, 0.0), z(references, 0.0), r(references, 0.0), u(inputs, 0.0);
+    r[0] = step;
+    StepResponse result{0.0, 0.0, 0.0, 0.0};
+    double t90 = -1.0, peak = 0.0, y = 0.0;
+    const int steps = static_cast<int>(2.0 / design.period);
+    for (int k = 0; k < steps; k++)
+    {
+        for (size_t i = 0; i < inputs; i++)
+        {
+            u[i] = 0.0;
+            for (size_t j = 0; j < references; j++)
+            {
+                u[i] += gains.kr(i, j) * r[j] - gains.ki(i, j) * z[j];
+            }
+            for (size_t j = 0; j < states; j++)
+            {
+                u[i] -= gains.kx(i, j) * w[j];
+            }
+            result.peak_duty = std::fmax(result.peak_duty, std::fabs(u[i]));
+        }
+        for (size_t j = 0; j < references; j++)
+        {
+            double output = 0.0;
+            for (size_t i = 0; i < states; i++)
+            {
+                output += gains.c(j, i) * w[i];
+            }
+            z[j] += design.period * (r[j] - output);
+        }
+        for (size_t i = 0; i < states; i++)
+        {
+            w[i] = a * w[i] + b * u[i];
+        }
+
+        y = 0.0;
+        for (size_t i = 0; i < states; i++)
+        {
+            y += gains.c(0, i) * w[i];
+        }
+        const double t = (k + 1) * design.period;
+        if (t90 < 0.0 && y >= 0.9 * step)
+        {
+            t90 = t;
+        }
+        peak = std::fmax(peak, y);
+    }
+    result.rise_time = t90;
+    result.overshoot = std::fmax(0.0, peak / step - 1.0);
+    result.final_error = std::fabs(step - y) / step;
+    return result;
+}
+
+void write_matrix(std::ostream& out, const char* name, const Matrix& m)
+{
+    char buffer[64];
+    out << "constexpr float " << name << "[" << m.rows << "][" << m.cols << "] = {";
+    for (size_t r = 0; r < m.rows; r++)
+    {
+        out << (r == 0 ? "{" : ", {");
+        for (size_t c = 0; c < m.cols; c++)
+        {
+            std::snprintf(buffer, sizeof(buffer), "%s%.7g", c == 0 ? "" : ", ", m(r, c));
+            out << buffer;
+        }
+        out << "}";
+    }
+    out << "};\n";
+}
+
+void write_fragment(std::ostream& out, const Design& design, const Gains& gains, const StepResponse& response)
+{
+    char buffer[256];
+    out << "// Generated by src/native/lqr_design.cpp, " << (design.chassis ? "chassis" : "wheel") << " model\n";
+    std::snprintf(buffer, sizeof(buffer), "// Model: gain %.3f rad/s, time constant %.4f s, period %.4f s\n", design.gain, design.time_constant, design.period);
+    out << buffer;
+    std::snprintf(buffer, sizeof(buffer), "// Weights: velocity %g, integral %g, duty %g\n", design.q_velocity, design.q_integral, design.r);
+    out << buffer;
+    std::snprintf(buffer, sizeof(buffer), "// Step: rise time %.3f s, overshoot %.1f %%, peak duty %.3f\n", response.rise_time, 100.0 * response.overshoot, response.peak_duty);
+    out << buffer;
+    const char* prefix = design.chassis ? "LQR_CHASSIS" : "LQR_WHEEL";
+    out << "constexpr size_t " << prefix << "_STATES = " << gains.kx.cols << ";\n";
+    out << "constexpr size_t " << prefix << "_INPUTS = " << gains.kx.rows << ";\n";
+    out << "constexpr size_t " << prefix << "_REFERENCES = " << gains.c.rows << ";\n";
+    std::snprintf(buffer, sizeof(buffer), "constexpr float %s_SAMPLE_TIME = %.6g; // s\n", prefix, design.period);
+    out << buffer;
+    write_matrix(out, (std::string(prefix) + "_KX").c_str(), gains.kx);
+    write_matrix(out, (std::string(prefix) + "_KI").c_str(), gains.ki);
+    write_matrix(out, (std::string(prefix) + "_KR").c_str(), gains.kr);
+    write_matrix(out, (std::string(prefix) + "_C").c_str(), gains.c);
+}
+
+int main(int argc, char** argv)
+{
+    Design design{MOTOR_MODEL_GAIN, MOTOR_MODEL_TIME_CONSTANT, CONTROL_PERIOD_MS * 1e-3, 1.0, 20.0, 40.0, false};
+    const char* output = nullptr;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--chassis") == 0)
+        {
+            design.chassis = true;
+        }
+        else if (std::strcmp(argv[i], "--gain") == 0 && has_value)
+        {
+            design.gain = std::atof(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--time-constant") == 0 && has_value)
+        {
+            design.time_constant = std::atof(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--period") == 0 && has_value)
+        {
+            design.period = std::atof(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--q-velocity") == 0 && has_value)
+        {
+            design.q_velocity = std::atof(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--q-integral") == 0 && has_value)
+        {
+            design.q_integral = std::atof(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--r") == 0 && has_value)
+        {
+            design.r = std::atof(argv[++i]);
+        }
+        else if (argv[i][0] != '-' && output == nullptr)
+        {
+            output = argv[i];
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--chassis] [--gain K] [--time-constant tau] [--period T] [--q-velocity q] [--q-integral q] [--r r] [fragment.h]" << std::endl;
+            return 1;
+        }
+    }
+
+    if (design.gain <= 0.0 || design.time_constant <= 0.0 || design.period <= 0.0 || design.r <= 0.0)
+    {
+        std::cerr << "Gain, time constant, period and duty weight must be positive" << std::endl;
+        return 1;
+    }
+
+    const Gains gains = design_lqr(design);
+    if (gains.iterations >= MAX_ITERATIONS)
+    {
+        std::cerr << "The Riccati iteration did not converge" << std::endl;
+        return 1;
+    }
+    const StepResponse response = simulate_step(design, gains);
+    std::cerr << "Riccati iteration converged after " << gains.iterations << " iterations" << std::endl;
+    std::cerr << "Step: rise time " << response.rise_time << " s, overshoot " << 100.0 * response.overshoot << " %, peak duty " << response.peak_duty << ", error after 2 s "
+              << 100.0 * response.final_error << " %" << std::endl;
+    if (response.peak_duty > 1.0)
+    {
+        std::cerr << "Warning: the step saturates the duty, increase --r" << std::endl;
+    }
+
+    if (output != nullptr)
+    {
+        std::ofstream out(output);
+        if (!out)
+        {
+            std::cerr << "Could not write " << output << std::endl;
+            return 1;
+        }
+        write_fragment(out, design, gains, response);
+        std::cerr << "Wrote " << output << std::endl;
+    }
+    else
+    {
+        write_fragment(std::cout, design, gains, response);
+    }
+    return 0;
+}
@@ -0,0 +1,842 @@
+// Offline design of the explicit MPC velocity controller for the identified
+// motor model, see include/roboost/utils/explicit_mpc_controller.hpp.
+//
+// Usage:
+//   mpc_design [options] [fragment.h]   print or write a conf_mpc.h fragment
+//
+// Options:
+//   --gain K               motor gain in rad/s at full duty (MOTOR_MODEL_GAIN)
+//   --time-constant tau    motor time constant in s (MOTOR_MODEL_TIME_CONSTANT)
+//   --period T             control period in s (CONTROL_PERIOD_MS)
+//   --horizon N            prediction horizon in periods, 1 to 6
+//   --q q                  weight of the velocity error
+//   --r rho                weight of the duty
+//   --max-velocity v       velocity constraint in rad/s (MAX_WHEEL_VELOCITY)
+//   --velocity-range v     range of measured velocities covered by the table
+//
+// The motor is the first order model from system_analyzer, sampled with a
+// zero-order hold: w[k+1] = a w[k] + b u[k] with a = exp(-T / tau) and
+// b = K (1 - a). Over the horizon the controller minimizes
+//
+//   sum q (w[k] - r)^2 + rho (u[k] - r / K)^2
+//
+// with the LQR cost to go as terminal weight, subject to |u[k]| <= 1 and
+// |w[k]| <= max velocity. The parameters of the problem are the measured
+// velocity and the reference, so the optimal first duty is a piecewise affine
+// function over that plane (Bemporad et al., 2002).
+//
+// The regions are found by enumerating the active sets of the constraints:
+// for each one the KKT conditions give the duty and the multipliers as affine
+// functions of the parameters, and the region is the polygon where the
+// multipliers are non-negative and the inactive constraints hold. Regions with
+// the same first duty are then separated by a binary search tree over the
+// region edges (Tondel et al., 2003), which is what the firmware walks. The
+// table is checked against the QP solved online on a grid and in a step
+// simulation.
+
+#include <algorithm>
+#include <cmath>
+#include <conf_hardware.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+constexpr size_t MAX_HORIZON = 6;
+constexpr int MAX_ITERATIONS = 100000;
+constexpr double TOLERANCE = 1e-12;
+constexpr double GEOMETRY_TOLERANCE = 1e-9;
+constexpr double LAW_TOLERANCE = 1e-6;
+constexpr int CHECK_GRID = 61;
+
+// Dense row-major matrix, the largest one is horizon x horizon
+struct Matrix
+{
+    size_t rows;
+    size_t cols;
+    std::vector<double> data;
+
+    Matrix(size_t rows, size_t cols) : rows(rows), cols(cols), data(rows * cols, 0.0) {}
+
+    double& operator()(size_t r, size_t c) { return data[r * cols + c]; }
+    double operator()(size_t r, size_t c) const { return data[r * cols + c]; }
+};
+
+Matrix multiply(const Matrix& a, const Matrix& b)
+{
+    Matrix m(a.rows, b.cols);
+    for (size_t r = 0; r < a.rows; r++)
+    {
+        for (size_t k = 0; k < a.cols; k++)
+        {
+            for (size_t c = 0; c < b.cols; c++)
+            {
+                m(r, c) += a(r, k) * b(k, c);
+            }
+        }
+    }
+    return m;
+}
+
+Matrix transpose(const Matrix& a)
+{
+    Matrix m(a.cols, a.rows);
+    for (size_t r = 0; r < a.rows; r++)
+    {
+        for (size_t c = 0; c < a.cols; c++)
+        {
+            m(c, r) = a(r, c);
+        }
+    }
+    return m;
+}
+
+// Solves a x = b by Gauss-Jordan elimination with partial pivoting, false if a is singular
+bool solve(Matrix a, Matrix& b)
+{
+    const size_t n = a.rows;
+    double scale = 0.0;
+    for (double value : a.data)
+    {
+        scale = std::fmax(scale, std::fabs(value));
+    }
+    for (size_t col = 0; col < n; col++)
+    {
+        size_t pivot = col;
+        for (size_t r = col + 1; r < n; r++)
+        {
+            if (std::fabs(a(r, col)) > std::fabs(a(pivot, col)))
+            {
+                pivot = r;
+            }
+        }
+        if (std::fabs(a(pivot, col)) <= GEOMETRY_TOLERANCE * scale)
+        {
+            return false;
+        }
+        for (size_t c = 0; c < n; c++)
+        {
+            std::swap(a(col, c), a(pivot, c));
+        }
+        for (size_t c = 0; c < b.cols; c++)
+        {
+            std::swap(b(col, c), b(pivot, c));
+        }
+        for (size_t r = 0; r < n; r++)
+        {
+            if (r == col)
+            {
+                continue;
+            }
+            const double factor = a(r, col) / a(col, col);
+            for (size_t c = 0; c < n; c++)
+            {
+                a(r, c) -= factor * a(col, c);
+            }
+            for (size_t c = 0; c < b.cols; c++)
+            {
+                b(r, c) -= factor * b(col, c);
+            }
+        }
+    }
+    for (size_t r = 0; r < n; r++)
+    {
+        for (size_t c = 0; c < b.cols; c++)
+        {
+            b(r, c) /= a(r, r);
+        }
+    }
+    return true;
+}
+
+struct Design
+{
+    double gain;
+    double time_constant;
+    double period;
+    size_t horizon;
+    double q;
+    double r;
+    double max_velocity;
+    double velocity_range;
+};
+
+// Parameters theta = (measured velocity, reference)
+struct Point
+{
+    double x;
+    double y;
+};
+
+using Polygon = std::vector<Point>;
+
+// Half-plane n . theta <= offset
+struct Plane
+{
+    double n[2];
+    double offset;
+};
+
+// First duty u = f . theta + g
+struct Law
+{
+    double f[2];
+    double g;
+};
+
+// QP in the duties U: minimize 1/2 U^T H U + U^T F theta subject to G U <= W + S theta
+struct Problem
+{
+    Matrix h;
+    Matrix h_inverse;
+    Matrix f;
+    Matrix g;
+    Matrix w;
+    Matrix s;
+    double a;
+    double b;
+    double terminal_weight;
+};
+
+Problem build_problem(const Design& design)
+{
+    const size_t n = design.horizon;
+    const double a = std::exp(-design.period / design.time_constant);
+    const double b = design.gain * (1.0 - a);
+
+    // Cost to go of the unconstrained loop on the velocity error, scalar Riccati iteration
+    double p = design.q;
+    for (int i = 0; i < MAX_ITERATIONS; i++)
+    {
+        const double next = design.q + a * a * p - (a * b * p) * (a * b * p) / (design.r + b * b * p);
+        const bool converged = std::fabs(next - p) <= TOLERANCE * next;
+        p = next;
+        if (converged)
+        {
+            break;
+        }
+    }
+
+    // w[k] - r = phi_k theta + gamma_k U for k = 1 .. N
+    Matrix gamma(n, n), phi(n, 2);
+    for (size_t k = 0; k < n; k++)
+    {
+        phi(k, 0) = std::pow(a, static_cast<double>(k + 1));
+        phi(k, 1) = -1.0;
+        for (size_t j = 0; j <= k; j++)
+        {
+            gamma(k, j) = std::pow(a, static_cast<double>(k - j)) * b;
+        }
+    }
+
+    Problem problem{Matrix(n, n), Matrix(n, n), Matrix(n, 2), Matrix(4 * n, n), Matrix(4 * n, 1), Matrix(4 * n, 2), a, b, p};
+    for (size_t k = 0; k < n; k++)
+    {
+        const double weight = k + 1 == n ? p : design.q;
+        for (size_t i = 0; i < n; i++)
+        {
+            for (size_t j = 0; j < n; j++)
+            {
+                problem.h(i, j) += weight * gamma(k, i) * gamma(k, j);
+            }
+            problem.f(i, 0) += weight * gamma(k, i) * phi(k, 0);
+            problem.f(i, 1) += weight * gamma(k, i) * phi(k, 1);
+        }
+        // (u[k] - r / K)^2
+        problem.h(k, k) += design.r;
+        problem.f(k, 1) -= design.r / design.gain;
+    }
+
+    // u[k] <= 1, -u[k] <= 1, w[k] <= v, -w[k] <= v
+    for (size_t k = 0; k < n; k++)
+    {
+        problem.g(4 * k, k) = 1.0;
+        problem.w(4 * k, 0) = 1.0;
+        problem.g(4 * k + 1, k) = -1.0;
+        problem.w(4 * k + 1, 0) = 1.0;
+        for (size_t j = 0; j < n; j++)
+        {
+            problem.g(4 * k + 2, j) = gamma(k, j);
+            problem.g(4 * k + 3, j) = -gamma(k, j);
+        }
+        problem.w(4 * k + 2, 0) = design.max_velocity;
+        problem.s(4 * k + 2, 0) = -phi(k, 0);
+        problem.w(4 * k + 3, 0) = design.max_velocity;
+        problem.s(4 * k + 3, 0) = phi(k, 0);
+    }
+
+    Matrix identity(n, n);
+    for (size_t i = 0; i < n; i++)
+    {
+        identity(i, i) = 1.0;
+    }
+    problem.h_inverse = identity;
+    solve(problem.h, problem.h_inverse);
+    return problem;
+}
+
+double area(const Polygon& polygon)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i < polygon.size(); i++)
+    {
+        const Point& p = polygon[i];
+        const Point& q = polygon[(i + 1) % polygon.size()];
+        sum += p.x * q.y - q.x * p.y;
+    }
+    return 0.5 * std::fabs(sum);
+}
+
+// Sutherland-Hodgman step, the part of a convex polygon in the half-plane
+Polygon clip(const Polygon& polygon, const Plane& plane)
+{
+    Polygon result;
+    for (size_t i = 0; i < polygon.size(); i++)
+    {
+        const Point& p = polygon[i];
+        const Point& q = polygon[(i + 1) % polygon.size()];
+        const double dp = plane.n[0] * p.x + plane.n[1] * p.y - plane.offset;
+        const double dq = plane.n[0] * q.x + plane.n[1] * q.y - plane.offset;
+        if (dp <= 0.0)
+        {
+            result.push_back(p);
+        }
+        if ((dp < 0.0 && dq > 0.0) || (dp > 0.0 && dq < 0.0))
+        {
+            const double t = dp / (dp - dq);
+            result.push_back({p.x + t * (q.x - p.x), p.y + t * (q.y - p.y)});
+        }
+    }
+    return result;
+}
+
+Plane flip(const Plane& plane) { return {{-plane.n[0], -plane.n[1]}, -plane.offset}; }
+
+// Plane through an edge, with unit normal and the sign fixed so equal lines compare equal
+Plane edge_plane(const Point& p, const Point& q)
+{
+    double nx = q.y - p.y, ny = p.x - q.x;
+    const double length = std::hypot(nx, ny);
+    nx /= length;
+    ny /= length;
+    if (nx < -GEOMETRY_TOLERANCE || (std::fabs(nx) <= GEOMETRY_TOLERANCE && ny < 0.0))
+    {
+        nx = -nx;
+        ny = -ny;
+    }
+    return {{nx, ny}, nx * p.x + ny * p.y};
+}
+
+struct Piece
+{
+    Polygon polygon;
+    size_t law;
+};
+
+struct Partition
+{
+    std::vector<Piece> regions;
+    std::vector<Law> laws;
+    size_t active_sets;
+};
+
+size_t find_law(std::vector<Law>& laws, const Law& law, double scale)
+{
+    for (size_t i = 0; i < laws.size(); i++)
+    {
+        if (std::fabs(laws[i].f[0] - law.f[0]) * scale <= LAW_TOLERANCE && std::fabs(laws[i].f[1] - law.f[1]) * scale <= LAW_TOLERANCE && std::fabs(laws[i].g - law.g) <= LAW_TOLERANCE)
+        {
+            return i;
+        }
+    }
+    laws.push_back(law);
+    return laws.size() - 1;
+}
+
+// Region of one active set, empty if the set is degenerate or its region has no area
+bool region_of(const Problem& problem, const std::vector<size_t>& active, const Polygon& box, Polygon& polygon, Law& law)
+{
+    const size_t n = problem.h.rows;
+    const size_t m = problem.g.rows;
+    const size_t count = active.size();
+
+    Matrix ga(count, n), wa(count, 1), sa(count, 2);
+    for (size_t i = 0; i < count; i++)
+    {
+        for (size_t j = 0; j < n; j++)
+        {
+            ga(i, j) = problem.g(active[i], j);
+        }
+        wa(i, 0) = problem.w(active[i], 0);
+        sa(i, 0) = problem.s(active[i], 0);
+        sa(i, 1) = problem.s(active[i], 1);
+    }
+
+    // U = X theta + x from the KKT conditions
+    Matrix x_theta = multiply(problem.h_inverse, problem.f), x_offset(n, 1);
+    for (double& value : x_theta.data)
+    {
+        value = -value;
+    }
+    Matrix lambda_theta(count, 2), lambda_offset(count, 1);
+    if (count > 0)
+    {
+        // lambda = -(G_A H^-1 G_A^T)^-1 (W_A + (S_A + G_A H^-1 F) theta), singular without linear independence
+        const Matrix hg = multiply(problem.h_inverse, transpose(ga));
+        Matrix rhs(count, 3);
+        const Matrix gx = multiply(ga, x_theta);
+        for (size_t i = 0; i < count; i++)
+        {
+            rhs(i, 0) = -(sa(i, 0) - gx(i, 0));
+            rhs(i, 1) = -(sa(i, 1) - gx(i, 1));
+            rhs(i, 2) = -wa(i, 0);
+        }
+        if (!solve(multiply(ga, hg), rhs))
+        {
+            return false;
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            lambda_theta(i, 0) = rhs(i, 0);
+            lambda_theta(i, 1) = rhs(i, 1);
+            lambda_offset(i, 0) = rhs(i, 2);
+        }
+        const Matrix correction = multiply(hg, lambda_theta);
+        const Matrix correction_offset = multiply(hg, lambda_offset);
+        for (size_t j = 0; j < n; j++)
+        {
+            x_theta(j, 0) -= correction(j, 0);
+            x_theta(j, 1) -= correction(j, 1);
+            x_offset(j, 0) -= correction_offset(j, 0);
+        }
+    }
+
+    polygon = box;
+    // Dual feasibility, lambda >= 0
+    for (size_t i = 0; i < count && polygon.size() >= 3; i++)
+    {
+        polygon = clip(polygon, {{-lambda_theta(i, 0), -lambda_theta(i, 1)}, lambda_offset(i, 0)});
+    }
+    // Primal feasibility of the inactive constraints
+    for (size_t row = 0; row < m && polygon.size() >= 3; row++)
+    {
+        if (std::find(active.begin(), active.end(), row) != active.end())
+        {
+            continue;
+        }
+        double gx0 = 0.0, gx1 = 0.0, gxo = 0.0;
+        for (size_t j = 0; j < n; j++)
+        {
+            gx0 += problem.g(row, j) * x_theta(j, 0);
+            gx1 += problem.g(row, j) * x_theta(j, 1);
+            gxo += problem.g(row, j) * x_offset(j, 0);
+        }
+        polygon = clip(polygon, {{gx0 - problem.s(row, 0), gx1 - problem.s(row, 1)}, problem.w(row, 0) - gxo});
+    }
+    if (polygon.size() < 3 || area(polygon) <= GEOMETRY_TOLERANCE * area(box))
+    {
+        return false;
+    }
+    law = {{x_theta(0, 0), x_theta(0, 1)}, x_offset(0, 0)};
+    return true;
+}
+
+// Depth first over the active sets, a set is extended only with later rows and never with both bounds of one quantity
+void enumerate(const Problem& problem, const Polygon& box, double scale, std::vector<size_t>& active, size_t next, Partition& partition)
+{
+    Polygon polygon;
+    Law law;
+    partition.active_sets++;
+    if (region_of(problem, active, box, polygon, law))
+    {
+        partition.regions.push_back({polygon, find_law(partition.laws, law, scale)});
+    }
+    if (active.size() == problem.h.rows)
+    {
+        return;
+    }
+    for (size_t row = next; row < problem.g.rows; row++)
+    {
+        // Rows 2i and 2i + 1 are the upper and lower bound of the same quantity
+        if (!active.empty() && active.back() == (row ^ 1))
+        {
+            continue;
+        }
+        active.push_back(row);
+        enumerate(problem, box, scale, active, row + 1, partition);
+        active.pop_back();
+    }
+}
+
+// Node of the search tree, children >= 0 are nodes and < 0 are -(law + 1)
+struct Node
+{
+    Plane plane;
+    int child[2];
+};
+
+// Splits the pieces until every cell holds a single law, always along the edge that balances the sides best
+int build_tree(std::vector<Piece> pieces, double box_area, std::vector<Node>& nodes, size_t& depth, size_t level)
+{
+    depth = std::max(depth, level);
+    bool single = true;
+    for (const Piece& piece : pieces)
+    {
+        single = single && piece.law == pieces.front().law;
+    }
+    if (single)
+    {
+        return -static_cast<int>(pieces.front().law) - 1;
+    }
+
+    std::vector<Plane> candidates;
+    for (const Piece& piece : pieces)
+    {
+        for (size_t i = 0; i < piece.polygon.size(); i++)
+        {
+            const Point& p = piece.polygon[i];
+            const Point& q = piece.polygon[(i + 1) % piece.polygon.size()];
+            if (std::hypot(q.x - p.x, q.y - p.y) > GEOMETRY_TOLERANCE)
+            {
+                candidates.push_back(edge_plane(p, q));
+            }
+        }
+    }
+
+    const double min_area = GEOMETRY_TOLERANCE * box_area;
+    size_t best_cost = pieces.size() * 2 + 1;
+    Plane best{};
+    for (const Plane& plane : candidates)
+    {
+        size_t left = 0, right = 0;
+        for (const Piece& piece : pieces)
+        {
+            left += area(clip(piece.polygon, plane)) > min_area ? 1 : 0;
+            right += area(clip(piece.polygon, flip(plane))) > min_area ? 1 : 0;
+        }
+        if (left == 0 || right == 0)
+        {
+            continue;
+        }
+        const size_t cost = std::max(left, right) * 2 + (left + right > pieces.size() ? 1 : 0);
+        if (cost < best_cost)
+        {
+            best_cost = cost;
+            best = plane;
+        }
+    }
+    if (best_cost > pieces.size() * 2)
+    {
+        // Only slivers below the area tolerance disagree, take the law of the largest piece
+        size_t largest = 0;
+        for (size_t i = 1; i < pieces.size(); i++)
+        {
+            largest = area(pieces[i].polygon) > area(pieces[largest].polygon) ? i : largest;
+        }
+        return -static_cast<int>(pieces[largest].law) - 1;
+    }
+
+    std::vector<Piece> sides[2];
+    for (const Piece& piece : pieces)
+    {
+        const Polygon left = clip(piece.polygon, best);
+        const Polygon right = clip(piece.polygon, flip(best));
+        if (area(left) > min_area)
+        {
+            sides[0].push_back({left, piece.law});
+        }
+        if (area(right) > min_area)
+        {
+            sides[1].push_back({right, piece.law});
+        }
+    }
+
+    const size_t index = nodes.size();
+    nodes.push_back({best, {0, 0}});
+    for (int side = 0; side < 2; side++)
+    {
+        const int child = build_tree(sides[side], box_area, nodes, depth, level + 1);
+        nodes[index].child[side] = child;
+    }
+    return static_cast<int>(index);
+}
+
+double evaluate(const std::vector<Node>& nodes, const std::vector<Law>& laws, double velocity, double reference)
+{
+    int index = 0;
+    while (index >= 0)
+    {
+        const Node& node = nodes[index];
+        index = node.child[node.plane.n[0] * velocity + node.plane.n[1] * reference <= node.plane.offset ? 0 : 1];
+    }
+    const Law& law = laws[-index - 1];
+    return std::fmax(-1.0, std::fmin(1.0, law.f[0] * velocity + law.f[1] * reference + law.g));
+}
+
+// First duty of the QP solved online by coordinate ascent on the dual (Hildreth's method), the reference for the check
+double solve_online(const Problem& problem, double velocity, double reference)
+{
+    const size_t n = problem.h.rows;
+    const size_t m = problem.g.rows;
+    const Matrix hg = multiply(problem.h_inverse, transpose(problem.g));
+    const Matrix dual = multiply(problem.g, hg);
+    const Matrix x = multiply(problem.h_inverse, problem.f);
+
+    // Unconstrained optimum and the dual linear term d = W + S theta - G U*
+    std::vector<double> u(n), d(m), lambda(m, 0.0);
+    for (size_t j = 0; j < n; j++)
+    {
+        u[j] = -(x(j, 0) * velocity + x(j, 1) * reference);
+    }
+    for (size_t i = 0; i < m; i++)
+    {
+        d[i] = problem.w(i, 0) + problem.s(i, 0) * velocity + problem.s(i, 1) * reference;
+        for (size_t j = 0; j < n; j++)
+        {
+            d[i] -= problem.g(i, j) * u[j];
+        }
+    }
+    for (int iteration = 0; iteration < 20000; iteration++)
+    {
+        double change = 0.0;
+        for (size_t i = 0; i < m; i++)
+        {
+            double gradient = d[i];
+            for (size_t j = 0; j < m; j++)
+            {
+                gradient += dual(i, j) * lambda[j];
+            }
+            const double next = std::fmax(0.0, lambda[i] - gradient / dual(i, i));
+            change = std::fmax(change, std::fabs(next - lambda[i]));
+            lambda[i] = next;
+        }
+        if (change < 1e-13)
+        {
+            break;
+        }
+    }
+    double first = u[0];
+    for (size_t i = 0; i < m; i++)
+    {
+        first -= hg(0, i) * lambda[i];
+    }
+    return first;
+}
+
+struct StepResponse
+{
+    double rise_time; // s to 90 %
+    double peak;      // largest velocity
+    double final_error;
+};
+
+// Step from rest on the nominal model with the table
+StepResponse simulate_step(const Design& design, const Problem& problem, const std::vector<Node>& nodes, const std::vector<Law>& laws, double step)
+{
+    StepResponse result{-1.0, 0.0, 0.0};
+    double w = 0.0;
+    const int steps = static_cast<int>(2.0 / design.period);
+    for (int k = 0; k < steps; k++)
+    {
+        w = problem.a * w + problem.b * evaluate(nodes, laws, w, step);
+        if (result.rise_time < 0.0 && w >= 0.9 * step)
+        {
+            result.rise_time = (k + 1) * design.period;
+        }
+        result.peak = std::fmax(result.peak, w);
+    }
+    result.final_error = std::fabs(step - w);
+    return result;
+}
+
+// Round-off of exact zeros would otherwise end up in the table
+double snap(double value) { return std::fabs(value) < 1e-12 ? 0.0 : value; }
+
+void write_fragment(std::ostream& out, const Design& design, const std::vector<Node>& nodes, const std::vector<Law>& laws, size_t regions, size_t depth, const StepResponse& response)
+{
+    char buffer[256];
+    out << "// Generated by src/native/mpc_design.cpp\n";
+    std::snprintf(buffer, sizeof(buffer), "// Model: gain %.3f rad/s, time constant %.4f s, period %.4f s\n", design.gain, design.time_constant, design.period);
+    out << buffer;
+    std::snprintf(buffer, sizeof(buffer), "// Horizon %zu, weights: velocity %g, duty %g, velocity limit %g rad/s\n", design.horizon, design.q, design.r, design.max_velocity);
+    out << buffer;
+    std::snprintf(buffer, sizeof(buffer), "// %zu regions, %zu laws, tree depth %zu; step to the limit: rise time %.3f s, peak %.3f rad/s\n", regions, laws.size(), depth, response.rise_time,
+                  response.peak);
+    out << buffer;
+    std::snprintf(buffer, sizeof(buffer), "constexpr size_t MPC_WHEEL_NODES = %zu;\n", nodes.size());
+    out << buffer;
+    std::snprintf(buffer, sizeof(buffer), "constexpr size_t MPC_WHEEL_LAWS = %zu;\n", laws.size());
+    out << buffer;
+    std::snprintf(buffer, sizeof(buffer), "constexpr float MPC_WHEEL_SAMPLE_TIME = %.6g; // s\n", design.period);
+    out << buffer;
+    std::snprintf(buffer, sizeof(buffer), "constexpr float MPC_WHEEL_VELOCITY_RANGE = %.6g; // rad/s, measured velocities are clamped to it\n", design.velocity_range);
+    out << buffer;
+    std::snprintf(buffer, sizeof(buffer), "constexpr float MPC_WHEEL_MAX_VELOCITY = %.6g; // rad/s, references are clamped to it\n", design.max_velocity);
+    out << buffer;
+
+    out << "constexpr float MPC_WHEEL_PLANES[" << nodes.size() << "][3] = {";
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        std::snprintf(buffer, sizeof(buffer), "%s{%.7g, %.7g, %.7g}", i == 0 ? "" : ", ", snap(nodes[i].plane.n[0]), snap(nodes[i].plane.n[1]), snap(nodes[i].plane.offset));
+        out << buffer;
+    }
+    out << "};\n";
+    out << "constexpr int16_t MPC_WHEEL_CHILDREN[" << nodes.size() << "][2] = {";
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        out << (i == 0 ? "" : ", ") << "{" << nodes[i].child[0] << ", " << nodes[i].child[1] << "}";
+    }
+    out << "};\n";
+    out << "constexpr float MPC_WHEEL_LAW_TABLE[" << laws.size() << "][3] = {";
+    for (size_t i = 0; i < laws.size(); i++)
+    {
+        std::snprintf(buffer, sizeof(buffer), "%s{%.7g, %.7g, %.7g}", i == 0 ? "" : ", ", snap(laws[i].f[0]), snap(laws[i].f[1]), snap(laws[i].g));
+        out << buffer;
+    }
+    out << "};\n";
+}
+
+int main(int argc, char** argv)
+{
+    Design design{MOTOR_MODEL_GAIN, MOTOR_MODEL_TIME_CONSTANT, CONTROL_PERIOD_MS * 1e-3, 5, 1.0, 40.0, MAX_WHEEL_VELOCITY, 1.2 * MOTOR_MODEL_GAIN};
+    const char* output = nullptr;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--gain") == 0 && has_value)
+        {
+            design.gain = std::atof(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--time-constant") == 0 && has_value)
+        {
+            design.time_constant = std::atof(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--period") == 0 && has_value)
+        {
+            design.period = std::atof(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--horizon") == 0 && has_value)
+        {
+            design.horizon = static_cast<size_t>(std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--q") == 0 && has_value)
+        {
+            design.q = std::atof(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--r") == 0 && has_value)
+        {
+            design.r = std::atof(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--max-velocity") == 0 && has_value)
+        {
+            design.max_velocity = std::atof(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--velocity-range") == 0 && has_value)
+        {
+            design.velocity_range = std::atof(argv[++i]);
+        }
+        else if (argv[i][0] != '-' && output == nullptr)
+        {
+            output = argv[i];
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--gain K] [--time-constant tau] [--period T] [--horizon N] [--q q] [--r r] [--max-velocity v] [--velocity-range v] [fragment.h]" << std::endl;
+            return 1;
+        }
+    }
+
+    if (design.gain <= 0.0 || design.time_constant <= 0.0 || design.period <= 0.0 || design.q <= 0.0 || design.r <= 0.0 || design.max_velocity <= 0.0 || design.velocity_range <= 0.0)
+    {
+        std::cerr << "Model, period, weights and velocities must be positive" << std::endl;
+        return 1;
+    }
+    if (design.horizon < 1 || design.horizon > MAX_HORIZON)
+    {
+        std::cerr << "The horizon must be between 1 and " << MAX_HORIZON << std::endl;
+        return 1;
+    }
+
+    const Problem problem = build_problem(design);
+    const Polygon box = {{-design.velocity_range, -design.max_velocity}, {design.velocity_range, -design.max_velocity}, {design.velocity_range, design.max_velocity}, {-design.velocity_range, design.max_velocity}};
+    const double scale = std::fmax(design.velocity_range, design.max_velocity);
+
+    Partition partition{{}, {}, 0};
+    std::vector<size_t> active;
+    enumerate(problem, box, scale, active, 0, partition);
+    if (partition.regions.empty())
+    {
+        std::cerr << "No feasible region, the velocity limit cannot be kept" << std::endl;
+        return 1;
+    }
+
+    std::vector<Node> nodes;
+    size_t depth = 0;
+    const int root = build_tree(partition.regions, area(box), nodes, depth, 0);
+    if (root < 0)
+    {
+        // A single law, the root only has to lead to it
+        nodes.push_back({{{0.0, 0.0}, 0.0}, {root, root}});
+    }
+    std::cerr << "Checked " << partition.active_sets << " active sets: " << partition.regions.size() << " regions with " << partition.laws.size() << " laws, " << nodes.size()
+              << " tree nodes, depth " << depth << std::endl;
+
+    // Against the online solution on a grid, points outside every region are infeasible for the QP
+    double covered = 0.0, max_error = 0.0;
+    for (int i = 0; i < CHECK_GRID; i++)
+    {
+        for (int j = 0; j < CHECK_GRID; j++)
+        {
+            const double velocity = design.velocity_range * (2.0 * i / (CHECK_GRID - 1) - 1.0) * 0.999;
+            const double reference = design.max_velocity * (2.0 * j / (CHECK_GRID - 1) - 1.0) * 0.999;
+            bool inside = false;
+            for (const Piece& region : partition.regions)
+            {
+                const Polygon point = clip(clip(clip(clip(region.polygon, {{1.0, 0.0}, velocity + 1e-6}), {{-1.0, 0.0}, -velocity + 1e-6}), {{0.0, 1.0}, reference + 1e-6}),
+                                           {{0.0, -1.0}, -reference + 1e-6});
+                inside = inside || point.size() >= 3;
+            }
+            if (!inside)
+            {
+                continue;
+            }
+            covered += 1.0;
+            max_error = std::fmax(max_error, std::fabs(evaluate(nodes, partition.laws, velocity, reference) - solve_online(problem, velocity, reference)));
+        }
+    }
+    covered /= CHECK_GRID * CHECK_GRID;
+    std::cerr << "Grid check: " << 100.0 * covered << " % covered, largest duty error against the online QP " << max_error << std::endl;
+    if (covered < 1.0)
+    {
+        std::cerr << "Warning: part of the velocity range has no feasible solution, lower --velocity-range or raise --max-velocity" << std::endl;
+    }
+    if (max_error > 1e-4)
+    {
+        std::cerr << "Warning: the table deviates from the online QP" << std::endl;
+    }
+
+    const StepResponse response = simulate_step(design, problem, nodes, partition.laws, design.max_velocity);
+    std::cerr << "Step to " << design.max_velocity << " rad/s: rise time " << response.rise_time << " s, peak " << response.peak << " rad/s, error after 2 s " << response.final_error << " rad/s"
+              << std::endl;
+
+    if (output != nullptr)
+    {
+        std::ofstream out(output);
+        if (!out)
+        {
+            std::cerr << "Could not write " << output << std::endl;
+            return 1;
+        }
+        write_fragment(out, design, nodes, partition.laws, partition.regions.size(), depth, response);
+        std::cerr << "Wrote " << output << std::endl;
+    }
+    else
+    {
+        write_fragment(std::cout, design, nodes, partition.laws, partition.regions.size(), depth, response);
+    }
+    return 0;
+}
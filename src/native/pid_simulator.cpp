@@ -1,10 +1,11 @@
 #include <cmath>
 #include <fstream>
 #include <functional>
-#include <iostream>
 #include <matplotlibcpp.h>
+#include <roboost/utils/clock.hpp>
 #include <roboost/utils/controllers.hpp>
 #include <roboost/utils/filters.hpp>
+#include <roboost/utils/log_context.hpp>
 #include <roboost/utils/timing.hpp>
 #include <vector>
 
@@ -63,8 +64,10 @@ int main()
     float kp = 0.6, ki = 1.05, kd = 0.001;
     LowPassFilter derivative_filter(1.0 / (1.0 + 2.0 * M_PI * kd * dt), dt);
 
-    ConsoleLogger& logger = ConsoleLogger::get_instance();
-    Scheduler timing_service = Scheduler::get_instance(logger);
+    // The simulation runs on its own clock, the PID controller still reads dt from the scheduler
+    ManualClock clock;
+    LogContext log("pid_simulator");
+    Scheduler& timing_service = Scheduler::get_instance();
     timing_service.setDeltaTime(TIMING_S_TO_US(dt));
 
     PIDControllerConfig config{kp, ki, kd, 10.0, derivative_filter, &timing_service};
@@ -81,7 +84,7 @@ int main()
 
     for (int i = 0; i < num_steps; ++i)
     {
-        time = i * dt;
+        time = clock.now_us() * 1e-6;
         double setpoint = setpointFunction(time);
         double control_value = pid.update(setpoint, system_output);
         system_output = simulateSystem(control_value, system_output, dt, timeConstants);
@@ -91,6 +94,7 @@ int main()
         setpoints.push_back(setpoint);
         outputs.push_back(system_output);
         control_values.push_back(control_value);
+        clock.advance(TIMING_S_TO_US(dt));
     }
 
     // Plotting
@@ -104,6 +108,6 @@ int main()
     plt::legend();
     plt::show();
 
-    std::cout << "Simulation and plotting completed." << std::endl;
+    log.log(LogLevel::INFO, "Simulation and plotting completed after %.2f s simulated", clock.now_us() * 1e-6);
     return 0;
 }
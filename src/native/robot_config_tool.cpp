@@ -0,0 +1,149 @@
+// Builds a robot configuration blob for the RUNTIME_CONFIG firmware.
+//
+// Usage:
+//   robot_config_tool [options] [blob.bin]
+//     --wheel-radius <m> --wheel-base <m> --track-width <m> --max-wheel-velocity <rad/s>
+//     --resolution <motor> <pulses> --inverted <motor> <0|1> --gains <motor> <kp> <ki> <kd>
+//
+// Starts from the values in conf_hardware.h, applies the options, validates
+// the result and prints the command that sends it to the robot. The robot
+// stores it in NVS, answers on robot_config_status and restarts.
+
+#include <chrono>
+#include <conf_hardware.h>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <roboost/utils/robot_config.hpp>
+#include <string>
+
+using namespace roboost::config;
+
+using Config = RobotConfig<MOTOR_COUNT>;
+
+bool parse_motor(const char* arg, size_t& motor)
+{
+    motor = std::strtoul(arg, nullptr, 10);
+    if (motor >= MOTOR_COUNT)
+    {
+        std::cerr << "Motor index out of range: " << arg << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool parse_arguments(int argc, char** argv, Config& config, std::string& output)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string option = argv[i];
+        const int remaining = argc - i - 1;
+        size_t motor;
+
+        if (option == "--wheel-radius" && remaining >= 1)
+        {
+            config.wheel_radius = std::strtof(argv[++i], nullptr);
+        }
+        else if (option == "--wheel-base" && remaining >= 1)
+        {
+            config.wheel_base = std::strtof(argv[++i], nullptr);
+        }
+        else if (option == "--track-width" && remaining >= 1)
+        {
+            config.track_width = std::strtof(argv[++i], nullptr);
+        }
+        else if (option == "--max-wheel-velocity" && remaining >= 1)
+        {
+            config.max_wheel_velocity = std::strtof(argv[++i], nullptr);
+        }
+        else if (option == "--resolution" && remaining >= 2 && parse_motor(argv[i + 1], motor))
+        {
+            config.motors[motor].encoder_resolution = static_cast<uint16_t>(std::strtoul(argv[i + 2], nullptr, 10));
+            i += 2;
+        }
+        else if (option == "--inverted" && remaining >= 2 && parse_motor(argv[i + 1], motor))
+        {
+            config.motors[motor].inverted = std::strtoul(argv[i + 2], nullptr, 10) != 0;
+            i += 2;
+        }
+        else if (option == "--gains" && remaining >= 4 && parse_motor(argv[i + 1], motor))
+        {
+            config.motors[motor].gains = {std::strtof(argv[i + 2], nullptr), std::strtof(argv[i + 3], nullptr), std::strtof(argv[i + 4], nullptr)};
+            i += 4;
+        }
+        else if (option.rfind("--", 0) != 0 && output.empty())
+        {
+            output = option;
+        }
+        else
+        {
+            std::cerr << "Invalid argument: " << option << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    Config config = make_robot_config(WHEEL_RADIUS, WHEEL_BASE, TRACK_WIDTH, MAX_WHEEL_VELOCITY, ROBOT_MOTORS);
+    std::string output;
+    if (!parse_arguments(argc, argv, config, output))
+    {
+        return 1;
+    }
+    if (!is_valid(config))
+    {
+        std::cerr << "Invalid configuration: non-positive geometry, negative gains, pin conflicts, input only or flash pins, or invalid channels" << std::endl;
+        return 1;
+    }
+
+    uint8_t blob[serialized_size<MOTOR_COUNT>()];
+    const size_t size = serialize(config, blob, sizeof(blob));
+
+    // Decoding cost, which is what the robot pays at boot
+    constexpr int repetitions = 100000;
+    Config decoded = config;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < repetitions; r++)
+    {
+        if (deserialize(blob, size, decoded) != ConfigStatus::OK)
+        {
+            std::cerr << "Round trip failed" << std::endl;
+            return 1;
+        }
+    }
+    const double decode_time = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count() / repetitions;
+
+    std::cout << "Configuration: wheel radius " << config.wheel_radius << " m, wheel base " << config.wheel_base << " m, track width " << config.track_width << " m, max wheel velocity "
+              << config.max_wheel_velocity << " rad/s" << std::endl;
+    for (size_t i = 0; i < MOTOR_COUNT; i++)
+    {
+        const auto& m = config.motors[i];
+        std::cout << "  Motor " << i << ": resolution " << m.encoder_resolution << (m.inverted ? ", inverted" : "") << ", gains " << m.gains.kp << " " << m.gains.ki << " " << m.gains.kd
+                  << std::endl;
+    }
+    std::cout << size << " bytes, CRC 0x" << std::hex << crc32(blob + ROBOT_CONFIG_HEADER_SIZE, size - ROBOT_CONFIG_HEADER_SIZE) << std::dec << ", decoded in " << decode_time * 1e9
+              << " ns on this host" << std::endl;
+
+    if (!output.empty())
+    {
+        std::ofstream file(output, std::ios::binary);
+        if (!file.is_open())
+        {
+            std::cerr << "Error opening file: " << output << std::endl;
+            return 1;
+        }
+        file.write(reinterpret_cast<const char*>(blob), size);
+        std::cout << "Wrote " << output << std::endl;
+    }
+
+    std::cout << std::endl << "ros2 topic pub --once /robot_config std_msgs/msg/UInt8MultiArray \"{data: [";
+    for (size_t i = 0; i < size; i++)
+    {
+        std::cout << (i ? ", " : "") << static_cast<int>(blob[i]);
+    }
+    std::cout << "]}\"" << std::endl;
+    return 0;
+}
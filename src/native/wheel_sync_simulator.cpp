@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <conf_hardware.h>
+#include <iostream>
+#include <roboost/kinematics/kinematics.hpp>
+#include <roboost/motor_control/wheel_synchronization.hpp>
+#include <roboost/utils/clock.hpp>
+#include <roboost/utils/timing_context.hpp>
+
+using namespace roboost::kinematics;
+using namespace roboost::motor_control;
+
+constexpr size_t WHEEL_COUNT = 4;
+using WheelArray = std::array<float, WHEEL_COUNT>;
+
+// Simulation parameters
+constexpr double sim_time = 10.0;     // Simulation time in seconds
+constexpr double physics_dt = 0.0005; // Integration step of the plant in seconds
+constexpr double control_dt = 0.02;   // Control period of the firmware in seconds
+constexpr int substeps = static_cast<int>(control_dt / physics_dt + 0.5);
+
+// Wheel PI controller, same for all wheels
+constexpr float kp = 0.04f;
+constexpr float ki = 0.4f;
+constexpr float max_integral = 2.5f;
+
+// Mismatched motors: M1 has the 600 count encoder and a slower, weaker motor
+const std::array<double, WHEEL_COUNT> motor_gain = {26.0, 21.0, 25.0, 26.5};          // rad/s at full duty
+const std::array<double, WHEEL_COUNT> motor_time_constant = {0.08, 0.13, 0.09, 0.08}; // s
+const std::array<int, WHEEL_COUNT> encoder_resolution = {ROBOT_MOTORS[0].encoder_resolution, ROBOT_MOTORS[1].encoder_resolution, ROBOT_MOTORS[2].encoder_resolution,
+                                                         ROBOT_MOTORS[3].encoder_resolution};
+
+struct WheelState
+{
+    double velocity = 0.0;
+    double angle = 0.0;
+    long last_count = 0;
+    float integral = 0.0f;
+};
+
+struct SimulationResult
+{
+    double final_heading; // rad
+    double lateral_drift; // m, perpendicular to the commanded direction
+    double rms_yaw_rate;  // rad/s
+};
+
+// Command profile: forward square wave between 0.6 and 0.15 m/s
+double commanded_vx(double time) { return (static_cast<int>(time) % 2 == 0) ? 0.6 : 0.15; }
+
+SimulationResult simulate(bool synchronized)
+{
+    MecanumKinematics4W kinematics(WHEEL_RADIUS, WHEEL_BASE, TRACK_WIDTH);
+    WheelSynchronizationController<MecanumKinematics4W, WHEEL_COUNT> synchronizer(kinematics, 0.2f, 1.0f, 1.5f, 2.0f, 0.5f);
+
+    // The controllers run on the simulated time, like the firmware tasks on the system clock
+    roboost::timing::ManualClock clock;
+    roboost::timing::TimingContext control_timing(static_cast<uint32_t>(control_dt * 1e6 + 0.5));
+
+    std::array<WheelState, WHEEL_COUNT> wheels;
+    std::array<double, WHEEL_COUNT> duty = {};
+    double x = 0.0, y = 0.0, theta = 0.0;
+    double yaw_rate_squared_sum = 0.0;
+    long samples = 0;
+
+    const int control_steps = static_cast<int>(sim_time / control_dt);
+    for (int step = 0; step < control_steps; step++)
+    {
+        control_timing.tick(clock.now_us());
+        const double time = control_timing.get_sample_time_us() * 1e-6;
+        const float dt = control_timing.get_dt();
+
+        // Setpoints from the inverse kinematics
+        roboost::math::Vector<float> command = {static_cast<float>(commanded_vx(time)), 0.0f, 0.0f};
+        roboost::math::Vector<float> wheel_setpoints = kinematics.calculate_wheel_velocity(command);
+
+        // Quantized velocity measurement like the half quad encoders deliver it
+        WheelArray setpoints, measured;
+        for (size_t i = 0; i < WHEEL_COUNT; i++)
+        {
+            long count = static_cast<long>(std::floor(wheels[i].angle * encoder_resolution[i] / (2.0 * M_PI)));
+            measured[i] = static_cast<float>((count - wheels[i].last_count) * 2.0 * M_PI / encoder_resolution[i] / dt);
+            wheels[i].last_count = count;
+            setpoints[i] = wheel_setpoints[i];
+        }
+
+        const WheelArray& targets = synchronized ? synchronizer.update(setpoints, measured, dt) : setpoints;
+
+        for (size_t i = 0; i < WHEEL_COUNT; i++)
+        {
+            float error = targets[i] - measured[i];
+            wheels[i].integral = std::max(-max_integral, std::min(max_integral, wheels[i].integral + error * dt));
+            duty[i] = std::max(-1.0, std::min(1.0, static_cast<double>(kp * error + ki * wheels[i].integral)));
+        }
+
+        // Plant: first order motors, chassis motion from the actual wheel speeds
+        for (int sub = 0; sub < substeps; sub++)
+        {
+            roboost::math::Vector<float> wheel_velocity = {0.0f, 0.0f, 0.0f, 0.0f};
+            for (size_t i = 0; i < WHEEL_COUNT; i++)
+            {
+                wheels[i].velocity += (motor_gain[i] * duty[i] - wheels[i].velocity) * physics_dt / motor_time_constant[i];
+                wheels[i].angle += wheels[i].velocity * physics_dt;
+                wheel_velocity[i] = static_cast<float>(wheels[i].velocity);
+            }
+
+            roboost::math::Vector<float> robot_velocity = kinematics.calculate_robot_velocity(wheel_velocity);
+            x += (robot_velocity[0] * std::cos(theta) - robot_velocity[1] * std::sin(theta)) * physics_dt;
+            y += (robot_velocity[0] * std::sin(theta) + robot_velocity[1] * std::cos(theta)) * physics_dt;
+            theta += robot_velocity[2] * physics_dt;
+            yaw_rate_squared_sum += robot_velocity[2] * robot_velocity[2];
+            samples++;
+        }
+        clock.advance(control_timing.get_nominal_period_us());
+    }
+
+    return {theta, y, std::sqrt(yaw_rate_squared_sum / samples)};
+}
+
+void print_result(const char* name, const SimulationResult& result)
+{
+    std::cout << name << ":\n";
+    std::cout << "  Final heading:      " << result.final_heading * 180.0 / M_PI << " deg\n";
+    std::cout << "  Lateral drift:      " << result.lateral_drift * 1000.0 << " mm\n";
+    std::cout << "  RMS yaw rate:       " << result.rms_yaw_rate << " rad/s\n";
+}
+
+int main()
+{
+    std::cout << "Mecanum base driving a forward square wave for " << sim_time << " s with mismatched wheels" << std::endl;
+
+    SimulationResult independent = simulate(false);
+    SimulationResult synchronized = simulate(true);
+
+    print_result("Independent wheel controllers", independent);
+    print_result("Cross-coupled synchronization", synchronized);
+
+    return 0;
+}
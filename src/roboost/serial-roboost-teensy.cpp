@@ -28,6 +28,8 @@
 #include <nav_msgs/msg/odometry.h>
 #include <sensor_msgs/msg/joint_state.h>
 
+#include <roboost/utils/fast_math.hpp>
+#include <roboost/utils/timebase.hpp>
 #include <roboost/utils/timing.hpp>
 
 #include "conf_hardware.h"
@@ -39,44 +41,35 @@
 #include <roboost/motor_control/simple_motor_controller.hpp>
 #include <roboost/utils/logging.hpp>
 
-#define MOTOR_COUNT 4
+auto drivers = roboost::motor_control::make_motor_drivers<roboost::motor_control::L298NMotorDriver>(ROBOT_MOTORS);
 
-roboost::motor_control::L298NMotorDriver drivers[MOTOR_COUNT] = {
-    {M0_IN1, M0_IN2, M0_ENA, M0_PWM_CNL}, {M1_IN1, M1_IN2, M1_ENA, M1_PWM_CNL}, {M2_IN1, M2_IN2, M2_ENA, M2_PWM_CNL}, {M3_IN1, M3_IN2, M3_ENA, M3_PWM_CNL}};
+// auto encoders = roboost::motor_control::make_encoders<HalfQuadEncoder>(ROBOT_MOTORS);
 
-// HalfQuadEncoder encoders[MOTOR_COUNT] = {
-//     {M0_ENC_A, M0_ENC_B, M0_ENC_RESOLUTION},
-//     {M1_ENC_A, M1_ENC_B, M1_ENC_RESOLUTION},
-//     {M2_ENC_A, M2_ENC_B, M2_ENC_RESOLUTION},
-//     {M3_ENC_A, M3_ENC_B, M3_ENC_RESOLUTION}};
+auto encoders = roboost::motor_control::make_per_motor<roboost::motor_control::DummyEncoder>(ROBOT_MOTORS, [](size_t i) { return roboost::motor_control::DummyEncoder(ROBOT_MOTORS[i].encoder_resolution); });
 
-roboost::motor_control::DummyEncoder encoders[MOTOR_COUNT] = {{M0_ENC_RESOLUTION}, {M1_ENC_RESOLUTION}, {M2_ENC_RESOLUTION}, {M3_ENC_RESOLUTION}};
-
-constexpr double base_kp = 0.105;
-constexpr double base_ki = 0.125;
 constexpr double modifier_ki_linear = 2.0;
 constexpr double modifier_ki_rotational = 1.1;
-constexpr double base_kd = 0.005;
 constexpr double max_expected_sampling_time = 0.2;
 constexpr double max_integral = 5.2;
 
-roboost::controllers::PIDController controllers[MOTOR_COUNT] = {{base_kp, base_ki, base_kd, max_expected_sampling_time, max_integral},
-                                                                {base_kp, base_ki, base_kd, max_expected_sampling_time, max_integral},
-                                                                {base_kp, base_ki, base_kd, max_expected_sampling_time, max_integral},
-                                                                {base_kp, base_ki, base_kd, max_expected_sampling_time, max_integral}};
+auto controllers = roboost::motor_control::make_pid_controllers<roboost::controllers::PIDController>(ROBOT_MOTORS, max_expected_sampling_time, max_integral);
 
-roboost::filters::NoFilter encoder_input_filters[MOTOR_COUNT] = {{}, {}, {}, {}};
+std::array<roboost::filters::NoFilter, MOTOR_COUNT> encoder_input_filters;
 
-roboost::filters::NoFilter motor_output_filters[MOTOR_COUNT] = {{}, {}, {}, {}};
+std::array<roboost::filters::NoFilter, MOTOR_COUNT> motor_output_filters;
 
 static double MIN_OUTPUT = 0.35;
 
-roboost::motor_control::VelocityController motor_controllers[MOTOR_COUNT] = {{drivers[0], encoders[0], controllers[0], encoder_input_filters[0], motor_output_filters[0], MIN_OUTPUT},
-                                                                             {drivers[1], encoders[1], controllers[1], encoder_input_filters[1], motor_output_filters[1], MIN_OUTPUT},
-                                                                             {drivers[2], encoders[2], controllers[2], encoder_input_filters[2], motor_output_filters[2], MIN_OUTPUT},
-                                                                             {drivers[3], encoders[3], controllers[3], encoder_input_filters[3], motor_output_filters[3], MIN_OUTPUT}};
+#ifdef FAST_MATH
+using OdometryMath = roboost::math::PolynomialMath;
+#else
+using OdometryMath = roboost::math::LibmMath;
+#endif
+
+auto motor_controllers =
+    roboost::motor_control::make_motor_controllers<roboost::motor_control::VelocityController>(drivers, encoders, controllers, encoder_input_filters, motor_output_filters, MIN_OUTPUT);
 
-roboost::motor_control::MotorControllerManager motor_control_manager{&motor_controllers[0], &motor_controllers[1], &motor_controllers[2], &motor_controllers[3]};
+auto motor_control_manager = roboost::motor_control::make_motor_controller_manager<roboost::motor_control::MotorControllerManager>(motor_controllers);
 
 roboost::kinematics::MecanumKinematics4W kinematics(WHEEL_RADIUS, WHEEL_BASE, TRACK_WIDTH);
 roboost::robot_controller::RobotVelocityController robot_controller(motor_control_manager, &kinematics);
@@ -107,12 +100,11 @@ rcl_node_t node;
 unsigned long last_time = 0;
 Eigen::Vector3d pose = Eigen::Vector3d::Zero();
 
-unsigned long last_time_sync_ms = 0;
-unsigned long last_time_sync_ns = 0;
 const unsigned long time_sync_interval = 1000;
 const int sync_timeout_ms = 500;
-int64_t synced_time_ms = 0;
+// Agent epoch at the last sync and the local time it was received at
 int64_t synced_time_ns = 0;
+uint64_t synced_local_us = 0;
 
 roboost::timing::Scheduler& timing_service = roboost::timing::Scheduler::get_instance();
 
@@ -136,7 +128,7 @@ static const double default_covariance[36] = {
 
 // Function prototypes
 void cmd_vel_subscription_callback(const void* msgin);
-void set_ros_timestamp(std_msgs__msg__Header& header, unsigned long sync_ms, unsigned long sync_ns);
+void set_ros_timestamp(std_msgs__msg__Header& header, int64_t sync_ns, uint64_t sync_local_us);
 void publish_joint_states(const Eigen::Vector4d& velocities, double dt);
 void update_odometry(const Eigen::Vector3d& velocity, double dt);
 void pub_timer_callback(rcl_timer_t* timer, int64_t last_call_time);
@@ -214,9 +206,8 @@ void init_microros()
 
     if (rmw_uros_epoch_synchronized())
     {
-        // Get time in milliseconds or nanoseconds
-        synced_time_ms = rmw_uros_epoch_millis();
         synced_time_ns = rmw_uros_epoch_nanos();
+        synced_local_us = roboost::timing::now_us64();
     }
     else
     {
@@ -350,23 +341,23 @@ void cmd_vel_subscription_callback(const void* msgin)
     // Based on max velocity multiply the ki value by a factor
     if (abs(smoothed_cmd_vel(0)) > 0.5 || abs(smoothed_cmd_vel(1)) > 0.5)
     {
-        for (int i = 0; i < MOTOR_COUNT; i++)
+        for (size_t i = 0; i < MOTOR_COUNT; i++)
         {
-            controllers[i].set_ki(base_ki * modifier_ki_linear);
+            controllers[i].set_ki(ROBOT_MOTORS[i].gains.ki * modifier_ki_linear);
         }
     }
     else if (abs(smoothed_cmd_vel(2)) > 1.0)
     {
-        for (int i = 0; i < MOTOR_COUNT; i++)
+        for (size_t i = 0; i < MOTOR_COUNT; i++)
         {
-            controllers[i].set_ki(base_ki * modifier_ki_rotational);
+            controllers[i].set_ki(ROBOT_MOTORS[i].gains.ki * modifier_ki_rotational);
         }
     }
     else
     {
-        for (int i = 0; i < MOTOR_COUNT; i++)
+        for (size_t i = 0; i < MOTOR_COUNT; i++)
         {
-            controllers[i].set_ki(base_ki);
+            controllers[i].set_ki(ROBOT_MOTORS[i].gains.ki);
         }
     }
 
@@ -374,16 +365,19 @@ void cmd_vel_subscription_callback(const void* msgin)
 }
 
 /**
- * @brief Helper function to set the ROS timestamp for a message.
+ * @brief Helper function to set the ROS timestamp for a message. The time
+ * since the last sync is taken from the 64 bit timebase, so the stamps stay
+ * continuous however long the robot runs.
  *
  * @param header Header of the message
- * @param sync_ms Synced time in milliseconds
- * @param sync_ns Nano second part of the synced time
+ * @param sync_ns Agent epoch at the last sync in nanoseconds
+ * @param sync_local_us Local time of the last sync in microseconds
  */
-void set_ros_timestamp(std_msgs__msg__Header& header, unsigned long sync_ms, unsigned long sync_ns)
+void set_ros_timestamp(std_msgs__msg__Header& header, int64_t sync_ns, uint64_t sync_local_us)
 {
-    header.stamp.sec = (sync_ms + millis() - last_time_sync_ms) / 1000;
-    header.stamp.nanosec = sync_ns + (micros() * 1000 - last_time_sync_ns) % 1000000000;
+    const int64_t stamp_ns = sync_ns + static_cast<int64_t>(roboost::timing::now_us64() - sync_local_us) * 1000;
+    header.stamp.sec = static_cast<int32_t>(stamp_ns / 1000000000);
+    header.stamp.nanosec = static_cast<uint32_t>(stamp_ns % 1000000000);
 }
 
 /**
@@ -399,7 +393,7 @@ void publish_joint_states(const Eigen::Vector4d& velocities, double dt)
         joint_state_msg.position.data[i] += velocities(i) * dt;
         joint_state_msg.velocity.data[i] = velocities(i);
     }
-    set_ros_timestamp(joint_state_msg.header, synced_time_ms, synced_time_ns);
+    set_ros_timestamp(joint_state_msg.header, synced_time_ns, synced_local_us);
     RCSOFTCHECK(rcl_publish(&joint_state_publisher, &joint_state_msg, NULL), logger);
 }
 
@@ -415,7 +409,7 @@ void publish_wanted_joint_states(const Eigen::Vector4d& velocities, double dt)
     {
         wanted_joint_state_msg.position.data[i] = velocities(i);
     }
-    set_ros_timestamp(wanted_joint_state_msg.header, synced_time_ms, synced_time_ns);
+    set_ros_timestamp(wanted_joint_state_msg.header, synced_time_ns, synced_local_us);
     RCSOFTCHECK(rcl_publish(&wanted_joint_state_publisher, &wanted_joint_state_msg, NULL), logger);
 }
 
@@ -427,15 +421,17 @@ void publish_wanted_joint_states(const Eigen::Vector4d& velocities, double dt)
  */
 void update_odometry(const Eigen::Vector3d& velocity, double dt)
 {
-    pose(0) += velocity(0) * cos(pose(2)) * dt - velocity(1) * sin(pose(2)) * dt;
-    pose(1) += velocity(0) * sin(pose(2)) * dt + velocity(1) * cos(pose(2)) * dt;
-    pose(2) += velocity(2) * dt;
-    pose(2) = atan2(sin(pose(2)), cos(pose(2)));
+    // One sine and cosine of the heading per update, FAST_MATH also wraps the heading without atan2
+    const double cos_heading = OdometryMath::cos(pose(2));
+    const double sin_heading = OdometryMath::sin(pose(2));
+    pose(0) += (velocity(0) * cos_heading - velocity(1) * sin_heading) * dt;
+    pose(1) += (velocity(0) * sin_heading + velocity(1) * cos_heading) * dt;
+    pose(2) = OdometryMath::wrap_angle(pose(2) + velocity(2) * dt);
 
     odom_msg.pose.pose.position.x = pose(0);
     odom_msg.pose.pose.position.y = pose(1);
-    odom_msg.pose.pose.orientation.w = cos(pose(2) / 2.0);
-    odom_msg.pose.pose.orientation.z = sin(pose(2) / 2.0);
+    odom_msg.pose.pose.orientation.w = OdometryMath::cos(pose(2) / 2.0);
+    odom_msg.pose.pose.orientation.z = OdometryMath::sin(pose(2) / 2.0);
     odom_msg.twist.twist.linear.x = velocity(0);
     odom_msg.twist.twist.linear.y = velocity(1);
     odom_msg.twist.twist.angular.z = velocity(2);
@@ -455,11 +451,11 @@ void pub_timer_callback(rcl_timer_t* timer, int64_t last_call_time)
         return;
     }
 
-    set_ros_timestamp(odom_msg.header, synced_time_ms, synced_time_ns);
+    set_ros_timestamp(odom_msg.header, synced_time_ns, synced_local_us);
     RCSOFTCHECK(rcl_publish(&odom_publisher, &odom_msg, NULL), logger);
 
     // TODO: Remove this
-    set_ros_timestamp(joint_state_msg.header, synced_time_ms, synced_time_ns);
+    set_ros_timestamp(joint_state_msg.header, synced_time_ns, synced_local_us);
     RCSOFTCHECK(rcl_publish(&joint_state_publisher, &joint_state_msg, NULL), logger);
 }
 
@@ -481,11 +477,8 @@ void sync_timer_callback(rcl_timer_t* timer, int64_t last_call_time)
 
     if (rmw_uros_epoch_synchronized())
     {
-        // Get time in milliseconds or nanoseconds
-        synced_time_ms = rmw_uros_epoch_millis();
         synced_time_ns = rmw_uros_epoch_nanos();
-        last_time_sync_ms = millis();
-        last_time_sync_ns = micros() * 1000;
+        synced_local_us = roboost::timing::now_us64();
     }
     else
     {
@@ -500,9 +493,8 @@ void sync_callback()
 
     if (rmw_uros_epoch_synchronized())
     {
-        // Get time in milliseconds or nanoseconds
-        synced_time_ms = rmw_uros_epoch_millis();
         synced_time_ns = rmw_uros_epoch_nanos();
+        synced_local_us = roboost::timing::now_us64();
     }
     else
     {
@@ -15,7 +15,9 @@
 
 #include <Arduino.h>
 #include <ArduinoEigen.h>
+#include <WiFi.h>
 #include <micro_ros_platformio.h>
+#include <rmw_microros/rmw_microros.h>
 
 #include "rcl_checks.h"
 #include <rcl/rcl.h>
@@ -28,11 +30,27 @@
 #include <nav_msgs/msg/odometry.h>
 #include <sensor_msgs/msg/joint_state.h>
 
+#include <roboost/kinematics/desaturation.hpp>
+#include <roboost/motor_control/command_timeout.hpp>
+#include <roboost/motor_control/iterative_learning.hpp>
+#include <roboost/utils/clock.hpp>
+#include <roboost/utils/coroutine.hpp>
+#include <roboost/utils/explicit_mpc_controller.hpp>
+#include <roboost/utils/fast_math.hpp>
+#include <roboost/utils/log_context.hpp>
+#include <roboost/utils/lqr_controller.hpp>
+#include <roboost/utils/robot_config.hpp>
+#include <roboost/utils/schedulability.hpp>
+#include <roboost/utils/timebase.hpp>
+#include <roboost/utils/timing_context.hpp>
+#include <roboost/utils/watchdog.hpp>
 #include <utils/diagnostics.hpp>
 #include <utils/initialization.hpp>
 #include <utils/timing.hpp>
 
 #include "conf_hardware.h"
+#include "conf_lqr.h"
+#include "conf_mpc.h"
 #include "conf_network.h"
 #include "motor_control/encoder.hpp"
 #include "motor_control/motor-drivers/l298n_motor_driver.hpp"
@@ -40,48 +58,160 @@
 #include "motor_control/simple_motor_controller.hpp"
 #include "robot_controller.hpp"
 
-#define MOTOR_COUNT 4
+#ifdef IMU
+#include <Wire.h>
+#include <roboost/sensors/mpu6050.hpp>
+#include <roboost/utils/heading_estimator.hpp>
+#include <sensor_msgs/msg/imu.h>
+#endif
+
+#ifdef WATCHDOG
+#include <atomic>
+#include <esp_task_wdt.h>
+#endif
+
+#ifdef DISTURBANCE_OBSERVER
+#include <roboost/motor_control/disturbance_observer.hpp>
+#endif
+
+#ifdef ILC
+#include <atomic>
+#include <std_msgs/msg/u_int8.h>
+#endif
+
+#ifdef WHEEL_SYNCHRONIZATION
+#include <roboost/motor_control/wheel_synchronization.hpp>
+#endif
+
+#ifdef RUNTIME_CONFIG
+#include <nvs.h>
+#include <nvs_flash.h>
+#include <std_msgs/msg/u_int8.h>
+#include <std_msgs/msg/u_int8_multi_array.h>
+#endif
+
+using RobotConfig = roboost::config::RobotConfig<MOTOR_COUNT>;
+
+#ifdef FAST_MATH
+using OdometryMath = roboost::math::PolynomialMath;
+#else
+using OdometryMath = roboost::math::LibmMath;
+#endif
+
+// Compiled in values, used unless a valid configuration is stored in NVS
+const RobotConfig default_robot_config = roboost::config::make_robot_config(WHEEL_RADIUS, WHEEL_BASE, TRACK_WIDTH, MAX_WHEEL_VELOCITY, ROBOT_MOTORS);
+
+#ifdef RUNTIME_CONFIG
+static const char* config_nvs_namespace = "roboost";
+static const char* config_nvs_key = "robot_config";
+
+// Pins of other peripherals a loaded configuration must leave free
+#ifdef IMU
+static const uint8_t config_reserved_pins[] = {IMU_SDA, IMU_SCL};
+static const size_t config_reserved_pin_count = 2;
+#else
+static const uint8_t* const config_reserved_pins = nullptr;
+static const size_t config_reserved_pin_count = 0;
+#endif
+roboost::config::ConfigStatus config_load_status = roboost::config::ConfigStatus::NOT_FOUND;
+unsigned long config_load_time_us = 0;
+
+RobotConfig load_robot_config();
+
+// Loaded during static initialization, before the motor stack below is built from it
+const RobotConfig robot_config = load_robot_config();
+#else
+const RobotConfig& robot_config = default_robot_config;
+#endif
+
+auto drivers = roboost::motor_control::make_motor_drivers<L298NMotorDriver>(robot_config.motors);
+
+auto encoders = roboost::motor_control::make_encoders<HalfQuadEncoder>(robot_config.motors);
 
-L298NMotorDriver drivers[MOTOR_COUNT] = {{M0_IN1, M0_IN2, M0_ENA, M0_PWM_CNL}, {M1_IN1, M1_IN2, M1_ENA, M1_PWM_CNL}, {M2_IN1, M2_IN2, M2_ENA, M2_PWM_CNL}, {M3_IN1, M3_IN2, M3_ENA, M3_PWM_CNL}};
-
-HalfQuadEncoder encoders[MOTOR_COUNT] = {
-    {M0_ENC_A, M0_ENC_B, M0_ENC_RESOLUTION}, {M1_ENC_A, M1_ENC_B, M1_ENC_RESOLUTION}, {M2_ENC_A, M2_ENC_B, M2_ENC_RESOLUTION}, {M3_ENC_A, M3_ENC_B, M3_ENC_RESOLUTION}};
-
-constexpr double base_kp = 0.105;
-constexpr double base_ki = 0.125;
 constexpr double modifier_ki_linear = 2.0;
 constexpr double modifier_ki_rotational = 1.1;
-constexpr double base_kd = 0.005;
 constexpr double max_expected_sampling_time = 0.2;
 constexpr double max_integral = 5.2;
 
-PIDController controllers[MOTOR_COUNT] = {{base_kp, base_ki, base_kd, max_expected_sampling_time, max_integral},
-                                          {base_kp, base_ki, base_kd, max_expected_sampling_time, max_integral},
-                                          {base_kp, base_ki, base_kd, max_expected_sampling_time, max_integral},
-                                          {base_kp, base_ki, base_kd, max_expected_sampling_time, max_integral}};
+#ifdef LQR_CONTROL
+// Limit of the integrated velocity error in rad, the LQR gains already include the sample time
+constexpr float lqr_max_integral = 2.0f;
+static_assert(LQR_WHEEL_SAMPLE_TIME > CONTROL_PERIOD_MS * 1e-3f - 5e-4f && LQR_WHEEL_SAMPLE_TIME < CONTROL_PERIOD_MS * 1e-3f + 5e-4f, "conf_lqr.h was designed for another control period");
+
+static_assert(LQR_WHEEL_STATES == 1 && LQR_WHEEL_INPUTS == 1 && LQR_WHEEL_REFERENCES == 1, "The wheel loops need the single wheel model of conf_lqr.h");
+
+using roboost::controllers::LQRVelocityController;
+auto controllers = roboost::motor_control::make_per_motor<LQRVelocityController>(
+    robot_config.motors, [](size_t) { return LQRVelocityController(LQR_WHEEL_KX, LQR_WHEEL_KI, LQR_WHEEL_KR, LQR_WHEEL_C, LQR_WHEEL_SAMPLE_TIME, 1.0f, lqr_max_integral); });
+#elif defined(MPC_CONTROL)
+static_assert(MPC_WHEEL_SAMPLE_TIME > CONTROL_PERIOD_MS * 1e-3f - 5e-4f && MPC_WHEEL_SAMPLE_TIME < CONTROL_PERIOD_MS * 1e-3f + 5e-4f, "conf_mpc.h was designed for another control period");
 
-NoFilter encoder_input_filters[MOTOR_COUNT] = {NoFilter(), NoFilter(), NoFilter(), NoFilter()};
+using WheelMPCController = roboost::controllers::ExplicitMPCController<MPC_WHEEL_NODES, MPC_WHEEL_LAWS>;
+auto controllers = roboost::motor_control::make_per_motor<WheelMPCController>(
+    robot_config.motors, [](size_t) { return WheelMPCController(MPC_WHEEL_PLANES, MPC_WHEEL_CHILDREN, MPC_WHEEL_LAW_TABLE, MPC_WHEEL_VELOCITY_RANGE, MPC_WHEEL_MAX_VELOCITY); });
+#else
+auto controllers = roboost::motor_control::make_pid_controllers<PIDController>(robot_config.motors, max_expected_sampling_time, max_integral);
+#endif
 
-NoFilter motor_output_filters[MOTOR_COUNT] = {NoFilter(), NoFilter(), NoFilter(), NoFilter()};
+std::array<NoFilter, MOTOR_COUNT> encoder_input_filters;
+
+std::array<NoFilter, MOTOR_COUNT> motor_output_filters;
 
 static double MIN_OUTPUT = 0.35;
 
-VelocityController motor_controllers[MOTOR_COUNT] = {{drivers[0], encoders[0], controllers[0], encoder_input_filters[0], motor_output_filters[0], MIN_OUTPUT},
-                                                     {drivers[1], encoders[1], controllers[1], encoder_input_filters[1], motor_output_filters[1], MIN_OUTPUT},
-                                                     {drivers[2], encoders[2], controllers[2], encoder_input_filters[2], motor_output_filters[2], MIN_OUTPUT},
-                                                     {drivers[3], encoders[3], controllers[3], encoder_input_filters[3], motor_output_filters[3], MIN_OUTPUT}};
+// Period of the control task, the sample time of everything it updates
+constexpr uint32_t control_period_us = TIMING_MS_TO_US(CONTROL_PERIOD_MS);
+
+#ifdef DISTURBANCE_OBSERVER
+// The velocity controllers drive the motors through the observers, which add the estimated load to every command
+using CompensatedDriver = roboost::motor_control::DisturbanceCompensatedDriver<HalfQuadEncoder>;
+const roboost::motor_control::MotorModel motor_model = {MOTOR_MODEL_GAIN, MOTOR_MODEL_TIME_CONSTANT, MOTOR_MODEL_INERTIA};
+auto compensated_drivers = roboost::motor_control::make_per_motor<CompensatedDriver>(
+    robot_config.motors,
+    [](size_t i)
+    {
+        return CompensatedDriver(drivers[i], encoders[i], roboost::motor_control::DisturbanceObserver<>(motor_model, control_period_us * 1e-6f, DOB_CUTOFF_FREQUENCY, DOB_MAX_COMPENSATION),
+                                 1 << (roboost::motor_control::PWM_RESOLUTION - 1));
+    });
 
-MotorControllerManager motor_control_manager{&motor_controllers[0], &motor_controllers[1], &motor_controllers[2], &motor_controllers[3]};
+auto motor_controllers = roboost::motor_control::make_motor_controllers<VelocityController>(compensated_drivers, encoders, controllers, encoder_input_filters, motor_output_filters, MIN_OUTPUT);
+#else
+auto motor_controllers = roboost::motor_control::make_motor_controllers<VelocityController>(drivers, encoders, controllers, encoder_input_filters, motor_output_filters, MIN_OUTPUT);
+#endif
 
-MecanumKinematics4W kinematics(WHEEL_RADIUS, WHEEL_BASE, TRACK_WIDTH);
+auto motor_control_manager = roboost::motor_control::make_motor_controller_manager<MotorControllerManager>(motor_controllers);
+
+MecanumKinematics4W kinematics(robot_config.wheel_radius, robot_config.wheel_base, robot_config.track_width);
 RobotVelocityController robot_controller(motor_control_manager, &kinematics);
 
+// Keeps every wheel below its limit while preserving the commanded direction
+roboost::kinematics::TwistDesaturator<MecanumKinematics4W, Eigen::Vector3d> cmd_vel_desaturator(kinematics, robot_config.max_wheel_velocity, roboost::kinematics::DesaturationMode::ROTATION_PRIORITY);
+
+#ifdef WHEEL_SYNCHRONIZATION
+// Couples the wheel loops through the kinematics, its robot-frame correction is added to the command
+roboost::motor_control::WheelSynchronizationController<MecanumKinematics4W, MOTOR_COUNT, Eigen::Vector3d, Eigen::Vector4d> wheel_synchronizer(kinematics, SYNC_KP_LINEAR, SYNC_KI_LINEAR, SYNC_KP_ANGULAR,
+                                                                                                                                          SYNC_KI_ANGULAR, SYNC_MAX_INTEGRAL);
+#endif
+
 MovingAverageFilter cmd_vel_filter_x = MovingAverageFilter(2);
 MovingAverageFilter cmd_vel_filter_y = MovingAverageFilter(2);
 MovingAverageFilter cmd_vel_filter_theta = MovingAverageFilter(4);
 
 Eigen::Matrix<double, 3, 1> smoothed_cmd_vel;
 
+// Expires cmd_vel when the link drops, evaluated in the control loop
+roboost::motor_control::CommandTimeout<3> cmd_vel_timeout(TIMING_MS_TO_US(CMD_VEL_TIMEOUT_MS), STOP_MAX_DECELERATION, STOP_MAX_JERK);
+
+#ifdef ILC
+// Learned feedforward of repeated trajectories on (vx, vy, omega), added to the command in the control loop
+roboost::motor_control::IterativeLearningController<3, ILC_MAX_DURATION_MS / CONTROL_PERIOD_MS, ILC_TRAJECTORIES> ilc(ILC_LEARNING_GAIN, ILC_LEAD, CONTROL_PERIOD_MS * 1e-3f, ILC_CUTOFF_FREQUENCY,
+                                                                                                                   ILC_MAX_FEEDFORWARD);
+rcl_subscription_t ilc_subscriber;
+std_msgs__msg__UInt8 ilc_msg;
+// Trajectory id from ilc_run for the control loop, -1 without a new request
+std::atomic<int> ilc_request{-1};
+#endif
+
 rcl_subscription_t cmd_vel_subscriber;
 rcl_publisher_t odom_publisher;
 rcl_publisher_t joint_state_publisher, wanted_joint_state_publisher;
@@ -100,15 +230,84 @@ rcl_node_t node;
 unsigned long last_time = 0;
 Eigen::Vector3d pose = Eigen::Vector3d::Zero();
 
-unsigned long last_time_sync_ms = 0;
-unsigned long last_time_sync_ns = 0;
 const unsigned long time_sync_interval = 1000;
 const int sync_timeout_ms = 500;
-int64_t synced_time_ms = 0;
+// Agent epoch at the last sync and the local time it was received at
 int64_t synced_time_ns = 0;
+uint64_t synced_local_us = 0;
 
 Scheduler& timing_service = Scheduler::get_instance();
 
+// Time and diagnostics are handed to the tasks, see clock.hpp and log_context.hpp
+roboost::timing::SystemClock& system_clock = roboost::timing::default_clock();
+roboost::logging::LogContext task_log("Tasks");
+roboost::logging::LogContext network_log("micro-ROS");
+
+// Admission control for the cooperative task set, fed with measured execution times
+constexpr size_t MAX_TASK_COUNT = 8;
+roboost::timing::SchedulabilityAnalyzer<MAX_TASK_COUNT> admission_control;
+
+// Measured period of every task, indexed like the admission control
+roboost::timing::TimingContext task_timing[MAX_TASK_COUNT];
+int control_task_id = -1;
+
+// The publish timer is run by the executor, not the timing service, and measures its own period
+roboost::timing::TimingContext publish_timing(TIMING_MS_TO_US(100));
+
+// Network bring-up runs as a coroutine so that the control loop starts right after reset
+roboost::timing::CoroutineRunner<1> coroutine_runner;
+bool micro_ros_ready = false;
+const unsigned long agent_ping_interval_ms = 200;
+const unsigned long bring_up_retry_interval_ms = 500;
+const unsigned long executor_spin_timeout_ms = 100;
+
+// Boot instrumentation, times since power-on in microseconds
+uint64_t boot_first_control_tick_us = 0;
+uint64_t boot_micro_ros_ready_us = 0;
+uint64_t boot_first_odom_us = 0;
+
+#ifdef WATCHDOG
+// Supervisor of the critical tasks, see watchdog_task for the escalation
+roboost::timing::SoftwareWatchdog<3> watchdog;
+int control_watchdog_id = -1;
+int executor_watchdog_id = -1;
+int telemetry_watchdog_id = -1;
+const unsigned long watchdog_check_interval_ms = 10;
+const uint32_t hardware_watchdog_timeout_s = 5;
+// The control task shares the loop with the executor spin, which blocks for up to executor_spin_timeout_ms
+const uint32_t control_watchdog_deadline_ms = 250;
+
+// Set by the supervisor, handled by the tasks themselves
+std::atomic<bool> safe_stop_latched{false};
+std::atomic<bool> network_restart_requested{false};
+roboost::logging::LogContext watchdog_log("Watchdog");
+
+#define WATCHDOG_HEARTBEAT(id) (&watchdog.get_heartbeat(id))
+#else
+#define WATCHDOG_HEARTBEAT(id) nullptr
+#endif
+
+#ifdef IMU
+// Heading from gyro and wheel odometry, the gyro bias is estimated online
+roboost::sensors::MPU6050 imu(Wire, IMU_SDA, IMU_SCL);
+roboost::estimators::HeadingKalmanFilter heading_filter;
+roboost::estimators::FusedOdometry<roboost::estimators::HeadingKalmanFilter> fused_odometry(heading_filter);
+bool imu_available = false;
+
+rcl_publisher_t imu_publisher;
+sensor_msgs__msg__Imu imu_msg;
+static const char* imu_frame_id = "imu_link";
+#endif
+
+#ifdef RUNTIME_CONFIG
+// Configuration updates as serialized blob, answered with the resulting ConfigStatus
+rcl_subscription_t config_subscriber;
+rcl_publisher_t config_status_publisher;
+std_msgs__msg__UInt8MultiArray config_msg;
+std_msgs__msg__UInt8 config_status_msg;
+uint8_t config_msg_buffer[roboost::config::serialized_size<MOTOR_COUNT>()];
+#endif
+
 // Predefined global or static data
 static const char* odom_frame_id = "odom";
 static const char* base_link_frame_id = "base_link";
@@ -127,19 +326,150 @@ static const double default_covariance[36] = {
 
 // Function prototypes
 void cmd_vel_subscription_callback(const void* msgin);
-void set_ros_timestamp(std_msgs__msg__Header& header, unsigned long sync_ms, unsigned long sync_ns);
-void publish_joint_states(const Eigen::Vector4d& velocities, double dt);
+void set_ros_timestamp(std_msgs__msg__Header& header, int64_t sync_ns, uint64_t sync_local_us);
 void update_odometry(const Eigen::Vector3d& velocity, double dt);
-void pub_timer_callback(rcl_timer_t* timer, int64_t last_call_time);
+void odom_timer_callback(rcl_timer_t* timer, int64_t last_call_time);
 void sync_timer_callback(rcl_timer_t* timer, int64_t last_call_time);
 void init_odometry_msg();
+#ifdef IMU
+void init_imu_msg();
+void update_heading_fusion(float dt);
+void publish_fused_odometry(const Eigen::Vector3d& velocity);
+#endif
+#ifdef RUNTIME_CONFIG
+void config_subscription_callback(const void* msgin);
+#endif
+#ifdef ILC
+void ilc_subscription_callback(const void* msgin);
+#endif
 void init_joint_state_msg();
 void init_wanted_joint_state_msg();
-void init_microros();
-void pub_callback();
+void print_free_heap();
+int add_monitored_task(std::function<void(const roboost::timing::TimingContext&)> callback, uint32_t period, uint32_t timeout, const char* name, uint32_t wcet_estimate,
+                       roboost::timing::Heartbeat* heartbeat = nullptr);
+#ifdef WATCHDOG
+void start_watchdog();
+void watchdog_task(void* parameters);
+void watchdog_handler(size_t task_id, roboost::timing::WatchdogAction action);
+void safe_stop_motors();
+void destroy_micro_ros_entities();
+#endif
 
 /**
- * @brief Setup function for initializing micro-ROS, pin modes, etc.
+ * @brief One rcl call of the bring-up and the cleanup of its entity. A failed
+ * step is finalized before it is retried, so no entity is initialized twice.
+ * Steps that only register an entity with the executor leave nothing behind
+ * when they fail and have no fini.
+ */
+struct MicroRosBringUpStep
+{
+    rcl_ret_t (*init)();
+    void (*fini)();
+};
+
+// cmd_vel, the publish timer and the optional subscriptions
+#ifdef ILC
+constexpr size_t executor_handles = 4;
+#else
+constexpr size_t executor_handles = 3;
+#endif
+
+// Entity creation in the order required by rclc
+const MicroRosBringUpStep micro_ros_bring_up_steps[] = {
+    {[]() { return rclc_support_init(&support, 0, NULL, &allocator); }, []() { (void)rclc_support_fini(&support); }},
+    {[]() { return rclc_node_init_default(&node, "roboost_pmc_node", "", &support); }, []() { (void)rcl_node_fini(&node); }},
+    {[]() { return rclc_publisher_init_default(&odom_publisher, &node, ROSIDL_GET_MSG_TYPE_SUPPORT(nav_msgs, msg, Odometry), "odom"); }, []() { (void)rcl_publisher_fini(&odom_publisher, &node); }},
+#ifdef IMU
+    {[]() { return rclc_publisher_init_default(&imu_publisher, &node, ROSIDL_GET_MSG_TYPE_SUPPORT(sensor_msgs, msg, Imu), "imu"); }, []() { (void)rcl_publisher_fini(&imu_publisher, &node); }},
+#endif
+    {[]() { return rclc_timer_init_default(&publish_timer, &support, RCL_MS_TO_NS(100), odom_timer_callback); }, []() { (void)rcl_timer_fini(&publish_timer); }},
+    {[]() { return rclc_timer_init_default(&sync_timer, &support, RCL_MS_TO_NS(time_sync_interval), sync_timer_callback); }, []() { (void)rcl_timer_fini(&sync_timer); }},
+    {[]() { return rclc_subscription_init_default(&cmd_vel_subscriber, &node, ROSIDL_GET_MSG_TYPE_SUPPORT(geometry_msgs, msg, Twist), "cmd_vel"); },
+     []() { (void)rcl_subscription_fini(&cmd_vel_subscriber, &node); }},
+    {[]() { return rclc_executor_init(&executor, &support.context, executor_handles, &allocator); }, []() { (void)rclc_executor_fini(&executor); }},
+    {[]() { return rclc_executor_add_subscription(&executor, &cmd_vel_subscriber, &twist_msg, &cmd_vel_subscription_callback, ON_NEW_DATA); }, nullptr},
+    {[]() { return rclc_executor_add_timer(&executor, &publish_timer); }, nullptr},
+#ifdef RUNTIME_CONFIG
+    {[]() { return rclc_publisher_init_default(&config_status_publisher, &node, ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, UInt8), "robot_config_status"); },
+     []() { (void)rcl_publisher_fini(&config_status_publisher, &node); }},
+    {[]() { return rclc_subscription_init_default(&config_subscriber, &node, ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, UInt8MultiArray), "robot_config"); },
+     []() { (void)rcl_subscription_fini(&config_subscriber, &node); }},
+    {[]() { return rclc_executor_add_subscription(&executor, &config_subscriber, &config_msg, &config_subscription_callback, ON_NEW_DATA); }, nullptr},
+#endif
+#ifdef ILC
+    {[]() { return rclc_subscription_init_default(&ilc_subscriber, &node, ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, UInt8), "ilc_run"); }, []() { (void)rcl_subscription_fini(&ilc_subscriber, &node); }},
+    {[]() { return rclc_executor_add_subscription(&executor, &ilc_subscriber, &ilc_msg, &ilc_subscription_callback, ON_NEW_DATA); }, nullptr},
+#endif
+};
+
+/**
+ * @brief Brings up Wi-Fi, the micro-ROS agent connection and all entities
+ * without blocking the control loop. Every step is retried until it succeeds,
+ * so a missing agent only delays the network side.
+ *
+ */
+class MicroRosBringUp : public roboost::timing::Coroutine
+{
+protected:
+    roboost::timing::CoroutineStatus run() override
+    {
+        CO_BEGIN();
+
+        network_log.log(roboost::logging::LogLevel::INFO, "Initializing transport...");
+        print_free_heap();
+        WiFi.begin(SSID, SSID_PW);
+        CO_AWAIT(WiFi.status() == WL_CONNECTED);
+
+        locator.address = IPAddress(AGENT_IP);
+        locator.port = AGENT_PORT;
+        rmw_uros_set_custom_transport(false, (void*)&locator, platformio_transport_open, platformio_transport_close, platformio_transport_write, platformio_transport_read);
+
+        network_log.log(roboost::logging::LogLevel::INFO, "Waiting for agent...");
+        while (rmw_uros_ping_agent(5, 1) != RMW_RET_OK)
+        {
+            CO_DELAY_MS(agent_ping_interval_ms);
+        }
+
+        allocator = rcl_get_default_allocator();
+
+        network_log.log(roboost::logging::LogLevel::INFO, "Initializing entities...");
+        print_free_heap();
+        for (step = 0; step < sizeof(micro_ros_bring_up_steps) / sizeof(micro_ros_bring_up_steps[0]); step++)
+        {
+            while (micro_ros_bring_up_steps[step].init() != RCL_RET_OK)
+            {
+                network_log.log(roboost::logging::LogLevel::WARNING, "Bring-up step %u failed, retrying", static_cast<unsigned>(step));
+                if (micro_ros_bring_up_steps[step].fini != nullptr)
+                {
+                    micro_ros_bring_up_steps[step].fini();
+                }
+                CO_DELAY_MS(bring_up_retry_interval_ms);
+            }
+            CO_YIELD();
+        }
+
+        init_odometry_msg();
+#ifdef IMU
+        init_imu_msg();
+#endif
+
+        micro_ros_ready = true;
+        boot_micro_ros_ready_us = system_clock.now_us();
+        network_log.log(roboost::logging::LogLevel::INFO, "Ready after %lu us", static_cast<unsigned long>(boot_micro_ros_ready_us));
+
+        CO_END();
+    }
+
+private:
+    struct micro_ros_agent_locator locator;
+    size_t step = 0;
+};
+
+MicroRosBringUp micro_ros_bring_up;
+
+/**
+ * @brief Setup function for initializing the hardware and the control loop.
+ * micro-ROS is brought up in the background afterwards.
  *
  */
 void setup()
@@ -151,18 +481,143 @@ void setup()
     // Setup Timingservice
     timing_service.reset();
 
-    // set_microros_serial_transports(Serial);
+#ifdef RUNTIME_CONFIG
+    Serial.print("Robot configuration: ");
+    Serial.print(roboost::config::to_string(config_load_status));
+    Serial.print(config_load_status == roboost::config::ConfigStatus::OK ? " (from NVS, " : " (using conf_hardware.h, ");
+    Serial.print(config_load_time_us);
+    Serial.println("us)");
+
+    config_msg.data.data = config_msg_buffer;
+    config_msg.data.capacity = sizeof(config_msg_buffer);
+    config_msg.data.size = 0;
+#endif
+
+#ifdef IMU
+    // Without the sensor the odometry falls back to the wheel yaw rate
+    imu_available = imu.begin();
+    if (!imu_available)
+    {
+        Serial.println("MPU6050 not found, using wheel odometry only");
+    }
+#endif
 
-    init_microros();
+    // Hold the robot still until the first command arrives
+    robot_controller.set_latest_command(Eigen::Vector3d::Zero());
 
-    timing_service.addTask([]() { robot_controller.update(); }, TIMING_MS_TO_US(20), TIMING_MS_TO_US(50),
-                           "Contoller update"); // Update robot controller every
-                                                // 20ms with a timeout of 50ms
+#ifdef WATCHDOG
+    control_watchdog_id = watchdog.add_task("Contoller update", TIMING_MS_TO_US(control_watchdog_deadline_ms), roboost::timing::WatchdogAction::RESET, system_clock.now_us());
+    executor_watchdog_id = watchdog.add_task("Executor spin", TIMING_MS_TO_US(1000), roboost::timing::WatchdogAction::RESTART_TASK, system_clock.now_us());
+    telemetry_watchdog_id = watchdog.add_task("Robot state", TIMING_MS_TO_US(3000), roboost::timing::WatchdogAction::LOG, system_clock.now_us());
+#endif
 
-    timing_service.addTask([]() { RCSOFTCHECK(rclc_executor_spin_some(&executor, RCL_MS_TO_NS(100))); }, TIMING_MS_TO_US(200), TIMING_MS_TO_US(500), "Executor spin");
+    control_task_id = add_monitored_task(
+        [](const roboost::timing::TimingContext& timing)
+        {
+            const auto& command = cmd_vel_timeout.update(timing.get_sample_time_us());
+#ifdef ILC
+            // Runs start and end between two ticks, learning from a finished run takes a few thousand multiply-adds
+            const int ilc_id = ilc_request.exchange(-1, std::memory_order_relaxed);
+            if (ilc_id == 0)
+            {
+                ilc.finish();
+            }
+            else if (ilc_id > 0)
+            {
+                ilc.start(static_cast<uint8_t>(ilc_id));
+            }
+            // Without fresh commands the robot no longer follows the trajectory
+            if (cmd_vel_timeout.is_expired())
+            {
+                ilc.abort();
+            }
+            const float* feedforward = ilc.get_feedforward();
+            Eigen::Vector3d robot_command(command[0] + feedforward[0], command[1] + feedforward[1], command[2] + feedforward[2]);
+#else
+            Eigen::Vector3d robot_command(command[0], command[1], command[2]);
+#endif
+#ifdef WHEEL_SYNCHRONIZATION
+            // The encoders hold the response to the previous command, the correction acts one period later like the ILC lead
+            const Eigen::Vector4d wheel_setpoints = kinematics.calculate_wheel_velocity(robot_command);
+            std::array<float, MOTOR_COUNT> setpoints, measured;
+            for (size_t i = 0; i < MOTOR_COUNT; i++)
+            {
+                setpoints[i] = static_cast<float>(wheel_setpoints[i]);
+                measured[i] = static_cast<float>(encoders[i].get_velocity());
+            }
+            wheel_synchronizer.update(setpoints, measured, timing.get_dt());
+            const auto& correction = wheel_synchronizer.get_correction();
+            robot_command += Eigen::Vector3d(correction[0], correction[1], correction[2]);
+#endif
+#ifdef WATCHDOG
+            if (safe_stop_latched.load(std::memory_order_relaxed))
+            {
+                robot_command.setZero();
+#ifdef ILC
+                ilc.abort();
+#endif
+#ifdef WHEEL_SYNCHRONIZATION
+                wheel_synchronizer.reset();
+#endif
+            }
+#endif
+            robot_controller.set_latest_command(robot_command);
+            robot_controller.update();
+#ifdef ILC
+            const Eigen::Vector3d robot_velocity = robot_controller.get_robot_vel();
+            const float ilc_error[3] = {static_cast<float>(command[0] - robot_velocity(0)), static_cast<float>(command[1] - robot_velocity(1)),
+                                        static_cast<float>(command[2] - robot_velocity(2))};
+            ilc.record(ilc_error);
+#endif
+#ifdef IMU
+            update_heading_fusion(timing.get_dt());
+#endif
+            if (boot_first_control_tick_us == 0)
+            {
+                boot_first_control_tick_us = timing.get_sample_time_us();
+            }
+        },
+        control_period_us, TIMING_MS_TO_US(50), "Contoller update", TIMING_MS_TO_US(2),
+        WATCHDOG_HEARTBEAT(control_watchdog_id)); // Update robot controller every
+                                                  // 20ms with a timeout of 50ms
 
-    timing_service.addTask(
-        []()
+    // set_microros_serial_transports(Serial);
+
+    coroutine_runner.add(micro_ros_bring_up);
+    add_monitored_task(
+        [](const roboost::timing::TimingContext& timing)
+        {
+#ifdef WATCHDOG
+            // The entities are torn down here, never while the executor spins
+            if (network_restart_requested.exchange(false) && micro_ros_ready)
+            {
+                micro_ros_ready = false;
+                destroy_micro_ros_entities();
+                coroutine_runner.add(micro_ros_bring_up);
+            }
+#endif
+            // The coroutine delays are short and wrap-safe in 32 bit
+            coroutine_runner.update(static_cast<uint32_t>(timing.get_sample_time_us()));
+        },
+        TIMING_MS_TO_US(10), TIMING_MS_TO_US(50), "Network bring-up", TIMING_MS_TO_US(5));
+
+    // Only failed spins count as missed heartbeats, the bring-up retries on its own
+    static roboost::timing::Heartbeat* executor_heartbeat = WATCHDOG_HEARTBEAT(executor_watchdog_id);
+    add_monitored_task(
+        [](const roboost::timing::TimingContext&)
+        {
+            if (!micro_ros_ready || rclc_executor_spin_some(&executor, RCL_MS_TO_NS(executor_spin_timeout_ms)) == RCL_RET_OK)
+            {
+                if (executor_heartbeat != nullptr)
+                {
+                    executor_heartbeat->beat();
+                }
+            }
+        },
+        TIMING_MS_TO_US(200), TIMING_MS_TO_US(500), "Executor spin", TIMING_MS_TO_US(5));
+
+    add_monitored_task(
+        [](const roboost::timing::TimingContext&)
         {
             Serial.print("vx: ");
             Serial.print(robot_controller.get_robot_vel()(0));
@@ -171,8 +626,9 @@ void setup()
             Serial.print(" vtheta: ");
             Serial.print(robot_controller.get_robot_vel()(2));
             Serial.print(" dt: ");
-            Serial.print(timing_service.get_delta_time());
-            Serial.print("us");
+            Serial.print(task_timing[control_task_id].get_period_us());
+            Serial.print("us overruns: ");
+            Serial.print(task_timing[control_task_id].get_overrun_count());
 
             Serial.print(" wanted:: vx: ");
             Serial.print(robot_controller.get_wheel_vel_setpoints()(0));
@@ -180,8 +636,58 @@ void setup()
             Serial.print(robot_controller.get_wheel_vel_setpoints()(1));
             Serial.print(" vtheta: ");
             Serial.println(robot_controller.get_wheel_vel_setpoints()(2));
+
+            Serial.print("utilization: ");
+            Serial.print(admission_control.get_utilization());
+            Serial.print(" min slack: ");
+            Serial.print(admission_control.get_min_slack());
+            Serial.println(admission_control.is_feasible() ? "us" : "us (task set infeasible!)");
+
+            Serial.print("cmd_vel timeouts: ");
+            Serial.print(cmd_vel_timeout.get_timeout_count());
+            Serial.print(" last stop: ");
+            Serial.print(cmd_vel_timeout.get_last_stop_latency_us());
+            Serial.print("us max stop: ");
+            Serial.print(cmd_vel_timeout.get_max_stop_latency_us());
+            Serial.println(cmd_vel_timeout.is_stopping() ? "us (stopping)" : "us");
+
+#ifdef DISTURBANCE_OBSERVER
+            Serial.print("load torque:");
+            for (const CompensatedDriver& driver : compensated_drivers)
+            {
+                Serial.print(" ");
+                Serial.print(driver.get_observer().get_load_torque(), 4);
+            }
+            Serial.println(" Nm");
+#endif
+
+#ifdef ILC
+            if (ilc.is_running())
+            {
+                Serial.print("ILC trajectory: ");
+                Serial.print(ilc.get_active_id());
+                Serial.print(" sample: ");
+                Serial.print(ilc.get_sample());
+                Serial.print(" runs: ");
+                Serial.print(ilc.get_iterations(ilc.get_active_id()));
+                Serial.print(" last rms error: ");
+                Serial.println(ilc.get_rms_error(ilc.get_active_id()), 4);
+            }
+#endif
+
+            Serial.print("boot: first control tick: ");
+            Serial.print(boot_first_control_tick_us);
+            Serial.print("us micro-ROS ready: ");
+            Serial.print(boot_micro_ros_ready_us);
+            Serial.print("us first odometry: ");
+            Serial.print(boot_first_odom_us);
+            Serial.println("us");
         },
-        TIMING_MS_TO_US(1000), TIMING_MS_TO_US(2000), "Robot state");
+        TIMING_MS_TO_US(1000), TIMING_MS_TO_US(2000), "Robot state", TIMING_MS_TO_US(2), WATCHDOG_HEARTBEAT(telemetry_watchdog_id));
+
+#ifdef WATCHDOG
+    start_watchdog();
+#endif
 }
 
 /**
@@ -191,6 +697,189 @@ void setup()
  */
 void loop() { timing_service.update(); }
 
+/**
+ * @brief Register a task with the timing service after checking that the task
+ * set stays schedulable. The execution time of every call is measured and fed
+ * back into the analysis, the callback gets the timing context of its own
+ * task.
+ *
+ * @param callback Task function
+ * @param period Period in microseconds
+ * @param timeout Timeout in microseconds
+ * @param name Name of the task
+ * @param wcet_estimate Initial estimate of the execution time in microseconds
+ * @param heartbeat Beaten after every call if the task is supervised by the
+ * watchdog
+ * @return int Id of the task, -1 if the task was rejected
+ */
+int add_monitored_task(std::function<void(const roboost::timing::TimingContext&)> callback, uint32_t period, uint32_t timeout, const char* name, uint32_t wcet_estimate,
+                       roboost::timing::Heartbeat* heartbeat)
+{
+    int id = admission_control.add_task(name, period, period, wcet_estimate);
+    if (id < 0)
+    {
+        task_log.log(roboost::logging::LogLevel::ERROR, "%s rejected by admission control", name);
+        return -1;
+    }
+    task_timing[id] = roboost::timing::TimingContext(period, timeout);
+    if (!admission_control.is_feasible())
+    {
+        task_log.log(roboost::logging::LogLevel::WARNING, "Task set not schedulable after adding %s", name);
+    }
+
+    timing_service.addTask(
+        [callback, id, heartbeat]()
+        {
+            const bool was_feasible = admission_control.is_feasible();
+            roboost::timing::TimingContext& timing = task_timing[id];
+            timing.tick(system_clock.now_us());
+            callback(timing);
+            if (heartbeat != nullptr)
+            {
+                heartbeat->beat();
+            }
+            if (!admission_control.update_wcet(id, static_cast<uint32_t>(system_clock.now_us() - timing.get_sample_time_us())) && was_feasible)
+            {
+                task_log.log(roboost::logging::LogLevel::WARNING, "Task set became infeasible, slack: %ld", static_cast<long>(admission_control.get_slack(id)));
+            }
+        },
+        period, timeout, name);
+    return id;
+}
+
+#ifdef WATCHDOG
+/**
+ * @brief Start the supervisor task and subscribe it to the hardware task
+ * watchdog. Called after all supervised tasks are registered.
+ *
+ */
+void start_watchdog()
+{
+    watchdog.set_handler(watchdog_handler);
+
+    // The Arduino core already initialized the TWDT, this only reconfigures it
+    esp_task_wdt_init(hardware_watchdog_timeout_s, true);
+    xTaskCreate(watchdog_task, "Watchdog", 3072, NULL, 2, NULL);
+}
+
+/**
+ * @brief Supervisor task. Runs above the loop task so it also preempts a hung
+ * control loop, and feeds the hardware watchdog only while every task capped
+ * at RESET is healthy. If the control loop stays overdue for
+ * hardware_watchdog_timeout_s, e.g. because the handler itself cannot run, the
+ * chip is reset by the hardware. Late executor spins and telemetry never
+ * reset the chip.
+ *
+ * @param parameters Unused
+ */
+void watchdog_task(void* parameters)
+{
+    esp_task_wdt_add(NULL);
+    TickType_t last_wake = xTaskGetTickCount();
+    for (;;)
+    {
+        if (watchdog.check(system_clock.now_us()))
+        {
+            esp_task_wdt_reset();
+        }
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(watchdog_check_interval_ms));
+    }
+}
+
+/**
+ * @brief Escalation of the supervisor. Every deadline a task misses takes the
+ * next action, up to the maximum of the task:
+ * Contoller update: log, safe stop, reset.
+ * Executor spin: log, safe stop, restart of the micro-ROS bring-up.
+ * Robot state: log.
+ *
+ * @param task_id Id of the overdue task
+ * @param action Action to take, NONE if the task recovered
+ */
+void watchdog_handler(size_t task_id, roboost::timing::WatchdogAction action)
+{
+    using roboost::logging::LogLevel;
+    using roboost::timing::WatchdogAction;
+
+    const char* name = watchdog.get_name(task_id);
+    switch (action)
+    {
+    case WatchdogAction::NONE:
+        watchdog_log.log(LogLevel::INFO, "%s recovered", name);
+        break;
+    case WatchdogAction::LOG:
+        watchdog_log.log(LogLevel::WARNING, "%s missed its deadline", name);
+        break;
+    case WatchdogAction::SAFE_STOP:
+        watchdog_log.log(LogLevel::WARNING, "%s overdue, stopping motors", name);
+        safe_stop_motors();
+        break;
+    case WatchdogAction::RESTART_TASK:
+        if (static_cast<int>(task_id) == executor_watchdog_id)
+        {
+            watchdog_log.log(LogLevel::WARNING, "%s overdue, restarting micro-ROS", name);
+            network_restart_requested = true;
+        }
+        else
+        {
+            watchdog_log.log(LogLevel::WARNING, "%s overdue", name);
+        }
+        break;
+    case WatchdogAction::RESET:
+        watchdog_log.log(LogLevel::ERROR, "%s overdue, resetting", name);
+        Serial.flush();
+        esp_restart();
+        break;
+    }
+}
+
+/**
+ * @brief Cut the motor outputs directly, the control loop may be the task that
+ * hangs. The latch holds the robot still until a new command arrives.
+ *
+ */
+void safe_stop_motors()
+{
+    safe_stop_latched = true;
+    for (const auto& motor : robot_config.motors)
+    {
+        ledcWrite(motor.pwm_channel, 0);
+        digitalWrite(motor.in1, LOW);
+        digitalWrite(motor.in2, LOW);
+    }
+}
+
+/**
+ * @brief Release all micro-ROS entities so the bring-up can create them again.
+ * The session is destroyed without waiting for the agent, which is usually
+ * the reason for the restart.
+ *
+ */
+void destroy_micro_ros_entities()
+{
+    rmw_context_t* rmw_context = rcl_context_get_rmw_context(&support.context);
+    (void)rmw_uros_set_context_entity_destroy_session_timeout(rmw_context, 0);
+
+#ifdef ILC
+    RCSOFTCHECK(rcl_subscription_fini(&ilc_subscriber, &node));
+#endif
+#ifdef RUNTIME_CONFIG
+    RCSOFTCHECK(rcl_subscription_fini(&config_subscriber, &node));
+    RCSOFTCHECK(rcl_publisher_fini(&config_status_publisher, &node));
+#endif
+    RCSOFTCHECK(rcl_subscription_fini(&cmd_vel_subscriber, &node));
+    RCSOFTCHECK(rcl_timer_fini(&sync_timer));
+    RCSOFTCHECK(rcl_timer_fini(&publish_timer));
+#ifdef IMU
+    RCSOFTCHECK(rcl_publisher_fini(&imu_publisher, &node));
+#endif
+    RCSOFTCHECK(rcl_publisher_fini(&odom_publisher, &node));
+    RCSOFTCHECK(rclc_executor_fini(&executor));
+    RCSOFTCHECK(rcl_node_fini(&node));
+    RCSOFTCHECK(rclc_support_fini(&support));
+}
+#endif
+
 void print_free_heap()
 {
     Serial.print("free heap: ");
@@ -201,55 +890,6 @@ void print_free_heap()
     Serial.println(ESP.getFreeHeap() - ESP.getMinFreeHeap());
 }
 
-void init_microros()
-{
-
-    IPAddress agent_ip(AGENT_IP);
-    uint16_t agent_port = AGENT_PORT;
-    Serial.println("Initializing micro-ROS transport...");
-    print_free_heap();
-    set_microros_wifi_transports((char*)SSID, (char*)SSID_PW, agent_ip, agent_port);
-
-    allocator = rcl_get_default_allocator();
-
-    Serial.println("Initializing micro-ROS node...");
-    print_free_heap();
-    INIT(rclc_support_init(&support, 0, NULL, &allocator));
-    INIT(rclc_node_init_default(&node, "roboost_pmc_node", "", &support));
-
-    Serial.println("Initializing micro-ROS publishers...");
-    print_free_heap();
-    // INIT(rclc_publisher_init_default(&odom_publisher, &node,
-    // ROSIDL_GET_MSG_TYPE_SUPPORT(nav_msgs, msg, Odometry), "odom"));
-    // Serial.println("Odometry publisher initialized");
-    // INIT(rclc_publisher_init_default(&joint_state_publisher, &node,
-    // ROSIDL_GET_MSG_TYPE_SUPPORT(sensor_msgs, msg, JointState),
-    // "joint_states")); Serial.println("Joint state publisher initialized");
-    // INIT(rclc_publisher_init_default(&wanted_joint_state_publisher, &node,
-    // ROSIDL_GET_MSG_TYPE_SUPPORT(sensor_msgs, msg, JointState),
-    // "wanted_joint_states")); Serial.println("Wanted joint state publisher
-    // initialized");
-
-    Serial.println("Initializing micro-ROS timers...");
-    print_free_heap();
-    // INIT(rclc_timer_init_default(&publish_timer, &support, RCL_MS_TO_NS(100),
-    // pub_timer_callback));
-    INIT(rclc_timer_init_default(&sync_timer, &support, RCL_MS_TO_NS(time_sync_interval), sync_timer_callback));
-
-    Serial.println("Initializing micro-ROS subscriptions...");
-    print_free_heap();
-    INIT(rclc_subscription_init_default(&cmd_vel_subscriber, &node, ROSIDL_GET_MSG_TYPE_SUPPORT(geometry_msgs, msg, Twist), "cmd_vel"));
-
-    Serial.println("Adding subscriptions to the executor...");
-    print_free_heap();
-    INIT(rclc_executor_init(&executor, &support.context, 3, &allocator));
-    INIT(rclc_executor_add_subscription(&executor, &cmd_vel_subscriber, &twist_msg, &cmd_vel_subscription_callback, ON_NEW_DATA));
-
-    // init_odometry_msg();
-    // init_joint_state_msg();
-    // init_wanted_joint_state_msg();
-}
-
 /**
  * @brief Initialize the odometry message.
  *
@@ -337,76 +977,69 @@ void cmd_vel_subscription_callback(const void* msgin)
     smoothed_cmd_vel(1) = cmd_vel_filter_y.update(msg->linear.y);
     smoothed_cmd_vel(2) = cmd_vel_filter_theta.update(msg->angular.z);
 
+#if !defined(LQR_CONTROL) && !defined(MPC_CONTROL)
     // Based on max velocity multiply the ki value by a factor
     if (abs(smoothed_cmd_vel(0)) > 0.5 || abs(smoothed_cmd_vel(1)) > 0.5)
     {
-        for (int i = 0; i < MOTOR_COUNT; i++)
+        for (size_t i = 0; i < MOTOR_COUNT; i++)
         {
-            controllers[i].set_ki(base_ki * modifier_ki_linear);
+            controllers[i].set_ki(robot_config.motors[i].gains.ki * modifier_ki_linear);
         }
     }
     else if (abs(smoothed_cmd_vel(2)) > 1.0)
     {
-        for (int i = 0; i < MOTOR_COUNT; i++)
+        for (size_t i = 0; i < MOTOR_COUNT; i++)
         {
-            controllers[i].set_ki(base_ki * modifier_ki_rotational);
+            controllers[i].set_ki(robot_config.motors[i].gains.ki * modifier_ki_rotational);
         }
     }
     else
     {
-        for (int i = 0; i < MOTOR_COUNT; i++)
+        for (size_t i = 0; i < MOTOR_COUNT; i++)
         {
-            controllers[i].set_ki(base_ki);
+            controllers[i].set_ki(robot_config.motors[i].gains.ki);
         }
     }
-
-    robot_controller.set_latest_command(smoothed_cmd_vel);
+#endif
+
+#ifdef WATCHDOG
+    // A fresh command releases the safe stop
+    safe_stop_latched = false;
+#endif
+    // Applied by the control loop as long as it is fresh
+    const Eigen::Vector3d command = cmd_vel_desaturator.desaturate(smoothed_cmd_vel);
+    cmd_vel_timeout.set_command({static_cast<float>(command(0)), static_cast<float>(command(1)), static_cast<float>(command(2))}, system_clock.now_us());
 }
 
+#ifdef ILC
 /**
- * @brief Helper function to set the ROS timestamp for a message.
+ * @brief Callback function for the ilc_run messages. The id of a trajectory
+ * starts a run of it, 0 ends the current run. The control loop applies the
+ * request on its next tick.
  *
- * @param header Header of the message
- * @param sync_ms Synced time in milliseconds
- * @param sync_ns Nano second part of the synced time
+ * @param msgin std_msgs/UInt8 with the trajectory id
  */
-void set_ros_timestamp(std_msgs__msg__Header& header, unsigned long sync_ms, unsigned long sync_ns)
+void ilc_subscription_callback(const void* msgin)
 {
-    header.stamp.sec = (sync_ms + millis() - last_time_sync_ms) / 1000;
-    header.stamp.nanosec = sync_ns + (micros() * 1000 - last_time_sync_ns) % 1000000000;
+    const auto* msg = reinterpret_cast<const std_msgs__msg__UInt8*>(msgin);
+    ilc_request.store(msg->data, std::memory_order_relaxed);
 }
+#endif
 
 /**
- * @brief Helper function to publish joint states.
+ * @brief Helper function to set the ROS timestamp for a message. The time
+ * since the last sync is taken from the 64 bit timebase, so the stamps stay
+ * continuous however long the robot runs.
  *
- * @param velocities Vector of wheel velocities
- * @param dt Time step
- */
-void publish_joint_states(const Eigen::Vector4d& velocities, double dt)
-{
-    for (int i = 0; i < 4; i++)
-    {
-        joint_state_msg.position.data[i] += velocities(i) * dt;
-        joint_state_msg.velocity.data[i] = velocities(i);
-    }
-    set_ros_timestamp(joint_state_msg.header, synced_time_ms, synced_time_ns);
-    RCSOFTCHECK(rcl_publish(&joint_state_publisher, &joint_state_msg, NULL));
-}
-
-/**
- * @brief Helper function to publish desired joint states.
- *
- * @param velocities Vector of wheel velocities
- * @param dt Time step
+ * @param header Header of the message
+ * @param sync_ns Agent epoch at the last sync in nanoseconds
+ * @param sync_local_us Local time of the last sync in microseconds
  */
-void publish_wanted_joint_states(const Eigen::Vector4d& velocities, double dt)
+void set_ros_timestamp(std_msgs__msg__Header& header, int64_t sync_ns, uint64_t sync_local_us)
 {
-    for (int i = 0; i < 4; i++)
-    {
-        wanted_joint_state_msg.position.data[i] = velocities(i);
-    }
-    set_ros_timestamp(wanted_joint_state_msg.header, synced_time_ms, synced_time_ns);
-    RCSOFTCHECK(rcl_publish(&wanted_joint_state_publisher, &wanted_joint_state_msg, NULL));
+    const int64_t stamp_ns = sync_ns + static_cast<int64_t>(system_clock.now_us() - sync_local_us) * 1000;
+    header.stamp.sec = static_cast<int32_t>(stamp_ns / 1000000000);
+    header.stamp.nanosec = static_cast<uint32_t>(stamp_ns % 1000000000);
 }
 
 /**
@@ -417,27 +1050,30 @@ void publish_wanted_joint_states(const Eigen::Vector4d& velocities, double dt)
  */
 void update_odometry(const Eigen::Vector3d& velocity, double dt)
 {
-    pose(0) += velocity(0) * cos(pose(2)) * dt - velocity(1) * sin(pose(2)) * dt;
-    pose(1) += velocity(0) * sin(pose(2)) * dt + velocity(1) * cos(pose(2)) * dt;
-    pose(2) += velocity(2) * dt;
-    pose(2) = atan2(sin(pose(2)), cos(pose(2)));
+    // One sine and cosine of the heading per update, FAST_MATH also wraps the heading without atan2
+    const double cos_heading = OdometryMath::cos(pose(2));
+    const double sin_heading = OdometryMath::sin(pose(2));
+    pose(0) += (velocity(0) * cos_heading - velocity(1) * sin_heading) * dt;
+    pose(1) += (velocity(0) * sin_heading + velocity(1) * cos_heading) * dt;
+    pose(2) = OdometryMath::wrap_angle(pose(2) + velocity(2) * dt);
 
     odom_msg.pose.pose.position.x = pose(0);
     odom_msg.pose.pose.position.y = pose(1);
-    odom_msg.pose.pose.orientation.w = cos(pose(2) / 2.0);
-    odom_msg.pose.pose.orientation.z = sin(pose(2) / 2.0);
+    odom_msg.pose.pose.orientation.w = OdometryMath::cos(pose(2) / 2.0);
+    odom_msg.pose.pose.orientation.z = OdometryMath::sin(pose(2) / 2.0);
     odom_msg.twist.twist.linear.x = velocity(0);
     odom_msg.twist.twist.linear.y = velocity(1);
     odom_msg.twist.twist.angular.z = velocity(2);
 }
 
 /**
- * @brief Callback function for the publish timer.
+ * @brief Callback function for the odometry timer. Only publishes odometry, the
+ * joint state publishers are not brought up in this firmware.
  *
  * @param timer Timer object
  * @param last_call_time Last call time
  */
-void pub_timer_callback(rcl_timer_t* timer, int64_t last_call_time)
+void odom_timer_callback(rcl_timer_t* timer, int64_t last_call_time)
 {
     if (timer == NULL)
     {
@@ -445,41 +1081,93 @@ void pub_timer_callback(rcl_timer_t* timer, int64_t last_call_time)
         return;
     }
 
-    double dt = TIMING_US_TO_S_DOUBLE(timing_service.get_delta_time());
+    publish_timing.tick(system_clock.now_us());
+    const double dt = publish_timing.get_dt();
     Eigen::Vector3d robot_velocity = robot_controller.get_robot_vel();
 
-    // Update odometry
+#ifdef IMU
+    if (imu_available)
+    {
+        publish_fused_odometry(robot_velocity);
+    }
+    else
+    {
+        update_odometry(robot_velocity, dt);
+    }
+#else
     update_odometry(robot_velocity, dt);
-    set_ros_timestamp(odom_msg.header, synced_time_ms, synced_time_ns);
-    RCSOFTCHECK(rcl_publish(&odom_publisher, &odom_msg, NULL));
-
-    // Publish joint states
-    Eigen::Vector4d wheel_velocities = kinematics.calculate_wheel_velocity(robot_velocity);
-    publish_joint_states(wheel_velocities, dt);
+#endif
+    set_ros_timestamp(odom_msg.header, synced_time_ns, synced_local_us);
+    if (rcl_publish(&odom_publisher, &odom_msg, NULL) == RCL_RET_OK && boot_first_odom_us == 0)
+    {
+        boot_first_odom_us = system_clock.now_us();
+    }
+}
 
-    // Publish desired joint states
-    Eigen::Vector4d wanted_wheel_velocities = robot_controller.get_wheel_vel_setpoints();
-    publish_wanted_joint_states(wanted_wheel_velocities, dt);
+#ifdef IMU
+/**
+ * @brief Initialize the IMU message. The orientation is not estimated by the
+ * sensor, which is marked by -1 in the first covariance element.
+ *
+ */
+void init_imu_msg()
+{
+    imu_msg.header.frame_id.data = const_cast<char*>(imu_frame_id);
+    imu_msg.header.frame_id.size = strlen(imu_frame_id);
+    imu_msg.header.frame_id.capacity = imu_msg.header.frame_id.size + 1;
+    imu_msg.orientation_covariance[0] = -1.0;
 }
 
-void pub_callback()
+/**
+ * @brief Read the IMU and advance the fused odometry. Runs with the controller
+ * so that the heading is integrated at the control rate. The sensor is mounted
+ * flat with the z axis pointing up.
+ *
+ * @param dt Measured period of the controller task in seconds
+ */
+void update_heading_fusion(float dt)
 {
-    double dt = TIMING_US_TO_S_DOUBLE(timing_service.get_delta_time());
-    Eigen::Vector3d robot_velocity = robot_controller.get_robot_vel();
+    if (!imu_available)
+    {
+        return;
+    }
 
-    // Update odometry
-    update_odometry(robot_velocity, dt);
-    set_ros_timestamp(odom_msg.header, synced_time_ms, synced_time_ns);
-    RCSOFTCHECK(rcl_publish(&odom_publisher, &odom_msg, NULL));
+    // Without new samples the last averaged rate is reused
+    imu.update();
 
-    // Publish joint states
-    Eigen::Vector4d wheel_velocities = kinematics.calculate_wheel_velocity(robot_velocity);
-    publish_joint_states(wheel_velocities, dt);
+    Eigen::Vector3d robot_velocity = robot_controller.get_robot_vel();
+    fused_odometry.update(robot_velocity(0), robot_velocity(1), robot_velocity(2), imu.get_sample().angular_velocity[2], dt);
+}
 
-    // Publish desired joint states
-    Eigen::Vector4d wanted_wheel_velocities = robot_controller.get_wheel_vel_setpoints();
-    publish_wanted_joint_states(wanted_wheel_velocities, dt);
+/**
+ * @brief Fill the odometry message with the fused pose and publish the raw IMU
+ * data.
+ *
+ * @param velocity Robot velocity from the wheel odometry
+ */
+void publish_fused_odometry(const Eigen::Vector3d& velocity)
+{
+    const float heading = fused_odometry.get_heading();
+    odom_msg.pose.pose.position.x = fused_odometry.get_x();
+    odom_msg.pose.pose.position.y = fused_odometry.get_y();
+    odom_msg.pose.pose.orientation.w = OdometryMath::cos(heading / 2.0f);
+    odom_msg.pose.pose.orientation.z = OdometryMath::sin(heading / 2.0f);
+    odom_msg.pose.covariance[35] = heading_filter.get_heading_variance();
+    odom_msg.twist.twist.linear.x = velocity(0);
+    odom_msg.twist.twist.linear.y = velocity(1);
+    odom_msg.twist.twist.angular.z = fused_odometry.get_yaw_rate();
+
+    const roboost::sensors::ImuSample& sample = imu.get_sample();
+    imu_msg.angular_velocity.x = sample.angular_velocity[0];
+    imu_msg.angular_velocity.y = sample.angular_velocity[1];
+    imu_msg.angular_velocity.z = sample.angular_velocity[2];
+    imu_msg.linear_acceleration.x = sample.linear_acceleration[0];
+    imu_msg.linear_acceleration.y = sample.linear_acceleration[1];
+    imu_msg.linear_acceleration.z = sample.linear_acceleration[2];
+    set_ros_timestamp(imu_msg.header, synced_time_ns, synced_local_us);
+    RCSOFTCHECK(rcl_publish(&imu_publisher, &imu_msg, NULL));
 }
+#endif
 
 /**
  * @brief Callback function for the sync timer.
@@ -499,12 +1187,84 @@ void sync_timer_callback(rcl_timer_t* timer, int64_t last_call_time)
 
     if (rmw_uros_epoch_synchronized())
     {
-        // Get time in milliseconds or nanoseconds
-        synced_time_ms = rmw_uros_epoch_millis();
         synced_time_ns = rmw_uros_epoch_nanos();
+        synced_local_us = system_clock.now_us();
     }
     else
     {
         Serial.println("Error in sync_timer_callback: time not synchronized\n");
     }
-}
\ No newline at end of file
+}
+
+#ifdef RUNTIME_CONFIG
+/**
+ * @brief Load the robot configuration from NVS. Runs during static
+ * initialization, before initArduino, so NVS is initialized here. The time is
+ * read with now_us64() because system_clock is not initialized yet.
+ *
+ * @return RobotConfig Stored configuration, or the defaults if there is none
+ * or it is invalid. The result is kept in config_load_status.
+ */
+RobotConfig load_robot_config()
+{
+    const uint64_t start_us = roboost::timing::now_us64();
+    RobotConfig config = default_robot_config;
+    uint8_t blob[roboost::config::serialized_size<MOTOR_COUNT>()];
+    size_t size = sizeof(blob);
+    nvs_handle_t handle;
+
+    if (nvs_flash_init() == ESP_OK && nvs_open(config_nvs_namespace, NVS_READONLY, &handle) == ESP_OK)
+    {
+        // A blob of a different size fails with ESP_ERR_NVS_INVALID_LENGTH
+        const esp_err_t err = nvs_get_blob(handle, config_nvs_key, blob, &size);
+        nvs_close(handle);
+        if (err == ESP_OK)
+        {
+            config_load_status = roboost::config::deserialize(blob, size, config, config_reserved_pins, config_reserved_pin_count);
+        }
+        else if (err == ESP_ERR_NVS_INVALID_LENGTH)
+        {
+            config_load_status = roboost::config::ConfigStatus::WRONG_MOTOR_COUNT;
+        }
+    }
+    config_load_time_us = static_cast<unsigned long>(roboost::timing::now_us64() - start_us);
+    return config;
+}
+
+/**
+ * @brief Validate a received configuration, store it in NVS and restart so the
+ * motor stack is rebuilt from it. Invalid blobs are rejected without touching
+ * the stored configuration.
+ *
+ * @param msgin std_msgs/UInt8MultiArray with the serialized configuration
+ */
+void config_subscription_callback(const void* msgin)
+{
+    const auto* msg = reinterpret_cast<const std_msgs__msg__UInt8MultiArray*>(msgin);
+
+    RobotConfig config = robot_config;
+    roboost::config::ConfigStatus status = roboost::config::deserialize(msg->data.data, msg->data.size, config, config_reserved_pins, config_reserved_pin_count);
+
+    nvs_handle_t handle;
+    bool stored = false;
+    if (status == roboost::config::ConfigStatus::OK && nvs_open(config_nvs_namespace, NVS_READWRITE, &handle) == ESP_OK)
+    {
+        stored = nvs_set_blob(handle, config_nvs_key, msg->data.data, msg->data.size) == ESP_OK && nvs_commit(handle) == ESP_OK;
+        nvs_close(handle);
+    }
+
+    config_status_msg.data = static_cast<uint8_t>(status);
+    RCSOFTCHECK(rcl_publish(&config_status_publisher, &config_status_msg, NULL));
+
+    Serial.print("Received robot configuration: ");
+    Serial.println(roboost::config::to_string(status));
+    if (stored)
+    {
+        Serial.println("Configuration stored, restarting");
+        robot_controller.set_latest_command(Eigen::Vector3d::Zero());
+        robot_controller.update();
+        Serial.flush();
+        ESP.restart();
+    }
+}
+#endif
@@ -16,6 +16,7 @@
 #include <Arduino.h>
 #include <ArduinoEigen.h>
 #include <micro_ros_platformio.h>
+#include <rmw_microros/rmw_microros.h>
 
 #include "rcl_checks.h"
 #include <rcl/rcl.h>
@@ -28,6 +29,9 @@
 #include <nav_msgs/msg/odometry.h>
 #include <sensor_msgs/msg/joint_state.h>
 
+#include <roboost/utils/fast_math.hpp>
+#include <roboost/utils/timebase.hpp>
+#include <roboost/utils/timing_context.hpp>
 #include <utils/diagnostics.hpp>
 #include <utils/initialization.hpp>
 #include <utils/timing.hpp>
@@ -40,38 +44,32 @@
 #include "motor_control/simple_motor_controller.hpp"
 #include "robot_controller.hpp"
 
-#define MOTOR_COUNT 4
+auto drivers = roboost::motor_control::make_motor_drivers<L298NMotorDriver>(ROBOT_MOTORS);
 
-L298NMotorDriver drivers[MOTOR_COUNT] = {{M0_IN1, M0_IN2, M0_ENA, M0_PWM_CNL}, {M1_IN1, M1_IN2, M1_ENA, M1_PWM_CNL}, {M2_IN1, M2_IN2, M2_ENA, M2_PWM_CNL}, {M3_IN1, M3_IN2, M3_ENA, M3_PWM_CNL}};
+auto encoders = roboost::motor_control::make_encoders<HalfQuadEncoder>(ROBOT_MOTORS);
 
-HalfQuadEncoder encoders[MOTOR_COUNT] = {
-    {M0_ENC_A, M0_ENC_B, M0_ENC_RESOLUTION}, {M1_ENC_A, M1_ENC_B, M1_ENC_RESOLUTION}, {M2_ENC_A, M2_ENC_B, M2_ENC_RESOLUTION}, {M3_ENC_A, M3_ENC_B, M3_ENC_RESOLUTION}};
-
-constexpr double base_kp = 0.105;
-constexpr double base_ki = 0.125;
 constexpr double modifier_ki_linear = 2.0;
 constexpr double modifier_ki_rotational = 1.1;
-constexpr double base_kd = 0.005;
 constexpr double max_expected_sampling_time = 0.2;
 constexpr double max_integral = 5.2;
 
-PIDController controllers[MOTOR_COUNT] = {{base_kp, base_ki, base_kd, max_expected_sampling_time, max_integral},
-                                          {base_kp, base_ki, base_kd, max_expected_sampling_time, max_integral},
-                                          {base_kp, base_ki, base_kd, max_expected_sampling_time, max_integral},
-                                          {base_kp, base_ki, base_kd, max_expected_sampling_time, max_integral}};
+auto controllers = roboost::motor_control::make_pid_controllers<PIDController>(ROBOT_MOTORS, max_expected_sampling_time, max_integral);
 
-NoFilter encoder_input_filters[MOTOR_COUNT] = {NoFilter(), NoFilter(), NoFilter(), NoFilter()};
+std::array<NoFilter, MOTOR_COUNT> encoder_input_filters;
 
-NoFilter motor_output_filters[MOTOR_COUNT] = {NoFilter(), NoFilter(), NoFilter(), NoFilter()};
+std::array<NoFilter, MOTOR_COUNT> motor_output_filters;
 
 static double MIN_OUTPUT = 0.35;
 
-VelocityController motor_controllers[MOTOR_COUNT] = {{drivers[0], encoders[0], controllers[0], encoder_input_filters[0], motor_output_filters[0], MIN_OUTPUT},
-                                                     {drivers[1], encoders[1], controllers[1], encoder_input_filters[1], motor_output_filters[1], MIN_OUTPUT},
-                                                     {drivers[2], encoders[2], controllers[2], encoder_input_filters[2], motor_output_filters[2], MIN_OUTPUT},
-                                                     {drivers[3], encoders[3], controllers[3], encoder_input_filters[3], motor_output_filters[3], MIN_OUTPUT}};
+#ifdef FAST_MATH
+using OdometryMath = roboost::math::PolynomialMath;
+#else
+using OdometryMath = roboost::math::LibmMath;
+#endif
+
+auto motor_controllers = roboost::motor_control::make_motor_controllers<VelocityController>(drivers, encoders, controllers, encoder_input_filters, motor_output_filters, MIN_OUTPUT);
 
-MotorControllerManager motor_control_manager{&motor_controllers[0], &motor_controllers[1], &motor_controllers[2], &motor_controllers[3]};
+auto motor_control_manager = roboost::motor_control::make_motor_controller_manager<MotorControllerManager>(motor_controllers);
 
 MecanumKinematics4W kinematics(WHEEL_RADIUS, WHEEL_BASE, TRACK_WIDTH);
 RobotVelocityController robot_controller(motor_control_manager, &kinematics);
@@ -100,15 +98,19 @@ rcl_node_t node;
 unsigned long last_time = 0;
 Eigen::Vector3d pose = Eigen::Vector3d::Zero();
 
-unsigned long last_time_sync_ms = 0;
-unsigned long last_time_sync_ns = 0;
 const unsigned long time_sync_interval = 1000;
 const int sync_timeout_ms = 500;
-int64_t synced_time_ms = 0;
+// Agent epoch at the last sync and the local time it was received at
 int64_t synced_time_ns = 0;
+uint64_t synced_local_us = 0;
 
 Scheduler& timing_service = Scheduler::get_instance();
 
+// Every periodic task measures its own period, the scheduler's delta time
+// belongs to whichever of its tasks ran last
+roboost::timing::TimingContext control_timing(TIMING_MS_TO_US(20));
+roboost::timing::TimingContext publish_timing(TIMING_MS_TO_US(100));
+
 // Predefined global or static data
 static const char* odom_frame_id = "odom";
 static const char* base_link_frame_id = "base_link";
@@ -119,7 +121,7 @@ static const double default_covariance[36] = {0.8, 0, 0, 0, 0, 0, 0, 0, 0.8, 0,
 
 // Function prototypes
 void cmd_vel_subscription_callback(const void* msgin);
-void set_ros_timestamp(std_msgs__msg__Header& header, unsigned long sync_ms, unsigned long sync_ns);
+void set_ros_timestamp(std_msgs__msg__Header& header, int64_t sync_ns, uint64_t sync_local_us);
 void publish_joint_states(const Eigen::Vector4d& velocities, double dt);
 void update_odometry(const Eigen::Vector3d& velocity, double dt);
 void pub_timer_callback(rcl_timer_t* timer, int64_t last_call_time);
@@ -128,18 +130,59 @@ void init_odometry_msg();
 void init_joint_state_msg();
 void init_wanted_joint_state_msg();
 void init_microros();
-void pub_callback();
 
 SemaphoreHandle_t dataMutex;
 
+const unsigned long agent_ping_interval_ms = 200;
+const unsigned long bring_up_retry_interval_ms = 500;
+
+/**
+ * @brief One rcl call of the bring-up and the cleanup of its entity, like in
+ * serial-roboost.cpp. A failed step is finalized before it is retried, steps
+ * that only register an entity with the executor have no fini.
+ */
+struct MicroRosBringUpStep
+{
+    rcl_ret_t (*init)();
+    void (*fini)();
+};
+
+// Entity creation in the order required by rclc, the executor handles cmd_vel and the publish timer
+const MicroRosBringUpStep micro_ros_bring_up_steps[] = {
+    {[]() { return rclc_support_init(&support, 0, NULL, &allocator); }, []() { (void)rclc_support_fini(&support); }},
+    {[]() { return rclc_node_init_default(&node, "roboost_pmc_node", "", &support); }, []() { (void)rcl_node_fini(&node); }},
+    {[]() { return rclc_publisher_init_default(&odom_publisher, &node, ROSIDL_GET_MSG_TYPE_SUPPORT(nav_msgs, msg, Odometry), "odom"); }, []() { (void)rcl_publisher_fini(&odom_publisher, &node); }},
+    {[]() { return rclc_publisher_init_default(&joint_state_publisher, &node, ROSIDL_GET_MSG_TYPE_SUPPORT(sensor_msgs, msg, JointState), "joint_states"); },
+     []() { (void)rcl_publisher_fini(&joint_state_publisher, &node); }},
+    {[]() { return rclc_publisher_init_default(&wanted_joint_state_publisher, &node, ROSIDL_GET_MSG_TYPE_SUPPORT(sensor_msgs, msg, JointState), "wanted_joint_states"); },
+     []() { (void)rcl_publisher_fini(&wanted_joint_state_publisher, &node); }},
+    {[]() { return rclc_timer_init_default(&publish_timer, &support, RCL_MS_TO_NS(100), pub_timer_callback); }, []() { (void)rcl_timer_fini(&publish_timer); }},
+    {[]() { return rclc_timer_init_default(&sync_timer, &support, RCL_MS_TO_NS(time_sync_interval), sync_timer_callback); }, []() { (void)rcl_timer_fini(&sync_timer); }},
+    {[]() { return rclc_subscription_init_default(&cmd_vel_subscriber, &node, ROSIDL_GET_MSG_TYPE_SUPPORT(geometry_msgs, msg, Twist), "cmd_vel"); },
+     []() { (void)rcl_subscription_fini(&cmd_vel_subscriber, &node); }},
+    {[]() { return rclc_executor_init(&executor, &support.context, 3, &allocator); }, []() { (void)rclc_executor_fini(&executor); }},
+    {[]() { return rclc_executor_add_subscription(&executor, &cmd_vel_subscriber, &twist_msg, &cmd_vel_subscription_callback, ON_NEW_DATA); }, nullptr},
+    {[]() { return rclc_executor_add_timer(&executor, &publish_timer); }, nullptr},
+};
+
+// Boot instrumentation, times since power-on in microseconds
+uint64_t boot_first_control_tick_us = 0;
+uint64_t boot_micro_ros_ready_us = 0;
+uint64_t boot_first_odom_us = 0;
+
 void robotControllerTask(void* pvParameters)
 {
     while (true)
     {
         if (xSemaphoreTake(dataMutex, pdMS_TO_TICKS(100)) == pdTRUE)
         {
+            control_timing.tick(roboost::timing::now_us64());
             robot_controller.update();
             xSemaphoreGive(dataMutex);
+            if (boot_first_control_tick_us == 0)
+            {
+                boot_first_control_tick_us = control_timing.get_sample_time_us();
+            }
         }
         else
         {
@@ -152,6 +195,11 @@ void robotControllerTask(void* pvParameters)
 
 void microROSTask(void* pvParameters)
 {
+    // Network bring-up happens in this task so that the control loop on the
+    // other core is already running while Wi-Fi and the agent connect.
+    init_microros();
+    boot_micro_ros_ready_us = roboost::timing::now_us64();
+
     while (true)
     {
         if (xSemaphoreTake(dataMutex, pdMS_TO_TICKS(100)) == pdTRUE)
@@ -169,7 +217,8 @@ void microROSTask(void* pvParameters)
 }
 
 /**
- * @brief Setup function for initializing micro-ROS, pin modes, etc.
+ * @brief Setup function for initializing the hardware and the control loop.
+ * micro-ROS is brought up by the micro-ROS task afterwards.
  *
  */
 void setup()
@@ -181,9 +230,10 @@ void setup()
     // Setup Timingservice
     timing_service.reset();
 
-    // set_microros_serial_transports(Serial);
+    // Hold the robot still until the first command arrives
+    robot_controller.set_latest_command(Eigen::Vector3d::Zero());
 
-    init_microros();
+    // set_microros_serial_transports(Serial);
 
     // timing_service.addTask([]() {
     //     robot_controller.update();
@@ -204,8 +254,9 @@ void setup()
             Serial.print(" vtheta: ");
             Serial.print(robot_controller.get_robot_vel()(2));
             Serial.print(" dt: ");
-            Serial.print(timing_service.get_delta_time());
-            Serial.print("us");
+            Serial.print(control_timing.get_period_us());
+            Serial.print("us overruns: ");
+            Serial.print(control_timing.get_overrun_count());
 
             Serial.print(" wanted:: vx: ");
             Serial.print(robot_controller.get_wheel_vel_setpoints()(0));
@@ -213,6 +264,14 @@ void setup()
             Serial.print(robot_controller.get_wheel_vel_setpoints()(1));
             Serial.print(" vtheta: ");
             Serial.println(robot_controller.get_wheel_vel_setpoints()(2));
+
+            Serial.print("boot: first control tick: ");
+            Serial.print(boot_first_control_tick_us);
+            Serial.print("us micro-ROS ready: ");
+            Serial.print(boot_micro_ros_ready_us);
+            Serial.print("us first odometry: ");
+            Serial.print(boot_first_odom_us);
+            Serial.println("us");
         },
         TIMING_MS_TO_US(1000), TIMING_MS_TO_US(2000), "Robot state");
 
@@ -246,44 +305,44 @@ void print_free_heap()
     Serial.println(ESP.getFreeHeap() - ESP.getMinFreeHeap());
 }
 
+/**
+ * @brief Connect to Wi-Fi and the agent and create all entities. Runs in the
+ * micro-ROS task, so waiting for the agent and retrying failed steps does not
+ * hold up the control loop on the other core.
+ *
+ */
 void init_microros()
 {
-
     IPAddress agent_ip(AGENT_IP);
     uint16_t agent_port = AGENT_PORT;
     Serial.println("Initializing micro-ROS transport...");
     print_free_heap();
     set_microros_wifi_transports((char*)SSID, (char*)SSID_PW, agent_ip, agent_port);
 
-    allocator = rcl_get_default_allocator();
-
-    Serial.println("Initializing micro-ROS node...");
-    print_free_heap();
-    INIT(rclc_support_init(&support, 0, NULL, &allocator));
-    INIT(rclc_node_init_default(&node, "roboost_pmc_node", "", &support));
-
-    Serial.println("Initializing micro-ROS publishers...");
-    print_free_heap();
-    INIT(rclc_publisher_init_default(&odom_publisher, &node, ROSIDL_GET_MSG_TYPE_SUPPORT(nav_msgs, msg, Odometry), "odom"));
-    Serial.println("Odometry publisher initialized");
-    INIT(rclc_publisher_init_default(&joint_state_publisher, &node, ROSIDL_GET_MSG_TYPE_SUPPORT(sensor_msgs, msg, JointState), "joint_states"));
-    Serial.println("Joint state publisher initialized");
-    INIT(rclc_publisher_init_default(&wanted_joint_state_publisher, &node, ROSIDL_GET_MSG_TYPE_SUPPORT(sensor_msgs, msg, JointState), "wanted_joint_states"));
-    Serial.println("Wanted joint state publisher initialized");
-
-    Serial.println("Initializing micro-ROS timers...");
-    print_free_heap();
-    INIT(rclc_timer_init_default(&publish_timer, &support, RCL_MS_TO_NS(100), pub_timer_callback));
-    INIT(rclc_timer_init_default(&sync_timer, &support, RCL_MS_TO_NS(time_sync_interval), sync_timer_callback));
+    Serial.println("Waiting for agent...");
+    while (rmw_uros_ping_agent(5, 1) != RMW_RET_OK)
+    {
+        vTaskDelay(pdMS_TO_TICKS(agent_ping_interval_ms));
+    }
 
-    Serial.println("Initializing micro-ROS subscriptions...");
-    print_free_heap();
-    INIT(rclc_subscription_init_default(&cmd_vel_subscriber, &node, ROSIDL_GET_MSG_TYPE_SUPPORT(geometry_msgs, msg, Twist), "cmd_vel"));
+    allocator = rcl_get_default_allocator();
 
-    Serial.println("Adding subscriptions to the executor...");
+    Serial.println("Initializing micro-ROS entities...");
     print_free_heap();
-    INIT(rclc_executor_init(&executor, &support.context, 3, &allocator));
-    INIT(rclc_executor_add_subscription(&executor, &cmd_vel_subscriber, &twist_msg, &cmd_vel_subscription_callback, ON_NEW_DATA));
+    for (size_t step = 0; step < sizeof(micro_ros_bring_up_steps) / sizeof(micro_ros_bring_up_steps[0]); step++)
+    {
+        while (micro_ros_bring_up_steps[step].init() != RCL_RET_OK)
+        {
+            Serial.print("Bring-up step ");
+            Serial.print(static_cast<unsigned>(step));
+            Serial.println(" failed, retrying");
+            if (micro_ros_bring_up_steps[step].fini != nullptr)
+            {
+                micro_ros_bring_up_steps[step].fini();
+            }
+            vTaskDelay(pdMS_TO_TICKS(bring_up_retry_interval_ms));
+        }
+    }
 
     init_odometry_msg();
     init_joint_state_msg();
@@ -380,23 +439,23 @@ void cmd_vel_subscription_callback(const void* msgin)
     // Based on max velocity multiply the ki value by a factor
     if (abs(smoothed_cmd_vel(0)) > 0.5 || abs(smoothed_cmd_vel(1)) > 0.5)
     {
-        for (int i = 0; i < MOTOR_COUNT; i++)
+        for (size_t i = 0; i < MOTOR_COUNT; i++)
         {
-            controllers[i].set_ki(base_ki * modifier_ki_linear);
+            controllers[i].set_ki(ROBOT_MOTORS[i].gains.ki * modifier_ki_linear);
         }
     }
     else if (abs(smoothed_cmd_vel(2)) > 1.0)
     {
-        for (int i = 0; i < MOTOR_COUNT; i++)
+        for (size_t i = 0; i < MOTOR_COUNT; i++)
         {
-            controllers[i].set_ki(base_ki * modifier_ki_rotational);
+            controllers[i].set_ki(ROBOT_MOTORS[i].gains.ki * modifier_ki_rotational);
         }
     }
     else
     {
-        for (int i = 0; i < MOTOR_COUNT; i++)
+        for (size_t i = 0; i < MOTOR_COUNT; i++)
         {
-            controllers[i].set_ki(base_ki);
+            controllers[i].set_ki(ROBOT_MOTORS[i].gains.ki);
         }
     }
 
@@ -404,16 +463,19 @@ void cmd_vel_subscription_callback(const void* msgin)
 }
 
 /**
- * @brief Helper function to set the ROS timestamp for a message.
+ * @brief Helper function to set the ROS timestamp for a message. The time
+ * since the last sync is taken from the 64 bit timebase, so the stamps stay
+ * continuous however long the robot runs.
  *
  * @param header Header of the message
- * @param sync_ms Synced time in milliseconds
- * @param sync_ns Nano second part of the synced time
+ * @param sync_ns Agent epoch at the last sync in nanoseconds
+ * @param sync_local_us Local time of the last sync in microseconds
  */
-void set_ros_timestamp(std_msgs__msg__Header& header, unsigned long sync_ms, unsigned long sync_ns)
+void set_ros_timestamp(std_msgs__msg__Header& header, int64_t sync_ns, uint64_t sync_local_us)
 {
-    header.stamp.sec = (sync_ms + millis() - last_time_sync_ms) / 1000;
-    header.stamp.nanosec = sync_ns + (micros() * 1000 - last_time_sync_ns) % 1000000000;
+    const int64_t stamp_ns = sync_ns + static_cast<int64_t>(roboost::timing::now_us64() - sync_local_us) * 1000;
+    header.stamp.sec = static_cast<int32_t>(stamp_ns / 1000000000);
+    header.stamp.nanosec = static_cast<uint32_t>(stamp_ns % 1000000000);
 }
 
 /**
@@ -429,7 +491,7 @@ void publish_joint_states(const Eigen::Vector4d& velocities, double dt)
         joint_state_msg.position.data[i] += velocities(i) * dt;
         joint_state_msg.velocity.data[i] = velocities(i);
     }
-    set_ros_timestamp(joint_state_msg.header, synced_time_ms, synced_time_ns);
+    set_ros_timestamp(joint_state_msg.header, synced_time_ns, synced_local_us);
     RCSOFTCHECK(rcl_publish(&joint_state_publisher, &joint_state_msg, NULL));
 }
 
@@ -445,7 +507,7 @@ void publish_wanted_joint_states(const Eigen::Vector4d& velocities, double dt)
     {
         wanted_joint_state_msg.position.data[i] = velocities(i);
     }
-    set_ros_timestamp(wanted_joint_state_msg.header, synced_time_ms, synced_time_ns);
+    set_ros_timestamp(wanted_joint_state_msg.header, synced_time_ns, synced_local_us);
     RCSOFTCHECK(rcl_publish(&wanted_joint_state_publisher, &wanted_joint_state_msg, NULL));
 }
 
@@ -457,15 +519,17 @@ void publish_wanted_joint_states(const Eigen::Vector4d& velocities, double dt)
  */
 void update_odometry(const Eigen::Vector3d& velocity, double dt)
 {
-    pose(0) += velocity(0) * cos(pose(2)) * dt - velocity(1) * sin(pose(2)) * dt;
-    pose(1) += velocity(0) * sin(pose(2)) * dt + velocity(1) * cos(pose(2)) * dt;
-    pose(2) += velocity(2) * dt;
-    pose(2) = atan2(sin(pose(2)), cos(pose(2)));
+    // One sine and cosine of the heading per update, FAST_MATH also wraps the heading without atan2
+    const double cos_heading = OdometryMath::cos(pose(2));
+    const double sin_heading = OdometryMath::sin(pose(2));
+    pose(0) += (velocity(0) * cos_heading - velocity(1) * sin_heading) * dt;
+    pose(1) += (velocity(0) * sin_heading + velocity(1) * cos_heading) * dt;
+    pose(2) = OdometryMath::wrap_angle(pose(2) + velocity(2) * dt);
 
     odom_msg.pose.pose.position.x = pose(0);
     odom_msg.pose.pose.position.y = pose(1);
-    odom_msg.pose.pose.orientation.w = cos(pose(2) / 2.0);
-    odom_msg.pose.pose.orientation.z = sin(pose(2) / 2.0);
+    odom_msg.pose.pose.orientation.w = OdometryMath::cos(pose(2) / 2.0);
+    odom_msg.pose.pose.orientation.z = OdometryMath::sin(pose(2) / 2.0);
     odom_msg.twist.twist.linear.x = velocity(0);
     odom_msg.twist.twist.linear.y = velocity(1);
     odom_msg.twist.twist.angular.z = velocity(2);
@@ -485,32 +549,18 @@ void pub_timer_callback(rcl_timer_t* timer, int64_t last_call_time)
         return;
     }
 
-    double dt = TIMING_US_TO_S_DOUBLE(timing_service.get_delta_time());
+    publish_timing.tick(roboost::timing::now_us64());
+    const double dt = publish_timing.get_dt();
     Eigen::Vector3d robot_velocity = robot_controller.get_robot_vel();
 
     // Update odometry
     update_odometry(robot_velocity, dt);
-    set_ros_timestamp(odom_msg.header, synced_time_ms, synced_time_ns);
-    RCSOFTCHECK(rcl_publish(&odom_publisher, &odom_msg, NULL));
-
-    // Publish joint states
-    Eigen::Vector4d wheel_velocities = kinematics.calculate_wheel_velocity(robot_velocity);
-    publish_joint_states(wheel_velocities, dt);
-
-    // Publish desired joint states
-    Eigen::Vector4d wanted_wheel_velocities = robot_controller.get_wheel_vel_setpoints();
-    publish_wanted_joint_states(wanted_wheel_velocities, dt);
-}
-
-void pub_callback()
-{
-    double dt = TIMING_US_TO_S_DOUBLE(timing_service.get_delta_time());
-    Eigen::Vector3d robot_velocity = robot_controller.get_robot_vel();
-
-    // Update odometry
-    update_odometry(robot_velocity, dt);
-    set_ros_timestamp(odom_msg.header, synced_time_ms, synced_time_ns);
+    set_ros_timestamp(odom_msg.header, synced_time_ns, synced_local_us);
     RCSOFTCHECK(rcl_publish(&odom_publisher, &odom_msg, NULL));
+    if (boot_first_odom_us == 0)
+    {
+        boot_first_odom_us = roboost::timing::now_us64();
+    }
 
     // Publish joint states
     Eigen::Vector4d wheel_velocities = kinematics.calculate_wheel_velocity(robot_velocity);
@@ -539,9 +589,8 @@ void sync_timer_callback(rcl_timer_t* timer, int64_t last_call_time)
 
     if (rmw_uros_epoch_synchronized())
     {
-        // Get time in milliseconds or nanoseconds
-        synced_time_ms = rmw_uros_epoch_millis();
         synced_time_ns = rmw_uros_epoch_nanos();
+        synced_local_us = roboost::timing::now_us64();
     }
     else
     {
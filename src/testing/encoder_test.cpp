@@ -1,6 +1,7 @@
 #include <Arduino.h>
 #include <conf_hardware.h>
 #include <roboost/motor_control/motor_drivers/motor_driver.hpp>
+#include <roboost/utils/timebase.hpp>
 
 #define MAX_ENCODERS 16
 #define US_DEBOUNCE 10
@@ -92,7 +93,7 @@ InterruptEncoder::~InterruptEncoder()
 // This method is used for LOW and MEDIUM precision levels
 void InterruptEncoder::update_single()
 {
-    unsigned long current_time = micros();
+    const int64_t current_time = static_cast<int64_t>(roboost::timing::now_us64());
     if (current_time - last_time < US_DEBOUNCE)
     {
         return;
@@ -125,7 +126,7 @@ void InterruptEncoder::update_single()
 void InterruptEncoder::update_dual()
 {
     // Based on https://makeatronics.blogspot.com/2013/02/efficiently-reading-quadrature-with.html
-    unsigned long current_time = micros();
+    const int64_t current_time = static_cast<int64_t>(roboost::timing::now_us64());
     if (current_time - last_time < US_DEBOUNCE)
     {
         return;
@@ -230,9 +231,9 @@ void InterruptEncoder::attach()
     attached = true;
 }
 
-InterruptEncoder::config_t config = {InterruptEncoder::MEDIUM_PRECISION, M3_ENC_A, M3_ENC_B, ENCODER_RESOLUTION};
+InterruptEncoder::config_t config = {InterruptEncoder::MEDIUM_PRECISION, ROBOT_MOTORS[3].encoder_a, ROBOT_MOTORS[3].encoder_b, ENCODER_RESOLUTION};
 InterruptEncoder my_encoder(config);
-roboost::motor_control::L298NMotorDriver motor_driver = {M3_IN1, M3_IN2, M3_ENA, M3_PWM_CNL};
+roboost::motor_control::L298NMotorDriver motor_driver = {ROBOT_MOTORS[3].in1, ROBOT_MOTORS[3].in2, ROBOT_MOTORS[3].enable, ROBOT_MOTORS[3].pwm_channel};
 
 void setup()
 {
@@ -249,9 +250,9 @@ void loop()
     int64_t position_ticks = my_encoder.get_position_ticks();
     int64_t micros_between_ticks = my_encoder.get_micros_between_ticks();
 
-    static long last_time = 0;
+    static int64_t last_time = 0;
     float velocity = 0;
-    long current_time = micros();
+    const int64_t current_time = static_cast<int64_t>(roboost::timing::now_us64());
     if (current_time - my_encoder.last_time < VELOCITY_TIMEOUT)
     {
         if (micros_between_ticks > 0)
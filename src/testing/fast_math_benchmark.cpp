@@ -0,0 +1,82 @@
+#include <Arduino.h>
+#include <roboost/utils/fast_math.hpp>
+#include <roboost/utils/timebase.hpp>
+
+using namespace roboost::math;
+
+// Same inputs as src/native/fast_math_benchmark.cpp, fewer to fit into RAM
+#define SAMPLES 1024
+#define REPETITIONS 20
+
+float angles[SAMPLES];
+float ys[SAMPLES];
+float xs[SAMPLES];
+float squares[SAMPLES];
+
+volatile float sink;
+
+// Worst case error against double precision libm and time per call in ns
+template <typename Function, typename Reference>
+void benchmark(const char* name, Function function, Reference reference, bool relative)
+{
+    double max_error = 0.0;
+    for (int i = 0; i < SAMPLES; i++)
+    {
+        const double expected = reference(i);
+        double error = fabs(function(i) - expected);
+        if (relative)
+        {
+            error /= fabs(expected);
+        }
+        max_error = error > max_error ? error : max_error;
+    }
+
+    float sum = 0.0f;
+    const uint64_t start = roboost::timing::now_us64();
+    for (int r = 0; r < REPETITIONS; r++)
+    {
+        for (int i = 0; i < SAMPLES; i++)
+        {
+            sum += function(i);
+        }
+    }
+    const uint64_t end = roboost::timing::now_us64();
+    sink = sum;
+    Serial.printf("%-16s %10.2e %8.1f\n", name, max_error, (end - start) * 1000.0 / (SAMPLES * REPETITIONS));
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    delay(1000);
+
+    for (int i = 0; i < SAMPLES; i++)
+    {
+        angles[i] = -4.0f * PI_F + 8.0f * PI_F * i / SAMPLES;
+        ys[i] = 2.0f * sinf(angles[i] * 0.37f);
+        xs[i] = 2.0f * cosf(angles[i] * 0.37f);
+        squares[i] = 1e-4f + 100.0f * i / SAMPLES;
+    }
+    auto sin_reference = [](int i) { return sin(static_cast<double>(angles[i])); };
+    auto atan2_reference = [](int i) { return atan2(static_cast<double>(ys[i]), static_cast<double>(xs[i])); };
+    auto sqrt_reference = [](int i) { return sqrt(static_cast<double>(squares[i])); };
+
+    Serial.printf("%-16s %10s %8s\n", "Function", "Error", "ns");
+    benchmark("sin (double)", [](int i) { return static_cast<float>(sin(static_cast<double>(angles[i]))); }, sin_reference, false);
+    benchmark("sinf", [](int i) { return sinf(angles[i]); }, sin_reference, false);
+    benchmark("poly_sin", [](int i) { return poly_sin(angles[i]); }, sin_reference, false);
+    benchmark("table_sin", [](int i) { return table_sin(angles[i]); }, sin_reference, false);
+    benchmark("sin_q15", [](int i) { return sin_q15(rad_to_bam(angles[i])) * (1.0f / 32768.0f); }, sin_reference, false);
+
+    benchmark("atan2 (double)", [](int i) { return static_cast<float>(atan2(static_cast<double>(ys[i]), static_cast<double>(xs[i]))); }, atan2_reference, false);
+    benchmark("atan2f", [](int i) { return atan2f(ys[i], xs[i]); }, atan2_reference, false);
+    benchmark("poly_atan2", [](int i) { return poly_atan2(ys[i], xs[i]); }, atan2_reference, false);
+    benchmark("table_atan2", [](int i) { return table_atan2(ys[i], xs[i]); }, atan2_reference, false);
+    benchmark("atan2_bam", [](int i) { return bam_to_rad(static_cast<int16_t>(atan2_bam(static_cast<int32_t>(ys[i] * 1e6f), static_cast<int32_t>(xs[i] * 1e6f)))); }, atan2_reference, false);
+
+    benchmark("sqrtf", [](int i) { return sqrtf(squares[i]); }, sqrt_reference, true);
+    benchmark("poly_sqrt", [](int i) { return poly_sqrt(squares[i]); }, sqrt_reference, true);
+    benchmark("table_sqrt", [](int i) { return table_sqrt(squares[i]); }, sqrt_reference, true);
+}
+
+void loop() { delay(1000); }
@@ -46,9 +46,9 @@ constexpr float deadband_threshold = 0.01f;
 constexpr float minimum_output = 0.02f;
 
 // Motor, Encoder, and Controller instances arrays
-L298NMotorDriver motor_drivers[4] = {{M0_IN1, M0_IN2, M0_ENA, M0_PWM_CNL}, {M1_IN1, M1_IN2, M1_ENA, M1_PWM_CNL}, {M2_IN1, M2_IN2, M2_ENA, M2_PWM_CNL}, {M3_IN1, M3_IN2, M3_ENA, M3_PWM_CNL}};
+auto motor_drivers = roboost::motor_control::make_motor_drivers<L298NMotorDriver>(ROBOT_MOTORS);
 
-HalfQuadEncoder encoders[4] = {{M0_ENC_A, M0_ENC_B, M0_ENC_RESOLUTION}, {M1_ENC_A, M1_ENC_B, M1_ENC_RESOLUTION}, {M2_ENC_A, M2_ENC_B, M2_ENC_RESOLUTION}, {M3_ENC_A, M3_ENC_B, M3_ENC_RESOLUTION}};
+auto encoders = roboost::motor_control::make_encoders<HalfQuadEncoder>(ROBOT_MOTORS);
 
 LowPassFilter<float> derivative_filter = {cutoff_frequency_derivative, sampling_time_derivative};
 PIDController<float> controllers[4] = {
@@ -6,6 +6,7 @@
 #include <roboost/motor_control/motor_controllers/velocity_motor_controller.hpp>
 #include <roboost/motor_control/motor_drivers/l298n_motor_driver.hpp>
 #include <roboost/utils/controllers.hpp>
+#include <roboost/utils/coroutine.hpp>
 #include <roboost/utils/filters.hpp>
 #include <roboost/utils/gradient_descent.hpp>
 #include <roboost/utils/logging.hpp>
@@ -39,8 +40,8 @@ LowPassFilter derivative_filter = LowPassFilter(10, 0.00005); // time constant =
 
 double setpoint = 0.0;
 
-L298NMotorDriver motor_driver(M0_IN1, M0_IN2, M0_ENA, M0_PWM_CNL);
-HalfQuadEncoder encoder(M0_ENC_A, M0_ENC_B, M0_ENC_RESOLUTION, false);
+L298NMotorDriver motor_driver(ROBOT_MOTORS[0].in1, ROBOT_MOTORS[0].in2, ROBOT_MOTORS[0].enable, ROBOT_MOTORS[0].pwm_channel);
+HalfQuadEncoder encoder(ROBOT_MOTORS[0].encoder_a, ROBOT_MOTORS[0].encoder_b, ROBOT_MOTORS[0].encoder_resolution, false);
 PIDController controller(kp, ki, kd, max_integral, derivative_filter, &timing_service);
 
 MovingAverageFilter encoder_filter1 = MovingAverageFilter(2);
@@ -74,18 +75,9 @@ VelocityEstimator velocityEstimator(10); // Use last 10 samples to estimate velo
 
 const double max_amplitude = 4 * PI; // Maximum speed in rad/s
 
-unsigned long last_time = 0;
 const double amplitude = max_amplitude;
 const double frequency = 0.1;
 
-void setup()
-{
-    Serial.begin(115200);
-    logger.set_serial(Serial);
-    encoder.set_timing_service(timing_service);
-    encoder.set_logger(logger);
-}
-
 // Function for sine wave setpoint
 double sineWaveSetpoint(unsigned long time) { return amplitude * sin(2 * PI * frequency * time / 1000.0); }
 
@@ -127,17 +119,53 @@ double triangularWaveSetpoint(unsigned long time)
 
 double (*getSetpoint)(unsigned long) = triangularWaveSetpoint; // Function pointer to current setpoint function
 
-void loop()
+const unsigned long settle_time_ms = 2000;      // Motor at rest before the test
+const unsigned long test_duration_ms = 60000;   // Length of the setpoint sequence
+const unsigned long telemetry_interval_ms = 100;
+
+/**
+ * @brief Runs the setpoint sequence and prints the telemetry. Written as a
+ * coroutine so that the motor controller keeps being updated every loop.
+ *
+ */
+class StepResponse : public Coroutine
 {
-    timing_service.update();
+protected:
+    CoroutineStatus run() override
+    {
+        CO_BEGIN();
+
+        setpoint = 0.0;
+        CO_DELAY_MS(settle_time_ms);
+
+        Serial.println("Starting step response test...");
+        start_time = co_now_;
+        last_print = 0;
+
+        while (elapsed_ms() < test_duration_ms)
+        {
+            setpoint = getSetpoint(elapsed_ms()); // Calculate setpoint based on selected function
+
+            if (elapsed_ms() - last_print >= telemetry_interval_ms)
+            {
+                last_print = elapsed_ms();
+                print_telemetry();
+            }
+
+            CO_YIELD();
+        }
 
-    unsigned long time = TIMING_US_TO_MS(timing_service.getLastUpdateTime()); // Get time in milliseconds
+        setpoint = 0.0;
+        Serial.println("Step response test finished.");
 
-    setpoint = getSetpoint(time); // Calculate setpoint based on selected function
+        CO_END();
+    }
+
+private:
+    unsigned long elapsed_ms() const { return static_cast<uint32_t>(co_now_ - start_time) / 1000UL; }
 
-    if (time - last_time > 100)
+    void print_telemetry()
     {
-        last_time = time;
         Serial.print(">measured[rad/s]:");
         Serial.println(encoder.get_velocity()); // TODO: Such a low resolution encoder does not work well with high update rates
         Serial.print(">measured_filtered[rad/s]:");
@@ -158,9 +186,28 @@ void loop()
         Serial.println(motor_driver.get_motor_control());
         Serial.print(">position_setpoint:");
         Serial.println(motor_controller.get_setpoint());
-
-        // delay(100);
     }
 
+    uint32_t start_time = 0;
+    unsigned long last_print = 0;
+};
+
+StepResponse step_response;
+CoroutineRunner<1> coroutine_runner;
+
+void setup()
+{
+    Serial.begin(115200);
+    logger.set_serial(Serial);
+    encoder.set_timing_service(timing_service);
+    encoder.set_logger(logger);
+
+    coroutine_runner.add(step_response);
+}
+
+void loop()
+{
+    timing_service.update();
+    coroutine_runner.update(micros());
     motor_controller.update(setpoint);
 }
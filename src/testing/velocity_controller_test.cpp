@@ -33,8 +33,8 @@ constexpr float kd = 0.045; // 0.045
 constexpr float max_integral = 4000;
 
 // Motor, Encoder, and Controller instances
-L298NMotorDriver motor_driver = {M3_IN1, M3_IN2, M3_ENA, M3_PWM_CNL};
-HalfQuadEncoder encoder = {M3_ENC_A, M3_ENC_B, M3_ENC_RESOLUTION};
+L298NMotorDriver motor_driver = {ROBOT_MOTORS[3].in1, ROBOT_MOTORS[3].in2, ROBOT_MOTORS[3].enable, ROBOT_MOTORS[3].pwm_channel};
+HalfQuadEncoder encoder = {ROBOT_MOTORS[3].encoder_a, ROBOT_MOTORS[3].encoder_b, ROBOT_MOTORS[3].encoder_resolution};
 
 NoFilter<float> derivative_filter = {};
 NoFilter<float> input_filter = {};
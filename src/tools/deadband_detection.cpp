@@ -6,6 +6,7 @@
 #include <roboost/motor_control/motor_controllers/velocity_motor_controller.hpp>
 #include <roboost/motor_control/motor_drivers/l298n_motor_driver.hpp>
 #include <roboost/utils/controllers.hpp>
+#include <roboost/utils/coroutine.hpp>
 #include <roboost/utils/filters.hpp>
 #include <roboost/utils/logging.hpp>
 #include <roboost/utils/regression.hpp>
@@ -17,62 +18,86 @@ using namespace roboost::logging;
 using namespace roboost::controllers;
 using namespace roboost::filters;
 
-L298NMotorDriver motor_driver(M3_IN1, M3_IN2, M3_ENA, M3_PWM_CNL);
-HalfQuadEncoder encoder(M3_ENC_A, M3_ENC_B, M3_ENC_RESOLUTION, false);
+L298NMotorDriver motor_driver(ROBOT_MOTORS[3].in1, ROBOT_MOTORS[3].in2, ROBOT_MOTORS[3].enable, ROBOT_MOTORS[3].pwm_channel);
+HalfQuadEncoder encoder(ROBOT_MOTORS[3].encoder_a, ROBOT_MOTORS[3].encoder_b, ROBOT_MOTORS[3].encoder_resolution, false);
 SerialLogger& logger = SerialLogger::get_instance();
 Scheduler& timing_service = Scheduler::get_instance();
 
-void setup()
+/**
+ * @brief Ramps up the motor output until the encoder detects movement. Written
+ * as a coroutine so that the ramp does not block the CPU while waiting for the
+ * motor to respond.
+ *
+ */
+class DeadbandDetection : public Coroutine
 {
-    Serial.begin(115200);
+protected:
+    CoroutineStatus run() override
+    {
+        CO_BEGIN();
 
-    encoder.set_timing_service(timing_service);
-    encoder.set_logger(logger);
+        // Assuming the motor driver setup includes configuration for PWM, directions, etc.
+        motor_driver.set_motor_control(0); // Ensure motor is stopped initially
+        CO_DELAY_MS(2000);                 // Wait for system to stabilize
 
-    // Assuming the motor driver setup includes configuration for PWM, directions, etc.
-    motor_driver.set_motor_control(0); // Ensure motor is stopped initially
-    delay(2000);                       // Wait for system to stabilize
+        Serial.println("Starting deadband and minimum output test...");
 
-    Serial.println("Starting deadband and minimum output test...");
+        output = 0.0;
+        movement_detected = false;
 
-    double output = 0.0;
-    double increment = 0.001; // Increment size for control output
-    bool movementDetected = false;
-    double firstMovementOutput = 0.0;
+        while (!movement_detected && output <= 1.0)
+        {
+            motor_driver.set_motor_control(output);
+            CO_DELAY_MS(10); // Delay to allow motor response and encoder readings
 
-    while (!movementDetected && output <= 1.0)
-    {
-        motor_driver.set_motor_control(output);
-        delay(10); // Delay to allow motor response and encoder readings
+            encoder.update();                      // Update encoder to get the latest velocity
+            speed = encoder.get_velocity(); // Current motor speed
 
-        encoder.update();                      // Update encoder to get the latest velocity
-        double speed = encoder.get_velocity(); // Current motor speed
+            if (speed > 0.001)
+            {
+                movement_detected = true;
+                first_movement_output = output;
+                Serial.print("Movement detected at output: ");
+                Serial.println(output, DEC);
+            }
+            else
+            {
+                Serial.print("No movement at output: ");
+                Serial.println(output, DEC);
+            }
 
-        if (speed > 0.001)
-        {
-            movementDetected = true;
-            firstMovementOutput = output;
-            Serial.print("Movement detected at output: ");
-            Serial.println(output, DEC);
+            output += increment; // Increase the control output
         }
-        else
+
+        if (!movement_detected)
         {
-            Serial.print("No movement at output: ");
-            Serial.println(output, DEC);
+            Serial.println("No movement detected within the test range.");
         }
 
-        output += increment; // Increase the control output
-    }
+        motor_driver.set_motor_control(0); // Stop the motor
 
-    if (!movementDetected)
-    {
-        Serial.println("No movement detected within the test range.");
+        CO_END();
     }
 
-    motor_driver.set_motor_control(0); // Stop the motor
-}
+private:
+    const double increment = 0.001; // Increment size for control output
+    double output = 0.0;
+    double speed = 0.0;
+    bool movement_detected = false;
+    double first_movement_output = 0.0;
+};
+
+DeadbandDetection deadband_detection;
+CoroutineRunner<1> coroutine_runner;
 
-void loop()
+void setup()
 {
-    delay(1000); // Loop delay
-}
\ No newline at end of file
+    Serial.begin(115200);
+
+    encoder.set_timing_service(timing_service);
+    encoder.set_logger(logger);
+
+    coroutine_runner.add(deadband_detection);
+}
+
+void loop() { coroutine_runner.update(micros()); }
@@ -1,6 +1,28 @@
+#include "test_batch_kinematics.hpp"
+#include "test_command_timeout.hpp"
+#include "test_contexts.hpp"
+#include "test_coroutine.hpp"
 #include "test_controllers.hpp"
+#include "test_desaturation.hpp"
+#include "test_differentiators.hpp"
+#include "test_disturbance_observer.hpp"
+#include "test_explicit_mpc_controller.hpp"
+#include "test_fast_math.hpp"
+#include "test_filter_chain.hpp"
+#include "test_filter_design.hpp"
+#include "test_heading_estimator.hpp"
+#include "test_iterative_learning.hpp"
 #include "test_kinematics.hpp"
+#include "test_lqr_controller.hpp"
+#include "test_robot_config.hpp"
+#include "test_robot_description.hpp"
+#include "test_schedulability.hpp"
+#include "test_swerve_kinematics.hpp"
+#include "test_timebase.hpp"
+#include "test_timing_context.hpp"
 #include "test_velocity_controller.hpp"
+#include "test_watchdog.hpp"
+#include "test_wheel_synchronization.hpp"
 #include <gtest/gtest.h>
 
 int main(int argc, char** argv)
@@ -0,0 +1,27 @@
+#ifndef SIMULATED_MOTOR_HPP
+#define SIMULATED_MOTOR_HPP
+
+#include <math.h>
+
+/**
+ * @brief First order motor from duty to velocity, sampled with a zero-order
+ * hold. The defaults are the nominal motor model of conf_hardware.h at the 20 ms control period.
+ * The load is given in duty and acts on the input.
+ */
+struct SimulatedMotor
+{
+    float sample_time;
+    float gain;
+    float time_constant;
+    float velocity = 0.0f;
+
+    explicit SimulatedMotor(float sample_time = 0.02f, float gain = 25.0f, float time_constant = 0.08f) : sample_time(sample_time), gain(gain), time_constant(time_constant) {}
+
+    void step(float duty, float load = 0.0f)
+    {
+        const float a = expf(-sample_time / time_constant);
+        velocity = a * velocity + gain * (1.0f - a) * (duty - load);
+    }
+};
+
+#endif // SIMULATED_MOTOR_HPP
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include <math.h>
+#include <roboost/kinematics/batch_kinematics.hpp>
+#include <roboost/kinematics/kinematics.hpp>
+
+using namespace roboost::kinematics;
+
+class BatchKinematicsTest : public ::testing::Test
+{
+protected:
+    using Twist = roboost::math::Vector<float>;
+    static constexpr size_t CAPACITY = 64;
+
+    MecanumKinematics4W kinematics{0.05, 0.4, 0.3};
+    BatchKinematics<MecanumKinematics4W, Twist> batch_kinematics{kinematics};
+    TwistBatch<CAPACITY> twists;
+    WheelVelocityBatch<CAPACITY> wheels;
+};
+
+TEST_F(BatchKinematicsTest, MatchesSingleTwistKinematics)
+{
+    for (size_t n = 0; n < 37; ++n)
+    {
+        twists.add(0.5f * cosf(n), 0.3f * sinf(2.0f * n), 1.5f * sinf(n));
+    }
+    batch_kinematics.calculate_wheel_velocities(twists, wheels);
+
+    ASSERT_EQ(wheels.size, 37u);
+    for (size_t n = 0; n < wheels.size; ++n)
+    {
+        Twist expected = kinematics.calculate_wheel_velocity(Twist{twists.vx[n], twists.vy[n], twists.omega[n]});
+        float max_abs = 0.0f;
+        for (size_t i = 0; i < 4; ++i)
+        {
+            EXPECT_NEAR(wheels.wheel[i][n], expected[i], 1e-4);
+            max_abs = fmaxf(max_abs, fabsf(expected[i]));
+        }
+        EXPECT_NEAR(wheels.max_abs[n], max_abs, 1e-4);
+    }
+}
+
+TEST_F(BatchKinematicsTest, FeasibilityMask)
+{
+    twists.add(0.1f, 0.0f, 0.0f); // 2 rad/s on every wheel
+    twists.add(1.0f, 0.0f, 0.0f); // 20 rad/s
+    twists.add(0.0f, 0.0f, 1.0f); // 7 rad/s
+    twists.add(0.0f, 0.0f, 0.0f);
+
+    size_t feasible_count = batch_kinematics.calculate_wheel_velocities(twists, wheels, 10.0f);
+
+    EXPECT_EQ(feasible_count, 3u);
+    EXPECT_TRUE(wheels.feasible[0]);
+    EXPECT_FALSE(wheels.feasible[1]);
+    EXPECT_TRUE(wheels.feasible[2]);
+    EXPECT_TRUE(wheels.feasible[3]);
+}
+
+TEST_F(BatchKinematicsTest, FullBatchRejectsAdd)
+{
+    for (size_t n = 0; n < CAPACITY; ++n)
+    {
+        EXPECT_TRUE(twists.add(0.0f, 0.0f, 0.0f));
+    }
+    EXPECT_FALSE(twists.add(0.0f, 0.0f, 0.0f));
+}
@@ -0,0 +1,123 @@
+#include <cmath>
+#include <gtest/gtest.h>
+#include <roboost/motor_control/command_timeout.hpp>
+
+using roboost::motor_control::CommandTimeout;
+
+class CommandTimeoutTest : public ::testing::Test
+{
+protected:
+    static constexpr float max_deceleration[3] = {1.0f, 1.0f, 4.0f};
+    static constexpr float max_jerk[3] = {5.0f, 5.0f, 20.0f};
+    static constexpr uint32_t period_us = 20000;
+
+    CommandTimeout<3> timeout{500000, max_deceleration, max_jerk};
+};
+
+constexpr float CommandTimeoutTest::max_deceleration[3];
+constexpr float CommandTimeoutTest::max_jerk[3];
+
+TEST_F(CommandTimeoutTest, HoldsZeroWithoutCommand)
+{
+    for (uint32_t now = 0; now < 2000000; now += period_us)
+    {
+        EXPECT_EQ(timeout.update(now)[0], 0.0f);
+    }
+    EXPECT_EQ(timeout.get_timeout_count(), 0u);
+}
+
+TEST_F(CommandTimeoutTest, PassesFreshCommands)
+{
+    timeout.set_command({0.5f, -0.2f, 1.0f}, 0);
+    for (uint32_t now = 0; now <= 500000; now += period_us)
+    {
+        const auto& output = timeout.update(now);
+        EXPECT_EQ(output[0], 0.5f);
+        EXPECT_EQ(output[1], -0.2f);
+        EXPECT_EQ(output[2], 1.0f);
+    }
+    EXPECT_FALSE(timeout.is_expired());
+}
+
+TEST_F(CommandTimeoutTest, StopsWithinLimitsAndBoundedTicks)
+{
+    const CommandTimeout<3>::Command command = {1.5f, -0.5f, 2.0f};
+    timeout.set_command(command, 0);
+    uint32_t now = 0;
+    while (!timeout.is_expired())
+    {
+        now += period_us;
+        timeout.update(now);
+    }
+    EXPECT_EQ(timeout.get_timeout_count(), 1u);
+
+    const float stop_time = timeout.stop_time(command);
+    const uint32_t max_ticks = static_cast<uint32_t>(std::ceil(stop_time / (period_us * 1e-6f))) + 1;
+    const float dt = period_us * 1e-6f;
+
+    CommandTimeout<3>::Command previous = command, previous_acceleration = {0.0f, 0.0f, 0.0f};
+    auto output = timeout.get_output();
+    for (int i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(output[i], command[i]);
+    }
+    while (timeout.is_stopping())
+    {
+        now += period_us;
+        output = timeout.update(now);
+        for (int i = 0; i < 3; i++)
+        {
+            const float acceleration = (output[i] - previous[i]) / dt;
+            EXPECT_LE(std::fabs(acceleration), max_deceleration[i] * 1.01f);
+            EXPECT_LE(std::fabs(acceleration - previous_acceleration[i]) / dt, max_jerk[i] * 1.01f + 1e-3f);
+            EXPECT_LE(std::fabs(output[i]), std::fabs(previous[i]));
+            previous_acceleration[i] = acceleration;
+            previous[i] = output[i];
+        }
+        ASSERT_LE(timeout.get_stop_ticks(), max_ticks);
+    }
+
+    for (int i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(output[i], 0.0f);
+    }
+    EXPECT_GE(timeout.get_last_stop_latency_us(), static_cast<uint32_t>(stop_time * 1e6f) - period_us);
+    EXPECT_LE(timeout.get_last_stop_latency_us(), static_cast<uint32_t>(stop_time * 1e6f) + period_us);
+    EXPECT_EQ(timeout.get_max_stop_latency_us(), timeout.get_last_stop_latency_us());
+}
+
+TEST_F(CommandTimeoutTest, KeepsDirectionWhileStopping)
+{
+    timeout.set_command({0.8f, 0.4f, 0.0f}, 0);
+    for (uint32_t now = 0; now < 3000000; now += period_us)
+    {
+        const auto& output = timeout.update(now);
+        EXPECT_NEAR(output[1] * 2.0f, output[0], 1e-6f);
+        EXPECT_EQ(output[2], 0.0f);
+    }
+    EXPECT_EQ(timeout.get_output()[0], 0.0f);
+}
+
+TEST_F(CommandTimeoutTest, NewCommandEndsStop)
+{
+    timeout.set_command({1.0f, 0.0f, 0.0f}, 0);
+    timeout.update(0);
+    timeout.update(600000);
+    EXPECT_TRUE(timeout.is_stopping());
+
+    timeout.set_command({0.3f, 0.0f, 0.0f}, 620000);
+    EXPECT_EQ(timeout.update(620000)[0], 0.3f);
+    EXPECT_FALSE(timeout.is_expired());
+
+    timeout.update(1200000);
+    EXPECT_EQ(timeout.get_timeout_count(), 2u);
+}
+
+TEST_F(CommandTimeoutTest, StopTimeMatchesProfile)
+{
+    // Deceleration limit reached: 1 m/s at 1 m/s^2 and 5 m/s^3 takes 0.2 + 0.8 + 0.2 s
+    EXPECT_NEAR(timeout.stop_time({1.0f, 0.0f, 0.0f}), 1.2f, 1e-5f);
+    // Small command, triangular deceleration: 2 * sqrt(0.1 / 5)
+    EXPECT_NEAR(timeout.stop_time({0.1f, 0.0f, 0.0f}), 2.0f * std::sqrt(0.02f), 1e-5f);
+    EXPECT_EQ(timeout.stop_time({0.0f, 0.0f, 0.0f}), 0.0f);
+}
@@ -0,0 +1,123 @@
+#include <cstring>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <roboost/motor_control/command_timeout.hpp>
+#include <roboost/utils/clock.hpp>
+#include <roboost/utils/log_context.hpp>
+#include <roboost/utils/timing_context.hpp>
+#include <string>
+#include <vector>
+
+using namespace roboost::logging;
+using namespace roboost::timing;
+
+namespace
+{
+    struct LogBuffer
+    {
+        std::mutex mutex;
+        std::vector<std::string> lines;
+    };
+
+    void buffer_sink(void* user, LogLevel level, const char* name, const char* message)
+    {
+        LogBuffer* buffer = static_cast<LogBuffer*>(user);
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        buffer->lines.push_back(std::string(to_string(level)) + " " + name + ": " + message);
+    }
+
+    struct SimulatedRobot
+    {
+        static constexpr float max_deceleration[3] = {1.0f, 1.0f, 3.0f};
+        static constexpr float max_jerk[3] = {4.0f, 4.0f, 12.0f};
+
+        ManualClock clock;
+        LogContext log;
+        TimingContext control_timing{20000};
+        roboost::motor_control::CommandTimeout<3> command_timeout{300000, max_deceleration, max_jerk};
+        float velocity = 0.0f;
+        float position = 0.0f;
+
+        SimulatedRobot(const char* name, LogBuffer& buffer) : log(name, buffer_sink, &buffer) {}
+
+        // Drives for a second, then the link drops and the robot stops on its own
+        void run(float speed, int ticks)
+        {
+            const uint64_t start_us = clock.now_us();
+            for (int i = 0; i < ticks; i++)
+            {
+                clock.advance(20000);
+                control_timing.tick(clock.now_us());
+                if (clock.now_us() - start_us <= 1000000)
+                {
+                    command_timeout.set_command({speed, 0.0f, 0.0f}, clock.now_us());
+                }
+                const bool was_stopping = command_timeout.is_stopping();
+                velocity = command_timeout.update(control_timing.get_sample_time_us())[0];
+                position += velocity * control_timing.get_dt();
+                if (command_timeout.is_stopping() && !was_stopping)
+                {
+                    log.log(LogLevel::WARNING, "command expired after %u us", static_cast<unsigned>(clock.now_us() - start_us));
+                }
+            }
+            log.log(LogLevel::INFO, "stopped at %.4f m", position);
+        }
+    };
+
+    constexpr float SimulatedRobot::max_deceleration[3];
+    constexpr float SimulatedRobot::max_jerk[3];
+} // namespace
+
+TEST(ContextTest, ManualClockIsIndependent)
+{
+    ManualClock a, b(1000);
+    a.advance(500);
+    EXPECT_EQ(a.now_us(), 500u);
+    EXPECT_EQ(b.now_us(), 1000u);
+    b.set(42);
+    EXPECT_EQ(b.now_us(), 42u);
+}
+
+TEST(ContextTest, LogContextFiltersLevels)
+{
+    LogBuffer buffer;
+    LogContext log("robot", buffer_sink, &buffer, LogLevel::WARNING);
+    log.log(LogLevel::INFO, "dropped");
+    log.log(LogLevel::ERROR, "value %d", 7);
+    ASSERT_EQ(buffer.lines.size(), 1u);
+    EXPECT_EQ(buffer.lines[0], "ERROR robot: value 7");
+    EXPECT_EQ(log.get_message_count(), 1u);
+
+    log.set_level(LogLevel::DEBUG);
+    log.log(LogLevel::DEBUG, "kept");
+    EXPECT_EQ(buffer.lines.size(), 2u);
+}
+
+TEST(ContextTest, LogContextTruncatesLongMessages)
+{
+    LogBuffer buffer;
+    LogContext log("robot", buffer_sink, &buffer);
+    const std::string long_message(2 * LOG_MESSAGE_SIZE, 'x');
+    log.log(LogLevel::INFO, "%s", long_message.c_str());
+    ASSERT_EQ(buffer.lines.size(), 1u);
+    EXPECT_EQ(buffer.lines[0].size(), std::strlen("INFO robot: ") + LOG_MESSAGE_SIZE - 1);
+}
+
+TEST(ContextTest, RobotOnlyReadsItsOwnClock)
+{
+    LogBuffer log;
+    SimulatedRobot early("robot", log);
+    SimulatedRobot late("robot", log);
+    // Past the wrap of a 32 bit microsecond counter and far from the process time, a component reading any other time would diverge
+    late.clock.set(0x200000000ull);
+    early.run(0.4f, 200);
+    late.run(0.4f, 200);
+
+    EXPECT_EQ(late.position, early.position);
+    EXPECT_EQ(late.command_timeout.get_timeout_count(), 1u);
+    EXPECT_EQ(late.control_timing.get_overrun_count(), 0u);
+    ASSERT_EQ(log.lines.size(), 4u);
+    EXPECT_EQ(log.lines[0], "WARNING robot: command expired after 1320000 us");
+    EXPECT_EQ(log.lines[2], log.lines[0]);
+    EXPECT_EQ(log.lines[3], log.lines[1]);
+}
@@ -0,0 +1,194 @@
+#include <gtest/gtest.h>
+#include <roboost/utils/coroutine.hpp>
+
+using roboost::timing::Coroutine;
+using roboost::timing::CoroutineRunner;
+using roboost::timing::CoroutineStatus;
+
+// Counts up to three with a yield after every step, the counter is a member so it survives the yields
+class CountingCoroutine : public Coroutine
+{
+public:
+    int count = 0;
+    int starts = 0;
+
+protected:
+    CoroutineStatus run() override
+    {
+        CO_BEGIN();
+        starts++;
+        for (count = 0; count < 3;)
+        {
+            count++;
+            CO_YIELD();
+        }
+        CO_END();
+    }
+};
+
+// Marks the phase it reached, with a delay in between
+class DelayCoroutine : public Coroutine
+{
+public:
+    int phase = 0;
+
+protected:
+    CoroutineStatus run() override
+    {
+        CO_BEGIN();
+        phase = 1;
+        CO_DELAY_US(1000);
+        phase = 2;
+        CO_DELAY_MS(2);
+        phase = 3;
+        CO_END();
+    }
+};
+
+class AwaitCoroutine : public Coroutine
+{
+public:
+    bool ready = false;
+    bool passed = false;
+
+protected:
+    CoroutineStatus run() override
+    {
+        CO_BEGIN();
+        CO_AWAIT(ready);
+        passed = true;
+        CO_END();
+    }
+};
+
+TEST(CoroutineTest, ResumesAfterEachYield)
+{
+    CountingCoroutine coroutine;
+
+    for (int i = 1; i <= 3; i++)
+    {
+        EXPECT_EQ(coroutine.resume(0), CoroutineStatus::RUNNING);
+        EXPECT_EQ(coroutine.count, i);
+    }
+    EXPECT_EQ(coroutine.resume(0), CoroutineStatus::DONE);
+    EXPECT_TRUE(coroutine.is_done());
+    EXPECT_EQ(coroutine.starts, 1);
+
+    // A finished coroutine does not run again
+    EXPECT_EQ(coroutine.resume(0), CoroutineStatus::DONE);
+    EXPECT_EQ(coroutine.starts, 1);
+}
+
+TEST(CoroutineTest, DelayWaitsForTheTimePassedToResume)
+{
+    DelayCoroutine coroutine;
+
+    EXPECT_EQ(coroutine.resume(100), CoroutineStatus::RUNNING);
+    EXPECT_EQ(coroutine.phase, 1);
+    EXPECT_EQ(coroutine.resume(1099), CoroutineStatus::RUNNING);
+    EXPECT_EQ(coroutine.phase, 1);
+    EXPECT_EQ(coroutine.resume(1100), CoroutineStatus::RUNNING);
+    EXPECT_EQ(coroutine.phase, 2);
+    EXPECT_EQ(coroutine.resume(3099), CoroutineStatus::RUNNING);
+    EXPECT_EQ(coroutine.phase, 2);
+    EXPECT_EQ(coroutine.resume(3100), CoroutineStatus::DONE);
+    EXPECT_EQ(coroutine.phase, 3);
+}
+
+TEST(CoroutineTest, DelayHandlesTimerWrap)
+{
+    DelayCoroutine coroutine;
+
+    const uint32_t start = 0xFFFFFF00u;
+    EXPECT_EQ(coroutine.resume(start), CoroutineStatus::RUNNING);
+    EXPECT_EQ(coroutine.resume(start + 999u), CoroutineStatus::RUNNING);
+    EXPECT_EQ(coroutine.phase, 1);
+    EXPECT_EQ(coroutine.resume(start + 1000u), CoroutineStatus::RUNNING);
+    EXPECT_EQ(coroutine.phase, 2);
+}
+
+TEST(CoroutineTest, AwaitWaitsForCondition)
+{
+    AwaitCoroutine coroutine;
+
+    for (int i = 0; i < 5; i++)
+    {
+        EXPECT_EQ(coroutine.resume(0), CoroutineStatus::RUNNING);
+    }
+    EXPECT_FALSE(coroutine.passed);
+
+    coroutine.ready = true;
+    EXPECT_EQ(coroutine.resume(0), CoroutineStatus::DONE);
+    EXPECT_TRUE(coroutine.passed);
+}
+
+TEST(CoroutineTest, RestartBeginsAgain)
+{
+    CountingCoroutine coroutine;
+
+    coroutine.resume(0);
+    coroutine.resume(0);
+    EXPECT_EQ(coroutine.count, 2);
+
+    // Restarted in the middle
+    coroutine.restart();
+    EXPECT_EQ(coroutine.resume(0), CoroutineStatus::RUNNING);
+    EXPECT_EQ(coroutine.count, 1);
+    EXPECT_EQ(coroutine.starts, 2);
+
+    // Restarted after it finished
+    while (coroutine.resume(0) == CoroutineStatus::RUNNING)
+    {
+    }
+    coroutine.restart();
+    EXPECT_FALSE(coroutine.is_done());
+    EXPECT_EQ(coroutine.resume(0), CoroutineStatus::RUNNING);
+    EXPECT_EQ(coroutine.starts, 3);
+}
+
+TEST(CoroutineTest, RunnerRemovesFinishedCoroutines)
+{
+    CoroutineRunner<2> runner;
+    CountingCoroutine counting;
+    DelayCoroutine delay;
+    AwaitCoroutine await;
+
+    EXPECT_TRUE(runner.is_idle());
+    EXPECT_TRUE(runner.add(counting));
+    EXPECT_TRUE(runner.add(delay));
+    EXPECT_FALSE(runner.add(await));
+
+    // Both advance by one step per update
+    runner.update(0);
+    EXPECT_EQ(counting.count, 1);
+    EXPECT_EQ(delay.phase, 1);
+
+    for (int i = 0; i < 3; i++)
+    {
+        runner.update(0);
+    }
+    EXPECT_TRUE(counting.is_done());
+    EXPECT_FALSE(runner.is_idle());
+
+    // The slot of the finished coroutine is free again
+    EXPECT_TRUE(runner.add(await));
+    await.ready = true;
+    runner.update(1000);
+    runner.update(3000);
+    EXPECT_TRUE(await.passed);
+    EXPECT_EQ(delay.phase, 3);
+    EXPECT_TRUE(runner.is_idle());
+}
+
+TEST(CoroutineTest, RunnerRestartsAddedCoroutines)
+{
+    CoroutineRunner<1> runner;
+    CountingCoroutine coroutine;
+
+    coroutine.resume(0);
+    coroutine.resume(0);
+    EXPECT_TRUE(runner.add(coroutine));
+    runner.update(0);
+    EXPECT_EQ(coroutine.count, 1);
+    EXPECT_EQ(coroutine.starts, 2);
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include <math.h>
+#include <roboost/kinematics/desaturation.hpp>
+#include <roboost/kinematics/kinematics.hpp>
+
+using namespace roboost::kinematics;
+
+class TwistDesaturatorTest : public ::testing::Test
+{
+protected:
+    using Twist = roboost::math::Vector<float>;
+
+    MecanumKinematics4W kinematics{0.05, 0.4, 0.3};
+    TwistDesaturator<MecanumKinematics4W, Twist> desaturator{kinematics, 10.0f};
+
+    float max_wheel_velocity(const Twist& twist)
+    {
+        Twist wheels = kinematics.calculate_wheel_velocity(twist);
+        float max_abs = 0.0f;
+        for (size_t i = 0; i < wheels.size(); ++i)
+        {
+            max_abs = fmaxf(max_abs, fabsf(wheels[i]));
+        }
+        return max_abs;
+    }
+};
+
+TEST_F(TwistDesaturatorTest, FeasibleCommandUnchanged)
+{
+    Twist command = {0.2, -0.1, 0.3};
+    Twist result = desaturator.desaturate(command);
+
+    EXPECT_FALSE(desaturator.is_saturated());
+    for (size_t i = 0; i < 3; ++i)
+    {
+        EXPECT_FLOAT_EQ(result[i], command[i]);
+    }
+}
+
+TEST_F(TwistDesaturatorTest, UniformScalingKeepsDirection)
+{
+    Twist command = {1.0, 0.5, 2.0};
+    Twist result = desaturator.desaturate(command);
+
+    EXPECT_TRUE(desaturator.is_saturated());
+    EXPECT_NEAR(max_wheel_velocity(result), 10.0f, 1e-4);
+    EXPECT_NEAR(result[1] / result[0], 0.5f, 1e-5);
+    EXPECT_NEAR(result[2] / result[0], 2.0f, 1e-5);
+}
+
+TEST_F(TwistDesaturatorTest, RotationPriorityKeepsRotation)
+{
+    desaturator.set_mode(DesaturationMode::ROTATION_PRIORITY);
+    Twist command = {0.6, 0.0, 1.0};
+    Twist result = desaturator.desaturate(command);
+
+    EXPECT_FLOAT_EQ(result[2], 1.0f);
+    EXPECT_LT(result[0], 0.6f);
+    EXPECT_NEAR(max_wheel_velocity(result), 10.0f, 1e-4);
+}
+
+TEST_F(TwistDesaturatorTest, TranslationPriorityKeepsTranslation)
+{
+    desaturator.set_mode(DesaturationMode::TRANSLATION_PRIORITY);
+    Twist command = {0.4, 0.0, 3.0};
+    Twist result = desaturator.desaturate(command);
+
+    EXPECT_FLOAT_EQ(result[0], 0.4f);
+    EXPECT_LT(result[2], 3.0f);
+    EXPECT_NEAR(max_wheel_velocity(result), 10.0f, 1e-4);
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include <math.h>
+#include <roboost/utils/differentiators.hpp>
+
+using namespace roboost::filters;
+
+class DifferentiatorTest : public ::testing::Test
+{
+protected:
+    static constexpr double sample_time = 0.001;
+    static constexpr double counts_per_radian = 360 / (2.0 * M_PI);
+
+    // Encoder position quantized to 360 counts per revolution
+    static double quantized_position(double position) { return floor(position * counts_per_radian) / counts_per_radian; }
+};
+
+// Kernels are evaluated by the compiler
+constexpr auto savitzky_golay = savitzky_golay_kernel<9, 2>();
+static_assert(savitzky_golay[0] > 0.0 && savitzky_golay[8] < 0.0, "Savitzky-Golay kernel is not constexpr");
+
+TEST_F(DifferentiatorTest, KernelsMatchKnownCoefficients)
+{
+    // Five point Savitzky-Golay first derivative: (2, 1, 0, -1, -2) / 10
+    auto kernel = savitzky_golay_kernel<5, 2>();
+    EXPECT_NEAR(kernel[0], 0.2, 1e-12);
+    EXPECT_NEAR(kernel[1], 0.1, 1e-12);
+    EXPECT_NEAR(kernel[2], 0.0, 1e-12);
+
+    auto lanczos = lanczos_kernel<9>();
+    auto first_order = savitzky_golay_kernel<9, 1>();
+    for (size_t j = 0; j < 9; ++j)
+    {
+        EXPECT_NEAR(lanczos[j], savitzky_golay[j], 1e-12);
+        EXPECT_NEAR(lanczos[j], first_order[j], 1e-12);
+    }
+}
+
+TEST_F(DifferentiatorTest, PolynomialFitIsExactForParabola)
+{
+    KernelDifferentiator<double, 7> differentiator(polynomial_fit_kernel<7, 2>(), sample_time);
+
+    double derivative = 0.0;
+    double time = 0.0;
+    for (int i = 0; i < 20; ++i)
+    {
+        time = i * sample_time;
+        derivative = differentiator.update(3.0 * time * time + 2.0 * time);
+    }
+    EXPECT_NEAR(derivative, 6.0 * time + 2.0, 1e-6);
+}
+
+TEST_F(DifferentiatorTest, SavitzkyGolayReducesQuantizationNoise)
+{
+    KernelDifferentiator<float, 21> differentiator(savitzky_golay_kernel<21, 2>(), sample_time);
+
+    const double velocity = 5.0;
+    double previous = 0.0;
+    double difference_error = 0.0;
+    double savitzky_golay_error = 0.0;
+    for (int i = 0; i < 1000; ++i)
+    {
+        double position = quantized_position(velocity * i * sample_time);
+        double finite_difference = (position - previous) / sample_time;
+        float estimate = differentiator.update(position);
+        previous = position;
+        if (i >= 100)
+        {
+            difference_error += (finite_difference - velocity) * (finite_difference - velocity);
+            savitzky_golay_error += (estimate - velocity) * (estimate - velocity);
+        }
+    }
+
+    std::cout << "RMS error finite difference: " << sqrt(difference_error / 900) << " Savitzky-Golay: " << sqrt(savitzky_golay_error / 900) << std::endl;
+    EXPECT_LT(savitzky_golay_error, 0.05 * difference_error);
+}
+
+TEST_F(DifferentiatorTest, DerivativeFilterEqualsKernelOnSignal)
+{
+    constexpr auto kernel = savitzky_golay_kernel<11, 2>();
+    KernelDifferentiator<double, 11> differentiator(kernel, sample_time);
+    DerivativeKernelFilter<double, 11> derivative_filter(kernel);
+
+    double previous = 0.0;
+    for (int i = 0; i < 200; ++i)
+    {
+        double signal = sin(2.0 * M_PI * 3.0 * i * sample_time) + 0.01 * ((i * 7919) % 13 - 6);
+        double from_signal = differentiator.update(signal);
+        double from_difference = derivative_filter.update((signal - previous) / sample_time);
+        previous = signal;
+        if (i >= 11)
+        {
+            EXPECT_NEAR(from_signal, from_difference, 1e-6);
+        }
+    }
+}
@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include <math.h>
+#include <roboost/motor_control/disturbance_observer.hpp>
+#include "simulated_motor.hpp"
+
+using namespace roboost::motor_control;
+
+// Motor with the nominal model, 1 kHz control with a slow PI like the wheel controllers
+class DisturbanceObserverTest : public ::testing::Test
+{
+protected:
+    const MotorModel model{25.0f, 0.08f, 2e-4f};
+    const float sample_time = 1e-3f;
+    const float kp = 0.04f;
+    const float ki = 0.4f;
+
+    struct StepResult
+    {
+        float max_drop;       // largest velocity drop after the load step in rad/s
+        float final_error;    // velocity error at the end in rad/s
+        float final_estimate; // observer estimate at the end in duty
+        float final_integral; // PI integral at the end in duty
+    };
+
+    // Run at 10 rad/s, apply a load of load duty at 0.5 s and stop after 1 s
+    StepResult simulate_load_step(float load, bool use_observer, float model_error = 1.0f, float noise = 0.0f)
+    {
+        DisturbanceObserver<2> observer(model, sample_time, 20.0f);
+        const float setpoint = 10.0f;
+        // True motor, a model error scales its gain
+        SimulatedMotor motor(sample_time, model.gain * model_error, model.time_constant);
+        motor.velocity = setpoint;
+        float integral = setpoint / model.gain;
+        float duty = integral;
+        StepResult result{0.0f, 0.0f, 0.0f, 0.0f};
+        uint32_t seed = 1;
+        for (int k = 0; k < 1000; k++)
+        {
+            const float disturbance = k >= 500 ? load : 0.0f;
+            motor.step(duty, disturbance);
+
+            // Deterministic noise of +-noise on the measurement
+            seed = seed * 1664525u + 1013904223u;
+            const float measured = motor.velocity + noise * (static_cast<float>(seed >> 8) / 8388608.0f - 1.0f);
+
+            const float error = setpoint - measured;
+            integral += ki * error * sample_time;
+            const float pid = kp * error + integral;
+            if (use_observer)
+            {
+                observer.update(measured);
+                duty = observer.compensate(pid);
+            }
+            else
+            {
+                duty = pid > 1.0f ? 1.0f : (pid < -1.0f ? -1.0f : pid);
+            }
+            if (k >= 500)
+            {
+                result.max_drop = fmaxf(result.max_drop, setpoint - motor.velocity);
+            }
+        }
+        result.final_error = setpoint - motor.velocity;
+        result.final_estimate = observer.get_disturbance();
+        result.final_integral = integral;
+        return result;
+    }
+};
+
+TEST_F(DisturbanceObserverTest, EstimatesLoadStep)
+{
+    const StepResult result = simulate_load_step(0.2f, true);
+    EXPECT_NEAR(result.final_estimate, 0.2f, 1e-3f);
+    EXPECT_LT(fabsf(result.final_error), 0.05f);
+    // The observer takes the load, the integral stays where it was
+    EXPECT_NEAR(result.final_integral, 10.0f / 25.0f, 0.01f);
+}
+
+TEST_F(DisturbanceObserverTest, RejectsLoadFasterThanIntegral)
+{
+    const StepResult without = simulate_load_step(0.2f, false);
+    const StepResult with = simulate_load_step(0.2f, true);
+    EXPECT_LT(with.max_drop, 0.5f * without.max_drop);
+    EXPECT_LT(fabsf(with.final_error), fabsf(without.final_error));
+}
+
+TEST_F(DisturbanceObserverTest, ModelErrorAppearsAsDisturbance)
+{
+    // A motor 20 % weaker than the model needs 0.5 duty where the model expects 0.4, which looks like a load of 0.1
+    const StepResult result = simulate_load_step(0.0f, true, 0.8f);
+    EXPECT_NEAR(result.final_estimate, 0.1f, 0.01f);
+    EXPECT_LT(fabsf(result.final_error), 0.05f);
+}
+
+TEST_F(DisturbanceObserverTest, FiltersMeasurementNoise)
+{
+    // 0.5 rad/s of noise is 1 duty per tick before the Q-filter
+    const StepResult result = simulate_load_step(0.2f, true, 1.0f, 0.5f);
+    EXPECT_NEAR(result.final_estimate, 0.2f, 0.1f);
+    EXPECT_LT(fabsf(result.final_error), 1.0f);
+}
+
+TEST_F(DisturbanceObserverTest, LimitsCompensationAndDuty)
+{
+    DisturbanceObserver<1> observer(model, sample_time, 50.0f, 0.3f);
+    observer.update(0.0f);
+    observer.compensate(1.0f);
+    // Full duty without any motion is a stall, the estimate stops at the limit
+    for (int i = 0; i < 1000; i++)
+    {
+        observer.update(0.0f);
+        EXPECT_LE(observer.compensate(1.0f), 1.0f);
+    }
+    EXPECT_FLOAT_EQ(observer.get_disturbance(), 0.3f);
+    EXPECT_FLOAT_EQ(observer.get_applied_duty(), 1.0f);
+    EXPECT_NEAR(observer.get_load_torque(), 0.3f * 25.0f * 2e-4f / 0.08f, 1e-6f);
+
+    observer.reset();
+    EXPECT_EQ(observer.get_disturbance(), 0.0f);
+    EXPECT_EQ(observer.compensate(0.5f), 0.5f);
+}
+
+class MockDriver : public MotorDriver
+{
+public:
+    void set_motor_control(int32_t value) override { value_ = value; }
+
+    int32_t get_motor_control() const override { return value_; }
+
+private:
+    int32_t value_ = 0;
+};
+
+class MockVelocityEncoder
+{
+public:
+    float get_velocity() const { return velocity; }
+
+    float velocity = 0.0f;
+};
+
+TEST_F(DisturbanceObserverTest, DriverAddsFeedforward)
+{
+    MockDriver driver;
+    MockVelocityEncoder encoder;
+    DisturbanceCompensatedDriver<MockVelocityEncoder> compensated(driver, encoder, DisturbanceObserver<2>(model, sample_time, 20.0f), 1024);
+    // The velocity controller only knows the driver interface
+    MotorDriver& controlled = compensated;
+
+    // A motor that does not move at half duty carries a load of half duty
+    for (int i = 0; i < 200; i++)
+    {
+        controlled.set_motor_control(512);
+    }
+    EXPECT_NEAR(compensated.get_observer().get_disturbance(), 1.0f, 0.01f);
+    EXPECT_EQ(driver.get_motor_control(), 1024);
+    EXPECT_EQ(controlled.get_motor_control(), 1024);
+}
@@ -0,0 +1,74 @@
+#include <conf_mpc.h>
+#include <gtest/gtest.h>
+#include <math.h>
+#include <roboost/utils/explicit_mpc_controller.hpp>
+#include "simulated_motor.hpp"
+
+using roboost::controllers::ExplicitMPCController;
+
+// Table of conf/conf_mpc.h, designed for a motor with 25 rad/s at full duty, 0.08 s time constant, a 20 ms period and a 20 rad/s limit
+using WheelMPCController = ExplicitMPCController<MPC_WHEEL_NODES, MPC_WHEEL_LAWS>;
+
+TEST(ExplicitMPCControllerTest, TracksStepWithoutOvershoot)
+{
+    WheelMPCController wheel(MPC_WHEEL_PLANES, MPC_WHEEL_CHILDREN, MPC_WHEEL_LAW_TABLE, MPC_WHEEL_VELOCITY_RANGE, MPC_WHEEL_MAX_VELOCITY);
+    // The velocity controller only knows the Controller interface
+    roboost::controllers::Controller& controller = wheel;
+    SimulatedMotor motor;
+    float peak = 0.0f;
+    for (int k = 0; k < 100; k++)
+    {
+        motor.step(controller.update(10.0f, motor.velocity));
+        peak = fmaxf(peak, motor.velocity);
+    }
+    EXPECT_NEAR(motor.velocity, 10.0f, 0.01f);
+    EXPECT_LT(peak, 10.05f);
+}
+
+TEST(ExplicitMPCControllerTest, SaturatesFarFromReference)
+{
+    WheelMPCController controller(MPC_WHEEL_PLANES, MPC_WHEEL_CHILDREN, MPC_WHEEL_LAW_TABLE, MPC_WHEEL_VELOCITY_RANGE, MPC_WHEEL_MAX_VELOCITY);
+    EXPECT_FLOAT_EQ(controller.update(15.0f, 0.0f), 1.0f);
+    EXPECT_EQ(controller.get_law(), 1u);
+    EXPECT_FLOAT_EQ(controller.update(-15.0f, 0.0f), -1.0f);
+    EXPECT_EQ(controller.get_law(), 2u);
+
+    // Close to the reference the unconstrained law is active
+    EXPECT_NEAR(controller.update(10.0f, 9.9f), -0.07310359f * 9.9f + 0.1131036f * 10.0f, 1e-6f);
+    EXPECT_EQ(controller.get_law(), 0u);
+}
+
+TEST(ExplicitMPCControllerTest, KeepsVelocityLimit)
+{
+    WheelMPCController controller(MPC_WHEEL_PLANES, MPC_WHEEL_CHILDREN, MPC_WHEEL_LAW_TABLE, MPC_WHEEL_VELOCITY_RANGE, MPC_WHEEL_MAX_VELOCITY);
+    SimulatedMotor motor;
+    float peak = 0.0f;
+    for (int k = 0; k < 100; k++)
+    {
+        // Beyond the limit the reference is clamped to it
+        motor.step(controller.update(30.0f, motor.velocity));
+        peak = fmaxf(peak, motor.velocity);
+    }
+    EXPECT_LT(peak, MPC_WHEEL_MAX_VELOCITY + 0.01f);
+    EXPECT_NEAR(motor.velocity, MPC_WHEEL_MAX_VELOCITY, 0.01f);
+
+    // Pushed beyond the limit, the wheel is brought back within one period
+    motor.velocity = 26.0f;
+    motor.step(controller.update(MPC_WHEEL_MAX_VELOCITY, motor.velocity));
+    EXPECT_EQ(controller.get_law(), 3u);
+    EXPECT_NEAR(motor.velocity, MPC_WHEEL_MAX_VELOCITY, 0.01f);
+
+    // Measured velocities beyond the table are treated as its edge
+    EXPECT_FLOAT_EQ(controller.update(0.0f, 100.0f), controller.update(0.0f, MPC_WHEEL_VELOCITY_RANGE));
+}
+
+TEST(ExplicitMPCControllerTest, SingleLawTable)
+{
+    constexpr float planes[1][3] = {{0, 0, 0}};
+    constexpr int16_t children[1][2] = {{-1, -1}};
+    constexpr float laws[1][3] = {{0, 0.1, 2.0}};
+    ExplicitMPCController<1, 1> controller(planes, children, laws, MPC_WHEEL_VELOCITY_RANGE, MPC_WHEEL_MAX_VELOCITY, 0.5f);
+    EXPECT_FLOAT_EQ(controller.update(-10.0f, 3.0f), 0.5f);
+    EXPECT_FLOAT_EQ(controller.update(-30.0f, 3.0f), 0.0f);
+    EXPECT_EQ(controller.get_law(), 0u);
+}
@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <math.h>
+#include <roboost/utils/fast_math.hpp>
+#include <type_traits>
+
+using namespace roboost::math;
+
+// The bounds are the ones documented in fast_math.hpp, checked on a dense grid against libm in double
+
+TEST(FastMathTest, SineAndCosineStayWithinBounds)
+{
+    double poly_error = 0.0, table_error = 0.0;
+    for (int i = -200000; i <= 200000; i++)
+    {
+        const float x = i * 5e-3f;
+        const double reference_sin = sin(static_cast<double>(x));
+        const double reference_cos = cos(static_cast<double>(x));
+        poly_error = std::max({poly_error, fabs(poly_sin(x) - reference_sin), fabs(poly_cos(x) - reference_cos)});
+        table_error = std::max({table_error, fabs(table_sin(x) - reference_sin), fabs(table_cos(x) - reference_cos)});
+    }
+    EXPECT_LT(poly_error, 3e-7);
+    EXPECT_LT(table_error, 8e-5);
+}
+
+TEST(FastMathTest, Atan2StaysWithinBoundsInAllQuadrants)
+{
+    double poly_error = 0.0, table_error = 0.0;
+    for (int i = 0; i < 100000; i++)
+    {
+        const double angle = i * (2.0 * M_PI / 100000) - M_PI;
+        const float y = 2.5f * sin(angle);
+        const float x = 2.5f * cos(angle);
+        const double reference = atan2(static_cast<double>(y), static_cast<double>(x));
+        // -pi and pi are the same direction
+        poly_error = std::max(poly_error, fabs(remainder(poly_atan2(y, x) - reference, 2.0 * M_PI)));
+        table_error = std::max(table_error, fabs(remainder(table_atan2(y, x) - reference, 2.0 * M_PI)));
+    }
+    EXPECT_LT(poly_error, 2e-6);
+    EXPECT_LT(table_error, 2e-6);
+    EXPECT_EQ(poly_atan2(0.0f, 0.0f), 0.0f);
+    EXPECT_EQ(table_atan2(0.0f, 0.0f), 0.0f);
+    EXPECT_NEAR(poly_atan2(0.0f, -1.0f), M_PI, 1e-6);
+}
+
+TEST(FastMathTest, SqrtStaysWithinRelativeBounds)
+{
+    double poly_error = 0.0, table_error = 0.0;
+    for (int i = 0; i < 200000; i++)
+    {
+        // Mantissas across the range and exponents of both parities
+        const float x = ldexpf(1.0f + i / 200000.0f, i % 120 - 60);
+        const double reference = sqrt(static_cast<double>(x));
+        poly_error = std::max(poly_error, fabs(poly_sqrt(x) - reference) / reference);
+        table_error = std::max(table_error, fabs(table_sqrt(x) - reference) / reference);
+    }
+    EXPECT_LT(poly_error, 3e-7);
+    EXPECT_LT(table_error, 5e-6);
+    EXPECT_EQ(poly_sqrt(0.0f), 0.0f);
+    EXPECT_EQ(table_sqrt(-1.0f), 0.0f);
+}
+
+TEST(FastMathTest, FixedPointSineAndAtan2StayWithinBounds)
+{
+    int sine_error = 0;
+    for (int32_t angle = 0; angle < 65536; angle++)
+    {
+        const double radians = angle * (2.0 * M_PI / 65536);
+        sine_error = std::max(sine_error, static_cast<int>(ceil(fabs(sin_q15(static_cast<uint16_t>(angle)) - sin(radians) * 32768.0))));
+        sine_error = std::max(sine_error, static_cast<int>(ceil(fabs(cos_q15(static_cast<uint16_t>(angle)) - cos(radians) * 32768.0))));
+    }
+    EXPECT_LE(sine_error, 4);
+
+    double angle_error = 0.0;
+    for (int i = 0; i < 100000; i++)
+    {
+        const double angle = i * (2.0 * M_PI / 100000);
+        const int32_t y = static_cast<int32_t>(lround(1e6 * sin(angle)));
+        const int32_t x = static_cast<int32_t>(lround(1e6 * cos(angle)));
+        const double reference = atan2(static_cast<double>(y), static_cast<double>(x)) * 65536.0 / (2.0 * M_PI);
+        angle_error = std::max(angle_error, fabs(remainder(atan2_bam(y, x) - reference, 65536.0)));
+    }
+    EXPECT_LT(angle_error, 4.0);
+    EXPECT_EQ(atan2_bam(0, -5), 32768);
+    EXPECT_EQ(atan2_bam(-5, 0), 49152);
+}
+
+TEST(FastMathTest, IntegerSqrtIsExactFloor)
+{
+    for (uint64_t x = 0; x < 100000; x++)
+    {
+        const uint64_t root = isqrt(x);
+        EXPECT_LE(root * root, x);
+        EXPECT_GT((root + 1) * (root + 1), x);
+    }
+    EXPECT_EQ(isqrt(UINT64_MAX), UINT32_MAX);
+    EXPECT_EQ(sqrt_q16(4u << 16), 2u << 16);
+    EXPECT_EQ(sqrt_q16(2u << 16), 92681u); // sqrt(2) * 65536 = 92681.9
+}
+
+TEST(FastMathTest, BinaryAnglesWrap)
+{
+    EXPECT_EQ(rad_to_bam(M_PI / 2), 16384);
+    EXPECT_EQ(rad_to_bam(-M_PI / 2), 49152);
+    EXPECT_EQ(rad_to_bam(4.0f * M_PI + M_PI / 2), 16384);
+    EXPECT_NEAR(bam_to_rad(static_cast<int16_t>(49152)), -M_PI / 2, 1e-6);
+    EXPECT_NEAR(wrap_angle(3.0f * M_PI / 2), -M_PI / 2, 1e-6);
+}
+
+TEST(FastMathTest, PoliciesWrapAlike)
+{
+    // The default policy keeps the double precision of libm
+    static_assert(std::is_same<decltype(LibmMath::sin(0.0)), double>::value, "LibmMath is double precision");
+    EXPECT_DOUBLE_EQ(LibmMath::cos(1.0), cos(1.0));
+
+    for (double angle = -20.0; angle <= 20.0; angle += 0.37)
+    {
+        const double wrapped = LibmMath::wrap_angle(angle);
+        EXPECT_LE(fabs(wrapped), M_PI);
+        EXPECT_NEAR(sin(wrapped), sin(angle), 1e-12);
+        EXPECT_NEAR(PolynomialMath::wrap_angle(angle), wrapped, 1e-5);
+        EXPECT_NEAR(TableMath::wrap_angle(angle), wrapped, 1e-5);
+    }
+}
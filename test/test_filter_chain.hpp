@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include <roboost/utils/filter_chain.hpp>
+#include <roboost/utils/filter_design.hpp>
+#include <roboost/utils/filters.hpp>
+
+using namespace roboost::filters;
+
+class FilterChainTest : public ::testing::Test
+{
+protected:
+    struct PassThrough
+    {
+        float update(float input) { return input; }
+    };
+
+    struct Gain
+    {
+        float gain;
+        float update(float input) { return gain * input; }
+    };
+
+    struct Accumulator
+    {
+        float sum = 0.0f;
+        float update(float input) { return sum += input; }
+        void reset() { sum = 0.0f; }
+    };
+};
+
+TEST_F(FilterChainTest, AppliesFiltersInOrder)
+{
+    FilterChain<Gain, Accumulator, Gain> chain(Gain{2.0f}, Accumulator{}, Gain{-1.0f});
+
+    EXPECT_FLOAT_EQ(chain.update(1.0f), -2.0f);
+    EXPECT_FLOAT_EQ(chain.update(3.0f), -8.0f);
+    EXPECT_EQ(chain.size(), 3u);
+}
+
+TEST_F(FilterChainTest, ResetsOnlyFiltersWithState)
+{
+    Accumulator shared;
+    FilterChain<Accumulator&, Gain> chain(shared, Gain{0.5f});
+
+    chain.update(4.0f);
+    EXPECT_FLOAT_EQ(shared.sum, 4.0f);
+
+    chain.reset();
+    EXPECT_FLOAT_EQ(shared.sum, 0.0f);
+    EXPECT_FLOAT_EQ(chain.update(1.0f), 0.5f);
+}
+
+TEST_F(FilterChainTest, EmptyFiltersTakeNoSpace)
+{
+    FilterChain<PassThrough, PassThrough, PassThrough> chain(PassThrough{}, PassThrough{}, PassThrough{});
+    FilterChain<> empty;
+
+    EXPECT_EQ(sizeof(chain), 1u);
+    EXPECT_FLOAT_EQ(chain.update(1.5f), 1.5f);
+    EXPECT_FLOAT_EQ(empty.update(1.5f), 1.5f);
+}
+
+TEST_F(FilterChainTest, ChainsLibraryNoFilter)
+{
+    FilterChain<NoFilter<float>, Gain, NoFilter<float>> chain(NoFilter<float>(), Gain{2.0f}, NoFilter<float>());
+    FilterChain<NoFilter<float>, NoFilter<float>> pass_through{NoFilter<float>(), NoFilter<float>()};
+
+    EXPECT_FLOAT_EQ(chain.update(1.5f), 3.0f);
+    EXPECT_FLOAT_EQ(chain.update(-0.5f), -1.0f);
+    EXPECT_FLOAT_EQ(pass_through.update(0.25f), 0.25f);
+
+    chain.reset();
+    pass_through.reset();
+    EXPECT_FLOAT_EQ(chain.update(2.0f), 4.0f);
+    EXPECT_FLOAT_EQ(pass_through.update(-1.0f), -1.0f);
+}
+
+TEST_F(FilterChainTest, RetuneFilterInChain)
+{
+    FilterChain<SOSFilter<float, 1>, Gain> chain(SOSFilter<float, 1>(design_notch(1000.0, 50.0, 2.0)), Gain{1.0f});
+
+    chain.get<1>().gain = 3.0f;
+    EXPECT_FLOAT_EQ(chain.update(1.0f), 3.0f * design_notch(1000.0, 50.0, 2.0)[0].b0);
+}
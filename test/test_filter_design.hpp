@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <math.h>
+#include <roboost/utils/filter_design.hpp>
+
+using namespace roboost::filters;
+
+class FilterDesignTest : public ::testing::Test
+{
+protected:
+    static constexpr double sample_rate = 1000.0;
+
+    // Steady state gain for a sine input, from the RMS value of the last second
+    template <typename Filter>
+    double sine_gain(Filter& filter, double frequency)
+    {
+        filter.reset();
+        double squared_sum = 0.0;
+        for (int i = 0; i < 4000; ++i)
+        {
+            double output = filter.update(sin(2.0 * M_PI * frequency * i / sample_rate));
+            if (i >= 3000)
+            {
+                squared_sum += output * output;
+            }
+        }
+        return sqrt(2.0 * squared_sum / 1000.0);
+    }
+};
+
+// Designs are evaluated by the compiler
+constexpr auto butterworth_lowpass = design_butterworth_lowpass<2>(1000.0, 50.0);
+static_assert(butterworth_lowpass[0].b0 > 0.0, "Butterworth design is not constexpr");
+
+TEST_F(FilterDesignTest, ButterworthLowpassCutoff)
+{
+    SOSFilter<double, 2> filter(butterworth_lowpass);
+
+    EXPECT_NEAR(sine_gain(filter, 1.0), 1.0, 1e-3);
+    EXPECT_NEAR(sine_gain(filter, 50.0), 1.0 / sqrt(2.0), 5e-3);
+    // Fourth order: -80 dB per decade above the cutoff
+    EXPECT_LT(sine_gain(filter, 200.0), 5e-3);
+}
+
+TEST_F(FilterDesignTest, ButterworthHighpassCutoff)
+{
+    SOSFilter<double, 2> filter(design_butterworth_highpass<2>(sample_rate, 50.0));
+
+    EXPECT_NEAR(sine_gain(filter, 50.0), 1.0 / sqrt(2.0), 5e-3);
+    EXPECT_NEAR(sine_gain(filter, 300.0), 1.0, 5e-3);
+    EXPECT_LT(sine_gain(filter, 5.0), 1e-3);
+}
+
+TEST_F(FilterDesignTest, BesselStepHasNoOvershoot)
+{
+    SOSFilter<float, 3> filter(design_bessel_lowpass<3>(sample_rate, 20.0));
+
+    EXPECT_NEAR(sine_gain(filter, 20.0), 1.0 / sqrt(2.0), 1e-2);
+
+    filter.reset();
+    float max_output = 0.0f;
+    for (int i = 0; i < 1000; ++i)
+    {
+        max_output = fmaxf(max_output, filter.update(1.0f));
+    }
+    EXPECT_LT(max_output, 1.01f);
+    EXPECT_NEAR(filter.get_output(), 1.0f, 1e-4);
+}
+
+TEST_F(FilterDesignTest, NotchRemovesRollerVibration)
+{
+    // 12 rollers on a wheel turning at 10 rad/s
+    const double vibration_frequency = 10.0 * 12 / (2.0 * M_PI);
+    SOSFilter<float, 1> filter(design_notch(sample_rate, vibration_frequency, 2.0));
+
+    EXPECT_LT(sine_gain(filter, vibration_frequency), 1e-2);
+    EXPECT_NEAR(sine_gain(filter, 1.0), 1.0, 1e-2);
+    EXPECT_NEAR(sine_gain(filter, 200.0), 1.0, 1e-2);
+}
+
+TEST_F(FilterDesignTest, BandstopAttenuatesBand)
+{
+    SOSFilter<double, 3> filter(design_bandstop<3>(sample_rate, 15.0, 30.0));
+
+    EXPECT_NEAR(sine_gain(filter, 15.0), 1.0 / sqrt(2.0), 1e-2);
+    EXPECT_NEAR(sine_gain(filter, 30.0), 1.0 / sqrt(2.0), 1e-2);
+    EXPECT_LT(sine_gain(filter, sqrt(15.0 * 30.0)), 1e-2);
+    EXPECT_NEAR(sine_gain(filter, 1.0), 1.0, 1e-2);
+    EXPECT_NEAR(sine_gain(filter, 200.0), 1.0, 1e-2);
+}
+
+TEST_F(FilterDesignTest, FixedPointMatchesFloatingPoint)
+{
+    SOSFilter<double, 2> reference(butterworth_lowpass);
+    FixedPointSOSFilter<2> filter(butterworth_lowpass);
+
+    double max_error = 0.0;
+    for (int i = 0; i < 2000; ++i)
+    {
+        int32_t input = static_cast<int32_t>(100000 * sin(2.0 * M_PI * 20.0 * i / sample_rate)) + ((i * 7919) % 2001 - 1000);
+        max_error = fmax(max_error, fabs(filter.update(input) - reference.update(input)));
+    }
+
+    std::cout << "Maximum fixed point error: " << max_error << std::endl;
+    EXPECT_LT(max_error, 10.0);
+}
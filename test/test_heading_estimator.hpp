@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include <math.h>
+#include <roboost/sensors/imu.hpp>
+#include <roboost/utils/heading_estimator.hpp>
+
+using namespace roboost::estimators;
+using namespace roboost::sensors;
+
+class HeadingEstimatorTest : public ::testing::Test
+{
+protected:
+    static constexpr float dt = 0.02f;
+    static constexpr float gyro_bias = 0.02f;
+
+    SimulatedImu imu{gyro_bias, 0.005f};
+    HeadingKalmanFilter heading_filter;
+    FusedOdometry<HeadingKalmanFilter> odometry{heading_filter};
+
+    // Run the filter for a duration with the given true yaw rate and slip factor
+    // of the wheel odometry, returns the integrated true heading change
+    float run(float duration, float yaw_rate, float wheel_slip_factor)
+    {
+        float heading = 0.0f;
+        for (int i = 0; i < static_cast<int>(duration / dt); ++i)
+        {
+            imu.set_motion(yaw_rate);
+            imu.update();
+            odometry.update(0.0f, 0.0f, yaw_rate * wheel_slip_factor, imu.get_sample().angular_velocity[2], dt);
+            heading += yaw_rate * dt;
+        }
+        return heading;
+    }
+};
+
+TEST_F(HeadingEstimatorTest, EstimatesGyroBiasAtStandstill)
+{
+    run(20.0f, 0.0f, 1.0f);
+    std::cout << "Estimated bias: " << heading_filter.get_bias() << ", expected: " << gyro_bias << std::endl;
+    EXPECT_NEAR(heading_filter.get_bias(), gyro_bias, 0.003f);
+    EXPECT_NEAR(odometry.get_heading(), 0.0f, 0.05f);
+}
+
+TEST_F(HeadingEstimatorTest, RejectsWheelSlipDuringRotation)
+{
+    run(20.0f, 0.0f, 1.0f);
+    float true_heading = run(1.5f, 1.0f, 1.25f); // Wheels report 25% too much rotation
+
+    std::cout << "Fused heading: " << odometry.get_heading() << ", true heading: " << true_heading << ", wheel heading: " << true_heading * 1.25f << std::endl;
+    EXPECT_NEAR(odometry.get_heading(), true_heading, 0.02f);
+    EXPECT_GT(heading_filter.get_rejected_count(), 0u);
+}
+
+TEST(ComplementaryHeadingFilterTest, BlendsRates)
+{
+    ComplementaryHeadingFilter filter(0.9f);
+    float rate = filter.update(1.0f, 2.0f, 0.1f);
+    EXPECT_FLOAT_EQ(rate, 1.1f);
+    EXPECT_NEAR(filter.get_heading(), 0.11f, 1e-6);
+}
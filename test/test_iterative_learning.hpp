@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include <math.h>
+#include <roboost/motor_control/iterative_learning.hpp>
+#include "simulated_motor.hpp"
+
+using roboost::motor_control::IterativeLearningController;
+
+namespace ilc_test
+{
+    constexpr float SAMPLE_TIME = 0.02f;
+    constexpr size_t RUN_LENGTH = 150;
+
+    // Motor with a proportional velocity loop, the loop lags behind fast commands
+    struct Loop
+    {
+        SimulatedMotor motor{SAMPLE_TIME};
+
+        void step(float command, float load) { motor.step(0.05f * (command - motor.velocity) + command / 25.0f, load); }
+    };
+
+    // Trapezoid to 10 rad/s with a bump of load in the middle, the same every run
+    float profile(size_t k) { return k < 25 ? 0.4f * k : (k < 100 ? 10.0f : (k < 125 ? 10.0f - 0.4f * (k - 100) : 0.0f)); }
+
+    float load(size_t k) { return k >= 50 && k < 75 ? 0.1f : 0.0f; }
+
+    template <typename ILC>
+    float run(ILC& ilc, uint8_t id)
+    {
+        Loop loop;
+        float squared_error = 0.0f;
+        ilc.start(id);
+        for (size_t k = 0; k < RUN_LENGTH; k++)
+        {
+            loop.step(profile(k) + ilc.get_feedforward()[0], load(k));
+            const float error[1] = {profile(k) - loop.motor.velocity};
+            ilc.record(error);
+            squared_error += error[0] * error[0];
+        }
+        ilc.finish();
+        return sqrtf(squared_error / RUN_LENGTH);
+    }
+} // namespace ilc_test
+
+TEST(IterativeLearningTest, ErrorFallsOverRuns)
+{
+    const float max_feedforward[1] = {5.0f};
+    IterativeLearningController<1, 200, 2> ilc(0.8f, 1, ilc_test::SAMPLE_TIME, 5.0f, max_feedforward);
+
+    const float first = ilc_test::run(ilc, 1);
+    float previous = first;
+    for (int i = 0; i < 10; i++)
+    {
+        const float error = ilc_test::run(ilc, 1);
+        EXPECT_LT(error, previous * 1.01f);
+        previous = error;
+    }
+    EXPECT_LT(previous, 0.2f * first);
+    EXPECT_EQ(ilc.get_iterations(1), 11u);
+    EXPECT_NEAR(ilc.get_rms_error(1), previous, 1e-5f);
+}
+
+TEST(IterativeLearningTest, NoFeedforwardOutsideRuns)
+{
+    const float max_feedforward[1] = {5.0f};
+    IterativeLearningController<1, 200, 2> ilc(0.8f, 1, ilc_test::SAMPLE_TIME, 5.0f, max_feedforward);
+    for (int i = 0; i < 3; i++)
+    {
+        ilc_test::run(ilc, 1);
+    }
+    EXPECT_FALSE(ilc.is_running());
+    EXPECT_FLOAT_EQ(ilc.get_feedforward()[0], 0.0f);
+
+    ilc.start(1);
+    EXPECT_EQ(ilc.get_active_id(), 1);
+    EXPECT_NE(ilc.get_feedforward()[0], 0.0f);
+}
+
+TEST(IterativeLearningTest, TrajectoriesAreLearnedSeparately)
+{
+    const float max_feedforward[1] = {5.0f};
+    IterativeLearningController<1, 200, 2> ilc(0.8f, 1, ilc_test::SAMPLE_TIME, 5.0f, max_feedforward);
+    for (int i = 0; i < 5; i++)
+    {
+        ilc_test::run(ilc, 7);
+    }
+    EXPECT_EQ(ilc.get_iterations(7), 5u);
+    EXPECT_EQ(ilc.get_iterations(9), 0u);
+
+    // A new trajectory starts without feedforward
+    ilc.start(9);
+    EXPECT_FLOAT_EQ(ilc.get_feedforward()[0], 0.0f);
+    ilc.abort();
+    EXPECT_EQ(ilc.get_iterations(9), 0u);
+
+    // Both slots are taken
+    EXPECT_FALSE(ilc.start(11));
+    EXPECT_FALSE(ilc.is_running());
+    ilc.forget(9);
+    EXPECT_TRUE(ilc.start(11));
+    EXPECT_FALSE(ilc.start(0));
+}
+
+TEST(IterativeLearningTest, AbortedRunIsNotLearned)
+{
+    const float max_feedforward[1] = {5.0f};
+    IterativeLearningController<1, 200, 2> ilc(0.8f, 1, ilc_test::SAMPLE_TIME, 5.0f, max_feedforward);
+    ilc_test::run(ilc, 1);
+    ilc.start(1);
+    const float before = ilc.get_feedforward()[0];
+    const float error[1] = {100.0f};
+    for (int k = 0; k < 20; k++)
+    {
+        ilc.record(error);
+    }
+    ilc.abort();
+    EXPECT_FALSE(ilc.finish());
+    EXPECT_EQ(ilc.get_iterations(1), 1u);
+    ilc.start(1);
+    EXPECT_FLOAT_EQ(ilc.get_feedforward()[0], before);
+}
+
+TEST(IterativeLearningTest, FeedforwardIsLimited)
+{
+    const float max_feedforward[2] = {0.5f, 5.0f};
+    IterativeLearningController<2, 50, 1> ilc(1.0f, 0, ilc_test::SAMPLE_TIME, 5.0f, max_feedforward);
+    const float error[2] = {10.0f, 1.0f};
+    ilc.start(1);
+    // Longer than the buffer, the rest is not recorded
+    for (int k = 0; k < 80; k++)
+    {
+        ilc.record(error);
+    }
+    EXPECT_TRUE(ilc.finish());
+    ilc.start(1);
+    for (int k = 0; k < 50; k++)
+    {
+        EXPECT_FLOAT_EQ(ilc.get_feedforward()[0], 0.5f);
+        EXPECT_NEAR(ilc.get_feedforward()[1], 1.0f, 1e-5f);
+        const float none[2] = {0.0f, 0.0f};
+        ilc.record(none);
+    }
+    EXPECT_FLOAT_EQ(ilc.get_feedforward()[0], 0.0f);
+}
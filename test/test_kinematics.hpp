@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
+#include <roboost/kinematics/drive_kinematics.hpp>
 #include <roboost/kinematics/kinematics.hpp>
+#include <roboost/motor_control/drive_velocity_controller.hpp>
 
 using namespace roboost::kinematics;
 
@@ -57,4 +59,111 @@ TEST_F(MecanumKinematicsTest, CalculateRobotVelocity)
     ASSERT_EQ(calculated_velocity.size(), expected_robot_velocity.size()); // Ensure size matches
 
     // Expected vel is
-}
\ No newline at end of file
+}
+
+TEST_F(MecanumKinematicsTest, RoundTrip)
+{
+    roboost::math::Vector<float> robot_velocity = {0.3, -0.2, 0.8};
+
+    roboost::math::Vector<float> wheel_velocity = kinematics->calculate_wheel_velocity(robot_velocity);
+    roboost::math::Vector<float> calculated_velocity = kinematics->calculate_robot_velocity(wheel_velocity);
+    ASSERT_EQ(calculated_velocity.size(), robot_velocity.size());
+    for (size_t i = 0; i < calculated_velocity.size(); ++i)
+    {
+        EXPECT_NEAR(calculated_velocity[i], robot_velocity[i], 1e-5);
+    }
+}
+
+// Round trips of the drive kinematics, one fixture per model
+template <typename Kinematics>
+class DriveKinematicsTest : public ::testing::Test
+{
+protected:
+    static const Kinematics kinematics;
+};
+
+template <>
+const DifferentialDriveKinematics DriveKinematicsTest<DifferentialDriveKinematics>::kinematics{0.05f, 0.3f};
+template <>
+const OmniKinematics3W DriveKinematicsTest<OmniKinematics3W>::kinematics{0.05f, 0.2f};
+template <>
+const MecanumDriveKinematics DriveKinematicsTest<MecanumDriveKinematics>::kinematics{0.05f, 0.4f, 0.3f};
+
+using DriveKinematicsTypes = ::testing::Types<DifferentialDriveKinematics, OmniKinematics3W, MecanumDriveKinematics>;
+TYPED_TEST_SUITE(DriveKinematicsTest, DriveKinematicsTypes);
+
+TYPED_TEST(DriveKinematicsTest, SatisfiesInterface) { static_assert(is_drive_kinematics<TypeParam>::value, "Drive kinematics interface not satisfied"); }
+
+TYPED_TEST(DriveKinematicsTest, RobotVelocityRoundTrip)
+{
+    // The differential drive cannot move sideways
+    const float vy = TypeParam::WHEEL_COUNT == 2 ? 0.0f : -0.2f;
+    RobotVelocity robot_velocity = {0.3f, vy, 0.8f};
+
+    RobotVelocity calculated_velocity = this->kinematics.calculate_robot_velocity(this->kinematics.calculate_wheel_velocity(robot_velocity));
+    for (size_t i = 0; i < 3; ++i)
+    {
+        EXPECT_NEAR(calculated_velocity[i], robot_velocity[i], 1e-5);
+    }
+}
+
+TYPED_TEST(DriveKinematicsTest, WheelVelocityRoundTrip)
+{
+    // Wheel velocities of a feasible motion, redundant wheels must agree
+    typename TypeParam::WheelVelocity wheel_velocity = this->kinematics.calculate_wheel_velocity({-0.1f, 0.4f, -1.5f});
+
+    typename TypeParam::WheelVelocity calculated_velocity = this->kinematics.calculate_wheel_velocity(this->kinematics.calculate_robot_velocity(wheel_velocity));
+    for (size_t i = 0; i < TypeParam::WHEEL_COUNT; ++i)
+    {
+        EXPECT_NEAR(calculated_velocity[i], wheel_velocity[i], 1e-4);
+    }
+}
+
+TEST(DifferentialDriveKinematicsTest, TurnsInPlace)
+{
+    constexpr DifferentialDriveKinematics kinematics(0.05f, 0.3f);
+    constexpr DifferentialDriveKinematics::WheelVelocity wheel_velocity = kinematics.calculate_wheel_velocity({0.0f, 0.0f, 1.0f});
+
+    // Evaluated at compile time
+    static_assert(wheel_velocity[0] < 0.0f && wheel_velocity[1] > 0.0f, "Left wheel must drive backwards when turning left");
+    EXPECT_NEAR(wheel_velocity[0], -3.0f, 1e-5);
+    EXPECT_NEAR(wheel_velocity[1], 3.0f, 1e-5);
+}
+
+TEST(OmniKinematics3WTest, DrivesForward)
+{
+    OmniKinematics3W kinematics(0.05f, 0.2f);
+    OmniKinematics3W::WheelVelocity wheel_velocity = kinematics.calculate_wheel_velocity({0.1f, 0.0f, 0.0f});
+
+    // The wheel at 0 deg rolls along y and stays still, the others turn in opposite directions
+    EXPECT_NEAR(wheel_velocity[0], 0.0f, 1e-6);
+    EXPECT_NEAR(wheel_velocity[1], -wheel_velocity[2], 1e-6);
+    EXPECT_NEAR(wheel_velocity[1], -0.1f * 0.866025f / 0.05f, 1e-4);
+}
+
+// Motors that reach their setpoint within one update
+struct IdealMotorManager
+{
+    float speeds[3] = {};
+
+    void set_motor_speed(size_t index, float speed) { speeds[index] = speed; }
+
+    float get_motor_speed(size_t index) const { return speeds[index]; }
+
+    void update() {}
+};
+
+TEST(DriveVelocityControllerTest, TracksCommandOfOmniDrive)
+{
+    IdealMotorManager motors;
+    roboost::robot_controller::DriveVelocityController<OmniKinematics3W, IdealMotorManager> controller(motors, OmniKinematics3W(0.05f, 0.2f));
+    static_assert(decltype(controller)::WHEEL_COUNT == 3, "Wheel count must follow the kinematics");
+
+    controller.set_latest_command({0.2f, 0.1f, -0.5f});
+    controller.update();
+
+    EXPECT_NEAR(controller.get_robot_vel()[0], 0.2f, 1e-5);
+    EXPECT_NEAR(controller.get_robot_vel()[1], 0.1f, 1e-5);
+    EXPECT_NEAR(controller.get_robot_vel()[2], -0.5f, 1e-5);
+    EXPECT_FLOAT_EQ(motors.speeds[2], controller.get_wheel_vel_setpoints()[2]);
+}
@@ -0,0 +1,124 @@
+#include <conf_lqr.h>
+#include <gtest/gtest.h>
+#include <math.h>
+#include <roboost/utils/lqr_controller.hpp>
+#include "simulated_motor.hpp"
+
+using roboost::controllers::LQRController;
+using roboost::controllers::LQRVelocityController;
+
+// Gains of conf/conf_lqr.h, designed for a motor with 25 rad/s at full duty, 0.08 s time constant and a 20 ms period
+
+TEST(LQRControllerTest, WheelTracksStepWithoutOffset)
+{
+    LQRController<1, 1, 1> controller(LQR_WHEEL_KX, LQR_WHEEL_KI, LQR_WHEEL_KR, LQR_WHEEL_C, LQR_WHEEL_SAMPLE_TIME, 1.0f, 5.0f);
+    SimulatedMotor motor;
+    float peak = 0.0f;
+    for (int k = 0; k < 100; k++)
+    {
+        motor.step(controller.update(10.0f, motor.velocity));
+        peak = fmaxf(peak, motor.velocity);
+        if (k == 2)
+        {
+            // 90 % after two periods, as reported by lqr_design
+            EXPECT_GT(motor.velocity, 9.0f);
+        }
+    }
+    EXPECT_NEAR(motor.velocity, 10.0f, 0.01f);
+    EXPECT_LT(peak, 11.0f);
+}
+
+TEST(LQRControllerTest, IntegralRemovesLoad)
+{
+    LQRController<1, 1, 1> controller(LQR_WHEEL_KX, LQR_WHEEL_KI, LQR_WHEEL_KR, LQR_WHEEL_C, LQR_WHEEL_SAMPLE_TIME, 1.0f, 5.0f);
+    SimulatedMotor motor;
+    motor.gain = 20.0f; // weaker than the model
+    for (int k = 0; k < 300; k++)
+    {
+        motor.step(controller.update(10.0f, motor.velocity), k >= 100 ? 0.2f : 0.0f);
+    }
+    EXPECT_NEAR(motor.velocity, 10.0f, 0.01f);
+    EXPECT_GT(controller.get_integral(0), 0.0f);
+}
+
+TEST(LQRControllerTest, IntegralHoldsWhileSaturated)
+{
+    LQRController<1, 1, 1> controller(LQR_WHEEL_KX, LQR_WHEEL_KI, LQR_WHEEL_KR, LQR_WHEEL_C, LQR_WHEEL_SAMPLE_TIME, 1.0f, 5.0f);
+    SimulatedMotor motor;
+    // 40 rad/s is out of reach, the duty stays at its limit and the integral does not wind up
+    for (int k = 0; k < 200; k++)
+    {
+        const float duty = controller.update(40.0f, motor.velocity);
+        EXPECT_LE(duty, 1.0f);
+        motor.step(duty);
+    }
+    EXPECT_NEAR(motor.velocity, 25.0f, 0.01f);
+    EXPECT_EQ(controller.get_integral(0), 0.0f);
+
+    // Back in range there is no wound up integral to unwind
+    for (int k = 0; k < 50; k++)
+    {
+        motor.step(controller.update(10.0f, motor.velocity));
+    }
+    EXPECT_NEAR(motor.velocity, 10.0f, 0.1f);
+}
+
+TEST(LQRControllerTest, ScalarAndVectorUpdateMatch)
+{
+    LQRController<1, 1, 1> scalar(LQR_WHEEL_KX, LQR_WHEEL_KI, LQR_WHEEL_KR, LQR_WHEEL_C, LQR_WHEEL_SAMPLE_TIME, 1.0f, 5.0f);
+    LQRController<1, 1, 1> vector(LQR_WHEEL_KX, LQR_WHEEL_KI, LQR_WHEEL_KR, LQR_WHEEL_C, LQR_WHEEL_SAMPLE_TIME, 1.0f, 5.0f);
+    for (int k = 0; k < 20; k++)
+    {
+        const float reference[1] = {5.0f};
+        const float state[1] = {0.3f * k};
+        float output[1];
+        vector.update(reference, state, output);
+        EXPECT_FLOAT_EQ(scalar.update(5.0f, 0.3f * k), output[0]);
+    }
+    scalar.reset();
+    EXPECT_EQ(scalar.get_integral(0), 0.0f);
+}
+
+TEST(LQRControllerTest, VelocityControllerMatchesScalarUpdate)
+{
+    LQRController<1, 1, 1> scalar(LQR_WHEEL_KX, LQR_WHEEL_KI, LQR_WHEEL_KR, LQR_WHEEL_C, LQR_WHEEL_SAMPLE_TIME, 1.0f, 5.0f);
+    LQRVelocityController wheel(LQR_WHEEL_KX, LQR_WHEEL_KI, LQR_WHEEL_KR, LQR_WHEEL_C, LQR_WHEEL_SAMPLE_TIME, 1.0f, 5.0f);
+    // The velocity controller only knows the Controller interface
+    roboost::controllers::Controller& controller = wheel;
+    for (int k = 0; k < 20; k++)
+    {
+        EXPECT_FLOAT_EQ(static_cast<float>(controller.update(5.0, 0.3 * k)), scalar.update(5.0f, 0.3f * k));
+    }
+    EXPECT_FLOAT_EQ(wheel.get_lqr().get_integral(0), scalar.get_integral(0));
+    wheel.reset();
+    EXPECT_EQ(wheel.get_lqr().get_integral(0), 0.0f);
+}
+
+TEST(LQRControllerTest, ChassisTracksRobotVelocityWithMismatchedWheels)
+{
+    LQRController<4, 4, 3> controller(LQR_CHASSIS_KX, LQR_CHASSIS_KI, LQR_CHASSIS_KR, LQR_CHASSIS_C, LQR_CHASSIS_SAMPLE_TIME, 1.0f, 1.0f);
+    SimulatedMotor motors[4];
+    motors[1].gain = 20.0f;
+    const float reference[3] = {0.2f, 0.0f, 0.0f};
+    for (int k = 0; k < 200; k++)
+    {
+        const float state[4] = {motors[0].velocity, motors[1].velocity, motors[2].velocity, motors[3].velocity};
+        float duty[4];
+        controller.update(reference, state, duty);
+        for (size_t i = 0; i < 4; i++)
+        {
+            motors[i].step(duty[i]);
+        }
+    }
+
+    // The robot moves straight, the integrators act on the chassis motion
+    for (size_t r = 0; r < 3; r++)
+    {
+        float output = 0.0f;
+        for (size_t i = 0; i < 4; i++)
+        {
+            output += LQR_CHASSIS_C[r][i] * motors[i].velocity;
+        }
+        EXPECT_NEAR(output, reference[r], 1e-3f);
+    }
+}
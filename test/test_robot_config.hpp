@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include <roboost/utils/robot_config.hpp>
+
+using namespace roboost::config;
+using roboost::motor_control::MotorDescription;
+
+class RobotConfigTest : public ::testing::Test
+{
+protected:
+    const MotorDescription motors[4] = {
+        {23, 22, 21, 0, 17, 16, 360, false, {0.105f, 0.125f, 0.005f}},
+        {14, 18, 19, 1, 5, 15, 600, true, {0.105f, 0.125f, 0.005f}},
+        {26, 27, 13, 2, 39, 36, 360, false, {0.105f, 0.125f, 0.005f}},
+        {32, 33, 25, 3, 35, 34, 360, false, {0.11f, 0.13f, 0.0f}},
+    };
+
+    RobotConfig<4> config = make_robot_config(0.06f, 0.3185f, 0.38f, 20.0f, motors);
+    uint8_t blob[serialized_size<4>()];
+
+    void SetUp() override { ASSERT_EQ(serialize(config, blob, sizeof(blob)), sizeof(blob)); }
+
+    // Fallback values that must survive a rejected blob
+    RobotConfig<4> defaults() const { return make_robot_config(0.05f, 0.3f, 0.3f, 10.0f, motors); }
+};
+
+TEST_F(RobotConfigTest, RoundTrip)
+{
+    EXPECT_EQ(sizeof(blob), 113u);
+    EXPECT_EQ(crc32(reinterpret_cast<const uint8_t*>("123456789"), 9), 0xCBF43926u);
+
+    RobotConfig<4> loaded = defaults();
+    ASSERT_EQ(deserialize(blob, sizeof(blob), loaded), ConfigStatus::OK);
+    EXPECT_FLOAT_EQ(loaded.wheel_radius, 0.06f);
+    EXPECT_FLOAT_EQ(loaded.track_width, 0.38f);
+    EXPECT_FLOAT_EQ(loaded.max_wheel_velocity, 20.0f);
+    EXPECT_EQ(loaded.motors[1].encoder_resolution, 600);
+    EXPECT_TRUE(loaded.motors[1].inverted);
+    EXPECT_EQ(loaded.motors[2].encoder_b, 36);
+    EXPECT_FLOAT_EQ(loaded.motors[3].gains.ki, 0.13f);
+}
+
+TEST_F(RobotConfigTest, RejectsCorruptedBlobs)
+{
+    RobotConfig<4> loaded = defaults();
+
+    EXPECT_EQ(deserialize(blob, 8, loaded), ConfigStatus::TOO_SHORT);
+    EXPECT_EQ(deserialize(blob, sizeof(blob) - 1, loaded), ConfigStatus::TOO_SHORT);
+
+    uint8_t corrupted[sizeof(blob)];
+    memcpy(corrupted, blob, sizeof(blob));
+    corrupted[40] ^= 0x01;
+    EXPECT_EQ(deserialize(corrupted, sizeof(corrupted), loaded), ConfigStatus::BAD_CRC);
+
+    memcpy(corrupted, blob, sizeof(blob));
+    corrupted[0] = 0;
+    EXPECT_EQ(deserialize(corrupted, sizeof(corrupted), loaded), ConfigStatus::BAD_MAGIC);
+
+    memcpy(corrupted, blob, sizeof(blob));
+    corrupted[4] = ROBOT_CONFIG_VERSION + 1;
+    EXPECT_EQ(deserialize(corrupted, sizeof(corrupted), loaded), ConfigStatus::UNSUPPORTED_VERSION);
+
+    // Nothing was overwritten
+    EXPECT_FLOAT_EQ(loaded.wheel_radius, 0.05f);
+}
+
+TEST_F(RobotConfigTest, RejectsOtherVariantsAndInvalidValues)
+{
+    RobotConfig<3> three_motors = make_robot_config(0.06f, 0.3f, 0.3f, 20.0f, {motors[0], motors[1], motors[2]});
+    EXPECT_EQ(deserialize(blob, sizeof(blob), three_motors), ConfigStatus::WRONG_MOTOR_COUNT);
+
+    RobotConfig<4> loaded = defaults();
+    RobotConfig<4> invalid = config;
+    invalid.motors[3].encoder_a = invalid.motors[0].in1;
+    ASSERT_EQ(serialize(invalid, blob, sizeof(blob)), sizeof(blob));
+    EXPECT_EQ(deserialize(blob, sizeof(blob), loaded), ConfigStatus::INVALID_VALUES);
+
+    invalid = config;
+    invalid.wheel_radius = -0.06f;
+    ASSERT_EQ(serialize(invalid, blob, sizeof(blob)), sizeof(blob));
+    EXPECT_EQ(deserialize(blob, sizeof(blob), loaded), ConfigStatus::INVALID_VALUES);
+
+    EXPECT_FLOAT_EQ(loaded.wheel_radius, 0.05f);
+    EXPECT_EQ(serialize(config, blob, sizeof(blob) - 1), 0u);
+}
+
+TEST_F(RobotConfigTest, RejectsPinsTheBoardCannotUse)
+{
+    RobotConfig<4> loaded = defaults();
+
+    // GPIO 36 can only be an input
+    RobotConfig<4> invalid = config;
+    invalid.motors[0].enable = 36;
+    invalid.motors[2].encoder_b = 21;
+    ASSERT_EQ(serialize(invalid, blob, sizeof(blob)), sizeof(blob));
+    EXPECT_EQ(deserialize(blob, sizeof(blob), loaded), ConfigStatus::INVALID_VALUES);
+
+    // GPIO 9 belongs to the SPI flash
+    invalid = config;
+    invalid.motors[1].encoder_a = 9;
+    ASSERT_EQ(serialize(invalid, blob, sizeof(blob)), sizeof(blob));
+    EXPECT_EQ(deserialize(blob, sizeof(blob), loaded), ConfigStatus::INVALID_VALUES);
+
+    // Valid on its own, but GPIO 4 is taken by the IMU
+    invalid = config;
+    invalid.motors[1].encoder_a = 4;
+    const uint8_t imu_pins[2] = {4, 0};
+    ASSERT_EQ(serialize(invalid, blob, sizeof(blob)), sizeof(blob));
+    EXPECT_TRUE(is_valid(invalid));
+    EXPECT_EQ(deserialize(blob, sizeof(blob), loaded, imu_pins, 2), ConfigStatus::INVALID_VALUES);
+    EXPECT_EQ(deserialize(blob, sizeof(blob), loaded), ConfigStatus::OK);
+}
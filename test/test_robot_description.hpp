@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include <initializer_list>
+#include <roboost/motor_control/robot_description.hpp>
+
+using namespace roboost::motor_control;
+
+namespace robot_description_test
+{
+    constexpr MotorGains GAINS = {0.105f, 0.125f, 0.005f};
+
+    constexpr MotorDescription MOTORS[] = {
+        {23, 22, 21, 0, 17, 16, 360, false, GAINS},
+        {14, 18, 19, 1, 5, 15, 600, true, GAINS},
+        {26, 27, 13, 2, 39, 36, 360, false, GAINS},
+        {32, 33, 25, 3, 35, 34, 360, false, GAINS},
+    };
+
+    // Six wheels are two more lines. The ESP32 has too few free pins for them, these fit an ESP32-S3 module with quad flash without the
+    // strapping (0, 3, 45, 46), USB (19, 20), flash (26 to 32) and UART0 (43, 44) pins
+    constexpr MotorDescription SIX_MOTORS[] = {
+        {4, 5, 6, 0, 1, 2, 360, false, GAINS},
+        {7, 8, 9, 1, 10, 11, 600, true, GAINS},
+        {12, 13, 14, 2, 15, 16, 360, false, GAINS},
+        {17, 18, 21, 3, 47, 48, 360, false, GAINS},
+        {33, 34, 35, 4, 36, 37, 360, false, GAINS},
+        {38, 39, 40, 5, 41, 42, 360, false, GAINS},
+    };
+
+    constexpr MotorDescription DUPLICATE_PIN[] = {{23, 22, 21, 0, 17, 16, 360, false, GAINS}, {14, 18, 19, 1, 5, 17, 360, false, GAINS}};
+    constexpr MotorDescription DUPLICATE_CHANNEL[] = {{23, 22, 21, 0, 17, 16, 360, false, GAINS}, {14, 18, 19, 0, 5, 15, 360, false, GAINS}};
+    constexpr MotorDescription INPUT_ONLY_DRIVER[] = {{23, 22, 35, 0, 17, 16, 360, false, GAINS}};
+    constexpr MotorDescription FLASH_PIN[] = {{23, 22, 21, 0, 17, 9, 360, false, GAINS}};
+
+    // Not copyable or movable, the factories must construct in place
+    struct Driver
+    {
+        Driver(uint8_t in1, uint8_t in2, uint8_t enable, uint8_t channel) : in1(in1), in2(in2), enable(enable), channel(channel) {}
+        Driver(const Driver&) = delete;
+        Driver& operator=(const Driver&) = delete;
+        uint8_t in1, in2, enable, channel;
+    };
+
+    struct Encoder
+    {
+        Encoder(uint8_t a, uint8_t b, uint16_t resolution) : a(a), b(b), resolution(resolution) {}
+        uint8_t a, b;
+        uint16_t resolution;
+    };
+
+    struct Controller
+    {
+        Controller(double kp, double ki, double kd, double max_sampling_time, double max_integral) : kp(kp), ki(ki), kd(kd), max_sampling_time(max_sampling_time), max_integral(max_integral) {}
+        double kp, ki, kd, max_sampling_time, max_integral;
+    };
+
+    struct Filter
+    {
+    };
+
+    struct MotorController
+    {
+        MotorController(Driver& driver, Encoder& encoder, Controller& controller, Filter&, Filter&, double& min_output) : driver(driver), encoder(encoder), controller(controller), min_output(min_output) {}
+        MotorController(const MotorController&) = delete;
+        Driver& driver;
+        Encoder& encoder;
+        Controller& controller;
+        double& min_output;
+    };
+
+    struct Manager
+    {
+        Manager(std::initializer_list<MotorController*> controllers) : count(controllers.size()), first(*controllers.begin()) {}
+        size_t count;
+        MotorController* first;
+    };
+} // namespace robot_description_test
+
+// The fixture types are qualified in the tests, the library has types of the same names
+using namespace robot_description_test;
+
+TEST(RobotDescriptionTest, ValidatesAtCompileTime)
+{
+    static_assert(motor_count(MOTORS) == 4 && motor_count(SIX_MOTORS) == 6, "Motor count");
+    static_assert(has_unique_pins(MOTORS) && has_unique_pins(SIX_MOTORS), "Valid descriptions have unique pins");
+    static_assert(!has_unique_pins(DUPLICATE_PIN), "Duplicate encoder pin not detected");
+    static_assert(has_valid_pwm_channels(MOTORS, 16) && !has_valid_pwm_channels(MOTORS, 3), "Channel limit");
+    static_assert(!has_valid_pwm_channels(DUPLICATE_CHANNEL, 16), "Duplicate channel not detected");
+    static_assert(has_output_capable_driver_pins(MOTORS, 34, 39) && !has_output_capable_driver_pins(INPUT_ONLY_DRIVER, 34, 39), "Input only pin");
+    static_assert(is_pin_unused(MOTORS, 4) && !is_pin_unused(MOTORS, 36), "Pin usage");
+    static_assert(avoids_pin_range(MOTORS, 6, 11) && avoids_pin_range(SIX_MOTORS, 26, 32) && !avoids_pin_range(FLASH_PIN, 6, 11), "Flash pin");
+    static_assert(has_valid_encoder_resolutions(MOTORS), "Encoder resolution");
+}
+
+TEST(RobotDescriptionTest, BuildsMotorStack)
+{
+    auto drivers = make_motor_drivers<robot_description_test::Driver>(MOTORS);
+    auto encoders = make_encoders<robot_description_test::Encoder>(MOTORS);
+    auto controllers = make_pid_controllers<robot_description_test::Controller>(MOTORS, 0.2, 5.2);
+    std::array<robot_description_test::Filter, 4> input_filters, output_filters;
+    double min_output = 0.35;
+    auto motor_controllers = make_motor_controllers<robot_description_test::MotorController>(drivers, encoders, controllers, input_filters, output_filters, min_output);
+    auto manager = make_motor_controller_manager<robot_description_test::Manager>(motor_controllers);
+
+    EXPECT_EQ(drivers[0].in1, 23);
+    EXPECT_EQ(drivers[3].channel, 3);
+    EXPECT_EQ(encoders[1].resolution, 600);
+    EXPECT_FLOAT_EQ(controllers[2].ki, 0.125f);
+    EXPECT_DOUBLE_EQ(controllers[2].max_integral, 5.2);
+
+    // Inverted motor: driver inputs and encoder channels swapped
+    EXPECT_EQ(drivers[1].in1, 18);
+    EXPECT_EQ(drivers[1].in2, 14);
+    EXPECT_EQ(encoders[1].a, 15);
+    EXPECT_EQ(encoders[1].b, 5);
+
+    EXPECT_EQ(&motor_controllers[2].driver, &drivers[2]);
+    EXPECT_EQ(&motor_controllers[2].encoder, &encoders[2]);
+    EXPECT_EQ(&motor_controllers[3].min_output, &min_output);
+    EXPECT_EQ(manager.count, 4u);
+    EXPECT_EQ(manager.first, &motor_controllers[0]);
+}
+
+TEST(RobotDescriptionTest, BuildsSixWheelVariant)
+{
+    auto drivers = make_motor_drivers<robot_description_test::Driver>(SIX_MOTORS);
+    static_assert(std::tuple_size<decltype(drivers)>::value == 6, "One driver per motor");
+    EXPECT_EQ(drivers[5].enable, 40);
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include <roboost/utils/schedulability.hpp>
+
+using namespace roboost::timing;
+
+class SchedulabilityAnalyzerTest : public ::testing::Test
+{
+protected:
+    SchedulabilityAnalyzer<8> analyzer{SchedulingPolicy::DEADLINE_MONOTONIC, AdmissionMode::REJECT};
+};
+
+TEST_F(SchedulabilityAnalyzerTest, FirmwareTaskSetIsFeasible)
+{
+    // Controller update, executor spin and state print of the serial firmware
+    ASSERT_EQ(analyzer.add_task("Controller update", 20000, 0, 2000), 0);
+    ASSERT_EQ(analyzer.add_task("Executor spin", 200000, 0, 10000), 1);
+    ASSERT_EQ(analyzer.add_task("Robot state", 1000000, 0, 3000), 2);
+
+    ASSERT_TRUE(analyzer.is_feasible());
+    EXPECT_NEAR(analyzer.get_utilization(), 0.1 + 0.05 + 0.003, 1e-5);
+
+    // Controller is blocked by the longest lower priority task
+    std::cout << "Controller response time: " << analyzer.get_task(0).response_time << "us" << std::endl;
+    EXPECT_EQ(analyzer.get_task(0).response_time, 12000u);
+    EXPECT_EQ(analyzer.get_slack(0), 8000);
+    EXPECT_GT(analyzer.get_min_slack(), 0);
+}
+
+TEST_F(SchedulabilityAnalyzerTest, RejectsInfeasibleTask)
+{
+    ASSERT_EQ(analyzer.add_task("Controller update", 20000, 0, 2000), 0);
+
+    // A non-preemptive task longer than the controller deadline blocks it too long
+    EXPECT_EQ(analyzer.add_task("Long task", 100000, 0, 25000), -1);
+    EXPECT_EQ(analyzer.get_task_count(), 1u);
+    EXPECT_TRUE(analyzer.is_feasible());
+}
+
+TEST_F(SchedulabilityAnalyzerTest, MeasuredOverrunMakesSetInfeasible)
+{
+    int control = analyzer.add_task("Controller update", 20000, 0, 2000);
+    int executor = analyzer.add_task("Executor spin", 200000, 0, 10000);
+
+    EXPECT_TRUE(analyzer.update_wcet(control, 1500)); // Smaller than known WCET, ignored
+    EXPECT_EQ(analyzer.get_task(control).wcet, 2000u);
+
+    EXPECT_FALSE(analyzer.update_wcet(executor, 19000));
+    EXPECT_LT(analyzer.get_slack(control), 0);
+}
+
+TEST_F(SchedulabilityAnalyzerTest, EqualPriorityTasksInterfere)
+{
+    ASSERT_EQ(analyzer.add_task("Left motor", 10000, 5000, 3000), 0);
+
+    // Same deadline, so either task can run first and push the other past 5 ms
+    EXPECT_EQ(analyzer.add_task("Right motor", 10000, 5000, 3000), -1);
+    EXPECT_EQ(analyzer.get_task_count(), 1u);
+    EXPECT_EQ(analyzer.get_task(0).response_time, 3000u);
+}
+
+TEST(SchedulabilityAnalyzerRMTest, EqualPeriodTasksInterfere)
+{
+    SchedulabilityAnalyzer<4> analyzer{SchedulingPolicy::RATE_MONOTONIC, AdmissionMode::WARN, true};
+    analyzer.add_task("A", 10000, 0, 3000);
+    analyzer.add_task("B", 10000, 0, 3000);
+
+    EXPECT_TRUE(analyzer.is_feasible());
+    EXPECT_EQ(analyzer.get_task(0).response_time, 6000u);
+    EXPECT_EQ(analyzer.get_task(1).response_time, 6000u);
+    EXPECT_EQ(analyzer.get_min_slack(), 4000);
+}
+
+TEST(SchedulabilityAnalyzerEDFTest, DensityTest)
+{
+    SchedulabilityAnalyzer<4> analyzer{SchedulingPolicy::EDF, AdmissionMode::WARN, true};
+    analyzer.add_task("A", 10000, 0, 5000);
+    analyzer.add_task("B", 20000, 0, 9000);
+    EXPECT_TRUE(analyzer.is_feasible());
+
+    analyzer.add_task("C", 40000, 0, 4000);
+    EXPECT_FALSE(analyzer.is_feasible()); // Warn mode keeps the task
+    EXPECT_EQ(analyzer.get_task_count(), 3u);
+}
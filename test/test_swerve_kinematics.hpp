@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include <math.h>
+#include <roboost/kinematics/swerve_kinematics.hpp>
+
+using namespace roboost::kinematics;
+
+class SwerveKinematicsTest : public ::testing::Test
+{
+protected:
+    static constexpr float wheel_radius = 0.05f;
+
+    // Three modules on a circle of 0.2 m, four on a 0.4 x 0.3 m rectangle
+    const float x3[3] = {0.2f, -0.1f, -0.1f};
+    const float y3[3] = {0.0f, 0.173205f, -0.173205f};
+    const float x4[4] = {0.2f, 0.2f, -0.2f, -0.2f};
+    const float y4[4] = {0.15f, -0.15f, 0.15f, -0.15f};
+
+    SwerveKinematics3W swerve3{x3, y3, wheel_radius, 10.0f};
+    SwerveKinematics4W swerve4{x4, y4, wheel_radius, 10.0f};
+};
+
+TEST_F(SwerveKinematicsTest, TranslationSteersAllModulesAlike)
+{
+    std::array<float, 4> angles = {0.0f, 0.0f, 0.0f, 0.0f};
+    const auto& states = swerve4.calculate_module_states({0.3f, 0.3f, 0.0f}, angles, 1.0f);
+
+    for (const auto& state : states)
+    {
+        EXPECT_NEAR(state.angle, M_PI / 4, 1e-4);
+        EXPECT_NEAR(state.speed, sqrtf(0.18f) / wheel_radius, 1e-3);
+    }
+}
+
+TEST_F(SwerveKinematicsTest, ReversesInsteadOfTurningHalfway)
+{
+    std::array<float, 3> angles = {0.1f, 0.1f, 0.1f};
+    const auto& states = swerve3.calculate_module_states({-0.5f, 0.0f, 0.0f}, angles, 1.0f);
+
+    for (const auto& state : states)
+    {
+        EXPECT_NEAR(state.angle, 0.0f, 1e-4);
+        EXPECT_NEAR(state.speed, -0.5f / wheel_radius, 1e-3);
+    }
+}
+
+TEST_F(SwerveKinematicsTest, KeepsAngleContinuous)
+{
+    // Unwrapped steering angle from a multi turn encoder
+    std::array<float, 3> angles = {4.0f * M_PI, 4.0f * M_PI, 4.0f * M_PI};
+    const auto& states = swerve3.calculate_module_states({0.0f, 0.5f, 0.0f}, angles, 1.0f);
+
+    EXPECT_NEAR(states[0].angle, 4.0f * M_PI + M_PI / 2, 1e-4);
+}
+
+TEST_F(SwerveKinematicsTest, LimitsSteeringRate)
+{
+    swerve4.set_max_steering_rate(1.0f);
+    std::array<float, 4> angles = {0.0f, 0.0f, 0.0f, 0.0f};
+    const auto& states = swerve4.calculate_module_states({0.25f, 0.433013f, 0.0f}, angles, 0.1f);
+
+    // 60 deg requested, 0.1 rad allowed, the speed is reduced by the remaining error
+    EXPECT_NEAR(states[0].angle, 0.1f, 1e-5);
+    EXPECT_NEAR(states[0].speed, 0.5f / wheel_radius * cosf(M_PI / 3 - 0.1f), 0.1);
+    EXPECT_LT(states[0].speed, 0.5f / wheel_radius);
+}
+
+TEST_F(SwerveKinematicsTest, ForwardInvertsInverse)
+{
+    SwerveTwist twist = {0.4f, -0.2f, 1.3f};
+
+    const auto& states3 = swerve3.calculate_module_states(twist);
+    SwerveTwist result3 = swerve3.calculate_robot_velocity(states3);
+    EXPECT_NEAR(result3.vx, twist.vx, 1e-4);
+    EXPECT_NEAR(result3.vy, twist.vy, 1e-4);
+    EXPECT_NEAR(result3.omega, twist.omega, 1e-3);
+
+    const auto& states4 = swerve4.calculate_module_states(twist);
+    SwerveTwist result4 = swerve4.calculate_robot_velocity(states4);
+    EXPECT_NEAR(result4.vx, twist.vx, 1e-4);
+    EXPECT_NEAR(result4.vy, twist.vy, 1e-4);
+    EXPECT_NEAR(result4.omega, twist.omega, 1e-3);
+}
+
+TEST_F(SwerveKinematicsTest, PolynomialMathMatchesLibm)
+{
+    SwerveKinematics<4, roboost::math::PolynomialMath> polynomial{x4, y4, wheel_radius, 10.0f};
+    SwerveTwist twist = {0.4f, -0.2f, 1.3f};
+
+    const auto& reference = swerve4.calculate_module_states(twist);
+    const auto& states = polynomial.calculate_module_states(twist);
+    for (size_t i = 0; i < 4; i++)
+    {
+        EXPECT_NEAR(states[i].angle, reference[i].angle, 1e-5);
+        EXPECT_NEAR(states[i].speed, reference[i].speed, 1e-4);
+    }
+}
@@ -0,0 +1,106 @@
+#include <atomic>
+#include <gtest/gtest.h>
+#include <roboost/utils/timebase.hpp>
+#include <thread>
+#include <vector>
+
+using roboost::timing::WrapExtender;
+
+TEST(TimebaseTest, ExtendsAcrossWraps)
+{
+    WrapExtender extender;
+    uint64_t counter = 0;
+    uint64_t previous = 0;
+    // Steps of a bit less than half the counter range, the minimum read rate
+    for (int i = 0; i < 20; i++)
+    {
+        counter += 0x7FFFFFF0ull;
+        const uint64_t value = extender.read([&]() { return static_cast<uint32_t>(counter); });
+        EXPECT_EQ(value, counter);
+        EXPECT_GT(value, previous);
+        previous = value;
+    }
+}
+
+TEST(TimebaseTest, InterruptBetweenLoadAndReadCountsWrapOnce)
+{
+    WrapExtender extender;
+    EXPECT_EQ(extender.read([]() { return 0x7FFFFFFFu; }), 0x7FFFFFFFull);
+    EXPECT_EQ(extender.read([]() { return 0xFFFFFFF0u; }), 0xFFFFFFF0ull);
+
+    // An interrupt reads after the wrap while the task is between loading the state and reading the counter
+    const uint64_t value = extender.read(
+        [&]()
+        {
+            EXPECT_EQ(extender.read([]() { return 0x00000010u; }), 0x100000010ull);
+            return 0x00000020u;
+        });
+    EXPECT_EQ(value, 0x100000020ull);
+    EXPECT_EQ(extender.read([]() { return 0x00000030u; }), 0x100000030ull);
+}
+
+TEST(TimebaseTest, ConcurrentReadersAgree)
+{
+    // One writer moves the counter between rounds of reads, in steps well below half the counter range. The counter
+    // stands still during every read, so all readers race to publish the same half periods and must see the exact value
+    constexpr int readers = 4;
+    constexpr int rounds = 2000;
+    constexpr uint64_t step = 0x30000000ull;
+
+    WrapExtender extender;
+    std::atomic<uint64_t> counter{0};
+    std::atomic<int> round{0};
+    std::atomic<int> finished{0};
+    std::atomic<bool> failed{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < readers; t++)
+    {
+        threads.emplace_back(
+            [&]()
+            {
+                for (int r = 1; r <= rounds; r++)
+                {
+                    while (round.load() < r)
+                    {
+                        std::this_thread::yield();
+                    }
+                    const uint64_t expected = counter.load();
+                    for (int i = 0; i < 4; i++)
+                    {
+                        if (extender.read([&]() { return static_cast<uint32_t>(counter.load()); }) != expected)
+                        {
+                            failed = true;
+                        }
+                    }
+                    finished.fetch_add(1);
+                }
+            });
+    }
+    for (int r = 1; r <= rounds; r++)
+    {
+        counter.fetch_add(step);
+        round.store(r);
+        while (finished.load() < readers * r)
+        {
+            std::this_thread::yield();
+        }
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_FALSE(failed);
+    EXPECT_EQ(counter.load(), rounds * step);
+}
+
+TEST(TimebaseTest, NowIsMonotonic)
+{
+    uint64_t previous = roboost::timing::now_us64();
+    for (int i = 0; i < 1000; i++)
+    {
+        const uint64_t now = roboost::timing::now_us64();
+        EXPECT_GE(now, previous);
+        previous = now;
+    }
+    EXPECT_FLOAT_EQ(roboost::timing::elapsed_s(0x100000000ull, 0x100000000ull + 1500000), 1.5f);
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include <roboost/utils/timing_context.hpp>
+
+using roboost::timing::TimingContext;
+
+TEST(TimingContextTest, FirstSampleUsesNominalPeriod)
+{
+    TimingContext timing(20000);
+    timing.tick(123456);
+    EXPECT_EQ(timing.get_sample_time_us(), 123456u);
+    EXPECT_EQ(timing.get_period_us(), 20000u);
+    EXPECT_FLOAT_EQ(timing.get_dt(), 0.02f);
+    EXPECT_FALSE(timing.is_overrun());
+}
+
+TEST(TimingContextTest, MeasuresOwnPeriod)
+{
+    TimingContext control(20000), odometry(100000);
+    uint32_t now = 0;
+    for (int i = 0; i < 50; i++)
+    {
+        now += 20000;
+        control.tick(now);
+        if (i % 5 == 0)
+        {
+            odometry.tick(now);
+        }
+    }
+    EXPECT_EQ(control.get_period_us(), 20000u);
+    EXPECT_EQ(odometry.get_period_us(), 100000u);
+    EXPECT_FLOAT_EQ(odometry.get_dt(), 0.1f);
+    EXPECT_EQ(control.get_tick_count(), 50u);
+    EXPECT_EQ(odometry.get_tick_count(), 10u);
+    EXPECT_EQ(control.get_overrun_count() + odometry.get_overrun_count(), 0u);
+}
+
+TEST(TimingContextTest, FlagsOverruns)
+{
+    TimingContext timing(20000, 50000);
+    timing.tick(0);
+    timing.tick(50000);
+    EXPECT_FALSE(timing.is_overrun());
+    timing.tick(100001);
+    EXPECT_TRUE(timing.is_overrun());
+    timing.tick(120001);
+    EXPECT_FALSE(timing.is_overrun());
+    EXPECT_EQ(timing.get_overrun_count(), 1u);
+
+    TimingContext default_limit(20000);
+    default_limit.tick(0);
+    default_limit.tick(30001);
+    EXPECT_TRUE(default_limit.is_overrun());
+}
+
+TEST(TimingContextTest, HandlesLongUptime)
+{
+    // Past the point where a 32 bit microsecond counter wraps
+    TimingContext timing(20000);
+    timing.tick(0xFFFFFFFFull - 9999);
+    timing.tick(0x100000000ull + 10000);
+    EXPECT_EQ(timing.get_sample_time_us(), 0x100000000ull + 10000);
+    EXPECT_EQ(timing.get_period_us(), 20000u);
+    EXPECT_FALSE(timing.is_overrun());
+
+    // A stall longer than 32 bit saturates the period but still flags the overrun
+    timing.tick(0x300000000ull);
+    EXPECT_EQ(timing.get_period_us(), UINT32_MAX);
+    EXPECT_TRUE(timing.is_overrun());
+}
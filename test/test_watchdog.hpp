@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <roboost/utils/watchdog.hpp>
+#include <utility>
+#include <vector>
+
+using namespace roboost::timing;
+
+class WatchdogTest : public ::testing::Test
+{
+protected:
+    static std::vector<std::pair<size_t, WatchdogAction>> actions;
+
+    static void record(size_t task_id, WatchdogAction action) { actions.emplace_back(task_id, action); }
+
+    SoftwareWatchdog<3> watchdog{&record};
+    int control, telemetry;
+
+    void SetUp() override
+    {
+        actions.clear();
+        control = watchdog.add_task("control", 100, WatchdogAction::RESET, 0);
+        telemetry = watchdog.add_task("telemetry", 1000, WatchdogAction::LOG, 0);
+    }
+};
+
+std::vector<std::pair<size_t, WatchdogAction>> WatchdogTest::actions;
+
+TEST_F(WatchdogTest, HealthyWhileBeating)
+{
+    ASSERT_EQ(control, 0);
+    ASSERT_EQ(telemetry, 1);
+    for (uint32_t now = 50; now < 5000; now += 50)
+    {
+        watchdog.get_heartbeat(control).beat();
+        watchdog.get_heartbeat(telemetry).beat();
+        EXPECT_TRUE(watchdog.check(now));
+    }
+    EXPECT_TRUE(actions.empty());
+}
+
+TEST_F(WatchdogTest, EscalatesOncePerDeadline)
+{
+    watchdog.get_heartbeat(telemetry).beat();
+    EXPECT_TRUE(watchdog.check(99));
+    EXPECT_FALSE(watchdog.check(100));
+    EXPECT_EQ(watchdog.get_action(control), WatchdogAction::LOG);
+    EXPECT_FALSE(watchdog.check(150));
+    EXPECT_EQ(actions.size(), 1u);
+
+    EXPECT_FALSE(watchdog.check(200));
+    EXPECT_EQ(watchdog.get_action(control), WatchdogAction::SAFE_STOP);
+    EXPECT_FALSE(watchdog.check(300));
+    EXPECT_FALSE(watchdog.check(400));
+    EXPECT_FALSE(watchdog.check(1000));
+    EXPECT_EQ(watchdog.get_action(control), WatchdogAction::RESET);
+
+    ASSERT_EQ(actions.size(), 4u);
+    EXPECT_EQ(actions[3], std::make_pair(size_t(0), WatchdogAction::RESET));
+    EXPECT_EQ(watchdog.get_miss_count(control), 1u);
+}
+
+TEST_F(WatchdogTest, LateCheckReportsSkippedLevels)
+{
+    watchdog.get_heartbeat(telemetry).beat();
+    EXPECT_FALSE(watchdog.check(350));
+
+    ASSERT_EQ(actions.size(), 3u);
+    EXPECT_EQ(actions[0].second, WatchdogAction::LOG);
+    EXPECT_EQ(actions[1].second, WatchdogAction::SAFE_STOP);
+    EXPECT_EQ(actions[2].second, WatchdogAction::RESTART_TASK);
+}
+
+TEST_F(WatchdogTest, CapsActionAndRecovers)
+{
+    watchdog.get_heartbeat(control).beat();
+    watchdog.check(50);
+    for (uint32_t now = 100; now <= 5000; now += 100)
+    {
+        watchdog.get_heartbeat(control).beat();
+        // A late task capped below RESET does not stop the hardware watchdog feed
+        EXPECT_TRUE(watchdog.check(now));
+    }
+    EXPECT_EQ(watchdog.get_action(telemetry), WatchdogAction::LOG);
+    ASSERT_EQ(actions.size(), 1u);
+
+    watchdog.get_heartbeat(control).beat();
+    watchdog.get_heartbeat(telemetry).beat();
+    EXPECT_TRUE(watchdog.check(5050));
+    EXPECT_EQ(watchdog.get_action(telemetry), WatchdogAction::NONE);
+    EXPECT_EQ(actions.back(), std::make_pair(size_t(1), WatchdogAction::NONE));
+}
+
+TEST_F(WatchdogTest, HandlesLongUptime)
+{
+    // Past the point where a 32 bit microsecond counter wraps
+    constexpr uint64_t uptime = 0x100000000ull;
+    SoftwareWatchdog<1> watchdog;
+    const int id = watchdog.add_task("control", 100, WatchdogAction::RESET, uptime - 50);
+    EXPECT_TRUE(watchdog.check(uptime));
+    EXPECT_TRUE(watchdog.check(uptime + 40));
+    EXPECT_FALSE(watchdog.check(uptime + 60));
+    watchdog.get_heartbeat(id).beat();
+    EXPECT_TRUE(watchdog.check(uptime + 70));
+    EXPECT_EQ(watchdog.add_task("full", 100, WatchdogAction::LOG, 0), -1);
+}
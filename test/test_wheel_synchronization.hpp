@@ -0,0 +1,138 @@
+#include <array>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <roboost/kinematics/kinematics.hpp>
+#include <roboost/motor_control/wheel_synchronization.hpp>
+
+using SynchronizedMecanum = roboost::motor_control::WheelSynchronizationController<roboost::kinematics::MecanumKinematics4W>;
+
+class WheelSynchronizationTest : public ::testing::Test
+{
+protected:
+    using WheelArray = SynchronizedMecanum::WheelArray;
+
+    static constexpr float dt = 0.02f;
+
+    roboost::kinematics::MecanumKinematics4W kinematics{0.05f, 0.4f, 0.3f};
+    SynchronizedMecanum synchronizer{kinematics, 0.2f, 1.0f, 1.5f, 2.0f, 0.5f};
+
+    WheelArray wheel_velocity(float vx, float vy, float omega)
+    {
+        roboost::math::Vector<float> wheels = kinematics.calculate_wheel_velocity(roboost::math::Vector<float>{vx, vy, omega});
+        return {wheels[0], wheels[1], wheels[2], wheels[3]};
+    }
+
+    std::array<float, 3> robot_velocity(const WheelArray& wheels)
+    {
+        roboost::math::Vector<float> robot = kinematics.calculate_robot_velocity(roboost::math::Vector<float>{wheels[0], wheels[1], wheels[2], wheels[3]});
+        return {robot[0], robot[1], robot[2]};
+    }
+
+    // Drives forward with wheels that follow their target with a first order lag, wheel 2 only reaches
+    // 60 % of it. Returns the robot velocity of the measured wheels after 5 s.
+    std::array<float, 3> drive_with_weak_wheel(bool synchronized)
+    {
+        const WheelArray setpoints = wheel_velocity(0.5f, 0.0f, 0.0f);
+        const float gain[4] = {1.0f, 1.0f, 0.6f, 1.0f};
+        WheelArray measured = {};
+        for (int step = 0; step < 250; step++)
+        {
+            const WheelArray targets = synchronized ? synchronizer.update(setpoints, measured, dt) : setpoints;
+            for (size_t i = 0; i < 4; i++)
+            {
+                measured[i] += 0.2f * (gain[i] * targets[i] - measured[i]);
+            }
+        }
+        return robot_velocity(measured);
+    }
+};
+
+TEST_F(WheelSynchronizationTest, PassesSetpointsWithoutError)
+{
+    const WheelArray setpoints = wheel_velocity(0.4f, -0.2f, 0.5f);
+
+    const WheelArray& adjusted = synchronizer.update(setpoints, setpoints, dt);
+
+    for (size_t i = 0; i < 4; i++)
+    {
+        EXPECT_NEAR(adjusted[i], setpoints[i], 1e-5f);
+    }
+    for (float correction : synchronizer.get_correction())
+    {
+        EXPECT_NEAR(correction, 0.0f, 1e-6f);
+    }
+}
+
+TEST_F(WheelSynchronizationTest, StalledWheelSlowsItsPair)
+{
+    const WheelArray setpoints = wheel_velocity(0.5f, 0.0f, 0.0f);
+    WheelArray measured = setpoints;
+    measured[0] = 0.0f;
+
+    const WheelArray& adjusted = synchronizer.update(setpoints, measured, dt);
+
+    // The stalled wheel is pushed harder and at least one other wheel slows down, so the chassis does not turn towards the stalled wheel
+    EXPECT_GT(std::fabs(adjusted[0]), std::fabs(setpoints[0]));
+    size_t slowed = 0;
+    for (size_t i = 1; i < 4; i++)
+    {
+        slowed += std::fabs(adjusted[i]) < std::fabs(setpoints[i]) - 1e-3f ? 1 : 0;
+    }
+    EXPECT_GE(slowed, 1u);
+
+    // The wheel correction is a robot motion that opposes the robot-frame error
+    const std::array<float, 3> commanded = robot_velocity(setpoints);
+    const std::array<float, 3> corrected = robot_velocity(adjusted);
+    const std::array<float, 3>& error = synchronizer.get_robot_error();
+    for (size_t i = 0; i < 3; i++)
+    {
+        EXPECT_NEAR(corrected[i] - commanded[i], synchronizer.get_correction()[i], 1e-4f);
+        EXPECT_GE((corrected[i] - commanded[i]) * error[i], 0.0f);
+    }
+    EXPECT_NE(error[2], 0.0f);
+}
+
+TEST_F(WheelSynchronizationTest, WeakWheelKeepsChassisOnCourse)
+{
+    const std::array<float, 3> independent = drive_with_weak_wheel(false);
+    const std::array<float, 3> synchronized = drive_with_weak_wheel(true);
+
+    // The independent loops turn and drift, the coupled ones drive straight at the commanded speed
+    EXPECT_GT(std::fabs(independent[2]), 0.1f);
+    EXPECT_NEAR(synchronized[0], 0.5f, 0.01f);
+    EXPECT_NEAR(synchronized[1], 0.0f, 0.01f);
+    EXPECT_NEAR(synchronized[2], 0.0f, 0.01f);
+}
+
+TEST_F(WheelSynchronizationTest, LimitsIntegral)
+{
+    const WheelArray setpoints = wheel_velocity(0.5f, 0.0f, 0.0f);
+    const WheelArray stopped = {};
+
+    for (int step = 0; step < 1000; step++)
+    {
+        synchronizer.update(setpoints, stopped, dt);
+    }
+
+    for (float integral : synchronizer.get_integral())
+    {
+        EXPECT_LE(std::fabs(integral), 0.5f + 1e-6f);
+    }
+    EXPECT_FLOAT_EQ(synchronizer.get_integral()[0], 0.5f);
+}
+
+TEST_F(WheelSynchronizationTest, ResetClearsState)
+{
+    const WheelArray setpoints = wheel_velocity(0.5f, 0.0f, 0.0f);
+    synchronizer.update(setpoints, WheelArray{}, dt);
+
+    synchronizer.reset();
+
+    for (size_t i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(synchronizer.get_integral()[i], 0.0f);
+        EXPECT_EQ(synchronizer.get_correction()[i], 0.0f);
+    }
+    const WheelArray& adjusted = synchronizer.update(setpoints, setpoints, dt);
+    EXPECT_NEAR(adjusted[0], setpoints[0], 1e-5f);
+}